@@ -65,8 +65,10 @@
 #define LOG_TAG "agm_client_wrapper"
 
 #include <errno.h>
+#include <sys/mman.h>
 #include <agm/agm_api.h>
 #include <gio/gio.h>
+#include <gio/gunixfdlist.h>
 #include "utils.h"
 
 #define AGM_OBJECT_PATH "/org/qti/agm"
@@ -634,6 +636,21 @@ exit:
     return rc;
 }
 
+/*
+ *Filters are applied by the service to in-process callbacks, callbacks of
+ *remote clients are registered unfiltered by the IPC server.
+ */
+int agm_session_register_cb_filtered(uint32_t session_id, agm_event_cb cb,
+                                     enum event_type evt_type, void *client_data,
+                                     const struct agm_event_filter *filter)
+{
+    if (cb && filter && (filter->num_event_ids || filter->num_module_ids)) {
+        AGM_LOGE("%s: event filters are not supported over IPC\n", __func__);
+        return -EOPNOTSUPP;
+    }
+    return agm_session_register_cb(session_id, cb, evt_type, client_data);
+}
+
 int agm_session_register_for_events(uint32_t session_id,
                                     struct agm_event_reg_cfg *evt_reg_cfg) {
     GVariant *value_1, *value_2, *value_arr, *argument;
@@ -1170,12 +1187,14 @@ int agm_session_get_buf_info(uint32_t session_id, struct agm_buf_info *buf_info,
                              uint32_t flag)
 {
     GVariant *value_1 = NULL, *value_2 = NULL, *struct_v = NULL, *argument = NULL;
-    GVariant *val_arr = NULL, *result = NULL;
+    GVariant *val_arr = NULL, *result = NULL, *fds_v = NULL;
     GVariantIter arg_i, struct_i;
+    GUnixFDList *fd_list = NULL;
     GError *error = NULL;
     gconstpointer value;
     gsize n_elements;
     gsize element_size = sizeof(guchar);
+    gint32 fd_idx;
     int rc = 0;
 
     AGM_LOGD("%s\n", __func__);
@@ -1195,12 +1214,14 @@ int agm_session_get_buf_info(uint32_t session_id, struct agm_buf_info *buf_info,
             return rc;
     }
 
-    result = g_dbus_proxy_call_sync(mdata->proxy,
+    result = g_dbus_proxy_call_with_unix_fd_list_sync(mdata->proxy,
                                     "AgmSessionGetBufInfo",
                                     argument,
                                     G_DBUS_CALL_FLAGS_NONE,
                                     -1,
                                     NULL,
+                                    &fd_list,
+                                    NULL,
                                     &error);
 
     if (result == NULL) {
@@ -1218,7 +1239,24 @@ int agm_session_get_buf_info(uint32_t session_id, struct agm_buf_info *buf_info,
     g_variant_iter_next(&struct_i, "i", &buf_info->data_buf_size);
     g_variant_iter_next(&struct_i, "i", &buf_info->pos_buf_fd);
     g_variant_iter_next(&struct_i, "i", &buf_info->pos_buf_size);
+    /* time page fd, if asked for, is the only entry of the fd array */
+    buf_info->time_buf_fd = -1;
+    fds_v = g_variant_iter_next_value(&struct_i);
+    if (fds_v && g_variant_n_children(fds_v) && fd_list) {
+        g_variant_get_child(fds_v, 0, "h", &fd_idx);
+        buf_info->time_buf_fd = g_unix_fd_list_get(fd_list, fd_idx, &error);
+        if (buf_info->time_buf_fd < 0) {
+            AGM_LOGE("%s: no time page fd: %s\n", __func__, error->message);
+            g_error_free(error);
+            rc = -EINVAL;
+        }
+    }
+    if (fds_v)
+        g_variant_unref(fds_v);
+    g_variant_iter_next(&struct_i, "i", &buf_info->time_buf_size);
     g_variant_unref(result);
+    if (fd_list)
+        g_object_unref(fd_list);
     return rc;
 }
 
@@ -1914,6 +1952,42 @@ int agm_session_stop(uint64_t handle) {
     return 0;
 }
 
+int agm_session_cmd_async(uint64_t handle, enum agm_session_cmd cmd,
+                          uint32_t token) {
+    agm_client_session_data *ses_data = (agm_client_session_data *) handle;
+    GVariant *argument;
+    GVariant *result = NULL;
+    GError *error = NULL;
+
+    g_assert(ses_data != NULL);
+    g_assert(ses_data->proxy != NULL);
+    AGM_LOGD("%s\n", __func__);
+
+    /* the session proxy goes away with AgmSessionClose only */
+    if (cmd == AGM_SESSION_CMD_CLOSE)
+        return -EOPNOTSUPP;
+
+    argument = g_variant_new("(uu)", (uint32_t)cmd, token);
+
+    result = g_dbus_proxy_call_sync(ses_data->proxy,
+                                    "AgmSessionCmdAsync",
+                                    argument,
+                                    G_DBUS_CALL_FLAGS_NONE,
+                                    -1,
+                                    NULL,
+                                    &error);
+
+    if (result == NULL) {
+        AGM_LOGE("%s: Error invoking AgmSessionCmdAsync: %s\n", __func__,
+                  error->message);
+        g_error_free(error);
+        return -EINVAL;
+    }
+
+    g_variant_unref(result);
+    return 0;
+}
+
 int agm_session_start(uint64_t handle) {
     agm_client_session_data *ses_data = (agm_client_session_data *) handle;
     GVariant *result = NULL;
@@ -2029,48 +2103,14 @@ int agm_session_close(uint64_t handle) {
     return 0;
 }
 
-int agm_session_open(uint32_t session_id, enum agm_session_mode sess_mode, uint64_t *handle) {
-
-    GVariant *value_1 = NULL, *value_2 = NULL, *argument = NULL;
-
-    GVariant *result = NULL;
+/* Bind the object path returned for an opened session to a client handle */
+static int agm_session_attach(uint32_t session_id, GVariant *result,
+                              uint64_t *handle) {
     GError *error = NULL;
     int rc = 0;
     agm_client_session_data *ses_data = NULL;
-    agm_callback_data *cb_data;
     gchar thread_name[16] = "";
 
-    g_assert(handle != NULL);
-    AGM_LOGD("%s\n", __func__);
-
-    if (mdata == NULL) {
-        if ((rc = initialize_module_data()) != 0)
-            return rc;
-    }
-
-    value_1 = g_variant_new_uint32(session_id);
-    value_2 = g_variant_new_uint32(sess_mode);
-
-    argument = g_variant_new("(@u@u)", value_1, value_2);
-
-
-    result = g_dbus_proxy_call_sync(mdata->proxy,
-                                    "AgmSessionOpen",
-                                    argument,
-                                    G_DBUS_CALL_FLAGS_NONE,
-                                    -1,
-                                    NULL,
-                                    &error);
-
-    if (result == NULL) {
-        AGM_LOGE("%s: Error invoking AgmSessionOpen: %s\n", __func__,
-                  error->message);
-        g_error_free(error);
-        rc = -EINVAL;
-        goto exit;
-    }
-
-
     if ((ses_data = (agm_client_session_data *)g_hash_table_lookup(
                                         mdata->ses_hash_table,
                                         GINT_TO_POINTER(session_id))) == NULL) {
@@ -2137,6 +2177,663 @@ exit:
     return rc;
 }
 
+int agm_session_open(uint32_t session_id, enum agm_session_mode sess_mode, uint64_t *handle) {
+
+    GVariant *value_1 = NULL, *value_2 = NULL, *argument = NULL;
+
+    GVariant *result = NULL;
+    GError *error = NULL;
+    int rc = 0;
+
+    g_assert(handle != NULL);
+    AGM_LOGD("%s\n", __func__);
+
+    if (mdata == NULL) {
+        if ((rc = initialize_module_data()) != 0)
+            return rc;
+    }
+
+    value_1 = g_variant_new_uint32(session_id);
+    value_2 = g_variant_new_uint32(sess_mode);
+
+    argument = g_variant_new("(@u@u)", value_1, value_2);
+
+
+    result = g_dbus_proxy_call_sync(mdata->proxy,
+                                    "AgmSessionOpen",
+                                    argument,
+                                    G_DBUS_CALL_FLAGS_NONE,
+                                    -1,
+                                    NULL,
+                                    &error);
+
+    if (result == NULL) {
+        AGM_LOGE("%s: Error invoking AgmSessionOpen: %s\n", __func__,
+                  error->message);
+        g_error_free(error);
+        rc = -EINVAL;
+        return rc;
+    }
+
+    return agm_session_attach(session_id, result, handle);
+}
+
+int agm_session_transact(void *txn, size_t txn_size, uint64_t *handle) {
+    struct agm_session_txn *session_txn = (struct agm_session_txn *)txn;
+    GVariant *value_1, *value_2, *argument;
+    GVariant *result = NULL;
+    GError *error = NULL;
+    int rc = 0;
+
+    g_assert(txn != NULL && handle != NULL);
+    AGM_LOGD("%s\n", __func__);
+
+    if (txn_size < sizeof(struct agm_session_txn))
+        return -EINVAL;
+
+    *handle = 0;
+    if (mdata == NULL) {
+        if ((rc = initialize_module_data()) != 0)
+            return rc;
+    }
+
+    value_1 = g_variant_new_uint32(txn_size);
+    value_2 = g_variant_new_fixed_array(G_VARIANT_TYPE_BYTE,
+                                        (gconstpointer)txn,
+                                        txn_size,
+                                        sizeof(gchar));
+
+    argument = g_variant_new("(@u@ay)", value_1, value_2);
+
+    result = g_dbus_proxy_call_sync(mdata->proxy,
+                                    "AgmSessionTransact",
+                                    argument,
+                                    G_DBUS_CALL_FLAGS_NONE,
+                                    -1,
+                                    NULL,
+                                    &error);
+
+    if (result == NULL) {
+        AGM_LOGE("%s: Error invoking AgmSessionTransact: %s\n", __func__,
+                  error->message);
+        g_error_free(error);
+        rc = -EINVAL;
+        return rc;
+    }
+
+    /* only a transaction which opened the session replies an object path */
+    if (session_txn->flags & (AGM_SESSION_TXN_OPEN | AGM_SESSION_TXN_PREPARE |
+                              AGM_SESSION_TXN_START))
+        return agm_session_attach(session_txn->session_id, result, handle);
+
+    g_variant_unref(result);
+    return rc;
+}
+
+int agm_blob_register(enum agm_blob_type type, void *blob, size_t size,
+                      uint32_t *blob_id) {
+    GVariant *value_1, *value_2, *value_3, *argument;
+    GVariant *result = NULL;
+    GError *error = NULL;
+    int rc = 0;
+
+    g_assert(blob != NULL && blob_id != NULL);
+    AGM_LOGD("%s\n", __func__);
+
+    value_1 = g_variant_new_uint32(type);
+    value_2 = g_variant_new_uint32(size);
+    value_3 = g_variant_new_fixed_array(G_VARIANT_TYPE_BYTE,
+                                        (gconstpointer)blob,
+                                        size,
+                                        sizeof(gchar));
+
+    argument = g_variant_new("(@u@u@ay)", value_1, value_2, value_3);
+
+    if (mdata == NULL) {
+        if ((rc = initialize_module_data()) != 0)
+            return rc;
+    }
+
+    result = g_dbus_proxy_call_sync(mdata->proxy,
+                                    "AgmBlobRegister",
+                                    argument,
+                                    G_DBUS_CALL_FLAGS_NONE,
+                                    -1,
+                                    NULL,
+                                    &error);
+
+    if (result == NULL) {
+        AGM_LOGE("%s: Error invoking AgmBlobRegister: %s\n", __func__,
+                  error->message);
+        g_error_free(error);
+        rc = -EINVAL;
+        return rc;
+    }
+
+    g_variant_get(result, "(u)", blob_id);
+    g_variant_unref(result);
+    return rc;
+}
+
+int agm_blob_unregister(uint32_t blob_id) {
+    GVariant *argument;
+    GVariant *result = NULL;
+    GError *error = NULL;
+    int rc = 0;
+
+    AGM_LOGD("%s\n", __func__);
+
+    argument = g_variant_new("(u)", blob_id);
+
+    if (mdata == NULL) {
+        if ((rc = initialize_module_data()) != 0)
+            return rc;
+    }
+
+    result = g_dbus_proxy_call_sync(mdata->proxy,
+                                    "AgmBlobUnregister",
+                                    argument,
+                                    G_DBUS_CALL_FLAGS_NONE,
+                                    -1,
+                                    NULL,
+                                    &error);
+
+    if (result == NULL) {
+        AGM_LOGE("%s: Error invoking AgmBlobUnregister: %s\n", __func__,
+                  error->message);
+        g_error_free(error);
+        rc = -EINVAL;
+        return rc;
+    }
+
+    g_variant_unref(result);
+    return rc;
+}
+
+int agm_session_set_blob(uint32_t session_id, uint32_t aif_id,
+                         uint32_t blob_id) {
+    GVariant *value_1, *value_2, *value_3, *argument;
+    GVariant *result = NULL;
+    GError *error = NULL;
+    int rc = 0;
+
+    AGM_LOGD("%s\n", __func__);
+
+    value_1 = g_variant_new_uint32(session_id);
+    value_2 = g_variant_new_uint32(aif_id);
+    value_3 = g_variant_new_uint32(blob_id);
+
+    argument = g_variant_new("(@u@u@u)", value_1, value_2, value_3);
+
+    if (mdata == NULL) {
+        if ((rc = initialize_module_data()) != 0)
+            return rc;
+    }
+
+    result = g_dbus_proxy_call_sync(mdata->proxy,
+                                    "AgmSessionSetBlob",
+                                    argument,
+                                    G_DBUS_CALL_FLAGS_NONE,
+                                    -1,
+                                    NULL,
+                                    &error);
+
+    if (result == NULL) {
+        AGM_LOGE("%s: Error invoking AgmSessionSetBlob: %s\n", __func__,
+                  error->message);
+        g_error_free(error);
+        rc = -EINVAL;
+        return rc;
+    }
+
+    g_variant_unref(result);
+    return rc;
+}
+
+int agm_session_set_gain(uint32_t session_id, uint32_t gain,
+                         uint32_t ramp_duration_ms) {
+    GVariant *argument;
+    GVariant *result = NULL;
+    GError *error = NULL;
+    int rc = 0;
+
+    AGM_LOGD("%s\n", __func__);
+
+    argument = g_variant_new("(uuu)", session_id, gain, ramp_duration_ms);
+
+    if (mdata == NULL) {
+        if ((rc = initialize_module_data()) != 0)
+            return rc;
+    }
+
+    result = g_dbus_proxy_call_sync(mdata->proxy,
+                                    "AgmSessionSetGain",
+                                    argument,
+                                    G_DBUS_CALL_FLAGS_NONE,
+                                    -1,
+                                    NULL,
+                                    &error);
+
+    if (result == NULL) {
+        AGM_LOGE("%s: Error invoking AgmSessionSetGain: %s\n", __func__,
+                  error->message);
+        g_error_free(error);
+        rc = -EINVAL;
+        return rc;
+    }
+
+    g_variant_unref(result);
+    return rc;
+}
+
+int agm_session_aif_set_gain(uint32_t session_id, uint32_t aif_id,
+                             uint32_t gain, uint32_t ramp_duration_ms) {
+    GVariant *argument;
+    GVariant *result = NULL;
+    GError *error = NULL;
+    int rc = 0;
+
+    AGM_LOGD("%s\n", __func__);
+
+    argument = g_variant_new("(uuuu)", session_id, aif_id, gain,
+                             ramp_duration_ms);
+
+    if (mdata == NULL) {
+        if ((rc = initialize_module_data()) != 0)
+            return rc;
+    }
+
+    result = g_dbus_proxy_call_sync(mdata->proxy,
+                                    "AgmSessionAifSetGain",
+                                    argument,
+                                    G_DBUS_CALL_FLAGS_NONE,
+                                    -1,
+                                    NULL,
+                                    &error);
+
+    if (result == NULL) {
+        AGM_LOGE("%s: Error invoking AgmSessionAifSetGain: %s\n", __func__,
+                  error->message);
+        g_error_free(error);
+        rc = -EINVAL;
+        return rc;
+    }
+
+    g_variant_unref(result);
+    return rc;
+}
+
+int agm_session_stage_params(uint32_t session_id, void *payload,
+                             size_t size) {
+    GVariant *value_1, *value_2, *value_3, *argument;
+    GVariant *result = NULL;
+    GError *error = NULL;
+    int rc = 0;
+
+    g_assert(payload != NULL);
+    AGM_LOGD("%s\n", __func__);
+
+    value_1 = g_variant_new_uint32(session_id);
+    value_2 = g_variant_new_uint32(size);
+    value_3 = g_variant_new_fixed_array(G_VARIANT_TYPE_BYTE,
+                                        (gconstpointer)payload,
+                                        size,
+                                        sizeof(gchar));
+
+    argument = g_variant_new("(@u@u@ay)", value_1, value_2, value_3);
+
+    if (mdata == NULL) {
+        if ((rc = initialize_module_data()) != 0)
+            return rc;
+    }
+
+    result = g_dbus_proxy_call_sync(mdata->proxy,
+                                    "AgmSessionStageParams",
+                                    argument,
+                                    G_DBUS_CALL_FLAGS_NONE,
+                                    -1,
+                                    NULL,
+                                    &error);
+
+    if (result == NULL) {
+        AGM_LOGE("%s: Error invoking AgmSessionStageParams: %s\n", __func__,
+                  error->message);
+        g_error_free(error);
+        rc = -EINVAL;
+        return rc;
+    }
+
+    g_variant_unref(result);
+    return rc;
+}
+
+int agm_session_aif_stage_params(uint32_t session_id, uint32_t aif_id,
+                                 void *payload, size_t size) {
+    GVariant *value_1, *value_2, *value_3, *value_4, *argument;
+    GVariant *result = NULL;
+    GError *error = NULL;
+    int rc = 0;
+
+    g_assert(payload != NULL);
+    AGM_LOGD("%s\n", __func__);
+
+    value_1 = g_variant_new_uint32(session_id);
+    value_2 = g_variant_new_uint32(aif_id);
+    value_3 = g_variant_new_uint32(size);
+    value_4 = g_variant_new_fixed_array(G_VARIANT_TYPE_BYTE,
+                                        (gconstpointer)payload,
+                                        size,
+                                        sizeof(gchar));
+
+    argument = g_variant_new("(@u@u@u@ay)", value_1, value_2, value_3, value_4);
+
+    if (mdata == NULL) {
+        if ((rc = initialize_module_data()) != 0)
+            return rc;
+    }
+
+    result = g_dbus_proxy_call_sync(mdata->proxy,
+                                    "AgmSessionAifStageParams",
+                                    argument,
+                                    G_DBUS_CALL_FLAGS_NONE,
+                                    -1,
+                                    NULL,
+                                    &error);
+
+    if (result == NULL) {
+        AGM_LOGE("%s: Error invoking AgmSessionAifStageParams: %s\n", __func__,
+                  error->message);
+        g_error_free(error);
+        rc = -EINVAL;
+        return rc;
+    }
+
+    g_variant_unref(result);
+    return rc;
+}
+
+int agm_session_commit_params(uint32_t session_id) {
+    GVariant *argument;
+    GVariant *result = NULL;
+    GError *error = NULL;
+    int rc = 0;
+
+    AGM_LOGD("%s\n", __func__);
+
+    argument = g_variant_new("(u)", session_id);
+
+    if (mdata == NULL) {
+        if ((rc = initialize_module_data()) != 0)
+            return rc;
+    }
+
+    result = g_dbus_proxy_call_sync(mdata->proxy,
+                                    "AgmSessionCommitParams",
+                                    argument,
+                                    G_DBUS_CALL_FLAGS_NONE,
+                                    -1,
+                                    NULL,
+                                    &error);
+
+    if (result == NULL) {
+        AGM_LOGE("%s: Error invoking AgmSessionCommitParams: %s\n", __func__,
+                  error->message);
+        g_error_free(error);
+        rc = -EINVAL;
+        return rc;
+    }
+
+    g_variant_unref(result);
+    return rc;
+}
+
+int agm_session_get_cal_stats(uint32_t session_id, uint32_t *applied,
+                              uint32_t *skipped) {
+    GVariant *argument;
+    GVariant *result = NULL;
+    GError *error = NULL;
+    int rc = 0;
+
+    AGM_LOGD("%s\n", __func__);
+
+    if (!applied || !skipped)
+        return -EINVAL;
+
+    argument = g_variant_new("(u)", session_id);
+
+    if (mdata == NULL) {
+        if ((rc = initialize_module_data()) != 0)
+            return rc;
+    }
+
+    result = g_dbus_proxy_call_sync(mdata->proxy,
+                                    "AgmSessionGetCalStats",
+                                    argument,
+                                    G_DBUS_CALL_FLAGS_NONE,
+                                    -1,
+                                    NULL,
+                                    &error);
+
+    if (result == NULL) {
+        AGM_LOGE("%s: Error invoking AgmSessionGetCalStats: %s\n", __func__,
+                  error->message);
+        g_error_free(error);
+        return -EINVAL;
+    }
+
+    g_variant_get(result, "(uu)", applied, skipped);
+    g_variant_unref(result);
+    return rc;
+}
+
+int agm_session_set_params_owned(uint32_t session_id, uint32_t aif_id,
+                                 void *payload, size_t size) {
+    int rc;
+
+    /* the payload is marshalled anyway, ownership only saves the free */
+    if (aif_id == AGM_AIF_NONE)
+        rc = agm_session_set_params(session_id, payload, size);
+    else
+        rc = agm_session_aif_set_params(session_id, aif_id, payload, size);
+    free(payload);
+    return rc;
+}
+
+int agm_session_set_params_fd(uint32_t session_id, uint32_t aif_id,
+                              int fd, size_t size) {
+    void *payload;
+    int rc;
+
+    /* fds are not passed over this transport, send the mapped contents */
+    payload = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (payload == MAP_FAILED) {
+        AGM_LOGE("%s: mmap failed for fd %d, size %zu\n", __func__, fd, size);
+        return -errno;
+    }
+
+    if (aif_id == AGM_AIF_NONE)
+        rc = agm_session_set_params(session_id, payload, size);
+    else
+        rc = agm_session_aif_set_params(session_id, aif_id, payload, size);
+    munmap(payload, size);
+    return rc;
+}
+
+/*
+ *Data moves through the per-session async thread of the server one buffer
+ *at a time, vectored calls are issued as a sequence of plain ones.
+ */
+int agm_session_writev(uint64_t handle, struct agm_iovec *iov,
+                       uint32_t iovcnt, uint32_t *done) {
+    size_t count, requested;
+    uint32_t i;
+    int rc = 0;
+
+    if (!iov || !done || iovcnt == 0 || iovcnt > AGM_SESSION_MAX_IOV)
+        return -EINVAL;
+
+    *done = 0;
+    for (i = 0; i < iovcnt; i++) {
+        requested = count = iov[i].size;
+        rc = agm_session_write(handle, iov[i].addr, &count);
+        iov[i].size = rc ? 0 : (uint32_t)count;
+        if (rc || count < requested)
+            break;
+        (*done)++;
+    }
+    while (++i < iovcnt)
+        iov[i].size = 0;
+    return rc;
+}
+
+int agm_session_readv(uint64_t handle, struct agm_iovec *iov,
+                      uint32_t iovcnt, uint32_t *done) {
+    size_t count, requested;
+    uint32_t i;
+    int rc = 0;
+
+    if (!iov || !done || iovcnt == 0 || iovcnt > AGM_SESSION_MAX_IOV)
+        return -EINVAL;
+
+    *done = 0;
+    for (i = 0; i < iovcnt; i++) {
+        requested = count = iov[i].size;
+        rc = agm_session_read(handle, iov[i].addr, &count);
+        iov[i].size = rc ? 0 : (uint32_t)count;
+        iov[i].flags = 0;
+        if (rc || count < requested)
+            break;
+        (*done)++;
+    }
+    while (++i < iovcnt)
+        iov[i].size = 0;
+    return rc;
+}
+
+/*
+ *Reads on this transport are serviced by the per-session async thread of
+ *the server, fan-out readers are not carried over it.
+ */
+int agm_session_reader_open(uint64_t handle, uint64_t *reader) {
+    AGM_LOGE("%s: not supported over D-Bus\n", __func__);
+    return -EOPNOTSUPP;
+}
+
+int agm_session_reader_read(uint64_t reader, void *buff, size_t *count,
+                            uint64_t *dropped) {
+    AGM_LOGE("%s: not supported over D-Bus\n", __func__);
+    return -EOPNOTSUPP;
+}
+
+int agm_session_reader_close(uint64_t reader) {
+    return -EOPNOTSUPP;
+}
+
+int agm_get_thread_sched_info(struct agm_thread_sched_info *info,
+                              uint32_t *num) {
+    GVariant *argument = NULL, *result = NULL, *array_v = NULL;
+    GError *error = NULL;
+    GVariantIter arg_i, array_i;
+    uint32_t count, i = 0;
+    guint64 cpu_mask;
+    int rc = 0;
+
+    AGM_LOGD("%s\n", __func__);
+
+    if (!num)
+        return -EINVAL;
+
+    argument = g_variant_new("(u)", info ? *num : 0);
+
+    if (mdata == NULL) {
+        if ((rc = initialize_module_data()) != 0)
+            return rc;
+    }
+
+    result = g_dbus_proxy_call_sync(mdata->proxy,
+                                    "AgmGetThreadSchedInfo",
+                                    argument,
+                                    G_DBUS_CALL_FLAGS_NONE,
+                                    -1,
+                                    NULL,
+                                    &error);
+
+    if (result == NULL) {
+        AGM_LOGE("%s: Error invoking AgmGetThreadSchedInfo: %s\n", __func__,
+                  error->message);
+        g_error_free(error);
+        return -EINVAL;
+    }
+
+    g_variant_iter_init(&arg_i, result);
+    g_variant_iter_next(&arg_i, "u", &count);
+    array_v = g_variant_iter_next_value(&arg_i);
+    if (info) {
+        /* never trust the reply to stay within the array of the caller */
+        if (count > *num) {
+            rc = -EINVAL;
+            goto done;
+        }
+        g_variant_iter_init(&array_i, array_v);
+        while (i < count && g_variant_iter_next(&array_i, "(iuiit)",
+                                                &info[i].tid,
+                                                &info[i].thread_class,
+                                                &info[i].policy,
+                                                &info[i].priority,
+                                                &cpu_mask)) {
+            info[i].cpu_mask = cpu_mask;
+            i++;
+        }
+        count = i;
+    }
+    *num = count;
+
+done:
+    g_variant_unref(array_v);
+    g_variant_unref(result);
+    return rc;
+}
+
+int agm_get_ssr_stats(struct agm_ssr_stats *stats) {
+    GVariant *result = NULL;
+    GError *error = NULL;
+    guint64 down_to_restored_us, up_to_restored_us;
+    int rc = 0;
+
+    AGM_LOGD("%s\n", __func__);
+
+    if (!stats)
+        return -EINVAL;
+
+    if (mdata == NULL) {
+        if ((rc = initialize_module_data()) != 0)
+            return rc;
+    }
+
+    result = g_dbus_proxy_call_sync(mdata->proxy,
+                                    "AgmGetSsrStats",
+                                    NULL,
+                                    G_DBUS_CALL_FLAGS_NONE,
+                                    -1,
+                                    NULL,
+                                    &error);
+
+    if (result == NULL) {
+        AGM_LOGE("%s: Error invoking AgmGetSsrStats: %s\n", __func__,
+                  error->message);
+        g_error_free(error);
+        return -EINVAL;
+    }
+
+    g_variant_get(result, "(uuutt)", &stats->ssr_count,
+                  &stats->sessions_restored, &stats->sessions_failed,
+                  &down_to_restored_us, &up_to_restored_us);
+    stats->down_to_restored_us = down_to_restored_us;
+    stats->up_to_restored_us = up_to_restored_us;
+    g_variant_unref(result);
+    return rc;
+}
+
 int agm_init() {
     GError *error = NULL;
     int rc = 0;
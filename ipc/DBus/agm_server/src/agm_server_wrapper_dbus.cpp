@@ -68,8 +68,10 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <unistd.h>
 #include <sstream>
 #include <agm/agm_api.h>
+#include <agm/agm_sched.h>
 #include "agm-dbus-utils.h"
 #include "agm_server_wrapper_dbus.h"
 
@@ -80,6 +82,9 @@
 #define AGM_SESSION_IFACE "org.Qti.Agm.Session"
 #define AGM_DBUS_CONNECTION "org.Qti.AgmService"
 
+/* the service lists far fewer threads, bounds what a client can ask for */
+#define MAX_THREAD_SCHED_INFO 64
+
 using namespace std;
 
 /* Module Level data */
@@ -90,6 +95,9 @@ typedef struct {
     agm_dbus_connection *conn;
     /* Hashmap containing all sessions info */
     GHashTable *sessions;
+    /* Hashmap of the blob ids registered by each client, keyed by the
+       unique bus name of the client. Used to drop them when it goes away */
+    GHashTable *blobs;
 } agm_module_dbus_data;
 
 /* Session specific data */
@@ -145,6 +153,18 @@ enum AgmModuleMethods {
     AgmSessionGetBufInfo,
     AgmGetBufferTimestamp,
     AgmSessionOpen,
+    AgmSessionTransact,
+    AgmBlobRegister,
+    AgmBlobUnregister,
+    AgmSessionSetBlob,
+    AgmGetThreadSchedInfo,
+    AgmGetSsrStats,
+    AgmSessionSetGain,
+    AgmSessionAifSetGain,
+    AgmSessionStageParams,
+    AgmSessionAifStageParams,
+    AgmSessionCommitParams,
+    AgmSessionGetCalStats,
     AgmDbusModuleMethodMax
 };
 
@@ -161,6 +181,7 @@ enum AgmSessionMethods {
     AgmSessionEos,
     AgmSessionGetTime,
     AgmGetHwProcessedBufCount,
+    AgmSessionCmdAsync,
     AgmDbusSessionMethodMax
 };
 
@@ -237,6 +258,42 @@ static void ipc_agm_session_get_buf_info(DBusConnection *conn,
 static void ipc_agm_session_open(DBusConnection *conn,
                                  DBusMessage *msg,
                                  void *userdata);
+static void ipc_agm_session_transact(DBusConnection *conn,
+                                     DBusMessage *msg,
+                                     void *userdata);
+static void ipc_agm_blob_register(DBusConnection *conn,
+                                  DBusMessage *msg,
+                                  void *userdata);
+static void ipc_agm_blob_unregister(DBusConnection *conn,
+                                    DBusMessage *msg,
+                                    void *userdata);
+static void ipc_agm_session_set_blob(DBusConnection *conn,
+                                     DBusMessage *msg,
+                                     void *userdata);
+static void ipc_agm_get_thread_sched_info(DBusConnection *conn,
+                                          DBusMessage *msg,
+                                          void *userdata);
+static void ipc_agm_get_ssr_stats(DBusConnection *conn,
+                                  DBusMessage *msg,
+                                  void *userdata);
+static void ipc_agm_session_set_gain(DBusConnection *conn,
+                                     DBusMessage *msg,
+                                     void *userdata);
+static void ipc_agm_session_aif_set_gain(DBusConnection *conn,
+                                         DBusMessage *msg,
+                                         void *userdata);
+static void ipc_agm_session_stage_params(DBusConnection *conn,
+                                         DBusMessage *msg,
+                                         void *userdata);
+static void ipc_agm_session_aif_stage_params(DBusConnection *conn,
+                                             DBusMessage *msg,
+                                             void *userdata);
+static void ipc_agm_session_commit_params(DBusConnection *conn,
+                                          DBusMessage *msg,
+                                          void *userdata);
+static void ipc_agm_session_get_cal_stats(DBusConnection *conn,
+                                          DBusMessage *msg,
+                                          void *userdata);
 static void ipc_agm_session_close(DBusConnection *conn,
                                   DBusMessage *msg,
                                   void *userdata);
@@ -252,6 +309,9 @@ static void ipc_agm_session_stop(DBusConnection *conn,
 static void ipc_agm_session_pause(DBusConnection *conn,
                                   DBusMessage *msg,
                                   void *userdata);
+static void ipc_agm_session_cmd_async(DBusConnection *conn,
+                                      DBusMessage *msg,
+                                      void *userdata);
 static void ipc_agm_session_resume(DBusConnection *conn,
                                    DBusMessage *msg,
                                    void *userdata);
@@ -312,7 +372,19 @@ static agm_dbus_method agm_dbus_module_methods[AgmDbusModuleMethodMax] = {
     {"AgmSessionGetParams", "uuay", ipc_agm_session_get_params},
     {"AgmSessionGetBufInfo", "uu", ipc_agm_session_get_buf_info},
     {"AgmGetBufferTimestamp", "u", ipc_agm_get_buffer_timestamp},
-    {"AgmSessionOpen", "uu", ipc_agm_session_open}
+    {"AgmSessionOpen", "uu", ipc_agm_session_open},
+    {"AgmSessionTransact", "uay", ipc_agm_session_transact},
+    {"AgmBlobRegister", "uuay", ipc_agm_blob_register},
+    {"AgmBlobUnregister", "u", ipc_agm_blob_unregister},
+    {"AgmSessionSetBlob", "uuu", ipc_agm_session_set_blob},
+    {"AgmGetThreadSchedInfo", "u", ipc_agm_get_thread_sched_info},
+    {"AgmGetSsrStats", "", ipc_agm_get_ssr_stats},
+    {"AgmSessionSetGain", "uuu", ipc_agm_session_set_gain},
+    {"AgmSessionAifSetGain", "uuuu", ipc_agm_session_aif_set_gain},
+    {"AgmSessionStageParams", "uuay", ipc_agm_session_stage_params},
+    {"AgmSessionAifStageParams", "uuuay", ipc_agm_session_aif_stage_params},
+    {"AgmSessionCommitParams", "u", ipc_agm_session_commit_params},
+    {"AgmSessionGetCalStats", "u", ipc_agm_session_get_cal_stats}
 };
 
 static agm_dbus_method agm_dbus_session_methods[AgmDbusSessionMethodMax] = {
@@ -327,7 +399,8 @@ static agm_dbus_method agm_dbus_session_methods[AgmDbusSessionMethodMax] = {
     {"AgmSessionSetConfig", "(uuu)(uu)ay", ipc_agm_session_set_config},
     {"AgmSessionEos", "", ipc_agm_session_eos},
     {"AgmSessionGetTime", "", ipc_agm_get_session_time},
-    {"AgmGetHwProcessedBufCount", "u", ipc_agm_get_hw_processed_buff_cnt}
+    {"AgmGetHwProcessedBufCount", "u", ipc_agm_get_hw_processed_buff_cnt},
+    {"AgmSessionCmdAsync", "uu", ipc_agm_session_cmd_async}
 };
 
 static agm_dbus_signal event_callback[AgmSignalMax] = {
@@ -359,6 +432,8 @@ static void* async_thread_func(void *userdata) {
 
     pthread_mutex_lock(&ses_data->lock);
     if (strcmp(ses_data->eventType, "Wait") == 0) {
+        /* the per session thread moves the session data */
+        agm_thread_sched_apply(AGM_THREAD_IPC);
         while (ses_data->thread_state != SES_THREAD_EXIT) {
             ret = pthread_cond_wait(&ses_data->cond, &ses_data->lock);
             AGM_LOGV("%s:returned value from wait:%d\n", __func__, ret);
@@ -391,7 +466,7 @@ static void* async_thread_func(void *userdata) {
                 ses_data->thread_state = SES_THREAD_IDLE;
             }
         }
-
+        agm_thread_sched_release();
     }
     if (strcmp(ses_data->eventType, "Signal") == 0) {
         AGM_LOGV("%s:Signal Event\n", __func__);
@@ -929,7 +1004,7 @@ static void ipc_agm_session_get_buf_info(DBusConnection *conn,
                                        void *userdata) {
     DBusMessage *reply = NULL;
     DBusMessageIter arg_i, array_i;
-    DBusMessageIter r_arg, struct_i;
+    DBusMessageIter r_arg, struct_i, fd_i;
     uint32_t session_id, flag;
     struct agm_buf_info *buf_info;
     char *value = NULL;
@@ -981,8 +1056,19 @@ static void ipc_agm_session_get_buf_info(DBusConnection *conn,
     dbus_message_iter_append_basic(&struct_i, DBUS_TYPE_INT32, &buf_info->data_buf_size);
     dbus_message_iter_append_basic(&struct_i, DBUS_TYPE_INT32, &buf_info->pos_buf_fd);
     dbus_message_iter_append_basic(&struct_i, DBUS_TYPE_INT32, &buf_info->pos_buf_size);
+    /* time page fd travels as a unix fd, the array is empty without it */
+    dbus_message_iter_open_container(&struct_i, DBUS_TYPE_ARRAY,
+                                     DBUS_TYPE_UNIX_FD_AS_STRING, &fd_i);
+    if (flag & TIME_BUF)
+        dbus_message_iter_append_basic(&fd_i, DBUS_TYPE_UNIX_FD,
+                                       &buf_info->time_buf_fd);
+    dbus_message_iter_close_container(&struct_i, &fd_i);
+    dbus_message_iter_append_basic(&struct_i, DBUS_TYPE_INT32, &buf_info->time_buf_size);
     dbus_message_iter_close_container(&r_arg, &struct_i);
     dbus_connection_send(conn, reply, NULL);
+    /* the message holds its own dup of the time page fd */
+    if (flag & TIME_BUF)
+        close(buf_info->time_buf_fd);
     free(buf_info);
     buf_info = NULL;
     dbus_message_unref(reply);
@@ -1061,7 +1147,6 @@ static void ipc_agm_session_aif_set_params(DBusConnection *conn,
     DBusMessage *reply = NULL;
     DBusMessageIter arg_i, array_i, r_arg;
     uint32_t session_id, aif_id, size;
-    void *buf = NULL;
     char *value = NULL;
     char **addr_value = &value;
     int n_elements = 0;
@@ -1097,22 +1182,18 @@ static void ipc_agm_session_aif_set_params(DBusConnection *conn,
     dbus_message_iter_next(&arg_i);
     dbus_message_iter_recurse(&arg_i, &array_i);
     dbus_message_iter_get_fixed_array(&array_i, addr_value, &n_elements);
-    buf = (void *)malloc(n_elements*sizeof(char));
-    memcpy(buf, value, n_elements);
 
-    if (agm_session_aif_set_params(session_id, aif_id, buf, size) != 0) {
+    /* the service only reads the payload, hand it the message array as is */
+    if ((uint32_t)n_elements < size ||
+        agm_session_aif_set_params(session_id, aif_id, value, size) != 0) {
         AGM_LOGE("agm_session_aif_set_params failed.");
         agm_dbus_send_error(mdata->conn, msg, DBUS_ERROR_FAILED,
                             "agm_session_aif_set_params failed.");
-        free(buf);
-        buf = NULL;
         return;
     }
 
     reply = dbus_message_new_method_return(msg);
     dbus_connection_send(conn, reply, NULL);
-    free(buf);
-    buf = NULL;
     dbus_message_unref(reply);
 }
 
@@ -1398,7 +1479,6 @@ static void ipc_agm_session_set_params(DBusConnection *conn,
     DBusMessage *reply = NULL;
     DBusMessageIter arg_i, array_i;
     uint32_t session_id, size;
-    void *payload = NULL;
     char *value = NULL;
     char **addr_value = &value;
     int n_elements = 0;
@@ -1432,22 +1512,18 @@ static void ipc_agm_session_set_params(DBusConnection *conn,
     dbus_message_iter_next(&arg_i);
     dbus_message_iter_recurse(&arg_i, &array_i);
     dbus_message_iter_get_fixed_array(&array_i, addr_value, &n_elements);
-    payload = (void *)malloc(n_elements*sizeof(char));
-    memcpy(payload, value, n_elements);
 
-    if (agm_session_set_params(session_id, (void *)payload, size) != 0) {
+    /* the service only reads the payload, hand it the message array as is */
+    if ((uint32_t)n_elements < size ||
+        agm_session_set_params(session_id, value, size) != 0) {
         AGM_LOGE("agm_session_set_params failed.");
         agm_dbus_send_error(mdata->conn, msg, DBUS_ERROR_FAILED,
                             "agm_session_set_params failed.");
-        free(payload);
-        payload = NULL;
         return;
     }
 
     reply = dbus_message_new_method_return(msg);
     dbus_connection_send(conn, reply, NULL);
-    free(payload);
-    payload = NULL;
     dbus_message_unref(reply);
 }
 
@@ -1542,6 +1618,120 @@ static void ipc_agm_get_aif_info_list(DBusConnection *conn,
     aifinfo = NULL;
 }
 
+static void ipc_agm_get_thread_sched_info(DBusConnection *conn,
+                                          DBusMessage *msg,
+                                          void *userdata) {
+    DBusMessage *reply = NULL;
+    DBusMessageIter arg_i;
+    DBusMessageIter r_arg, array_i, struct_i;
+    struct agm_thread_sched_info *info = NULL;
+    uint32_t num, i;
+    dbus_uint64_t cpu_mask;
+
+    if (userdata == NULL) {
+        AGM_LOGE("Invalid userdata");
+        agm_dbus_send_error(mdata->conn, msg, DBUS_ERROR_FAILED,
+                            "userdata is NULL");
+        return;
+    }
+
+    if (!dbus_message_iter_init(msg, &arg_i)) {
+        AGM_LOGE("ipc_agm_get_thread_sched_info has no arguments");
+        agm_dbus_send_error(mdata->conn, msg, DBUS_ERROR_FAILED,
+                            "ipc_agm_get_thread_sched_info has no arguments");
+        return;
+    }
+
+    if (strcmp(dbus_message_get_signature(msg), "u")) {
+        AGM_LOGE("Invalid signature for ipc_agm_get_thread_sched_info.");
+        agm_dbus_send_error(mdata->conn, msg, DBUS_ERROR_FAILED,
+                     "Invalid signature for ipc_agm_get_thread_sched_info.");
+        return;
+    }
+
+    dbus_message_iter_get_basic(&arg_i, &num);
+
+    if (num > MAX_THREAD_SCHED_INFO)
+        num = MAX_THREAD_SCHED_INFO;
+    if (num) {
+        info = (struct agm_thread_sched_info *)calloc(num, sizeof(*info));
+        if (info == NULL) {
+            agm_dbus_send_error(mdata->conn, msg, DBUS_ERROR_NO_MEMORY,
+                                "ipc_agm_get_thread_sched_info failed");
+            return;
+        }
+    }
+
+    if (agm_get_thread_sched_info(info, &num)) {
+        AGM_LOGE("agm_get_thread_sched_info failed");
+        agm_dbus_send_error(mdata->conn, msg, DBUS_ERROR_FAILED,
+                            "ipc_agm_get_thread_sched_info failed");
+        free(info);
+        return;
+    }
+
+    reply = dbus_message_new_method_return(msg);
+    dbus_message_iter_init_append(reply, &r_arg);
+    dbus_message_iter_append_basic(&r_arg, DBUS_TYPE_UINT32, &num);
+    dbus_message_iter_open_container(&r_arg, DBUS_TYPE_ARRAY, "(iuiit)",
+                                     &array_i);
+    for (i = 0; info && i < num; i++) {
+        dbus_message_iter_open_container(&array_i, DBUS_TYPE_STRUCT, NULL,
+                                         &struct_i);
+        dbus_message_iter_append_basic(&struct_i, DBUS_TYPE_INT32,
+                                       &info[i].tid);
+        dbus_message_iter_append_basic(&struct_i, DBUS_TYPE_UINT32,
+                                       &info[i].thread_class);
+        dbus_message_iter_append_basic(&struct_i, DBUS_TYPE_INT32,
+                                       &info[i].policy);
+        dbus_message_iter_append_basic(&struct_i, DBUS_TYPE_INT32,
+                                       &info[i].priority);
+        cpu_mask = info[i].cpu_mask;
+        dbus_message_iter_append_basic(&struct_i, DBUS_TYPE_UINT64, &cpu_mask);
+        dbus_message_iter_close_container(&array_i, &struct_i);
+    }
+    dbus_message_iter_close_container(&r_arg, &array_i);
+    dbus_connection_send(conn, reply, NULL);
+    dbus_message_unref(reply);
+    free(info);
+}
+
+static void ipc_agm_get_ssr_stats(DBusConnection *conn,
+                                  DBusMessage *msg,
+                                  void *userdata) {
+    DBusMessage *reply = NULL;
+    DBusMessageIter r_arg;
+    agm_module_dbus_data *mdata = (agm_module_dbus_data *)userdata;
+    struct agm_ssr_stats stats;
+    dbus_uint64_t down_to_restored_us, up_to_restored_us;
+
+    memset(&stats, 0, sizeof(stats));
+    if (agm_get_ssr_stats(&stats) != 0) {
+        AGM_LOGE("agm_get_ssr_stats failed");
+        agm_dbus_send_error(mdata->conn, msg, DBUS_ERROR_FAILED,
+                            "ipc_agm_get_ssr_stats failed");
+        return;
+    }
+
+    AGM_LOGV("%s : ", __func__);
+
+    down_to_restored_us = stats.down_to_restored_us;
+    up_to_restored_us = stats.up_to_restored_us;
+    reply = dbus_message_new_method_return(msg);
+    dbus_message_iter_init_append(reply, &r_arg);
+    dbus_message_iter_append_basic(&r_arg, DBUS_TYPE_UINT32, &stats.ssr_count);
+    dbus_message_iter_append_basic(&r_arg, DBUS_TYPE_UINT32,
+                                   &stats.sessions_restored);
+    dbus_message_iter_append_basic(&r_arg, DBUS_TYPE_UINT32,
+                                   &stats.sessions_failed);
+    dbus_message_iter_append_basic(&r_arg, DBUS_TYPE_UINT64,
+                                   &down_to_restored_us);
+    dbus_message_iter_append_basic(&r_arg, DBUS_TYPE_UINT64,
+                                   &up_to_restored_us);
+    dbus_connection_send(conn, reply, NULL);
+    dbus_message_unref(reply);
+}
+
 static void ipc_agm_set_params_with_tag(DBusConnection *conn,
                                         DBusMessage *msg,
                                         void *userdata) {
@@ -2293,6 +2483,64 @@ static void ipc_agm_session_pause(DBusConnection *conn,
     dbus_message_unref(reply);
 }
 
+static void ipc_agm_session_cmd_async(DBusConnection *conn,
+                                      DBusMessage *msg,
+                                      void *userdata) {
+    DBusMessage *reply = NULL;
+    DBusMessageIter arg_i;
+    agm_session_data *ses_data = (agm_session_data *)userdata;
+    uint32_t cmd, token;
+
+    if (userdata == NULL) {
+        AGM_LOGE("%s :Invalid userdata", __func__);
+        agm_dbus_send_error(mdata->conn, msg, DBUS_ERROR_FAILED,
+                            "userdata is NULL");
+        return;
+    }
+
+    if (!dbus_message_iter_init(msg, &arg_i)) {
+        AGM_LOGE("ipc_agm_session_cmd_async has no arguments");
+        agm_dbus_send_error(mdata->conn, msg, DBUS_ERROR_FAILED,
+                            "ipc_agm_session_cmd_async has no arguments");
+        return;
+    }
+
+    if (strcmp(dbus_message_get_signature(msg), "uu")) {
+        AGM_LOGE("Invalid signature for ipc_agm_session_cmd_async.");
+        agm_dbus_send_error(mdata->conn, msg, DBUS_ERROR_FAILED,
+                        "Invalid signature for ipc_agm_session_cmd_async.");
+        return;
+    }
+
+    dbus_message_iter_get_basic(&arg_i, &cmd);
+    dbus_message_iter_next(&arg_i);
+    dbus_message_iter_get_basic(&arg_i, &token);
+
+    /*
+     * The session object, its thread and callbacks are torn down by
+     * AgmSessionClose, a close behind its back would leave them dangling.
+     */
+    if (cmd == AGM_SESSION_CMD_CLOSE) {
+        AGM_LOGE("%s :async close not supported, use AgmSessionClose",
+                 __func__);
+        agm_dbus_send_error(mdata->conn, msg, DBUS_ERROR_NOT_SUPPORTED,
+                            "async close not supported.");
+        return;
+    }
+
+    if (agm_session_cmd_async(ses_data->handle, (enum agm_session_cmd)cmd,
+                              token)) {
+        AGM_LOGE("%s :agm_session_cmd_async failed.", __func__);
+        agm_dbus_send_error(mdata->conn, msg, DBUS_ERROR_FAILED,
+                            "agm_session_cmd_async failed.");
+        return;
+    }
+
+    reply = dbus_message_new_method_return(msg);
+    dbus_connection_send(conn, reply, NULL);
+    dbus_message_unref(reply);
+}
+
 static void ipc_agm_session_stop(DBusConnection *conn,
                                  DBusMessage *msg,
                                  void *userdata) {
@@ -2436,15 +2684,48 @@ static void ipc_agm_session_close(DBusConnection *conn,
     return;
 }
 
+/* Finish the bring-up of a session opened through the module interface */
+static void ses_session_opened(DBusConnection *conn,
+                               DBusMessage *msg,
+                               agm_session_data *ses_data) {
+    DBusMessage *reply = NULL;
+    DBusMessageIter arg_i;
+    gchar thread_name[32] = "";
+
+    ses_data->lock = PTHREAD_MUTEX_INITIALIZER;
+    ses_data->cond = PTHREAD_COND_INITIALIZER;
+    ses_data->thread_state = SES_THREAD_IDLE;
+    snprintf(ses_data->eventType, sizeof("Wait"), "%s", "Wait");
+    AGM_LOGD("%s:Wait Event", __func__);
+    snprintf(thread_name, sizeof(thread_name), "agm_ses_async_thread_%d",
+             ses_data->session_id);
+    if (pthread_create(&ses_data->ses_tid, NULL, async_thread_func, ses_data)){
+        AGM_LOGE("%s: agm session async thread creation failed", __func__);
+    }
+    AGM_LOGD("%s : agm session async thread creation success", __func__);
+
+    if (!dbus_connection_add_filter(conn,
+                                    disconnection_filter_cb,
+                                    ses_data,
+                                    NULL))
+        AGM_LOGE("Unable to add death notification filter");
+
+    reply = dbus_message_new_method_return(msg);
+    dbus_message_iter_init_append(reply, &arg_i);
+    dbus_message_iter_append_basic(&arg_i,
+                                   DBUS_TYPE_OBJECT_PATH,
+                                   &ses_data->dbus_obj_path);
+    dbus_connection_send(conn, reply, NULL);
+    dbus_message_unref(reply);
+}
+
 static void ipc_agm_session_open(DBusConnection *conn,
                                  DBusMessage *msg,
                                  void *userdata) {
     agm_module_dbus_data *mdata = (agm_module_dbus_data *)userdata;
-    DBusMessage *reply = NULL;
     DBusMessageIter arg_i;
     uint32_t session_id, sess_mode;
     char *dbus_obj_path = NULL;
-    gchar thread_name[32] = "";
     int32_t ret;
     agm_session_data *ses_data = NULL;
 
@@ -2482,75 +2763,643 @@ static void ipc_agm_session_open(DBusConnection *conn,
         return;
     }
 
-    ses_data->lock = PTHREAD_MUTEX_INITIALIZER;
-    ses_data->cond = PTHREAD_COND_INITIALIZER;
-    ses_data->thread_state = SES_THREAD_IDLE;
-    snprintf(ses_data->eventType, sizeof("Wait"), "%s", "Wait");
-    AGM_LOGD("%s:Wait Event", __func__);
-    snprintf(thread_name, sizeof(thread_name), "agm_ses_async_thread_%d", session_id);
-    if (pthread_create(&ses_data->ses_tid, NULL, async_thread_func, ses_data)){
-        AGM_LOGE("%s: agm session async thread creation failed", __func__);
-    }
-    AGM_LOGD("%s : agm session async thread creation success", __func__);
-
-    if (!dbus_connection_add_filter(conn,
-                                    disconnection_filter_cb,
-                                    ses_data,
-                                    NULL))
-        AGM_LOGE("Unable to add death notification filter");
-
-    reply = dbus_message_new_method_return(msg);
-    dbus_message_iter_init_append(reply, &arg_i);
-    dbus_message_iter_append_basic(&arg_i,
-                                   DBUS_TYPE_OBJECT_PATH,
-                                   &ses_data->dbus_obj_path);
-    dbus_connection_send(conn, reply, NULL);
-    dbus_message_unref(reply);
+    ses_session_opened(conn, msg, ses_data);
     AGM_LOGD("%s :Exit ", __func__);
     return;
 }
 
-/* Initialize module data. Get dbus connection and register module interface
-    with the connection */
-int ipc_agm_init() {
-    DBusError err;
-    int rc = 0;
+static void ipc_agm_session_transact(DBusConnection *conn,
+                                     DBusMessage *msg,
+                                     void *userdata) {
+    agm_module_dbus_data *mdata = (agm_module_dbus_data *)userdata;
+    DBusMessage *reply = NULL;
+    DBusMessageIter arg_i, array_i;
+    struct agm_session_txn *txn = NULL;
+    agm_session_data *ses_data = NULL;
+    uint64_t handle = 0;
+    uint32_t size;
+    char *value = NULL;
+    char **addr_value = &value;
+    int n_elements = 0;
 
-    AGM_LOGV("%s : ", __func__);
+    AGM_LOGD("%s :Enter ", __func__);
 
-    mdata = (agm_module_dbus_data *)malloc(sizeof(agm_module_dbus_data));
-    mdata->dbus_obj_path =
-                    (char *)malloc(sizeof(char)*(strlen(AGM_OBJECT_PATH) + 1));
-    memcpy(mdata->dbus_obj_path, AGM_OBJECT_PATH, strlen(AGM_OBJECT_PATH)+1);
+    if (userdata == NULL) {
+        AGM_LOGE("Invalid userdata");
+        return;
+    }
 
-    mdata->conn = agm_dbus_new_connection();
+    if (!dbus_message_iter_init(msg, &arg_i)) {
+        AGM_LOGE("ipc_agm_session_transact has no arguments");
+        agm_dbus_send_error(mdata->conn, msg, DBUS_ERROR_FAILED,
+                            "ipc_agm_session_transact has no arguments");
+        return;
+    }
 
-    dbus_error_init(&err);
-    rc = dbus_bus_request_name(mdata->conn->conn,
-                               AGM_DBUS_CONNECTION,
-                               DBUS_NAME_FLAG_REPLACE_EXISTING,
-                               &err);
+    if (strcmp(dbus_message_get_signature(msg), "uay")) {
+        AGM_LOGE("Invalid signature for ipc_agm_session_transact.");
+        agm_dbus_send_error(mdata->conn, msg, DBUS_ERROR_FAILED,
+                            "Invalid signature for ipc_agm_session_transact.");
+        return;
+    }
 
-    if (rc != DBUS_REQUEST_NAME_REPLY_PRIMARY_OWNER) {
-        AGM_LOGE("Failed to request name on bus: %s", err.message);
-        agm_dbus_connection_free(mdata->conn);
-        free(mdata->dbus_obj_path);
-        mdata->dbus_obj_path = NULL;
-        free(mdata);
-        mdata = NULL;
-        rc = -EINVAL;
-        return rc;
+    dbus_message_iter_get_basic(&arg_i, &size);
+    dbus_message_iter_next(&arg_i);
+    dbus_message_iter_recurse(&arg_i, &array_i);
+    dbus_message_iter_get_fixed_array(&array_i, addr_value, &n_elements);
+    if ((uint32_t)n_elements < size || size < sizeof(struct agm_session_txn)) {
+        agm_dbus_send_error(mdata->conn, msg, DBUS_ERROR_FAILED,
+                            "Invalid transaction size.");
+        return;
     }
 
-    if (agm_setup_dbus_with_main_loop(mdata->conn)) {
-        AGM_LOGE("Failed to setup main loop");
-        agm_dbus_connection_free(mdata->conn);
-        free(mdata->dbus_obj_path);
-        mdata->dbus_obj_path = NULL;
-        free(mdata);
-        mdata = NULL;
-        rc = -EINVAL;
-        return rc;
+    txn = (struct agm_session_txn *)malloc(size);
+    if (txn == NULL) {
+        agm_dbus_send_error(mdata->conn, msg, DBUS_ERROR_NO_MEMORY,
+                            "No memory for transaction.");
+        return;
+    }
+    memcpy(txn, value, size);
+
+    /*
+     * a session opened by the transaction gets its own object path, which
+     * must exist before the open or the handle would have no owner
+     */
+    if (txn->flags & (AGM_SESSION_TXN_OPEN | AGM_SESSION_TXN_PREPARE |
+                      AGM_SESSION_TXN_START)) {
+        ses_data = get_session_data(mdata, txn->session_id);
+        if (ses_data == NULL) {
+            free(txn);
+            agm_dbus_send_error(mdata->conn, msg, DBUS_ERROR_FAILED,
+                                "Unable to create session data.");
+            return;
+        }
+    }
+
+    if (agm_session_transact(txn, size, ses_data ? &ses_data->handle : &handle)) {
+        if (ses_data)
+            agm_free_session(ses_data);
+        free(txn);
+        agm_dbus_send_error(mdata->conn, msg, DBUS_ERROR_FAILED,
+                            "agm_session_transact failed.");
+        return;
+    }
+    free(txn);
+
+    if (ses_data) {
+        ses_session_opened(conn, msg, ses_data);
+        return;
+    }
+
+    reply = dbus_message_new_method_return(msg);
+    dbus_connection_send(conn, reply, NULL);
+    dbus_message_unref(reply);
+    AGM_LOGD("%s :Exit ", __func__);
+}
+
+static void agm_free_blob_list(gpointer key, gpointer value,
+                               gpointer userdata) {
+    g_list_free((GList *)value);
+}
+
+/* Unregister the blobs of a client which left the bus */
+static DBusHandlerResult blob_owner_filter_cb(DBusConnection *conn,
+                                              DBusMessage *msg,
+                                              void *userdata) {
+    agm_module_dbus_data *mdata = (agm_module_dbus_data *)userdata;
+    const char *name = NULL, *old_owner = NULL, *new_owner = NULL;
+    GList *blob_list = NULL, *node = NULL;
+
+    if (mdata == NULL || msg == NULL)
+        return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+
+    if (!dbus_message_is_signal(msg, DBUS_INTERFACE_DBUS, "NameOwnerChanged"))
+        return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+
+    if (!dbus_message_get_args(msg, NULL,
+                               DBUS_TYPE_STRING, &name,
+                               DBUS_TYPE_STRING, &old_owner,
+                               DBUS_TYPE_STRING, &new_owner,
+                               DBUS_TYPE_INVALID))
+        return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+
+    if (new_owner[0] != '\0')
+        return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+
+    blob_list = (GList *)g_hash_table_lookup(mdata->blobs, name);
+    if (blob_list == NULL)
+        return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+
+    AGM_LOGD("%s: client %s left, dropping its blobs", __func__, name);
+    for (node = blob_list; node != NULL; node = node->next)
+        agm_blob_unregister(GPOINTER_TO_UINT(node->data));
+    g_list_free(blob_list);
+    g_hash_table_remove(mdata->blobs, name);
+
+    return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+}
+
+static void ipc_agm_blob_register(DBusConnection *conn,
+                                  DBusMessage *msg,
+                                  void *userdata) {
+    agm_module_dbus_data *mdata = (agm_module_dbus_data *)userdata;
+    DBusMessage *reply = NULL;
+    DBusMessageIter arg_i, array_i, r_arg;
+    uint32_t type, size, blob_id = 0;
+    char *value = NULL;
+    char **addr_value = &value;
+    int n_elements = 0;
+    const char *sender = NULL;
+    GList *blob_list = NULL;
+
+    if (userdata == NULL) {
+        AGM_LOGE("Invalid userdata");
+        return;
+    }
+
+    /* an untracked registration would outlive the client */
+    sender = dbus_message_get_sender(msg);
+    if (sender == NULL) {
+        AGM_LOGE("ipc_agm_blob_register has no sender");
+        agm_dbus_send_error(mdata->conn, msg, DBUS_ERROR_FAILED,
+                            "ipc_agm_blob_register has no sender");
+        return;
+    }
+
+    if (!dbus_message_iter_init(msg, &arg_i)) {
+        AGM_LOGE("ipc_agm_blob_register has no arguments");
+        agm_dbus_send_error(mdata->conn, msg, DBUS_ERROR_FAILED,
+                            "ipc_agm_blob_register has no arguments");
+        return;
+    }
+
+    if (strcmp(dbus_message_get_signature(msg), "uuay")) {
+        AGM_LOGE("Invalid signature for ipc_agm_blob_register.");
+        agm_dbus_send_error(mdata->conn, msg, DBUS_ERROR_FAILED,
+                            "Invalid signature for ipc_agm_blob_register.");
+        return;
+    }
+
+    AGM_LOGV("%s : ", __func__);
+
+    dbus_message_iter_get_basic(&arg_i, &type);
+    dbus_message_iter_next(&arg_i);
+    dbus_message_iter_get_basic(&arg_i, &size);
+    dbus_message_iter_next(&arg_i);
+    dbus_message_iter_recurse(&arg_i, &array_i);
+    dbus_message_iter_get_fixed_array(&array_i, addr_value, &n_elements);
+
+    /* the registry keeps its own copy, register straight from the message */
+    if ((uint32_t)n_elements < size ||
+        agm_blob_register((enum agm_blob_type)type, (void *)value, size,
+                          &blob_id) != 0) {
+        AGM_LOGE("agm_blob_register failed.");
+        agm_dbus_send_error(mdata->conn, msg, DBUS_ERROR_FAILED,
+                            "agm_blob_register failed.");
+        return;
+    }
+
+    /* the table frees the copy of the name if the client is already known */
+    blob_list = (GList *)g_hash_table_lookup(mdata->blobs, sender);
+    blob_list = g_list_prepend(blob_list, GUINT_TO_POINTER(blob_id));
+    g_hash_table_insert(mdata->blobs, g_strdup(sender), blob_list);
+
+    reply = dbus_message_new_method_return(msg);
+    dbus_message_iter_init_append(reply, &r_arg);
+    dbus_message_iter_append_basic(&r_arg, DBUS_TYPE_UINT32, &blob_id);
+    dbus_connection_send(conn, reply, NULL);
+    dbus_message_unref(reply);
+}
+
+static void ipc_agm_blob_unregister(DBusConnection *conn,
+                                    DBusMessage *msg,
+                                    void *userdata) {
+    agm_module_dbus_data *mdata = (agm_module_dbus_data *)userdata;
+    DBusMessage *reply = NULL;
+    DBusMessageIter arg_i;
+    uint32_t blob_id;
+    const char *sender = NULL;
+    GList *blob_list = NULL, *node = NULL;
+
+    if (userdata == NULL) {
+        AGM_LOGE("Invalid userdata");
+        return;
+    }
+
+    if (!dbus_message_iter_init(msg, &arg_i)) {
+        AGM_LOGE("ipc_agm_blob_unregister has no arguments");
+        agm_dbus_send_error(mdata->conn, msg, DBUS_ERROR_FAILED,
+                            "ipc_agm_blob_unregister has no arguments");
+        return;
+    }
+
+    if (strcmp(dbus_message_get_signature(msg), "u")) {
+        AGM_LOGE("Invalid signature for ipc_agm_blob_unregister.");
+        agm_dbus_send_error(mdata->conn, msg, DBUS_ERROR_FAILED,
+                            "Invalid signature for ipc_agm_blob_unregister.");
+        return;
+    }
+
+    dbus_message_iter_get_basic(&arg_i, &blob_id);
+
+    /* a client only drops its own registrations */
+    sender = dbus_message_get_sender(msg);
+    if (sender != NULL)
+        blob_list = (GList *)g_hash_table_lookup(mdata->blobs, sender);
+    node = g_list_find(blob_list, GUINT_TO_POINTER(blob_id));
+    if (node == NULL) {
+        AGM_LOGE("blob %u not registered by %s", blob_id,
+                 sender ? sender : "unknown sender");
+        agm_dbus_send_error(mdata->conn, msg, DBUS_ERROR_ACCESS_DENIED,
+                            "blob not registered by this client.");
+        return;
+    }
+
+    blob_list = g_list_delete_link(blob_list, node);
+    if (blob_list == NULL)
+        g_hash_table_remove(mdata->blobs, sender);
+    else
+        g_hash_table_insert(mdata->blobs, g_strdup(sender), blob_list);
+
+    if (agm_blob_unregister(blob_id) != 0) {
+        AGM_LOGE("agm_blob_unregister failed.");
+        agm_dbus_send_error(mdata->conn, msg, DBUS_ERROR_FAILED,
+                            "agm_blob_unregister failed.");
+        return;
+    }
+
+    reply = dbus_message_new_method_return(msg);
+    dbus_connection_send(conn, reply, NULL);
+    dbus_message_unref(reply);
+}
+
+static void ipc_agm_session_set_blob(DBusConnection *conn,
+                                     DBusMessage *msg,
+                                     void *userdata) {
+    agm_module_dbus_data *mdata = (agm_module_dbus_data *)userdata;
+    DBusMessage *reply = NULL;
+    DBusMessageIter arg_i;
+    uint32_t session_id, aif_id, blob_id;
+
+    if (userdata == NULL) {
+        AGM_LOGE("Invalid userdata");
+        return;
+    }
+
+    if (!dbus_message_iter_init(msg, &arg_i)) {
+        AGM_LOGE("ipc_agm_session_set_blob has no arguments");
+        agm_dbus_send_error(mdata->conn, msg, DBUS_ERROR_FAILED,
+                            "ipc_agm_session_set_blob has no arguments");
+        return;
+    }
+
+    if (strcmp(dbus_message_get_signature(msg), "uuu")) {
+        AGM_LOGE("Invalid signature for ipc_agm_session_set_blob.");
+        agm_dbus_send_error(mdata->conn, msg, DBUS_ERROR_FAILED,
+                            "Invalid signature for ipc_agm_session_set_blob.");
+        return;
+    }
+
+    dbus_message_iter_get_basic(&arg_i, &session_id);
+    dbus_message_iter_next(&arg_i);
+    dbus_message_iter_get_basic(&arg_i, &aif_id);
+    dbus_message_iter_next(&arg_i);
+    dbus_message_iter_get_basic(&arg_i, &blob_id);
+
+    if (agm_session_set_blob(session_id, aif_id, blob_id) != 0) {
+        AGM_LOGE("agm_session_set_blob failed.");
+        agm_dbus_send_error(mdata->conn, msg, DBUS_ERROR_FAILED,
+                            "agm_session_set_blob failed.");
+        return;
+    }
+
+    reply = dbus_message_new_method_return(msg);
+    dbus_connection_send(conn, reply, NULL);
+    dbus_message_unref(reply);
+}
+
+static void ipc_agm_session_set_gain(DBusConnection *conn,
+                                     DBusMessage *msg,
+                                     void *userdata) {
+    agm_module_dbus_data *mdata = (agm_module_dbus_data *)userdata;
+    DBusMessage *reply = NULL;
+    DBusMessageIter arg_i;
+    uint32_t session_id, gain, ramp_duration_ms;
+
+    if (userdata == NULL) {
+        AGM_LOGE("Invalid userdata");
+        return;
+    }
+
+    if (!dbus_message_iter_init(msg, &arg_i)) {
+        AGM_LOGE("ipc_agm_session_set_gain has no arguments");
+        agm_dbus_send_error(mdata->conn, msg, DBUS_ERROR_FAILED,
+                            "ipc_agm_session_set_gain has no arguments");
+        return;
+    }
+
+    if (strcmp(dbus_message_get_signature(msg), "uuu")) {
+        AGM_LOGE("Invalid signature for ipc_agm_session_set_gain.");
+        agm_dbus_send_error(mdata->conn, msg, DBUS_ERROR_FAILED,
+                            "Invalid signature for ipc_agm_session_set_gain.");
+        return;
+    }
+
+    dbus_message_iter_get_basic(&arg_i, &session_id);
+    dbus_message_iter_next(&arg_i);
+    dbus_message_iter_get_basic(&arg_i, &gain);
+    dbus_message_iter_next(&arg_i);
+    dbus_message_iter_get_basic(&arg_i, &ramp_duration_ms);
+
+    if (agm_session_set_gain(session_id, gain, ramp_duration_ms) != 0) {
+        AGM_LOGE("agm_session_set_gain failed.");
+        agm_dbus_send_error(mdata->conn, msg, DBUS_ERROR_FAILED,
+                            "agm_session_set_gain failed.");
+        return;
+    }
+
+    reply = dbus_message_new_method_return(msg);
+    dbus_connection_send(conn, reply, NULL);
+    dbus_message_unref(reply);
+}
+
+static void ipc_agm_session_aif_set_gain(DBusConnection *conn,
+                                         DBusMessage *msg,
+                                         void *userdata) {
+    agm_module_dbus_data *mdata = (agm_module_dbus_data *)userdata;
+    DBusMessage *reply = NULL;
+    DBusMessageIter arg_i;
+    uint32_t session_id, aif_id, gain, ramp_duration_ms;
+
+    if (userdata == NULL) {
+        AGM_LOGE("Invalid userdata");
+        return;
+    }
+
+    if (!dbus_message_iter_init(msg, &arg_i)) {
+        AGM_LOGE("ipc_agm_session_aif_set_gain has no arguments");
+        agm_dbus_send_error(mdata->conn, msg, DBUS_ERROR_FAILED,
+                            "ipc_agm_session_aif_set_gain has no arguments");
+        return;
+    }
+
+    if (strcmp(dbus_message_get_signature(msg), "uuuu")) {
+        AGM_LOGE("Invalid signature for ipc_agm_session_aif_set_gain.");
+        agm_dbus_send_error(mdata->conn, msg, DBUS_ERROR_FAILED,
+                        "Invalid signature for ipc_agm_session_aif_set_gain.");
+        return;
+    }
+
+    dbus_message_iter_get_basic(&arg_i, &session_id);
+    dbus_message_iter_next(&arg_i);
+    dbus_message_iter_get_basic(&arg_i, &aif_id);
+    dbus_message_iter_next(&arg_i);
+    dbus_message_iter_get_basic(&arg_i, &gain);
+    dbus_message_iter_next(&arg_i);
+    dbus_message_iter_get_basic(&arg_i, &ramp_duration_ms);
+
+    if (agm_session_aif_set_gain(session_id, aif_id, gain,
+                                 ramp_duration_ms) != 0) {
+        AGM_LOGE("agm_session_aif_set_gain failed.");
+        agm_dbus_send_error(mdata->conn, msg, DBUS_ERROR_FAILED,
+                            "agm_session_aif_set_gain failed.");
+        return;
+    }
+
+    reply = dbus_message_new_method_return(msg);
+    dbus_connection_send(conn, reply, NULL);
+    dbus_message_unref(reply);
+}
+
+static void ipc_agm_session_stage_params(DBusConnection *conn,
+                                         DBusMessage *msg,
+                                         void *userdata) {
+    agm_module_dbus_data *mdata = (agm_module_dbus_data *)userdata;
+    DBusMessage *reply = NULL;
+    DBusMessageIter arg_i, array_i;
+    uint32_t session_id, size;
+    char *value = NULL;
+    char **addr_value = &value;
+    int n_elements = 0;
+
+    if (userdata == NULL) {
+        AGM_LOGE("Invalid userdata");
+        return;
+    }
+
+    if (!dbus_message_iter_init(msg, &arg_i)) {
+        AGM_LOGE("ipc_agm_session_stage_params has no arguments");
+        agm_dbus_send_error(mdata->conn, msg, DBUS_ERROR_FAILED,
+                            "ipc_agm_session_stage_params has no arguments");
+        return;
+    }
+
+    if (strcmp(dbus_message_get_signature(msg), "uuay")) {
+        AGM_LOGE("Invalid signature for ipc_agm_session_stage_params.");
+        agm_dbus_send_error(mdata->conn, msg, DBUS_ERROR_FAILED,
+                        "Invalid signature for ipc_agm_session_stage_params.");
+        return;
+    }
+
+    dbus_message_iter_get_basic(&arg_i, &session_id);
+    dbus_message_iter_next(&arg_i);
+    dbus_message_iter_get_basic(&arg_i, &size);
+    dbus_message_iter_next(&arg_i);
+    dbus_message_iter_recurse(&arg_i, &array_i);
+    dbus_message_iter_get_fixed_array(&array_i, addr_value, &n_elements);
+
+    /* the service copies what it stages, hand it the message array as is */
+    if ((uint32_t)n_elements < size ||
+        agm_session_stage_params(session_id, value, size) != 0) {
+        AGM_LOGE("agm_session_stage_params failed.");
+        agm_dbus_send_error(mdata->conn, msg, DBUS_ERROR_FAILED,
+                            "agm_session_stage_params failed.");
+        return;
+    }
+
+    reply = dbus_message_new_method_return(msg);
+    dbus_connection_send(conn, reply, NULL);
+    dbus_message_unref(reply);
+}
+
+static void ipc_agm_session_aif_stage_params(DBusConnection *conn,
+                                             DBusMessage *msg,
+                                             void *userdata) {
+    agm_module_dbus_data *mdata = (agm_module_dbus_data *)userdata;
+    DBusMessage *reply = NULL;
+    DBusMessageIter arg_i, array_i;
+    uint32_t session_id, aif_id, size;
+    char *value = NULL;
+    char **addr_value = &value;
+    int n_elements = 0;
+
+    if (userdata == NULL) {
+        AGM_LOGE("Invalid userdata");
+        return;
+    }
+
+    if (!dbus_message_iter_init(msg, &arg_i)) {
+        AGM_LOGE("ipc_agm_session_aif_stage_params has no arguments");
+        agm_dbus_send_error(mdata->conn, msg, DBUS_ERROR_FAILED,
+                            "ipc_agm_session_aif_stage_params has no arguments");
+        return;
+    }
+
+    if (strcmp(dbus_message_get_signature(msg), "uuuay")) {
+        AGM_LOGE("Invalid signature for ipc_agm_session_aif_stage_params.");
+        agm_dbus_send_error(mdata->conn, msg, DBUS_ERROR_FAILED,
+                    "Invalid signature for ipc_agm_session_aif_stage_params.");
+        return;
+    }
+
+    dbus_message_iter_get_basic(&arg_i, &session_id);
+    dbus_message_iter_next(&arg_i);
+    dbus_message_iter_get_basic(&arg_i, &aif_id);
+    dbus_message_iter_next(&arg_i);
+    dbus_message_iter_get_basic(&arg_i, &size);
+    dbus_message_iter_next(&arg_i);
+    dbus_message_iter_recurse(&arg_i, &array_i);
+    dbus_message_iter_get_fixed_array(&array_i, addr_value, &n_elements);
+
+    if ((uint32_t)n_elements < size ||
+        agm_session_aif_stage_params(session_id, aif_id, value, size) != 0) {
+        AGM_LOGE("agm_session_aif_stage_params failed.");
+        agm_dbus_send_error(mdata->conn, msg, DBUS_ERROR_FAILED,
+                            "agm_session_aif_stage_params failed.");
+        return;
+    }
+
+    reply = dbus_message_new_method_return(msg);
+    dbus_connection_send(conn, reply, NULL);
+    dbus_message_unref(reply);
+}
+
+static void ipc_agm_session_commit_params(DBusConnection *conn,
+                                          DBusMessage *msg,
+                                          void *userdata) {
+    agm_module_dbus_data *mdata = (agm_module_dbus_data *)userdata;
+    DBusMessage *reply = NULL;
+    DBusMessageIter arg_i;
+    uint32_t session_id;
+
+    if (userdata == NULL) {
+        AGM_LOGE("Invalid userdata");
+        return;
+    }
+
+    if (!dbus_message_iter_init(msg, &arg_i)) {
+        AGM_LOGE("ipc_agm_session_commit_params has no arguments");
+        agm_dbus_send_error(mdata->conn, msg, DBUS_ERROR_FAILED,
+                            "ipc_agm_session_commit_params has no arguments");
+        return;
+    }
+
+    if (strcmp(dbus_message_get_signature(msg), "u")) {
+        AGM_LOGE("Invalid signature for ipc_agm_session_commit_params.");
+        agm_dbus_send_error(mdata->conn, msg, DBUS_ERROR_FAILED,
+                        "Invalid signature for ipc_agm_session_commit_params.");
+        return;
+    }
+
+    dbus_message_iter_get_basic(&arg_i, &session_id);
+
+    if (agm_session_commit_params(session_id) != 0) {
+        AGM_LOGE("agm_session_commit_params failed.");
+        agm_dbus_send_error(mdata->conn, msg, DBUS_ERROR_FAILED,
+                            "agm_session_commit_params failed.");
+        return;
+    }
+
+    reply = dbus_message_new_method_return(msg);
+    dbus_connection_send(conn, reply, NULL);
+    dbus_message_unref(reply);
+}
+
+static void ipc_agm_session_get_cal_stats(DBusConnection *conn,
+                                          DBusMessage *msg,
+                                          void *userdata) {
+    agm_module_dbus_data *mdata = (agm_module_dbus_data *)userdata;
+    DBusMessage *reply = NULL;
+    DBusMessageIter arg_i, r_arg;
+    uint32_t session_id, applied = 0, skipped = 0;
+
+    if (userdata == NULL) {
+        AGM_LOGE("Invalid userdata");
+        return;
+    }
+
+    if (!dbus_message_iter_init(msg, &arg_i)) {
+        AGM_LOGE("ipc_agm_session_get_cal_stats has no arguments");
+        agm_dbus_send_error(mdata->conn, msg, DBUS_ERROR_FAILED,
+                            "ipc_agm_session_get_cal_stats has no arguments");
+        return;
+    }
+
+    if (strcmp(dbus_message_get_signature(msg), "u")) {
+        AGM_LOGE("Invalid signature for ipc_agm_session_get_cal_stats.");
+        agm_dbus_send_error(mdata->conn, msg, DBUS_ERROR_FAILED,
+                        "Invalid signature for ipc_agm_session_get_cal_stats.");
+        return;
+    }
+
+    dbus_message_iter_get_basic(&arg_i, &session_id);
+
+    if (agm_session_get_cal_stats(session_id, &applied, &skipped) != 0) {
+        AGM_LOGE("agm_session_get_cal_stats failed.");
+        agm_dbus_send_error(mdata->conn, msg, DBUS_ERROR_FAILED,
+                            "agm_session_get_cal_stats failed.");
+        return;
+    }
+
+    reply = dbus_message_new_method_return(msg);
+    dbus_message_iter_init_append(reply, &r_arg);
+    dbus_message_iter_append_basic(&r_arg, DBUS_TYPE_UINT32, &applied);
+    dbus_message_iter_append_basic(&r_arg, DBUS_TYPE_UINT32, &skipped);
+    dbus_connection_send(conn, reply, NULL);
+    dbus_message_unref(reply);
+}
+
+/* Initialize module data. Get dbus connection and register module interface
+    with the connection */
+int ipc_agm_init() {
+    DBusError err;
+    int rc = 0;
+
+    AGM_LOGV("%s : ", __func__);
+
+    mdata = (agm_module_dbus_data *)malloc(sizeof(agm_module_dbus_data));
+    mdata->dbus_obj_path =
+                    (char *)malloc(sizeof(char)*(strlen(AGM_OBJECT_PATH) + 1));
+    memcpy(mdata->dbus_obj_path, AGM_OBJECT_PATH, strlen(AGM_OBJECT_PATH)+1);
+
+    mdata->conn = agm_dbus_new_connection();
+
+    dbus_error_init(&err);
+    rc = dbus_bus_request_name(mdata->conn->conn,
+                               AGM_DBUS_CONNECTION,
+                               DBUS_NAME_FLAG_REPLACE_EXISTING,
+                               &err);
+
+    if (rc != DBUS_REQUEST_NAME_REPLY_PRIMARY_OWNER) {
+        AGM_LOGE("Failed to request name on bus: %s", err.message);
+        agm_dbus_connection_free(mdata->conn);
+        free(mdata->dbus_obj_path);
+        mdata->dbus_obj_path = NULL;
+        free(mdata);
+        mdata = NULL;
+        rc = -EINVAL;
+        return rc;
+    }
+
+    if (agm_setup_dbus_with_main_loop(mdata->conn)) {
+        AGM_LOGE("Failed to setup main loop");
+        agm_dbus_connection_free(mdata->conn);
+        free(mdata->dbus_obj_path);
+        mdata->dbus_obj_path = NULL;
+        free(mdata);
+        mdata = NULL;
+        rc = -EINVAL;
+        return rc;
     }
 
     if ((rc = agm_dbus_add_interface(mdata->conn,
@@ -2571,6 +3420,26 @@ int ipc_agm_init() {
                                             g_direct_equal,
                                             NULL,
                                             agm_free_session);
+    mdata->blobs = g_hash_table_new_full(g_str_hash,
+                                         g_str_equal,
+                                         g_free,
+                                         NULL);
+
+    /* clients leaving the bus are seen through NameOwnerChanged */
+    dbus_bus_add_match(mdata->conn->conn,
+                       "type='signal',sender='" DBUS_SERVICE_DBUS "',"
+                       "interface='" DBUS_INTERFACE_DBUS "',"
+                       "member='NameOwnerChanged',arg2=''",
+                       &err);
+    if (dbus_error_is_set(&err)) {
+        AGM_LOGE("Unable to watch clients leaving: %s", err.message);
+        dbus_error_free(&err);
+    } else if (!dbus_connection_add_filter(mdata->conn->conn,
+                                           blob_owner_filter_cb,
+                                           mdata,
+                                           NULL)) {
+        AGM_LOGE("Unable to add blob owner filter");
+    }
 
     if ((rc = agm_init()) != 0) {
         AGM_LOGE("agm initialization failed");
@@ -2604,6 +3473,11 @@ void ipc_agm_deinit() {
         mdata->dbus_obj_path = NULL;
     }
 
+    dbus_connection_remove_filter(mdata->conn->conn, blob_owner_filter_cb,
+                                  mdata);
+    g_hash_table_foreach(mdata->blobs, agm_free_blob_list, NULL);
+    g_hash_table_unref(mdata->blobs);
+
     agm_dbus_connection_free(mdata->conn);
     free(mdata);
     mdata = NULL;
@@ -26,7 +26,8 @@ LOCAL_SHARED_LIBRARIES := \
     libcutils \
     libhardware \
     libbase \
-    vendor.qti.hardware.AGMIPC@1.0
+    vendor.qti.hardware.AGMIPC@1.0 \
+    vendor.qti.hardware.AGMIPC@1.1
 
 LOCAL_HEADER_LIBRARIES := libagm_headers
 
@@ -39,7 +39,7 @@
 #include <hidl/LegacySupport.h>
 #include <log/log.h>
 #include <unistd.h>
-#include <vendor/qti/hardware/AGMIPC/1.0/IAGM.h>
+#include <vendor/qti/hardware/AGMIPC/1.1/IAGM.h>
 
 #include <agm/agm_api.h>
 #include <mutex>
@@ -47,11 +47,13 @@
 
 using android::hardware::Return;
 using android::hardware::hidl_vec;
-using vendor::qti::hardware::AGMIPC::V1_0::IAGM;
+using vendor::qti::hardware::AGMIPC::V1_1::IAGM;
 using vendor::qti::hardware::AGMIPC::V1_0::IAGMCallback;
 using vendor::qti::hardware::AGMIPC::V1_0::implementation::AGMCallback;
-using vendor::qti::hardware::AGMIPC::V1_0::MmapBufInfo;
+using vendor::qti::hardware::AGMIPC::V1_1::MmapBufInfo;
 using vendor::qti::hardware::AGMIPC::V1_0::AgmDumpInfo;
+using vendor::qti::hardware::AGMIPC::V1_1::AgmThreadSchedInfo;
+using vendor::qti::hardware::AGMIPC::V1_1::AgmSsrStats;
 using android::hardware::defaultPassthroughServiceImplementation;
 using android::hardware::configureRpcThreadpool;
 using android::hardware::joinRpcThreadpool;
@@ -266,6 +268,16 @@ int agm_session_stop(uint64_t handle){
     return -EINVAL;
 }
 
+int agm_session_cmd_async(uint64_t handle, enum agm_session_cmd cmd,
+                          uint32_t token){
+    ALOGV("%s called with handle = %llx \n", __func__, (unsigned long long) handle);
+    if (!agm_server_died) {
+        android::sp<IAGM> agm_client = get_agm_server();
+        return agm_client->ipc_agm_session_cmd_async(handle, cmd, token);
+    }
+    return -EINVAL;
+}
+
 int agm_session_pause(uint64_t handle){
     ALOGV("%s called with handle = %llx \n", __func__, (unsigned long long) handle);
     if (!agm_server_died) {
@@ -371,6 +383,340 @@ int agm_session_read(uint64_t handle, void *buf, size_t *byte_count){
     return -EINVAL;
 }
 
+int agm_session_writev(uint64_t handle, struct agm_iovec *iov,
+                       uint32_t iovcnt, uint32_t *done) {
+    ALOGV("%s called with handle = %llx \n", __func__, (unsigned long long) handle);
+    if (!agm_server_died) {
+        android::sp<IAGM> agm_client = get_agm_server();
+        hidl_vec<uint32_t> sizes, flags;
+        hidl_vec<uint64_t> timestamps;
+        hidl_vec<uint8_t> buff;
+        size_t total = 0, offset = 0;
+        uint32_t i;
+        int ret = -EINVAL;
+
+        if (!handle || iovcnt == 0 || iovcnt > AGM_SESSION_MAX_IOV)
+            return -EINVAL;
+
+        sizes.resize(iovcnt);
+        flags.resize(iovcnt);
+        timestamps.resize(iovcnt);
+        for (i = 0; i < iovcnt; i++) {
+            sizes[i] = iov[i].size;
+            flags[i] = iov[i].flags;
+            timestamps[i] = iov[i].timestamp;
+            total += iov[i].size;
+        }
+        /* all buffers go in one transaction, packed back to back */
+        buff.resize(total);
+        for (i = 0; i < iovcnt; i++) {
+            memcpy(buff.data() + offset, iov[i].addr, iov[i].size);
+            offset += iov[i].size;
+        }
+
+        auto status = agm_client->ipc_agm_session_writev(handle, sizes, flags,
+                   timestamps, buff,
+                   [&](int32_t _ret, uint32_t _done, hidl_vec<uint32_t> sizes_ret)
+                   { ret = _ret;
+                     *done = _done;
+                     for (i = 0; i < iovcnt && i < sizes_ret.size(); i++)
+                         iov[i].size = sizes_ret[i];
+                   });
+        if (!status.isOk()) {
+            ALOGE("%s: HIDL call failed. ret=%d\n", __func__, ret);
+        }
+        return ret;
+    }
+    return -EINVAL;
+}
+
+int agm_session_readv(uint64_t handle, struct agm_iovec *iov,
+                      uint32_t iovcnt, uint32_t *done) {
+    ALOGV("%s called with handle = %llx \n", __func__, (unsigned long long) handle);
+    if (!agm_server_died) {
+        android::sp<IAGM> agm_client = get_agm_server();
+        hidl_vec<uint32_t> sizes;
+        uint32_t i;
+        int ret = -EINVAL;
+
+        if (!handle || iovcnt == 0 || iovcnt > AGM_SESSION_MAX_IOV)
+            return -EINVAL;
+
+        sizes.resize(iovcnt);
+        for (i = 0; i < iovcnt; i++)
+            sizes[i] = iov[i].size;
+
+        auto status = agm_client->ipc_agm_session_readv(handle, sizes,
+                   [&](int32_t _ret, uint32_t _done, hidl_vec<uint32_t> sizes_ret,
+                       hidl_vec<uint32_t> flags, hidl_vec<uint64_t> timestamps,
+                       hidl_vec<uint8_t> buff)
+                   { size_t offset = 0;
+                     ret = _ret;
+                     *done = _done > iovcnt ? iovcnt : _done;
+                     if (sizes_ret.size() != iovcnt || flags.size() != iovcnt ||
+                         timestamps.size() != iovcnt)
+                         return;
+                     for (i = 0; i < iovcnt; i++) {
+                         /* sizes come from the server, keep them in bounds */
+                         if (sizes_ret[i] > sizes[i] ||
+                             offset + sizes_ret[i] > buff.size()) {
+                             if (!ret)
+                                 ret = -EINVAL;
+                             break;
+                         }
+                         memcpy(iov[i].addr, buff.data() + offset, sizes_ret[i]);
+                         offset += sizes[i];
+                         iov[i].size = sizes_ret[i];
+                         iov[i].flags = flags[i];
+                         iov[i].timestamp = timestamps[i];
+                     }
+                     if (i < iovcnt && *done > i)
+                         *done = i;
+                     for (; i < iovcnt; i++)
+                         iov[i].size = 0;
+                   });
+        if (!status.isOk()) {
+            ALOGE("%s: HIDL call failed. ret=%d\n", __func__, ret);
+        }
+        return ret;
+    }
+    return -EINVAL;
+}
+
+int agm_session_reader_open(uint64_t handle, uint64_t *reader) {
+    ALOGV("%s called with handle = %llx \n", __func__, (unsigned long long) handle);
+    if (!agm_server_died) {
+        android::sp<IAGM> agm_client = get_agm_server();
+        int ret = -EINVAL;
+
+        auto status = agm_client->ipc_agm_session_reader_open(handle,
+                   [&](int32_t _ret, uint64_t _reader)
+                   { ret = _ret;
+                     *reader = _reader;
+                   });
+        if (!status.isOk()) {
+            ALOGE("%s: HIDL call failed. ret=%d\n", __func__, ret);
+        }
+        return ret;
+    }
+    return -EINVAL;
+}
+
+int agm_session_reader_read(uint64_t reader, void *buf, size_t *byte_count,
+                            uint64_t *dropped) {
+    ALOGV("%s called with reader = %llx \n", __func__, (unsigned long long) reader);
+    if (!agm_server_died) {
+        android::sp<IAGM> agm_client = get_agm_server();
+        int ret = -EINVAL;
+
+        auto status = agm_client->ipc_agm_session_reader_read(reader, *byte_count,
+                   [&](int32_t _ret, hidl_vec<uint8_t> buff_hidl, uint32_t cnt,
+                       uint64_t _dropped)
+                   { ret = _ret;
+                     if (!ret && (cnt > buff_hidl.size() || cnt > *byte_count))
+                         ret = -EINVAL;
+                     if (!ret) {
+                         memcpy(buf, buff_hidl.data(), cnt);
+                         *byte_count = (size_t) cnt;
+                         *dropped = _dropped;
+                     }
+                   });
+        if (!status.isOk()) {
+            ALOGE("%s: HIDL call failed. ret=%d\n", __func__, ret);
+        }
+        return ret;
+    }
+    return -EINVAL;
+}
+
+int agm_session_reader_close(uint64_t reader) {
+    ALOGV("%s called with reader = %llx \n", __func__, (unsigned long long) reader);
+    if (!agm_server_died) {
+        android::sp<IAGM> agm_client = get_agm_server();
+        return agm_client->ipc_agm_session_reader_close(reader);
+    }
+    return -EINVAL;
+}
+
+int agm_get_thread_sched_info(struct agm_thread_sched_info *info,
+                              uint32_t *num) {
+    ALOGV("%s called\n", __func__);
+    if (!num)
+        return -EINVAL;
+
+    if (!agm_server_died) {
+        android::sp<IAGM> agm_client = get_agm_server();
+        int32_t ret = -EINVAL;
+
+        if (!agm_client)
+            return -EINVAL;
+
+        auto status = agm_client->ipc_agm_get_thread_sched_info(
+                                    info ? *num : 0,
+                                    [&](int32_t _ret,
+                                        hidl_vec<AgmThreadSchedInfo> info_hidl,
+                                        uint32_t num_hidl)
+        { ret = _ret;
+          if (ret)
+              return;
+          /* never trust the reply to stay within the array of the caller */
+          if (info && (num_hidl > *num || info_hidl.size() < num_hidl)) {
+              ret = -EINVAL;
+              return;
+          }
+          for (uint32_t i = 0; info && i < num_hidl; i++) {
+              info[i].tid = info_hidl[i].tid;
+              info[i].thread_class = info_hidl[i].thread_class;
+              info[i].policy = info_hidl[i].policy;
+              info[i].priority = info_hidl[i].priority;
+              info[i].cpu_mask = info_hidl[i].cpu_mask;
+          }
+          *num = num_hidl;
+        });
+        if (!status.isOk()) {
+            ALOGE("%s: HIDL call failed. ret=%d\n", __func__, ret);
+            return -EINVAL;
+        }
+        return ret;
+    }
+    return -EINVAL;
+}
+
+int agm_get_ssr_stats(struct agm_ssr_stats *stats) {
+    ALOGV("%s called\n", __func__);
+    if (!stats)
+        return -EINVAL;
+
+    if (!agm_server_died) {
+        android::sp<IAGM> agm_client = get_agm_server();
+        int32_t ret = -EINVAL;
+
+        if (!agm_client)
+            return -EINVAL;
+
+        auto status = agm_client->ipc_agm_get_ssr_stats(
+                                    [&](int32_t _ret, const AgmSsrStats& stats_hidl)
+        { ret = _ret;
+          if (ret)
+              return;
+          stats->ssr_count = stats_hidl.ssr_count;
+          stats->sessions_restored = stats_hidl.sessions_restored;
+          stats->sessions_failed = stats_hidl.sessions_failed;
+          stats->down_to_restored_us = stats_hidl.down_to_restored_us;
+          stats->up_to_restored_us = stats_hidl.up_to_restored_us;
+        });
+        if (!status.isOk()) {
+            ALOGE("%s: HIDL call failed. ret=%d\n", __func__, ret);
+            return -EINVAL;
+        }
+        return ret;
+    }
+    return -EINVAL;
+}
+
+int agm_session_set_gain(uint32_t session_id, uint32_t gain,
+                         uint32_t ramp_duration_ms) {
+    ALOGV("%s : sess_id = %d, gain = 0x%x, ramp = %d\n", __func__,
+           session_id, gain, ramp_duration_ms);
+    if (!agm_server_died) {
+        android::sp<IAGM> agm_client = get_agm_server();
+        return agm_client->ipc_agm_session_set_gain(session_id, gain,
+                                                    ramp_duration_ms);
+    }
+    return -EINVAL;
+}
+
+int agm_session_aif_set_gain(uint32_t session_id, uint32_t aif_id,
+                             uint32_t gain, uint32_t ramp_duration_ms) {
+    ALOGV("%s : sess_id = %d, aif_id = %d, gain = 0x%x, ramp = %d\n",
+           __func__, session_id, aif_id, gain, ramp_duration_ms);
+    if (!agm_server_died) {
+        android::sp<IAGM> agm_client = get_agm_server();
+        return agm_client->ipc_agm_session_aif_set_gain(session_id, aif_id,
+                                                        gain, ramp_duration_ms);
+    }
+    return -EINVAL;
+}
+
+int agm_session_stage_params(uint32_t session_id, void *payload, size_t size)
+{
+    ALOGV("%s : sess_id = %d, size = %zu\n", __func__, session_id, size);
+    if (!agm_server_died) {
+        android::sp<IAGM> agm_client = get_agm_server();
+
+        uint32_t size_hidl = (uint32_t) size;
+        hidl_vec<uint8_t> payload_hidl;
+        payload_hidl.resize(size_hidl);
+        memcpy(payload_hidl.data(), payload, size_hidl);
+        return agm_client->ipc_agm_session_stage_params(session_id,
+                                                        payload_hidl,
+                                                        size_hidl);
+    }
+    return -EINVAL;
+}
+
+int agm_session_aif_stage_params(uint32_t session_id, uint32_t aif_id,
+                                 void *payload, size_t size)
+{
+    ALOGV("%s : sess_id = %d, aif_id = %d, size = %zu\n", __func__,
+           session_id, aif_id, size);
+    if (!agm_server_died) {
+        android::sp<IAGM> agm_client = get_agm_server();
+
+        uint32_t size_hidl = (uint32_t) size;
+        hidl_vec<uint8_t> payload_hidl;
+        payload_hidl.resize(size_hidl);
+        memcpy(payload_hidl.data(), payload, size_hidl);
+        return agm_client->ipc_agm_session_aif_stage_params(session_id,
+                                                            aif_id,
+                                                            payload_hidl,
+                                                            size_hidl);
+    }
+    return -EINVAL;
+}
+
+int agm_session_commit_params(uint32_t session_id)
+{
+    ALOGV("%s : sess_id = %d\n", __func__, session_id);
+    if (!agm_server_died) {
+        android::sp<IAGM> agm_client = get_agm_server();
+        return agm_client->ipc_agm_session_commit_params(session_id);
+    }
+    return -EINVAL;
+}
+
+int agm_session_get_cal_stats(uint32_t session_id, uint32_t *applied,
+                              uint32_t *skipped)
+{
+    ALOGV("%s : sess_id = %d\n", __func__, session_id);
+    if (!applied || !skipped)
+        return -EINVAL;
+
+    if (!agm_server_died) {
+        android::sp<IAGM> agm_client = get_agm_server();
+        int32_t ret = -EINVAL;
+
+        if (!agm_client)
+            return -EINVAL;
+
+        auto status = agm_client->ipc_agm_session_get_cal_stats(session_id,
+                                    [&](int32_t _ret, uint32_t _applied,
+                                        uint32_t _skipped)
+        { ret = _ret;
+          if (ret)
+              return;
+          *applied = _applied;
+          *skipped = _skipped;
+        });
+        if (!status.isOk()) {
+            ALOGE("%s: HIDL call failed. ret=%d\n", __func__, ret);
+            return -EINVAL;
+        }
+        return ret;
+    }
+    return -EINVAL;
+}
+
 int agm_session_write(uint64_t handle, void *buf, size_t *byte_count) {
     ALOGV("%s called with handle = %llx \n", __func__, (unsigned long long) handle);
     if (!agm_server_died) {
@@ -773,6 +1119,21 @@ int agm_session_register_cb(uint32_t session_id, agm_event_cb cb,
     return -EINVAL;
 }
 
+/*
+ *Filters are applied by the service to in-process callbacks, callbacks of
+ *remote clients are registered unfiltered by the IPC server.
+ */
+int agm_session_register_cb_filtered(uint32_t session_id, agm_event_cb cb,
+                                     enum event_type evt_type, void *client_data,
+                                     const struct agm_event_filter *filter)
+{
+    if (cb && filter && (filter->num_event_ids || filter->num_module_ids)) {
+        ALOGE("%s: event filters are not supported over IPC\n", __func__);
+        return -EOPNOTSUPP;
+    }
+    return agm_session_register_cb(session_id, cb, evt_type, client_data);
+}
+
 int agm_session_eos(uint64_t handle)
 {
     ALOGV("%s called with handle = %llx \n", __func__, (unsigned long long) handle);
@@ -827,8 +1188,9 @@ int agm_session_get_buf_info(uint32_t session_id, struct agm_buf_info *buf_info,
         android::sp<IAGM> agm_client = get_agm_server();
         const native_handle *datahandle = nullptr;
         const native_handle *poshandle = nullptr;
+        const native_handle *timehandle = nullptr;
 
-        auto status = agm_client->ipc_agm_session_get_buf_info(session_id, flag,
+        auto status = agm_client->ipc_agm_session_get_buf_info_1_1(session_id, flag,
                 [&](int32_t _ret, const MmapBufInfo& buf_info_ret_hidl)
                 { ret = _ret;
                 if (!ret) {
@@ -842,6 +1204,11 @@ int agm_session_get_buf_info(uint32_t session_id, struct agm_buf_info *buf_info,
                 buf_info->pos_buf_fd = poshandle->data[0];
                 buf_info->pos_buf_size = buf_info_ret_hidl.pos_size;
                 }
+                if (flag & TIME_BUF) {
+                timehandle = buf_info_ret_hidl.timeSharedMemory.handle();
+                buf_info->time_buf_fd = dup(timehandle->data[0]);
+                buf_info->time_buf_size = buf_info_ret_hidl.time_size;
+                }
                 }
                 });
         if (!status.isOk()) {
@@ -1112,6 +1479,113 @@ int agm_session_write_datapath_params(uint32_t session_id, struct agm_buff *buf)
     return -EINVAL;
 }
 
+int agm_session_transact(void *txn, size_t txn_size, uint64_t *handle)
+{
+    ALOGV("%s : size = %zu\n", __func__, txn_size);
+    int ret = -EINVAL;
+    if (!agm_server_died) {
+        android::sp<IAGM> agm_client = get_agm_server();
+
+        uint32_t size_hidl = (uint32_t) txn_size;
+        hidl_vec<uint8_t> txn_hidl;
+        txn_hidl.resize(size_hidl);
+        memcpy(txn_hidl.data(), txn, size_hidl);
+        auto status = agm_client->ipc_agm_session_transact(txn_hidl, size_hidl,
+                              [&](int32_t _ret, hidl_vec<uint64_t> handle_hidl)
+                              {  ret = _ret;
+                                 *handle = *handle_hidl.data();
+                              });
+        if (!status.isOk()) {
+            ALOGE("%s: HIDL call failed. ret=%d\n", __func__, ret);
+        }
+    }
+    return ret;
+}
+
+int agm_blob_register(enum agm_blob_type type, void *blob, size_t size,
+                      uint32_t *blob_id)
+{
+    ALOGV("%s : type = %d, size = %zu\n", __func__, type, size);
+    int ret = -EINVAL;
+    if (!agm_server_died) {
+        android::sp<IAGM> agm_client = get_agm_server();
+
+        uint32_t size_hidl = (uint32_t) size;
+        hidl_vec<uint8_t> blob_hidl;
+        blob_hidl.resize(size_hidl);
+        memcpy(blob_hidl.data(), blob, size_hidl);
+        auto status = agm_client->ipc_agm_blob_register((uint32_t) type,
+                              blob_hidl, size_hidl,
+                              [&](int32_t _ret, uint32_t blob_id_ret)
+                              {  ret = _ret;
+                                 *blob_id = blob_id_ret;
+                              });
+        if (!status.isOk()) {
+            ALOGE("%s: HIDL call failed. ret=%d\n", __func__, ret);
+        }
+    }
+    return ret;
+}
+
+int agm_blob_unregister(uint32_t blob_id)
+{
+    ALOGV("%s : blob_id = %d\n", __func__, blob_id);
+    if (!agm_server_died) {
+        android::sp<IAGM> agm_client = get_agm_server();
+        return agm_client->ipc_agm_blob_unregister(blob_id);
+    }
+    return -EINVAL;
+}
+
+int agm_session_set_params_owned(uint32_t session_id, uint32_t aif_id,
+                                 void *payload, size_t size)
+{
+    int ret;
+
+    /* the payload is marshalled anyway, ownership only saves the free */
+    if (aif_id == AGM_AIF_NONE)
+        ret = agm_session_set_params(session_id, payload, size);
+    else
+        ret = agm_session_aif_set_params(session_id, aif_id, payload, size);
+    free(payload);
+    return ret;
+}
+
+int agm_session_set_params_fd(uint32_t session_id, uint32_t aif_id,
+                              int fd, size_t size)
+{
+    ALOGV("%s : sess_id = %d, aif_id = %d, size = %zu\n", __func__,
+           session_id, aif_id, size);
+    int ret = -EINVAL;
+    if (!agm_server_died) {
+        android::sp<IAGM> agm_client = get_agm_server();
+        native_handle_t *fd_handle = native_handle_create(1, 0);
+        if (!fd_handle) {
+            ALOGE("%s native_handle_create fails", __func__);
+            return -ENOMEM;
+        }
+        /* the caller keeps ownership of fd */
+        fd_handle->data[0] = fd;
+        ret = agm_client->ipc_agm_session_set_params_fd(session_id, aif_id,
+                                                        hidl_handle(fd_handle),
+                                                        (uint32_t)size);
+        native_handle_delete(fd_handle);
+    }
+    return ret;
+}
+
+int agm_session_set_blob(uint32_t session_id, uint32_t aif_id, uint32_t blob_id)
+{
+    ALOGV("%s : sess_id = %d, aif_id = %d, blob_id = %d\n", __func__,
+           session_id, aif_id, blob_id);
+    if (!agm_server_died) {
+        android::sp<IAGM> agm_client = get_agm_server();
+        return agm_client->ipc_agm_session_set_blob(session_id, aif_id,
+                                                    blob_id);
+    }
+    return -EINVAL;
+}
+
 int agm_dump(struct agm_dump_info *dump_info) {
     if (agm_server_died) {
         ALOGE("%s: Cannot perform dump, AGM service has died", __func__);
@@ -34,7 +34,7 @@
 #ifndef ANDROID_SYSTEM_AGMIPC_V1_0_AGM_H
 #define ANDROID_SYSTEM_AGMIPC_V1_0_AGM_H
 
-#include <vendor/qti/hardware/AGMIPC/1.0/IAGM.h>
+#include <vendor/qti/hardware/AGMIPC/1.1/IAGM.h>
 #include <hidl/MQDescriptor.h>
 #include <hidl/Status.h>
 #include <vector>
@@ -57,6 +57,8 @@ using ::android::hardware::Return;
 using ::android::hardware::Void;
 using ::android::hardware::hidl_handle;
 using ::android::sp;
+using ::vendor::qti::hardware::AGMIPC::V1_1::AgmThreadSchedInfo;
+using ::vendor::qti::hardware::AGMIPC::V1_1::AgmSsrStats;
 
 class SrvrClbk
 {
@@ -99,7 +101,7 @@ typedef struct clbk_data {
    SrvrClbk *srv_clt_data;
 } clbk_data;
 
-struct AGM : public IAGM {
+struct AGM : public V1_1::IAGM {
     public :
     AGM() {
       agm_initialized = agm_init() == 0?true:false;
@@ -170,6 +172,8 @@ struct AGM : public IAGM {
     Return<int32_t> ipc_agm_session_prepare(uint64_t hndl) override;
     Return<int32_t> ipc_agm_session_start(uint64_t hndl) override;
     Return<int32_t> ipc_agm_session_stop(uint64_t hndl) override;
+    Return<int32_t> ipc_agm_session_cmd_async(uint64_t hndl, uint32_t cmd,
+                                              uint32_t token) override;
     Return<int32_t> ipc_agm_session_pause(uint64_t hndl) override;
     Return<int32_t> ipc_agm_session_flush(uint64_t hndl) override;
     Return<int32_t> ipc_agm_sessionid_flush(uint32_t session_id) override;
@@ -225,6 +229,55 @@ struct AGM : public IAGM {
     Return<int32_t> ipc_agm_session_write_datapath_params(uint32_t session_id,
                                const hidl_vec<AgmBuff>& buff) override;
 
+    // Methods from ::vendor::qti::hardware::AGMIPC::V1_1::IAGM follow.
+    Return<void> ipc_agm_session_get_buf_info_1_1(uint32_t session_id, uint32_t flag,
+                               ipc_agm_session_get_buf_info_1_1_cb _hidl_cb) override;
+    Return<void> ipc_agm_session_transact(const hidl_vec<uint8_t>& txn,
+                               uint32_t size,
+                               ipc_agm_session_transact_cb _hidl_cb) override;
+    Return<void> ipc_agm_blob_register(uint32_t type,
+                               const hidl_vec<uint8_t>& blob,
+                               uint32_t size,
+                               ipc_agm_blob_register_cb _hidl_cb) override;
+    Return<int32_t> ipc_agm_blob_unregister(uint32_t blob_id) override;
+    Return<int32_t> ipc_agm_session_set_blob(uint32_t session_id,
+                               uint32_t aif_id, uint32_t blob_id) override;
+    Return<int32_t> ipc_agm_session_set_params_fd(uint32_t session_id,
+                               uint32_t aif_id, const hidl_handle& fd,
+                               uint32_t size) override;
+    Return<void> ipc_agm_session_reader_open(uint64_t hndl,
+                               ipc_agm_session_reader_open_cb _hidl_cb) override;
+    Return<void> ipc_agm_session_reader_read(uint64_t reader, uint32_t count,
+                               ipc_agm_session_reader_read_cb _hidl_cb) override;
+    Return<int32_t> ipc_agm_session_reader_close(uint64_t reader) override;
+    Return<void> ipc_agm_session_writev(uint64_t hndl,
+                               const hidl_vec<uint32_t>& sizes,
+                               const hidl_vec<uint32_t>& flags,
+                               const hidl_vec<uint64_t>& timestamps,
+                               const hidl_vec<uint8_t>& buff,
+                               ipc_agm_session_writev_cb _hidl_cb) override;
+    Return<void> ipc_agm_session_readv(uint64_t hndl,
+                               const hidl_vec<uint32_t>& sizes,
+                               ipc_agm_session_readv_cb _hidl_cb) override;
+    Return<void> ipc_agm_get_thread_sched_info(uint32_t num,
+                               ipc_agm_get_thread_sched_info_cb _hidl_cb) override;
+    Return<void> ipc_agm_get_ssr_stats(ipc_agm_get_ssr_stats_cb _hidl_cb) override;
+    Return<int32_t> ipc_agm_session_set_gain(uint32_t session_id, uint32_t gain,
+                               uint32_t ramp_duration_ms) override;
+    Return<int32_t> ipc_agm_session_aif_set_gain(uint32_t session_id,
+                               uint32_t aif_id, uint32_t gain,
+                               uint32_t ramp_duration_ms) override;
+    Return<int32_t> ipc_agm_session_stage_params(uint32_t session_id,
+                               const hidl_vec<uint8_t>& payload,
+                               uint32_t size) override;
+    Return<int32_t> ipc_agm_session_aif_stage_params(uint32_t session_id,
+                               uint32_t aif_id,
+                               const hidl_vec<uint8_t>& payload,
+                               uint32_t size) override;
+    Return<int32_t> ipc_agm_session_commit_params(uint32_t session_id) override;
+    Return<void> ipc_agm_session_get_cal_stats(uint32_t session_id,
+                               ipc_agm_session_get_cal_stats_cb _hidl_cb) override;
+
     int is_agm_initialized() { return agm_initialized;}
 
 private:
@@ -68,6 +68,8 @@
 #include <cutils/android_filesystem_config.h>
 #include <pthread.h>
 #include <signal.h>
+#include <algorithm>
+#include <unistd.h>
 #include "gsl_intf.h"
 #include <hwbinder/IPCThreadState.h>
 #include <utils/ProcessCallStack.h>
@@ -82,6 +84,12 @@
 
 #define MAX_KVPAIR 48
 
+/* the service lists far fewer threads, bounds what a client can ask for */
+#define MAX_THREAD_SCHED_INFO 64
+
+/* a readv reply must fit in the hwbinder transaction buffer */
+#define MAX_READV_BYTES (512 * 1024)
+
 static const constexpr int DEBUGGER_SIGNAL = (__SIGRTMIN + 3);
 
 using AgmCallbackData = ::vendor::qti::hardware::AGMIPC::V1_0::implementation::clbk_data;
@@ -101,6 +109,8 @@ typedef struct {
    uint64_t handle;
    std::vector<std::pair<int, int>> shared_mem_fd_list;
    std::vector<uint32_t> aif_id_list;
+   /* buffer size of the last set_config, bounds readv buffers */
+   uint32_t buf_size;
 } agm_client_session_handle;
 
 typedef struct {
@@ -108,6 +118,10 @@ typedef struct {
     uint32_t pid;
     android::sp<IAGMCallback> clbk_binder;
     struct listnode agm_client_hndl_list;
+    /* capture fan-out readers, closed if the client dies */
+    std::vector<uint64_t> reader_list;
+    /* blob registrations, one entry each, dropped if the client dies */
+    std::vector<uint32_t> blob_list;
 } client_info;
 
 void dumpAgmStackTrace(struct agm_dump_info *d_info) {
@@ -172,6 +186,12 @@ void client_death_notifier::serviceDied(uint64_t cookie,
         handle = node_to_item(node, client_info, list);
         if (handle->pid == cookie) {
             ALOGV("%s: MATCHED pid = %llu\n", __func__, (unsigned long long) cookie);
+            for (const auto & reader : handle->reader_list)
+                agm_session_reader_close(reader);
+            handle->reader_list.clear();
+            for (const auto & blob_id : handle->blob_list)
+                agm_blob_unregister(blob_id);
+            handle->blob_list.clear();
             list_for_each_safe(sess_node, sess_tempnode,
                                       &handle->agm_client_hndl_list) {
                 session_handle = node_to_item(sess_node, agm_client_session_handle, list);
@@ -346,6 +366,26 @@ static void remove_session_aif_from_list_l(uint32_t session_id, uint32_t aif_id)
     }
 }
 
+/* session of the calling client opened with hndl, NULL if there is none */
+static agm_client_session_handle* get_session_handle_by_hndl_l(uint64_t hndl)
+{
+    struct listnode *node = NULL;
+    agm_client_session_handle *session_handle = NULL;
+    client_info *client_handle = NULL;
+    int pid = ::android::hardware::IPCThreadState::self()->getCallingPid();
+
+    client_handle = get_client_handle_l(pid);
+    if (!client_handle)
+        return NULL;
+
+    list_for_each(node, &client_handle->agm_client_hndl_list) {
+        session_handle = node_to_item(node, agm_client_session_handle, list);
+        if (session_handle->handle == hndl)
+            return session_handle;
+    }
+    return NULL;
+}
+
 static void add_session_handle_to_list_l(uint32_t session_id, uint64_t handle)
 {
     agm_client_session_handle *session_handle = NULL;
@@ -754,25 +794,16 @@ Return<int32_t> AGM::ipc_agm_session_aif_set_params(uint32_t session_id,
     ALOGV("%s : session_id = %d, aif_id =%d, size = %d\n", __func__,
                                                       session_id, aif_id, size);
     size_t size_local = (size_t) size;
-    void * payload_local = NULL;
-    int32_t ret = 0;
 
     if (payload.size() < size) {
         return -EINVAL;
     }
 
-    payload_local = (void*) calloc (1,size);
-    if (payload_local == NULL) {
-        ALOGE("%s: Cannot allocate memory for payload_local\n", __func__);
-        return -ENOMEM;
-    }
-    memcpy(payload_local, payload.data(), size);
-    ret = agm_session_aif_set_params(session_id,
+    /* the service only reads the payload, hand it the vector as is */
+    return agm_session_aif_set_params(session_id,
                                       aif_id,
-                                      payload_local,
+                                      (void *)payload.data(),
                                       size_local);
-    free(payload_local);
-    return ret;
 }
 
 Return<int32_t> AGM::ipc_agm_session_aif_set_cal(uint32_t session_id,
@@ -810,22 +841,14 @@ Return<int32_t> AGM::ipc_agm_session_set_params(uint32_t session_id,
                                                uint32_t size) {
     ALOGV("%s : session_id = %d, size = %d\n", __func__, session_id, size);
     size_t size_local = (size_t) size;
-    void * payload_local = NULL;
-    int32_t ret = 0;
 
     if (payload.size() < size) {
         return -EINVAL;
     }
 
-    payload_local = (void*) calloc (1,size);
-    if (payload_local == NULL) {
-        ALOGE("%s: Cannot allocate memory for payload_local\n", __func__);
-        return -ENOMEM;
-    }
-    memcpy(payload_local, payload.data(), size);
-    ret = agm_session_set_params(session_id, payload_local, size_local);
-    free(payload_local);
-    return ret;
+    /* the service only reads the payload, hand it the vector as is */
+    return agm_session_set_params(session_id, (void *)payload.data(),
+                                  size_local);
 }
 
 Return<int32_t> AGM::ipc_agm_set_params_with_tag(uint32_t session_id,
@@ -1017,14 +1040,24 @@ Return<int32_t> AGM::ipc_agm_session_set_config(uint64_t hndl,
                                   session_config_local,
                                   media_config_local,
                                   buffer_config_local);
+    if (!ret) {
+        agm_client_session_handle *session_handle = NULL;
+
+        pthread_mutex_lock(&client_list_lock);
+        session_handle = get_session_handle_by_hndl_l(hndl);
+        if (session_handle)
+            session_handle->buf_size = buffer_config_local->size;
+        pthread_mutex_unlock(&client_list_lock);
+    }
     free(session_config_local);
     free(media_config_local);
     free(buffer_config_local);
     return ret;
 }
 
-Return<int32_t> AGM::ipc_agm_session_close(uint64_t hndl) {
-    ALOGV("%s called with handle = %llx \n", __func__, (unsigned long long) hndl);
+/* stop tracking a session of the calling client once it is being closed */
+static void remove_session_handle(uint64_t hndl)
+{
     struct listnode *node = NULL;
     struct listnode *tempnode = NULL;
     agm_client_session_handle *session_handle = NULL;
@@ -1060,6 +1093,12 @@ Return<int32_t> AGM::ipc_agm_session_close(uint64_t hndl) {
     }
 done:
     pthread_mutex_unlock(&client_list_lock);
+}
+
+Return<int32_t> AGM::ipc_agm_session_close(uint64_t hndl) {
+    ALOGV("%s called with handle = %llx \n", __func__, (unsigned long long) hndl);
+
+    remove_session_handle(hndl);
     return agm_session_close(hndl);
 }
 
@@ -1081,6 +1120,24 @@ Return<int32_t> AGM::ipc_agm_session_stop(uint64_t hndl) {
     return agm_session_stop(hndl);
 }
 
+Return<int32_t> AGM::ipc_agm_session_cmd_async(uint64_t hndl, uint32_t cmd,
+                                               uint32_t token) {
+    int32_t ret;
+
+    ALOGV("%s called with handle = %llx cmd = %u\n", __func__,
+          (unsigned long long) hndl, cmd);
+
+    ret = agm_session_cmd_async(hndl, (enum agm_session_cmd)cmd, token);
+    /*
+     * the session is released only once the queued close runs, which it
+     * does even if the client dies first, so death must not close the
+     * handle a second time
+     */
+    if (ret == 0 && cmd == AGM_SESSION_CMD_CLOSE)
+        remove_session_handle(hndl);
+    return ret;
+}
+
 Return<int32_t> AGM::ipc_agm_session_pause(uint64_t hndl) {
     ALOGV("%s called with handle = %llx \n", __func__, (unsigned long long) hndl);
 
@@ -1348,11 +1405,27 @@ Return<void> AGM::ipc_agm_get_buffer_timestamp(uint32_t session_id,
 
 Return<void> AGM::ipc_agm_session_get_buf_info(uint32_t session_id, uint32_t flag,
                                              ipc_agm_session_get_buf_info_cb _hidl_cb) {
+    /* 1.0 MmapBufInfo has no room for the time page, do not dup one */
+    return ipc_agm_session_get_buf_info_1_1(session_id, flag & ~TIME_BUF,
+            [&](int32_t ret, const V1_1::MmapBufInfo& info_1_1) {
+                MmapBufInfo info;
+
+                info.dataSharedMemory = info_1_1.dataSharedMemory;
+                info.data_size = info_1_1.data_size;
+                info.posSharedMemory = info_1_1.posSharedMemory;
+                info.pos_size = info_1_1.pos_size;
+                _hidl_cb(ret, info);
+            });
+}
+
+Return<void> AGM::ipc_agm_session_get_buf_info_1_1(uint32_t session_id, uint32_t flag,
+                                   ipc_agm_session_get_buf_info_1_1_cb _hidl_cb) {
     struct agm_buf_info buf_info;
     int32_t ret = -EINVAL;
-    MmapBufInfo info;
+    V1_1::MmapBufInfo info;
     native_handle_t *dataHidlHandle = nullptr;
     native_handle_t *posHidlHandle = nullptr;
+    native_handle_t *timeHidlHandle = nullptr;
 
     ALOGV("%s : session_id = %d\n", __func__, session_id);
 
@@ -1382,6 +1455,18 @@ Return<void> AGM::ipc_agm_session_get_buf_info(uint32_t session_id, uint32_t fla
                     buf_info.pos_buf_size);
             info.pos_size = buf_info.pos_buf_size;
         }
+        if (flag & TIME_BUF) {
+            timeHidlHandle = native_handle_create(1, 0);
+            if (!timeHidlHandle) {
+                ALOGE("%s native_handle_create fails", __func__);
+                close(buf_info.time_buf_fd);
+                goto exit;
+            }
+            timeHidlHandle->data[0] = buf_info.time_buf_fd;
+            info.timeSharedMemory = hidl_memory("agm_time_page", timeHidlHandle,
+                    buf_info.time_buf_size);
+            info.time_size = buf_info.time_buf_size;
+        }
     }
 
     _hidl_cb(ret, info);
@@ -1393,6 +1478,12 @@ exit:
     if (posHidlHandle != nullptr)
         native_handle_delete(posHidlHandle);
 
+    /* time page fd is a dup made for this call, unlike the data/pos fds */
+    if (timeHidlHandle != nullptr) {
+        native_handle_close(timeHidlHandle);
+        native_handle_delete(timeHidlHandle);
+    }
+
     return Void();
 }
 
@@ -1688,6 +1779,490 @@ exit:
     return ret;
 }
 
+/*
+ *Track the aifs a transaction connects or sets metadata on, as the single
+ *calls do, so that they are cleaned up on client death. added gets the
+ *aifs which were not tracked yet, the only ones to drop if it fails.
+ */
+static void add_txn_aifs_to_list_l(uint32_t session_id, const uint8_t *txn,
+                                   uint32_t size, std::vector<uint32_t> &added)
+{
+    const struct agm_session_txn_record *rec;
+    agm_client_session_handle *session_handle = NULL;
+    uint32_t num_records = ((const struct agm_session_txn *)txn)->num_records;
+    size_t offset = sizeof(struct agm_session_txn);
+    uint32_t i;
+
+    session_handle = get_session_handle_l(session_id);
+    if (!session_handle)
+        return;
+
+    for (i = 0; i < num_records; i++) {
+        if (offset > size || size - offset < sizeof(struct agm_session_txn_record))
+            break;
+        rec = (const struct agm_session_txn_record *)(txn + offset);
+        offset += sizeof(struct agm_session_txn_record);
+        if (rec->size > size - offset)
+            break;
+        offset += AGM_SESSION_TXN_ALIGN(rec->size);
+
+        if (rec->type != AGM_SESSION_TXN_AIF_CONNECT &&
+            (rec->type != AGM_SESSION_TXN_AIF_METADATA ||
+             rec->size < sizeof(uint32_t) || !NUM_GKV(rec->payload)))
+            continue;
+
+        if (std::find(session_handle->aif_id_list.begin(),
+                      session_handle->aif_id_list.end(),
+                      rec->aif_id) != session_handle->aif_id_list.end())
+            continue;
+        add_session_aif_to_list_l(session_id, rec->aif_id);
+        added.push_back(rec->aif_id);
+    }
+}
+
+/* buffer size set by the last config record of a transaction, 0 if none */
+static uint32_t get_txn_buf_size(const uint8_t *txn, uint32_t size)
+{
+    const struct agm_session_txn_record *rec;
+    uint32_t num_records = ((const struct agm_session_txn *)txn)->num_records;
+    size_t offset = sizeof(struct agm_session_txn);
+    uint32_t i, buf_size = 0;
+
+    for (i = 0; i < num_records; i++) {
+        if (offset > size || size - offset < sizeof(struct agm_session_txn_record))
+            break;
+        rec = (const struct agm_session_txn_record *)(txn + offset);
+        offset += sizeof(struct agm_session_txn_record);
+        if (rec->size > size - offset)
+            break;
+        offset += AGM_SESSION_TXN_ALIGN(rec->size);
+
+        if (rec->type == AGM_SESSION_TXN_CONFIG &&
+            rec->size >= sizeof(struct agm_session_txn_config))
+            buf_size = ((const struct agm_session_txn_config *)
+                                                rec->payload)->buf_size;
+    }
+    return buf_size;
+}
+
+Return<void> AGM::ipc_agm_session_transact(const hidl_vec<uint8_t>& txn,
+                                           uint32_t size,
+                                           ipc_agm_session_transact_cb _hidl_cb) {
+    uint64_t handle = 0;
+    agm_client_session_handle *session_handle = NULL;
+    hidl_vec<uint64_t> handle_ret(1);
+    std::vector<uint32_t> added;
+    void *txn_local = NULL;
+    uint32_t session_id = 0;
+    int32_t ret = -EINVAL;
+
+    ALOGV("%s : size = %d\n", __func__, size);
+    if (txn.size() < size || size < sizeof(struct agm_session_txn))
+        goto exit;
+
+    session_id = ((struct agm_session_txn *)txn.data())->session_id;
+    pthread_mutex_lock(&client_list_lock);
+    session_handle = get_session_handle_l(session_id);
+    if (session_handle)
+        add_txn_aifs_to_list_l(session_id, txn.data(), size, added);
+    pthread_mutex_unlock(&client_list_lock);
+    if (!session_handle)
+        goto exit;
+
+    txn_local = calloc(1, size);
+    if (txn_local == NULL) {
+        ALOGE("%s: Cannot allocate memory for txn_local\n", __func__);
+        ret = -ENOMEM;
+        goto exit;
+    }
+    memcpy(txn_local, txn.data(), size);
+    ret = agm_session_transact(txn_local, size, &handle);
+    if (!ret && handle) {
+        pthread_mutex_lock(&session_handle->handle_lock);
+        add_session_handle_to_list_l(session_id, handle);
+        pthread_mutex_unlock(&session_handle->handle_lock);
+    }
+    if (!ret) {
+        uint32_t buf_size = get_txn_buf_size(txn.data(), size);
+
+        pthread_mutex_lock(&client_list_lock);
+        if (buf_size)
+            session_handle->buf_size = buf_size;
+        pthread_mutex_unlock(&client_list_lock);
+    }
+    free(txn_local);
+
+exit:
+    /* aifs tracked before the transaction stay tracked */
+    if (ret && !added.empty()) {
+        pthread_mutex_lock(&client_list_lock);
+        for (const auto & aif_id : added)
+            remove_session_aif_from_list_l(session_id, aif_id);
+        pthread_mutex_unlock(&client_list_lock);
+    }
+    *handle_ret.data() = handle;
+    _hidl_cb(ret, handle_ret);
+    return Void();
+}
+
+Return<void> AGM::ipc_agm_blob_register(uint32_t type,
+                                        const hidl_vec<uint8_t>& blob,
+                                        uint32_t size,
+                                        ipc_agm_blob_register_cb _hidl_cb) {
+    client_info *client_handle = NULL;
+    int pid = ::android::hardware::IPCThreadState::self()->getCallingPid();
+    uint32_t blob_id = 0;
+    int32_t ret = -EINVAL;
+
+    ALOGV("%s : type = %d, size = %d\n", __func__, type, size);
+    /* the registry keeps its own copy, register straight from the vector */
+    if (blob.size() >= size)
+        ret = agm_blob_register((enum agm_blob_type)type,
+                                (void *)blob.data(), size, &blob_id);
+    if (!ret) {
+        pthread_mutex_lock(&client_list_lock);
+        client_handle = get_client_handle_l(pid);
+        if (client_handle)
+            client_handle->blob_list.push_back(blob_id);
+        pthread_mutex_unlock(&client_list_lock);
+        /* an untracked registration would outlive the client */
+        if (!client_handle) {
+            ALOGE("%s: no client registered for pid %d\n", __func__, pid);
+            agm_blob_unregister(blob_id);
+            blob_id = 0;
+            ret = -EINVAL;
+        }
+    }
+    _hidl_cb(ret, blob_id);
+    return Void();
+}
+
+Return<int32_t> AGM::ipc_agm_blob_unregister(uint32_t blob_id) {
+    client_info *client_handle = NULL;
+    int pid = ::android::hardware::IPCThreadState::self()->getCallingPid();
+    std::vector<uint32_t>::iterator it;
+    bool owned = false;
+
+    ALOGV("%s : blob_id = %d\n", __func__, blob_id);
+    /* a client only drops its own registrations */
+    pthread_mutex_lock(&client_list_lock);
+    client_handle = get_client_handle_l(pid);
+    if (client_handle) {
+        it = std::find(client_handle->blob_list.begin(),
+                       client_handle->blob_list.end(), blob_id);
+        if (it != client_handle->blob_list.end()) {
+            client_handle->blob_list.erase(it);
+            owned = true;
+        }
+    }
+    pthread_mutex_unlock(&client_list_lock);
+
+    if (!owned) {
+        ALOGE("%s: blob %u not registered by pid %d\n", __func__, blob_id, pid);
+        return -EPERM;
+    }
+    return agm_blob_unregister(blob_id);
+}
+
+Return<int32_t> AGM::ipc_agm_session_set_params_fd(uint32_t session_id,
+                                                   uint32_t aif_id,
+                                                   const hidl_handle& fd,
+                                                   uint32_t size) {
+    const native_handle *handle = fd.getNativeHandle();
+
+    ALOGV("%s : session_id = %d, aif_id = %d, size = %d\n", __func__,
+           session_id, aif_id, size);
+    if (!handle || handle->numFds < 1)
+        return -EINVAL;
+
+    /* the fd belongs to the hidl handle, it is mapped only for this call */
+    return agm_session_set_params_fd(session_id, aif_id, handle->data[0],
+                                     (size_t)size);
+}
+
+Return<int32_t> AGM::ipc_agm_session_set_blob(uint32_t session_id,
+                                              uint32_t aif_id,
+                                              uint32_t blob_id) {
+    ALOGV("%s : session_id = %d, aif_id = %d, blob_id = %d\n", __func__,
+           session_id, aif_id, blob_id);
+    return agm_session_set_blob(session_id, aif_id, blob_id);
+}
+
+Return<void> AGM::ipc_agm_session_reader_open(uint64_t hndl,
+                                        ipc_agm_session_reader_open_cb _hidl_cb) {
+    client_info *client_handle = NULL;
+    uint64_t reader = 0;
+    int pid = ::android::hardware::IPCThreadState::self()->getCallingPid();
+    int32_t ret;
+
+    ALOGV("%s called with handle = %llx \n", __func__, (unsigned long long) hndl);
+    ret = agm_session_reader_open(hndl, &reader);
+    if (!ret) {
+        pthread_mutex_lock(&client_list_lock);
+        client_handle = get_client_handle_l(pid);
+        if (client_handle)
+            client_handle->reader_list.push_back(reader);
+        pthread_mutex_unlock(&client_list_lock);
+    }
+    _hidl_cb(ret, reader);
+    return Void();
+}
+
+Return<void> AGM::ipc_agm_session_reader_read(uint64_t reader, uint32_t count,
+                                        ipc_agm_session_reader_read_cb _hidl_cb) {
+    hidl_vec<uint8_t> buff_ret;
+    uint64_t dropped = 0;
+    size_t cnt = (size_t) count;
+    int32_t ret;
+
+    ALOGV("%s called with reader = %llx \n", __func__, (unsigned long long) reader);
+    /* read straight into the reply vector, it is trimmed to what was read */
+    buff_ret.resize(count);
+    ret = agm_session_reader_read(reader, buff_ret.data(), &cnt, &dropped);
+    if (ret)
+        cnt = 0;
+    buff_ret.resize(cnt);
+    _hidl_cb(ret, buff_ret, cnt, dropped);
+    return Void();
+}
+
+Return<int32_t> AGM::ipc_agm_session_reader_close(uint64_t reader) {
+    client_info *client_handle = NULL;
+    int pid = ::android::hardware::IPCThreadState::self()->getCallingPid();
+    std::vector<uint64_t>::iterator it;
+
+    ALOGV("%s called with reader = %llx \n", __func__, (unsigned long long) reader);
+    pthread_mutex_lock(&client_list_lock);
+    client_handle = get_client_handle_l(pid);
+    if (client_handle) {
+        it = std::find(client_handle->reader_list.begin(),
+                       client_handle->reader_list.end(), reader);
+        if (it != client_handle->reader_list.end())
+            client_handle->reader_list.erase(it);
+    }
+    pthread_mutex_unlock(&client_list_lock);
+
+    return agm_session_reader_close(reader);
+}
+
+Return<void> AGM::ipc_agm_session_writev(uint64_t hndl,
+                                         const hidl_vec<uint32_t>& sizes,
+                                         const hidl_vec<uint32_t>& flags,
+                                         const hidl_vec<uint64_t>& timestamps,
+                                         const hidl_vec<uint8_t>& buff,
+                                         ipc_agm_session_writev_cb _hidl_cb) {
+    struct agm_iovec iov[AGM_SESSION_MAX_IOV] = {};
+    hidl_vec<uint32_t> sizes_ret;
+    uint32_t iovcnt = sizes.size(), i, done = 0;
+    size_t offset = 0;
+    int32_t ret;
+
+    ALOGV("%s called with handle = %llx \n", __func__, (unsigned long long) hndl);
+    if (iovcnt == 0 || iovcnt > AGM_SESSION_MAX_IOV ||
+        flags.size() != iovcnt || timestamps.size() != iovcnt) {
+        _hidl_cb(-EINVAL, 0, sizes_ret);
+        return Void();
+    }
+
+    /* buffers are written straight from the request vector */
+    for (i = 0; i < iovcnt; i++) {
+        if (offset + sizes[i] > buff.size()) {
+            _hidl_cb(-EINVAL, 0, sizes_ret);
+            return Void();
+        }
+        iov[i].addr = (uint8_t *)buff.data() + offset;
+        iov[i].size = sizes[i];
+        iov[i].flags = flags[i];
+        iov[i].timestamp = timestamps[i];
+        offset += sizes[i];
+    }
+
+    ret = agm_session_writev(hndl, iov, iovcnt, &done);
+    sizes_ret.resize(iovcnt);
+    for (i = 0; i < iovcnt; i++)
+        sizes_ret[i] = iov[i].size;
+    _hidl_cb(ret, done, sizes_ret);
+    return Void();
+}
+
+Return<void> AGM::ipc_agm_session_readv(uint64_t hndl,
+                                        const hidl_vec<uint32_t>& sizes,
+                                        ipc_agm_session_readv_cb _hidl_cb) {
+    struct agm_iovec iov[AGM_SESSION_MAX_IOV] = {};
+    hidl_vec<uint32_t> sizes_ret, flags_ret;
+    hidl_vec<uint64_t> timestamps_ret;
+    hidl_vec<uint8_t> buff_ret;
+    agm_client_session_handle *session_handle = NULL;
+    uint32_t iovcnt = sizes.size(), i, done = 0, buf_size = 0;
+    size_t total = 0, offset = 0;
+    int32_t ret;
+
+    ALOGV("%s called with handle = %llx \n", __func__, (unsigned long long) hndl);
+    if (iovcnt == 0 || iovcnt > AGM_SESSION_MAX_IOV) {
+        _hidl_cb(-EINVAL, 0, sizes_ret, flags_ret, timestamps_ret, buff_ret);
+        return Void();
+    }
+
+    pthread_mutex_lock(&client_list_lock);
+    session_handle = get_session_handle_by_hndl_l(hndl);
+    if (session_handle)
+        buf_size = session_handle->buf_size;
+    pthread_mutex_unlock(&client_list_lock);
+
+    /* no read returns more than a session buffer, 0 if never configured */
+    for (i = 0; i < iovcnt; i++) {
+        if (sizes[i] > buf_size) {
+            ALOGE("%s: buffer %u of %u bytes, session buffer is %u\n",
+                  __func__, i, sizes[i], buf_size);
+            _hidl_cb(-EINVAL, 0, sizes_ret, flags_ret, timestamps_ret, buff_ret);
+            return Void();
+        }
+        total += sizes[i];
+    }
+    if (total > MAX_READV_BYTES) {
+        ALOGE("%s: %zu bytes requested, at most %d\n", __func__, total,
+              MAX_READV_BYTES);
+        _hidl_cb(-EINVAL, 0, sizes_ret, flags_ret, timestamps_ret, buff_ret);
+        return Void();
+    }
+    /* read straight into the reply vector, buffer i at its requested offset */
+    buff_ret.resize(total);
+    for (i = 0; i < iovcnt; i++) {
+        iov[i].addr = buff_ret.data() + offset;
+        iov[i].size = sizes[i];
+        offset += sizes[i];
+    }
+
+    ret = agm_session_readv(hndl, iov, iovcnt, &done);
+    sizes_ret.resize(iovcnt);
+    flags_ret.resize(iovcnt);
+    timestamps_ret.resize(iovcnt);
+    for (i = 0; i < iovcnt; i++) {
+        sizes_ret[i] = iov[i].size;
+        flags_ret[i] = iov[i].flags;
+        timestamps_ret[i] = iov[i].timestamp;
+    }
+    _hidl_cb(ret, done, sizes_ret, flags_ret, timestamps_ret, buff_ret);
+    return Void();
+}
+
+Return<void> AGM::ipc_agm_get_thread_sched_info(uint32_t num,
+                               ipc_agm_get_thread_sched_info_cb _hidl_cb) {
+    struct agm_thread_sched_info *info = NULL;
+    hidl_vec<AgmThreadSchedInfo> info_ret;
+    uint32_t i;
+    int32_t ret;
+
+    ALOGV("%s called with num = %u\n", __func__, num);
+    if (num > MAX_THREAD_SCHED_INFO)
+        num = MAX_THREAD_SCHED_INFO;
+    if (num) {
+        info = (struct agm_thread_sched_info *)calloc(num, sizeof(*info));
+        if (info == NULL) {
+            ALOGE("%s: Cannot allocate memory for info\n", __func__);
+            _hidl_cb(-ENOMEM, info_ret, 0);
+            return Void();
+        }
+    }
+
+    ret = agm_get_thread_sched_info(info, &num);
+    if (ret) {
+        _hidl_cb(ret, info_ret, 0);
+        goto done;
+    }
+
+    if (info) {
+        info_ret.resize(num);
+        for (i = 0; i < num; i++) {
+            info_ret[i].tid = info[i].tid;
+            info_ret[i].thread_class = info[i].thread_class;
+            info_ret[i].policy = info[i].policy;
+            info_ret[i].priority = info[i].priority;
+            info_ret[i].cpu_mask = info[i].cpu_mask;
+        }
+    }
+    _hidl_cb(0, info_ret, num);
+done:
+    free(info);
+    return Void();
+}
+
+Return<void> AGM::ipc_agm_get_ssr_stats(ipc_agm_get_ssr_stats_cb _hidl_cb) {
+    struct agm_ssr_stats stats;
+    AgmSsrStats stats_ret;
+    int32_t ret;
+
+    ALOGV("%s called\n", __func__);
+    memset(&stats, 0, sizeof(stats));
+    ret = agm_get_ssr_stats(&stats);
+    stats_ret.ssr_count = stats.ssr_count;
+    stats_ret.sessions_restored = stats.sessions_restored;
+    stats_ret.sessions_failed = stats.sessions_failed;
+    stats_ret.down_to_restored_us = stats.down_to_restored_us;
+    stats_ret.up_to_restored_us = stats.up_to_restored_us;
+    _hidl_cb(ret, stats_ret);
+    return Void();
+}
+
+Return<int32_t> AGM::ipc_agm_session_set_gain(uint32_t session_id,
+                                              uint32_t gain,
+                                              uint32_t ramp_duration_ms) {
+    ALOGV("%s : session_id = %d, gain = 0x%x, ramp = %d\n", __func__,
+           session_id, gain, ramp_duration_ms);
+    return agm_session_set_gain(session_id, gain, ramp_duration_ms);
+}
+
+Return<int32_t> AGM::ipc_agm_session_aif_set_gain(uint32_t session_id,
+                                                  uint32_t aif_id,
+                                                  uint32_t gain,
+                                                  uint32_t ramp_duration_ms) {
+    ALOGV("%s : session_id = %d, aif_id = %d, gain = 0x%x, ramp = %d\n",
+           __func__, session_id, aif_id, gain, ramp_duration_ms);
+    return agm_session_aif_set_gain(session_id, aif_id, gain,
+                                    ramp_duration_ms);
+}
+
+Return<int32_t> AGM::ipc_agm_session_stage_params(uint32_t session_id,
+                                               const hidl_vec<uint8_t>& payload,
+                                               uint32_t size) {
+    ALOGV("%s : session_id = %d, size = %d\n", __func__, session_id, size);
+    if (payload.size() < size)
+        return -EINVAL;
+
+    /* the service copies what it stages, hand it the vector as is */
+    return agm_session_stage_params(session_id, (void *)payload.data(),
+                                    (size_t)size);
+}
+
+Return<int32_t> AGM::ipc_agm_session_aif_stage_params(uint32_t session_id,
+                                               uint32_t aif_id,
+                                               const hidl_vec<uint8_t>& payload,
+                                               uint32_t size) {
+    ALOGV("%s : session_id = %d, aif_id = %d, size = %d\n", __func__,
+                                                 session_id, aif_id, size);
+    if (payload.size() < size)
+        return -EINVAL;
+
+    return agm_session_aif_stage_params(session_id, aif_id,
+                                        (void *)payload.data(), (size_t)size);
+}
+
+Return<int32_t> AGM::ipc_agm_session_commit_params(uint32_t session_id) {
+    ALOGV("%s : session_id = %d\n", __func__, session_id);
+    return agm_session_commit_params(session_id);
+}
+
+Return<void> AGM::ipc_agm_session_get_cal_stats(uint32_t session_id,
+                                  ipc_agm_session_get_cal_stats_cb _hidl_cb) {
+    uint32_t applied = 0, skipped = 0;
+    int32_t ret;
+
+    ALOGV("%s : session_id = %d\n", __func__, session_id);
+    ret = agm_session_get_cal_stats(session_id, &applied, &skipped);
+    _hidl_cb(ret, applied, skipped);
+    return Void();
+}
+
 Return<int32_t> AGM::ipc_agm_dump(const hidl_vec<AgmDumpInfo>& dump_info) {
     struct agm_dump_info *d_info =
             (struct agm_dump_info *)dump_info.data();
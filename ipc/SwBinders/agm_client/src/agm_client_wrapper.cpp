@@ -241,6 +241,17 @@ int agm_session_stop(uint64_t handle)
     return -EAGAIN;
 }
 
+int agm_session_cmd_async(uint64_t handle, enum agm_session_cmd cmd,
+                          uint32_t token)
+{
+    if (!agm_server_died) {
+        android::sp<IAgmService> agm_client = get_agm_server();
+        return agm_client->ipc_agm_session_cmd_async(handle, cmd, token);
+    }
+    AGM_LOGE("%s: agm service is not running\n", __func__);
+    return -EAGAIN;
+}
+
 int agm_session_pause(uint64_t handle)
 {
     if (!agm_server_died) {
@@ -427,6 +438,21 @@ int agm_session_register_cb(uint32_t session_id, agm_event_cb cb,
     return -EAGAIN;
 }
 
+/*
+ *Filters are applied by the service to in-process callbacks, callbacks of
+ *remote clients are registered unfiltered by the IPC server.
+ */
+int agm_session_register_cb_filtered(uint32_t session_id, agm_event_cb cb,
+                                     enum event_type evt_type, void *client_data,
+                                     const struct agm_event_filter *filter)
+{
+    if (cb && filter && (filter->num_event_ids || filter->num_module_ids)) {
+        ALOGE("%s: event filters are not supported over IPC\n", __func__);
+        return -EOPNOTSUPP;
+    }
+    return agm_session_register_cb(session_id, cb, evt_type, client_data);
+}
+
 int agm_session_set_ec_ref(uint32_t capture_session_id, uint32_t aif_id,
                                                              bool state)
 {
@@ -516,3 +542,224 @@ int agm_session_get_buf_info(uint32_t session_id, struct agm_buf_info *buf_info,
     ALOGE("%s: agm service is not running\n", __func__);
     return -EAGAIN;
 }
+
+int agm_session_transact(void *txn, size_t txn_size, uint64_t *handle)
+{
+    if (!agm_server_died) {
+        android::sp<IAgmService> agm_client = get_agm_server();
+        return agm_client->ipc_agm_session_transact(txn, txn_size, handle);
+    }
+    ALOGE("%s: agm service is not running\n", __func__);
+    return -EAGAIN;
+}
+
+int agm_blob_register(enum agm_blob_type type, void *blob, size_t size,
+                      uint32_t *blob_id)
+{
+    if (!agm_server_died) {
+        android::sp<IAgmService> agm_client = get_agm_server();
+        return agm_client->ipc_agm_blob_register(type, blob, size, blob_id);
+    }
+    ALOGE("%s: agm service is not running\n", __func__);
+    return -EAGAIN;
+}
+
+int agm_blob_unregister(uint32_t blob_id)
+{
+    if (!agm_server_died) {
+        android::sp<IAgmService> agm_client = get_agm_server();
+        return agm_client->ipc_agm_blob_unregister(blob_id);
+    }
+    ALOGE("%s: agm service is not running\n", __func__);
+    return -EAGAIN;
+}
+
+int agm_session_set_params_owned(uint32_t session_id, uint32_t aif_id,
+                                 void *payload, size_t size)
+{
+    int ret;
+
+    /* the payload is marshalled anyway, ownership only saves the free */
+    if (aif_id == AGM_AIF_NONE)
+        ret = agm_session_set_params(session_id, payload, size);
+    else
+        ret = agm_session_aif_set_params(session_id, aif_id, payload, size);
+    free(payload);
+    return ret;
+}
+
+int agm_session_set_params_fd(uint32_t session_id, uint32_t aif_id,
+                              int fd, size_t size)
+{
+    if (!agm_server_died) {
+        android::sp<IAgmService> agm_client = get_agm_server();
+        return agm_client->ipc_agm_session_set_params_fd(session_id, aif_id,
+                                                         fd, size);
+    }
+    ALOGE("%s: agm service is not running\n", __func__);
+    return -EAGAIN;
+}
+
+int agm_session_writev(uint64_t handle, struct agm_iovec *iov,
+                       uint32_t iovcnt, uint32_t *done)
+{
+    if (!agm_server_died) {
+        android::sp<IAgmService> agm_client = get_agm_server();
+        return agm_client->ipc_agm_session_writev(handle, iov, iovcnt, done);
+    }
+    ALOGE("%s: agm service is not running\n", __func__);
+    return -EAGAIN;
+}
+
+int agm_session_readv(uint64_t handle, struct agm_iovec *iov,
+                      uint32_t iovcnt, uint32_t *done)
+{
+    if (!agm_server_died) {
+        android::sp<IAgmService> agm_client = get_agm_server();
+        return agm_client->ipc_agm_session_readv(handle, iov, iovcnt, done);
+    }
+    ALOGE("%s: agm service is not running\n", __func__);
+    return -EAGAIN;
+}
+
+int agm_session_reader_open(uint64_t handle, uint64_t *reader)
+{
+    if (!agm_server_died) {
+        android::sp<IAgmService> agm_client = get_agm_server();
+        return agm_client->ipc_agm_session_reader_open(handle, reader);
+    }
+    ALOGE("%s: agm service is not running\n", __func__);
+    return -EAGAIN;
+}
+
+int agm_session_reader_read(uint64_t reader, void *buff, size_t *count,
+                            uint64_t *dropped)
+{
+    if (!agm_server_died) {
+        android::sp<IAgmService> agm_client = get_agm_server();
+        return agm_client->ipc_agm_session_reader_read(reader, buff, count,
+                                                       dropped);
+    }
+    ALOGE("%s: agm service is not running\n", __func__);
+    return -EAGAIN;
+}
+
+int agm_session_reader_close(uint64_t reader)
+{
+    if (!agm_server_died) {
+        android::sp<IAgmService> agm_client = get_agm_server();
+        return agm_client->ipc_agm_session_reader_close(reader);
+    }
+    ALOGE("%s: agm service is not running\n", __func__);
+    return -EAGAIN;
+}
+
+int agm_get_thread_sched_info(struct agm_thread_sched_info *info,
+                              uint32_t *num)
+{
+    if (!num)
+        return -EINVAL;
+
+    if (!agm_server_died) {
+        android::sp<IAgmService> agm_client = get_agm_server();
+        return agm_client->ipc_agm_get_thread_sched_info(info, num);
+    }
+    ALOGE("%s: agm service is not running\n", __func__);
+    return -EAGAIN;
+}
+
+int agm_get_ssr_stats(struct agm_ssr_stats *stats)
+{
+    if (!stats)
+        return -EINVAL;
+
+    if (!agm_server_died) {
+        android::sp<IAgmService> agm_client = get_agm_server();
+        return agm_client->ipc_agm_get_ssr_stats(stats);
+    }
+    ALOGE("%s: agm service is not running\n", __func__);
+    return -EAGAIN;
+}
+
+int agm_session_set_gain(uint32_t session_id, uint32_t gain,
+                         uint32_t ramp_duration_ms)
+{
+    if (!agm_server_died) {
+        android::sp<IAgmService> agm_client = get_agm_server();
+        return agm_client->ipc_agm_session_set_gain(session_id, gain,
+                                                    ramp_duration_ms);
+    }
+    ALOGE("%s: agm service is not running\n", __func__);
+    return -EAGAIN;
+}
+
+int agm_session_aif_set_gain(uint32_t session_id, uint32_t aif_id,
+                             uint32_t gain, uint32_t ramp_duration_ms)
+{
+    if (!agm_server_died) {
+        android::sp<IAgmService> agm_client = get_agm_server();
+        return agm_client->ipc_agm_session_aif_set_gain(session_id, aif_id,
+                                                        gain, ramp_duration_ms);
+    }
+    ALOGE("%s: agm service is not running\n", __func__);
+    return -EAGAIN;
+}
+
+int agm_session_stage_params(uint32_t session_id, void *payload, size_t size)
+{
+    if (!agm_server_died) {
+        android::sp<IAgmService> agm_client = get_agm_server();
+        return agm_client->ipc_agm_session_stage_params(session_id, payload,
+                                                        size);
+    }
+    ALOGE("%s: agm service is not running\n", __func__);
+    return -EAGAIN;
+}
+
+int agm_session_aif_stage_params(uint32_t session_id, uint32_t aif_id,
+                                 void *payload, size_t size)
+{
+    if (!agm_server_died) {
+        android::sp<IAgmService> agm_client = get_agm_server();
+        return agm_client->ipc_agm_session_aif_stage_params(session_id, aif_id,
+                                                            payload, size);
+    }
+    ALOGE("%s: agm service is not running\n", __func__);
+    return -EAGAIN;
+}
+
+int agm_session_commit_params(uint32_t session_id)
+{
+    if (!agm_server_died) {
+        android::sp<IAgmService> agm_client = get_agm_server();
+        return agm_client->ipc_agm_session_commit_params(session_id);
+    }
+    ALOGE("%s: agm service is not running\n", __func__);
+    return -EAGAIN;
+}
+
+int agm_session_get_cal_stats(uint32_t session_id, uint32_t *applied,
+                              uint32_t *skipped)
+{
+    if (!applied || !skipped)
+        return -EINVAL;
+
+    if (!agm_server_died) {
+        android::sp<IAgmService> agm_client = get_agm_server();
+        return agm_client->ipc_agm_session_get_cal_stats(session_id, applied,
+                                                         skipped);
+    }
+    ALOGE("%s: agm service is not running\n", __func__);
+    return -EAGAIN;
+}
+
+int agm_session_set_blob(uint32_t session_id, uint32_t aif_id, uint32_t blob_id)
+{
+    if (!agm_server_died) {
+        android::sp<IAgmService> agm_client = get_agm_server();
+        return agm_client->ipc_agm_session_set_blob(session_id, aif_id,
+                                                    blob_id);
+    }
+    ALOGE("%s: agm service is not running\n", __func__);
+    return -EAGAIN;
+}
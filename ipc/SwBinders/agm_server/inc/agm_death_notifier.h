@@ -86,12 +86,19 @@ typedef struct {
      //bool rx;
  } agm_client_session_handle;
 
+typedef struct {
+    struct listnode list;
+    uint32_t blob_id;
+} agm_client_blob;
+
 typedef struct {
     struct listnode list;
     sp<IAGMClient> binder;
     pid_t pid;
     sp<client_death_notifier> Client_death_notifier;
     struct listnode agm_client_hndl_list;
+    /* blob registrations, one entry each, dropped if the client dies */
+    struct listnode agm_client_blob_list;
 } client_info;
 
 client_info *get_client_handle_from_list(pid_t pid);
@@ -99,3 +106,5 @@ void agm_register_client(sp<IBinder> binder);
 void agm_unregister_client(sp<IBinder> binder);
 void agm_add_session_obj_handle(uint64_t handle);
 void agm_remove_session_obj_handle(uint64_t handle);
+int agm_add_blob(uint32_t blob_id);
+bool agm_remove_blob(uint32_t blob_id);
@@ -91,6 +91,9 @@ class AgmService : public BnAgmService
         virtual int ipc_agm_session_prepare(uint64_t handle);
         virtual int ipc_agm_session_start(uint64_t handle);
         virtual int ipc_agm_session_stop(uint64_t handle);
+        virtual int ipc_agm_session_cmd_async(uint64_t handle,
+                                              enum agm_session_cmd cmd,
+                                              uint32_t token);
         virtual int ipc_agm_session_pause(uint64_t handle);
         virtual int ipc_agm_session_resume(uint64_t handle);
         virtual int ipc_agm_session_open(uint32_t session_id,
@@ -148,6 +151,49 @@ class AgmService : public BnAgmService
                          enum agm_gapless_silence_type type, uint32_t silence);
         virtual int ipc_agm_session_get_buf_info(uint32_t session_id,
                            struct agm_buf_info *buf_info, uint32_t flag);
+        virtual int ipc_agm_session_transact(void *txn, size_t txn_size,
+                                             uint64_t *handle);
+        virtual int ipc_agm_blob_register(enum agm_blob_type type, void *payload,
+                                          size_t size, uint32_t *blob_id);
+        virtual int ipc_agm_blob_unregister(uint32_t blob_id);
+        virtual int ipc_agm_session_set_blob(uint32_t session_id,
+                                             uint32_t aif_id,
+                                             uint32_t blob_id);
+        virtual int ipc_agm_session_set_params_fd(uint32_t session_id,
+                                                  uint32_t aif_id, int fd,
+                                                  size_t size);
+        virtual int ipc_agm_session_reader_open(uint64_t handle,
+                                                uint64_t *reader);
+        virtual int ipc_agm_session_reader_read(uint64_t reader, void *buff,
+                                                size_t *count,
+                                                uint64_t *dropped);
+        virtual int ipc_agm_session_reader_close(uint64_t reader);
+        virtual int ipc_agm_session_writev(uint64_t handle,
+                                           struct agm_iovec *iov,
+                                           uint32_t iovcnt, uint32_t *done);
+        virtual int ipc_agm_session_readv(uint64_t handle,
+                                          struct agm_iovec *iov,
+                                          uint32_t iovcnt, uint32_t *done);
+        virtual int ipc_agm_get_thread_sched_info(
+                                      struct agm_thread_sched_info *info,
+                                      uint32_t *num);
+        virtual int ipc_agm_get_ssr_stats(struct agm_ssr_stats *stats);
+        virtual int ipc_agm_session_set_gain(uint32_t session_id,
+                                             uint32_t gain,
+                                             uint32_t ramp_duration_ms);
+        virtual int ipc_agm_session_aif_set_gain(uint32_t session_id,
+                                                 uint32_t aif_id, uint32_t gain,
+                                                 uint32_t ramp_duration_ms);
+        virtual int ipc_agm_session_stage_params(uint32_t session_id,
+                                                 void *payload, size_t size);
+        virtual int ipc_agm_session_aif_stage_params(uint32_t session_id,
+                                                     uint32_t aif_id,
+                                                     void *payload,
+                                                     size_t size);
+        virtual int ipc_agm_session_commit_params(uint32_t session_id);
+        virtual int ipc_agm_session_get_cal_stats(uint32_t session_id,
+                                                  uint32_t *applied,
+                                                  uint32_t *skipped);
         ~AgmService()
         {
             AGM_LOGV("AGMService destructor");
@@ -92,6 +92,9 @@ class IAgmService: public ::android::IInterface
         virtual int ipc_agm_session_prepare(uint64_t handle)= 0;
         virtual int ipc_agm_session_start(uint64_t handle)= 0;
         virtual int ipc_agm_session_stop(uint64_t handle)= 0;
+        virtual int ipc_agm_session_cmd_async(uint64_t handle,
+                                              enum agm_session_cmd cmd,
+                                              uint32_t token) = 0;
         virtual int ipc_agm_session_pause(uint64_t handle)= 0;
         virtual int ipc_agm_session_resume(uint64_t handle)= 0;
         virtual int ipc_agm_session_read(uint64_t handle,
@@ -153,6 +156,50 @@ class IAgmService: public ::android::IInterface
                                     uint32_t silence) = 0;
         virtual int ipc_agm_session_get_buf_info(uint32_t session_id,
                            struct agm_buf_info *buf_info, uint32_t flag) = 0;
+        virtual int ipc_agm_session_transact(void *txn, size_t txn_size,
+                                             uint64_t *handle) = 0;
+        virtual int ipc_agm_blob_register(enum agm_blob_type type, void *payload,
+                                          size_t size, uint32_t *blob_id) = 0;
+        virtual int ipc_agm_blob_unregister(uint32_t blob_id) = 0;
+        virtual int ipc_agm_session_set_blob(uint32_t session_id,
+                                             uint32_t aif_id,
+                                             uint32_t blob_id) = 0;
+        virtual int ipc_agm_session_set_params_fd(uint32_t session_id,
+                                                  uint32_t aif_id, int fd,
+                                                  size_t size) = 0;
+        virtual int ipc_agm_session_reader_open(uint64_t handle,
+                                                uint64_t *reader) = 0;
+        virtual int ipc_agm_session_reader_read(uint64_t reader, void *buff,
+                                                size_t *count,
+                                                uint64_t *dropped) = 0;
+        virtual int ipc_agm_session_reader_close(uint64_t reader) = 0;
+        virtual int ipc_agm_session_writev(uint64_t handle,
+                                           struct agm_iovec *iov,
+                                           uint32_t iovcnt, uint32_t *done) = 0;
+        virtual int ipc_agm_session_readv(uint64_t handle,
+                                          struct agm_iovec *iov,
+                                          uint32_t iovcnt, uint32_t *done) = 0;
+        virtual int ipc_agm_get_thread_sched_info(
+                                      struct agm_thread_sched_info *info,
+                                      uint32_t *num) = 0;
+        virtual int ipc_agm_get_ssr_stats(struct agm_ssr_stats *stats) = 0;
+        virtual int ipc_agm_session_set_gain(uint32_t session_id,
+                                             uint32_t gain,
+                                             uint32_t ramp_duration_ms) = 0;
+        virtual int ipc_agm_session_aif_set_gain(uint32_t session_id,
+                                                 uint32_t aif_id, uint32_t gain,
+                                                 uint32_t ramp_duration_ms) = 0;
+        virtual int ipc_agm_session_stage_params(uint32_t session_id,
+                                                 void *payload,
+                                                 size_t size) = 0;
+        virtual int ipc_agm_session_aif_stage_params(uint32_t session_id,
+                                                     uint32_t aif_id,
+                                                     void *payload,
+                                                     size_t size) = 0;
+        virtual int ipc_agm_session_commit_params(uint32_t session_id) = 0;
+        virtual int ipc_agm_session_get_cal_stats(uint32_t session_id,
+                                                  uint32_t *applied,
+                                                  uint32_t *skipped) = 0;
 };
 
 class BnAgmService : public ::android::BnInterface<IAgmService> {
@@ -113,6 +113,7 @@ void agm_register_client(sp<IBinder> binder)
     client_handle->Client_death_notifier = Client_death_notifier;
     list_add_tail(&g_client_list, &client_handle->list);
     list_init(&client_handle->agm_client_hndl_list);
+    list_init(&client_handle->agm_client_blob_list);
     pthread_mutex_unlock(&g_client_list_lock);
     
 }
@@ -171,6 +172,59 @@ void agm_remove_session_obj_handle(uint64_t handle)
     pthread_mutex_unlock(&g_client_list_lock);
 }
 
+int agm_add_blob(uint32_t blob_id)
+{
+    client_info *client_handle = NULL;
+    agm_client_blob *blob = NULL;
+
+    client_handle =
+          get_client_handle_from_list(IPCThreadState::self()->getCallingPid());
+    if (client_handle == NULL) {
+        AGM_LOGE("%s: Could not find client handle\n", __func__);
+        return -EINVAL;
+    }
+
+    blob = (agm_client_blob *)calloc(1, sizeof(agm_client_blob));
+    if (blob == NULL) {
+        AGM_LOGE("%s: Cannot allocate memory to store blob id\n", __func__);
+        return -ENOMEM;
+    }
+    blob->blob_id = blob_id;
+    pthread_mutex_lock(&g_client_list_lock);
+    list_add_tail(&client_handle->agm_client_blob_list, &blob->list);
+    pthread_mutex_unlock(&g_client_list_lock);
+    return 0;
+}
+
+/* false if the calling client holds no registration of blob_id */
+bool agm_remove_blob(uint32_t blob_id)
+{
+    client_info *client_handle = NULL;
+    struct listnode *node = NULL;
+    agm_client_blob *blob = NULL;
+    bool found = false;
+
+    client_handle =
+          get_client_handle_from_list(IPCThreadState::self()->getCallingPid());
+    if (client_handle == NULL) {
+        AGM_LOGE("%s: Could not find client handle\n", __func__);
+        return false;
+    }
+
+    pthread_mutex_lock(&g_client_list_lock);
+    list_for_each(node, &client_handle->agm_client_blob_list) {
+        blob = node_to_item(node, agm_client_blob, list);
+        if (blob->blob_id == blob_id) {
+            list_remove(node);
+            free(blob);
+            found = true;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&g_client_list_lock);
+    return found;
+}
+
 void agm_unregister_client(sp<IBinder> binder)
 {
     android::sp<IAGMClient> client_binder =
@@ -203,6 +257,7 @@ void client_death_notifier::binderDied(const wp<IBinder>& who)
     struct listnode *node = NULL;
     struct listnode *tempnode = NULL;
     agm_client_session_handle *hndl = NULL;
+    agm_client_blob *blob = NULL;
     struct listnode *sess_node = NULL;
     struct listnode *sess_tempnode = NULL;
 
@@ -219,6 +274,13 @@ void client_death_notifier::binderDied(const wp<IBinder>& who)
                        free(hndl);
                    }
                 }
+                list_for_each_safe(sess_node, sess_tempnode,
+                                   &handle->agm_client_blob_list) {
+                    blob = node_to_item(sess_node, agm_client_blob, list);
+                    agm_blob_unregister(blob->blob_id);
+                    list_remove(sess_node);
+                    free(blob);
+                }
                 list_remove(node);
                 free(handle);
         }
@@ -126,6 +126,13 @@ int AgmService::ipc_agm_session_stop(uint64_t handle){
     return agm_session_stop(handle);
 };
 
+int AgmService::ipc_agm_session_cmd_async(uint64_t handle,
+                                          enum agm_session_cmd cmd,
+                                          uint32_t token){
+    ALOGV("%s called\n", __func__);
+    return agm_session_cmd_async(handle, cmd, token);
+};
+
 int AgmService::ipc_agm_session_pause(uint64_t handle){
     ALOGV("%s called\n", __func__);
     return agm_session_pause(handle);
@@ -285,3 +292,111 @@ int AgmService::ipc_agm_session_get_buf_info(uint32_t session_id,
     ALOGV("%s called\n", __func__);
     return agm_session_get_buf_info(session_id, buf_info, flag);
 };
+
+int AgmService::ipc_agm_session_transact(void *txn, size_t txn_size,
+                                         uint64_t *handle) {
+    ALOGV("%s called\n", __func__);
+    return agm_session_transact(txn, txn_size, handle);
+};
+
+int AgmService::ipc_agm_blob_register(enum agm_blob_type type, void *payload,
+                                      size_t size, uint32_t *blob_id) {
+    ALOGV("%s called\n", __func__);
+    return agm_blob_register(type, payload, size, blob_id);
+};
+
+int AgmService::ipc_agm_blob_unregister(uint32_t blob_id) {
+    ALOGV("%s called\n", __func__);
+    return agm_blob_unregister(blob_id);
+};
+
+int AgmService::ipc_agm_session_set_blob(uint32_t session_id, uint32_t aif_id,
+                                         uint32_t blob_id) {
+    ALOGV("%s called\n", __func__);
+    return agm_session_set_blob(session_id, aif_id, blob_id);
+};
+
+int AgmService::ipc_agm_session_set_params_fd(uint32_t session_id,
+                                              uint32_t aif_id, int fd,
+                                              size_t size) {
+    ALOGV("%s called\n", __func__);
+    return agm_session_set_params_fd(session_id, aif_id, fd, size);
+};
+
+int AgmService::ipc_agm_session_reader_open(uint64_t handle, uint64_t *reader) {
+    ALOGV("%s called\n", __func__);
+    return agm_session_reader_open(handle, reader);
+};
+
+int AgmService::ipc_agm_session_reader_read(uint64_t reader, void *buff,
+                                            size_t *count, uint64_t *dropped) {
+    ALOGV("%s called\n", __func__);
+    return agm_session_reader_read(reader, buff, count, dropped);
+};
+
+int AgmService::ipc_agm_session_reader_close(uint64_t reader) {
+    ALOGV("%s called\n", __func__);
+    return agm_session_reader_close(reader);
+};
+
+int AgmService::ipc_agm_session_writev(uint64_t handle, struct agm_iovec *iov,
+                                       uint32_t iovcnt, uint32_t *done) {
+    ALOGV("%s called\n", __func__);
+    return agm_session_writev(handle, iov, iovcnt, done);
+};
+
+int AgmService::ipc_agm_session_readv(uint64_t handle, struct agm_iovec *iov,
+                                      uint32_t iovcnt, uint32_t *done) {
+    ALOGV("%s called\n", __func__);
+    return agm_session_readv(handle, iov, iovcnt, done);
+};
+
+int AgmService::ipc_agm_get_thread_sched_info(struct agm_thread_sched_info *info,
+                                              uint32_t *num) {
+    ALOGV("%s called\n", __func__);
+    return agm_get_thread_sched_info(info, num);
+};
+
+int AgmService::ipc_agm_get_ssr_stats(struct agm_ssr_stats *stats) {
+    ALOGV("%s called\n", __func__);
+    return agm_get_ssr_stats(stats);
+};
+
+int AgmService::ipc_agm_session_set_gain(uint32_t session_id, uint32_t gain,
+                                         uint32_t ramp_duration_ms) {
+    ALOGV("%s called\n", __func__);
+    return agm_session_set_gain(session_id, gain, ramp_duration_ms);
+};
+
+int AgmService::ipc_agm_session_aif_set_gain(uint32_t session_id,
+                                             uint32_t aif_id, uint32_t gain,
+                                             uint32_t ramp_duration_ms) {
+    ALOGV("%s called\n", __func__);
+    return agm_session_aif_set_gain(session_id, aif_id, gain,
+                                    ramp_duration_ms);
+};
+
+int AgmService::ipc_agm_session_stage_params(uint32_t session_id,
+                                             void *payload, size_t size) {
+    ALOGV("%s called\n", __func__);
+    return agm_session_stage_params(session_id, payload, size);
+};
+
+int AgmService::ipc_agm_session_aif_stage_params(uint32_t session_id,
+                                                 uint32_t aif_id,
+                                                 void *payload, size_t size) {
+    ALOGV("%s called\n", __func__);
+    return agm_session_aif_stage_params(session_id, aif_id, payload, size);
+};
+
+int AgmService::ipc_agm_session_commit_params(uint32_t session_id) {
+    ALOGV("%s called\n", __func__);
+    return agm_session_commit_params(session_id);
+};
+
+int AgmService::ipc_agm_session_get_cal_stats(uint32_t session_id,
+                                              uint32_t *applied,
+                                              uint32_t *skipped) {
+    ALOGV("%s called\n", __func__);
+    return agm_session_get_cal_stats(session_id, applied, skipped);
+};
@@ -94,6 +94,9 @@
 
 #define MAX_KVPAIR 48
 
+/* the service lists far fewer threads, bounds what a client can ask for */
+#define MAX_THREAD_SCHED_INFO 64
+
 #ifndef memscpy
 #define memscpy(dst, dst_size, src, bytes_to_copy) (void) \
                     memcpy(dst, src, MIN(dst_size, bytes_to_copy))
@@ -150,6 +153,25 @@ enum {
     AIF_SET_PARAMS,
     SET_GAPLESS_SESSION_METADATA,
     GET_BUF_INFO,
+    SESSION_TRANSACT,
+    BLOB_REGISTER,
+    BLOB_UNREGISTER,
+    SESSION_SET_BLOB,
+    SESSION_SET_PARAMS_FD,
+    SESSION_READER_OPEN,
+    SESSION_READER_READ,
+    SESSION_READER_CLOSE,
+    SESSION_WRITEV,
+    SESSION_READV,
+    SESSION_CMD_ASYNC,
+    GET_THREAD_SCHED_INFO,
+    GET_SSR_STATS,
+    SESSION_SET_GAIN,
+    SESSION_AIF_SET_GAIN,
+    SESSION_STAGE_PARAMS,
+    SESSION_AIF_STAGE_PARAMS,
+    SESSION_COMMIT_PARAMS,
+    SESSION_GET_CAL_STATS,
 };
 
 class BpAgmService : public ::android::BpInterface<IAgmService>
@@ -377,6 +399,21 @@ class BpAgmService : public ::android::BpInterface<IAgmService>
             return reply.readInt32();
         }
 
+        virtual int ipc_agm_session_cmd_async(uint64_t handle,
+                                              enum agm_session_cmd cmd,
+                                              uint32_t token)
+        {
+            android::Parcel data, reply;
+
+            AGM_LOGV("%s:%d\n", __func__, __LINE__);
+            data.writeInterfaceToken(IAgmService::getInterfaceDescriptor());
+            data.writeInt64((long)handle);
+            data.writeUint32(cmd);
+            data.writeUint32(token);
+            remote()->transact(SESSION_CMD_ASYNC, data, &reply);
+            return reply.readInt32();
+        }
+
         virtual int ipc_agm_session_pause(uint64_t handle)
         {
             android::Parcel data, reply;
@@ -761,8 +798,366 @@ class BpAgmService : public ::android::BpInterface<IAgmService>
             buf_info->pos_buf_fd = dup(reply.readFileDescriptor());
             buf_info->pos_buf_size = reply.readInt32();
         }
+        if (flag & TIME_BUF) {
+            /* the fd only follows if the server had a time page */
+            buf_info->time_buf_fd = -1;
+            if (reply.readInt32()) {
+                buf_info->time_buf_fd = dup(reply.readFileDescriptor());
+                buf_info->time_buf_size = reply.readInt32();
+            }
+        }
+        return reply.readInt32();
+    }
+
+    virtual int ipc_agm_session_transact(void *txn, size_t txn_size,
+                                         uint64_t *handle)
+    {
+        android::Parcel data, reply;
+        android::Parcel::WritableBlob blob;
+
+        data.writeInterfaceToken(IAgmService::getInterfaceDescriptor());
+        data.writeUint32(txn_size);
+        data.writeBlob(txn_size, false, &blob);
+        memcpy(blob.data(), txn, txn_size);
+        remote()->transact(SESSION_TRANSACT, data, &reply);
+        blob.release();
+        *handle = (uint64_t)reply.readInt64();
+        return reply.readInt32();
+    }
+
+    virtual int ipc_agm_blob_register(enum agm_blob_type type, void *payload,
+                                      size_t size, uint32_t *blob_id)
+    {
+        android::Parcel data, reply;
+        android::Parcel::WritableBlob blob;
+
+        data.writeInterfaceToken(IAgmService::getInterfaceDescriptor());
+        data.writeUint32(type);
+        data.writeUint32(size);
+        data.writeBlob(size, false, &blob);
+        memcpy(blob.data(), payload, size);
+        remote()->transact(BLOB_REGISTER, data, &reply);
+        blob.release();
+        *blob_id = reply.readUint32();
+        return reply.readInt32();
+    }
+
+    virtual int ipc_agm_blob_unregister(uint32_t blob_id)
+    {
+        android::Parcel data, reply;
+
+        data.writeInterfaceToken(IAgmService::getInterfaceDescriptor());
+        data.writeUint32(blob_id);
+        remote()->transact(BLOB_UNREGISTER, data, &reply);
+        return reply.readInt32();
+    }
+
+    virtual int ipc_agm_session_set_blob(uint32_t session_id, uint32_t aif_id,
+                                         uint32_t blob_id)
+    {
+        android::Parcel data, reply;
+
+        data.writeInterfaceToken(IAgmService::getInterfaceDescriptor());
+        data.writeUint32(session_id);
+        data.writeUint32(aif_id);
+        data.writeUint32(blob_id);
+        remote()->transact(SESSION_SET_BLOB, data, &reply);
+        return reply.readInt32();
+    }
+
+    virtual int ipc_agm_session_set_params_fd(uint32_t session_id,
+                                              uint32_t aif_id, int fd,
+                                              size_t size)
+    {
+        android::Parcel data, reply;
+
+        data.writeInterfaceToken(IAgmService::getInterfaceDescriptor());
+        data.writeUint32(session_id);
+        data.writeUint32(aif_id);
+        data.writeUint32(size);
+        data.writeFileDescriptor(fd);
+        remote()->transact(SESSION_SET_PARAMS_FD, data, &reply);
+        return reply.readInt32();
+    }
+
+    virtual int ipc_agm_session_reader_open(uint64_t handle, uint64_t *reader)
+    {
+        android::Parcel data, reply;
+
+        data.writeInterfaceToken(IAgmService::getInterfaceDescriptor());
+        data.writeInt64((long)handle);
+        remote()->transact(SESSION_READER_OPEN, data, &reply);
+        *reader = (uint64_t)reply.readInt64();
+        return reply.readInt32();
+    }
+
+    virtual int ipc_agm_session_reader_read(uint64_t reader, void *buff,
+                                            size_t *count, uint64_t *dropped)
+    {
+        int rc = 0;
+        android::Parcel data, reply;
+        android::Parcel::ReadableBlob blob;
+        size_t requested = *count;
+
+        data.writeInterfaceToken(IAgmService::getInterfaceDescriptor());
+        data.writeInt64((long)reader);
+        data.writeUint32(*count);
+        remote()->transact(SESSION_READER_READ, data, &reply);
+        rc = reply.readInt32();
+        if (rc != 0) {
+            AGM_LOGE("reader read failed error out %d\n", rc);
+            return rc;
+        }
+        *dropped = (uint64_t)reply.readInt64();
+        *count = reply.readUint32();
+        if (*count > requested) {
+            AGM_LOGE("reader read returned %zu bytes of %zu\n", *count,
+                     requested);
+            *count = 0;
+            return -EINVAL;
+        }
+        if (*count) {
+            if (reply.readBlob(*count, &blob) != android::OK) {
+                *count = 0;
+                return -EINVAL;
+            }
+            memcpy(buff, blob.data(), *count);
+            blob.release();
+        }
+        return rc;
+    }
+
+    virtual int ipc_agm_session_reader_close(uint64_t reader)
+    {
+        android::Parcel data, reply;
+
+        data.writeInterfaceToken(IAgmService::getInterfaceDescriptor());
+        data.writeInt64((long)reader);
+        remote()->transact(SESSION_READER_CLOSE, data, &reply);
+        return reply.readInt32();
+    }
+
+    /* all buffers travel in one transaction, their data packed in one blob */
+    virtual int ipc_agm_session_writev(uint64_t handle, struct agm_iovec *iov,
+                                       uint32_t iovcnt, uint32_t *done)
+    {
+        android::Parcel data, reply;
+        android::Parcel::WritableBlob blob;
+        size_t total = 0, offset = 0;
+        uint32_t i;
+        int rc;
+
+        data.writeInterfaceToken(IAgmService::getInterfaceDescriptor());
+        data.writeInt64((long)handle);
+        data.writeUint32(iovcnt);
+        for (i = 0; i < iovcnt; i++) {
+            data.writeUint32(iov[i].size);
+            data.writeUint32(iov[i].flags);
+            data.writeUint64(iov[i].timestamp);
+            total += iov[i].size;
+        }
+        data.writeUint32(total);
+        data.writeBlob(total, false, &blob);
+        for (i = 0; i < iovcnt; i++) {
+            memcpy((uint8_t *)blob.data() + offset, iov[i].addr, iov[i].size);
+            offset += iov[i].size;
+        }
+        remote()->transact(SESSION_WRITEV, data, &reply);
+        blob.release();
+        rc = reply.readInt32();
+        *done = reply.readUint32();
+        for (i = 0; i < iovcnt; i++)
+            iov[i].size = reply.readUint32();
+        return rc;
+    }
+
+    virtual int ipc_agm_session_readv(uint64_t handle, struct agm_iovec *iov,
+                                      uint32_t iovcnt, uint32_t *done)
+    {
+        android::Parcel data, reply;
+        android::Parcel::ReadableBlob blob;
+        size_t total = 0, offset = 0;
+        uint32_t i, requested[AGM_SESSION_MAX_IOV];
+        int rc;
+
+        if (iovcnt > AGM_SESSION_MAX_IOV)
+            return -EINVAL;
+
+        data.writeInterfaceToken(IAgmService::getInterfaceDescriptor());
+        data.writeInt64((long)handle);
+        data.writeUint32(iovcnt);
+        for (i = 0; i < iovcnt; i++) {
+            requested[i] = iov[i].size;
+            data.writeUint32(iov[i].size);
+            total += iov[i].size;
+        }
+        remote()->transact(SESSION_READV, data, &reply);
+        rc = reply.readInt32();
+        *done = reply.readUint32();
+        /* never trust the reply to stay within the buffers of the caller */
+        if (*done > iovcnt)
+            *done = iovcnt;
+        for (i = 0; i < iovcnt; i++) {
+            iov[i].size = reply.readUint32();
+            iov[i].flags = reply.readUint32();
+            iov[i].timestamp = reply.readUint64();
+            if (iov[i].size > requested[i]) {
+                AGM_LOGE("readv buffer %u returned %u bytes of %u\n", i,
+                         iov[i].size, requested[i]);
+                iov[i].size = requested[i];
+                if (!rc)
+                    rc = -EINVAL;
+            }
+        }
+        /* the blob keeps the requested layout, buffer i starts at its offset */
+        if (reply.readBlob(total, &blob) == android::OK) {
+            for (i = 0; i < iovcnt; i++) {
+                memcpy(iov[i].addr, (uint8_t *)blob.data() + offset,
+                       iov[i].size);
+                offset += requested[i];
+            }
+            blob.release();
+        }
+        return rc;
+    }
+
+    virtual int ipc_agm_get_thread_sched_info(struct agm_thread_sched_info *info,
+                                              uint32_t *num)
+    {
+        android::Parcel data, reply;
+        android::Parcel::ReadableBlob blob;
+        uint32_t count;
+        int rc;
+
+        data.writeInterfaceToken(IAgmService::getInterfaceDescriptor());
+        data.writeUint32(info ? *num : 0);
+        remote()->transact(GET_THREAD_SCHED_INFO, data, &reply);
+        rc = reply.readInt32();
+        count = reply.readUint32();
+        if (rc)
+            return rc;
+
+        if (info && count) {
+            /* never trust the reply to stay within the array of the caller */
+            if (count > *num)
+                return -EINVAL;
+            if (reply.readBlob(count * sizeof(*info), &blob) != android::OK)
+                return -EINVAL;
+            memcpy(info, blob.data(), count * sizeof(*info));
+            blob.release();
+        }
+        *num = count;
+        return 0;
+    }
+
+    virtual int ipc_agm_get_ssr_stats(struct agm_ssr_stats *stats)
+    {
+        android::Parcel data, reply;
+        int rc;
+
+        data.writeInterfaceToken(IAgmService::getInterfaceDescriptor());
+        remote()->transact(GET_SSR_STATS, data, &reply);
+        rc = reply.readInt32();
+        if (rc)
+            return rc;
+
+        stats->ssr_count = reply.readUint32();
+        stats->sessions_restored = reply.readUint32();
+        stats->sessions_failed = reply.readUint32();
+        stats->down_to_restored_us = reply.readUint64();
+        stats->up_to_restored_us = reply.readUint64();
+        return 0;
+    }
+
+    virtual int ipc_agm_session_set_gain(uint32_t session_id, uint32_t gain,
+                                         uint32_t ramp_duration_ms)
+    {
+        android::Parcel data, reply;
+
+        data.writeInterfaceToken(IAgmService::getInterfaceDescriptor());
+        data.writeUint32(session_id);
+        data.writeUint32(gain);
+        data.writeUint32(ramp_duration_ms);
+        remote()->transact(SESSION_SET_GAIN, data, &reply);
+        return reply.readInt32();
+    }
+
+    virtual int ipc_agm_session_aif_set_gain(uint32_t session_id,
+                                             uint32_t aif_id, uint32_t gain,
+                                             uint32_t ramp_duration_ms)
+    {
+        android::Parcel data, reply;
+
+        data.writeInterfaceToken(IAgmService::getInterfaceDescriptor());
+        data.writeUint32(session_id);
+        data.writeUint32(aif_id);
+        data.writeUint32(gain);
+        data.writeUint32(ramp_duration_ms);
+        remote()->transact(SESSION_AIF_SET_GAIN, data, &reply);
+        return reply.readInt32();
+    }
+
+    virtual int ipc_agm_session_stage_params(uint32_t session_id,
+                                             void *payload, size_t count)
+    {
+        android::Parcel data, reply;
+        android::Parcel::WritableBlob blob;
+
+        data.writeInterfaceToken(IAgmService::getInterfaceDescriptor());
+        data.writeUint32(session_id);
+        data.writeUint32(count);
+        data.writeBlob(count, false, &blob);
+        memcpy(blob.data(), payload, count);
+        remote()->transact(SESSION_STAGE_PARAMS, data, &reply);
+        blob.release();
         return reply.readInt32();
     }
+
+    virtual int ipc_agm_session_aif_stage_params(uint32_t session_id,
+                              uint32_t aif_id, void *payload, size_t count)
+    {
+        android::Parcel data, reply;
+        android::Parcel::WritableBlob blob;
+
+        data.writeInterfaceToken(IAgmService::getInterfaceDescriptor());
+        data.writeUint32(session_id);
+        data.writeUint32(aif_id);
+        data.writeUint32(count);
+        data.writeBlob(count, false, &blob);
+        memcpy(blob.data(), payload, count);
+        remote()->transact(SESSION_AIF_STAGE_PARAMS, data, &reply);
+        blob.release();
+        return reply.readInt32();
+    }
+
+    virtual int ipc_agm_session_commit_params(uint32_t session_id)
+    {
+        android::Parcel data, reply;
+
+        data.writeInterfaceToken(IAgmService::getInterfaceDescriptor());
+        data.writeUint32(session_id);
+        remote()->transact(SESSION_COMMIT_PARAMS, data, &reply);
+        return reply.readInt32();
+    }
+
+    virtual int ipc_agm_session_get_cal_stats(uint32_t session_id,
+                                              uint32_t *applied,
+                                              uint32_t *skipped)
+    {
+        android::Parcel data, reply;
+        int rc;
+
+        data.writeInterfaceToken(IAgmService::getInterfaceDescriptor());
+        data.writeUint32(session_id);
+        remote()->transact(SESSION_GET_CAL_STATS, data, &reply);
+        rc = reply.readInt32();
+        if (rc)
+            return rc;
+
+        *applied = reply.readUint32();
+        *skipped = reply.readUint32();
+        return 0;
+    }
 };
 
 void ipc_cb (uint32_t session_id, struct agm_event_cb_params *event_params,
@@ -962,6 +1357,22 @@ android::status_t BnAgmService::onTransact(uint32_t code,
         reply->writeInt32(rc);
         break; }
 
+    case SESSION_CMD_ASYNC : {
+        uint64_t handle = (uint64_t )data.readInt64();
+        enum agm_session_cmd cmd = (enum agm_session_cmd)data.readUint32();
+        uint32_t token = data.readUint32();
+
+        rc = ipc_agm_session_cmd_async(handle, cmd, token);
+        /*
+         * the session is released only once the queued close runs, which
+         * it does even if the client dies first, so death must not close
+         * the handle a second time
+         */
+        if (rc == 0 && cmd == AGM_SESSION_CMD_CLOSE)
+            agm_remove_session_obj_handle(handle);
+        reply->writeInt32(rc);
+        break; }
+
     case PAUSE : {
         uint64_t handle = (uint64_t )data.readInt64();
         rc = ipc_agm_session_pause(handle);
@@ -1246,24 +1657,16 @@ android::status_t BnAgmService::onTransact(uint32_t code,
         uint32_t rc, pcm_idx, be_idx;
         size_t count = 0;
         android::Parcel::ReadableBlob blob;
-        void *bn_payload;
 
         pcm_idx = data.readUint32();
         be_idx = data.readUint32();
         count = (size_t) data.readUint32();
         data.readBlob(count, &blob);
 
-        bn_payload = calloc(count, sizeof(uint8_t));
-        if (!bn_payload) {
-            AGM_LOGE("calloc failed\n");
-            reply->writeInt32(-ENOMEM);
-            return -ENOMEM;
-        }
-
-        memcpy(bn_payload, blob.data(), count);
-        rc = ipc_agm_session_aif_set_params(pcm_idx, be_idx, bn_payload, count);
+        /* the service only reads the payload, hand it the blob as is */
+        rc = ipc_agm_session_aif_set_params(pcm_idx, be_idx,
+                                            (void *)blob.data(), count);
         blob.release();
-        free(bn_payload);
         reply->writeInt32(rc);
         break; }
 
@@ -1294,25 +1697,203 @@ android::status_t BnAgmService::onTransact(uint32_t code,
     case SESSION_SET_PARAMS: {
         uint32_t rc, pcm_idx;
         size_t count = 0;
-        void *bn_payload;
         android::Parcel::ReadableBlob blob;
 
         pcm_idx = data.readUint32();
         count = (size_t) data.readUint32();
         data.readBlob(count, &blob);
 
-        bn_payload = calloc(count, sizeof(uint8_t));
-        if (!bn_payload) {
+        /* the service only reads the payload, hand it the blob as is */
+        rc = ipc_agm_session_set_params(pcm_idx, (void *)blob.data(), count);
+        blob.release();
+        reply->writeInt32(rc);
+        break; }
+
+    case SESSION_SET_PARAMS_FD: {
+        uint32_t session_id, aif_id;
+        size_t size;
+        int fd;
+
+        session_id = data.readUint32();
+        aif_id = data.readUint32();
+        size = (size_t) data.readUint32();
+        /* owned by the parcel, only valid for this transaction */
+        fd = data.readFileDescriptor();
+        rc = ipc_agm_session_set_params_fd(session_id, aif_id, fd, size);
+        reply->writeInt32(rc);
+        break; }
+
+    case SESSION_READER_OPEN: {
+        uint64_t handle, reader = 0;
+
+        handle = (uint64_t)data.readInt64();
+        rc = ipc_agm_session_reader_open(handle, &reader);
+        reply->writeInt64((long)reader);
+        reply->writeInt32(rc);
+        break; }
+
+    case SESSION_READER_READ: {
+        uint64_t reader, dropped = 0;
+        size_t byte_count;
+        void *buf;
+        android::Parcel::WritableBlob blob;
+
+        reader = (uint64_t)data.readInt64();
+        byte_count = data.readUint32();
+        buf = calloc(1, byte_count);
+        if (buf == NULL) {
             AGM_LOGE("calloc failed\n");
-            rc =  -ENOMEM;
-            goto session_set_param_fail;
+            reply->writeInt32(-ENOMEM);
+            break;
         }
 
-        memcpy(bn_payload, blob.data(), count);
-        rc = ipc_agm_session_set_params(pcm_idx, bn_payload, count);
+        rc = ipc_agm_session_reader_read(reader, buf, &byte_count, &dropped);
+        reply->writeInt32(rc);
+        if (rc == 0) {
+            reply->writeInt64((long)dropped);
+            reply->writeUint32(byte_count);
+            if (byte_count) {
+                reply->writeBlob(byte_count, false, &blob);
+                memcpy(blob.data(), buf, byte_count);
+                blob.release();
+            }
+        }
+        free(buf);
+        break; }
 
-        free(bn_payload);
-    session_set_param_fail:
+    case SESSION_WRITEV: {
+        struct agm_iovec iov[AGM_SESSION_MAX_IOV] = {};
+        uint64_t handle;
+        uint32_t iovcnt, i, done = 0;
+        size_t total, offset = 0;
+        android::Parcel::ReadableBlob blob;
+
+        handle = (uint64_t)data.readInt64();
+        iovcnt = data.readUint32();
+        if (iovcnt > AGM_SESSION_MAX_IOV)
+            iovcnt = 0;
+        for (i = 0; i < iovcnt; i++) {
+            iov[i].size = data.readUint32();
+            iov[i].flags = data.readUint32();
+            iov[i].timestamp = data.readUint64();
+            offset += iov[i].size;
+        }
+        total = (size_t)data.readUint32();
+        if (iovcnt == 0 || offset > total ||
+            data.readBlob(total, &blob) != android::OK) {
+            AGM_LOGE("invalid writev request\n");
+            reply->writeInt32(-EINVAL);
+            reply->writeUint32(0);
+            for (i = 0; i < iovcnt; i++)
+                reply->writeUint32(0);
+            break;
+        }
+
+        /* buffers are written straight from the transaction blob */
+        offset = 0;
+        for (i = 0; i < iovcnt; i++) {
+            iov[i].addr = (uint8_t *)blob.data() + offset;
+            offset += iov[i].size;
+        }
+        rc = ipc_agm_session_writev(handle, iov, iovcnt, &done);
+        blob.release();
+        reply->writeInt32(rc);
+        reply->writeUint32(done);
+        for (i = 0; i < iovcnt; i++)
+            reply->writeUint32(iov[i].size);
+        break; }
+
+    case SESSION_READV: {
+        struct agm_iovec iov[AGM_SESSION_MAX_IOV] = {};
+        uint64_t handle;
+        uint32_t iovcnt, i, done = 0;
+        size_t total = 0, offset = 0;
+        uint8_t *buf = NULL;
+        android::Parcel::WritableBlob blob;
+
+        handle = (uint64_t)data.readInt64();
+        iovcnt = data.readUint32();
+        if (iovcnt > AGM_SESSION_MAX_IOV)
+            iovcnt = 0;
+        for (i = 0; i < iovcnt; i++) {
+            iov[i].size = data.readUint32();
+            total += iov[i].size;
+        }
+
+        if (iovcnt && total)
+            buf = (uint8_t *)calloc(1, total);
+        if (buf == NULL) {
+            rc = -EINVAL;
+        } else {
+            for (i = 0; i < iovcnt; i++) {
+                iov[i].addr = buf + offset;
+                offset += iov[i].size;
+            }
+            rc = ipc_agm_session_readv(handle, iov, iovcnt, &done);
+        }
+
+        reply->writeInt32(rc);
+        reply->writeUint32(done);
+        for (i = 0; i < iovcnt; i++) {
+            reply->writeUint32(buf ? iov[i].size : 0);
+            reply->writeUint32(iov[i].flags);
+            reply->writeUint64(iov[i].timestamp);
+        }
+        /* the blob keeps the requested layout, buffer i at its offset */
+        if (buf) {
+            reply->writeBlob(total, false, &blob);
+            memcpy(blob.data(), buf, total);
+            blob.release();
+            free(buf);
+        }
+        break; }
+
+    case GET_THREAD_SCHED_INFO: {
+        struct agm_thread_sched_info *info = NULL;
+        android::Parcel::WritableBlob blob;
+        uint32_t num = data.readUint32();
+
+        if (num > MAX_THREAD_SCHED_INFO)
+            num = MAX_THREAD_SCHED_INFO;
+        if (num) {
+            info = (struct agm_thread_sched_info *)calloc(num, sizeof(*info));
+            if (info == NULL) {
+                reply->writeInt32(-ENOMEM);
+                reply->writeUint32(0);
+                break;
+            }
+        }
+
+        rc = ipc_agm_get_thread_sched_info(info, &num);
+        reply->writeInt32(rc);
+        reply->writeUint32(rc ? 0 : num);
+        if (!rc && info && num) {
+            reply->writeBlob(num * sizeof(*info), false, &blob);
+            memcpy(blob.data(), info, num * sizeof(*info));
+            blob.release();
+        }
+        free(info);
+        break; }
+
+    case GET_SSR_STATS: {
+        struct agm_ssr_stats stats;
+
+        memset(&stats, 0, sizeof(stats));
+        rc = ipc_agm_get_ssr_stats(&stats);
+        reply->writeInt32(rc);
+        if (!rc) {
+            reply->writeUint32(stats.ssr_count);
+            reply->writeUint32(stats.sessions_restored);
+            reply->writeUint32(stats.sessions_failed);
+            reply->writeUint64(stats.down_to_restored_us);
+            reply->writeUint64(stats.up_to_restored_us);
+        }
+        break; }
+
+    case SESSION_READER_CLOSE: {
+        uint64_t reader = (uint64_t)data.readInt64();
+
+        rc = ipc_agm_session_reader_close(reader);
         reply->writeInt32(rc);
         break; }
 
@@ -1455,7 +2036,7 @@ android::status_t BnAgmService::onTransact(uint32_t code,
     case GET_BUF_INFO : {
         int rc;
         uint32_t session_id, flag;
-        struct agm_buf_info buf_info;
+        struct agm_buf_info buf_info = {};
 
         session_id = data.readUint32();
         flag = data.readUint32();
@@ -1468,9 +2049,171 @@ android::status_t BnAgmService::onTransact(uint32_t code,
             reply->writeFileDescriptor(buf_info.pos_buf_fd);
             reply->writeInt32(buf_info.pos_buf_size);
         }
+        if (flag & TIME_BUF) {
+            /* on success the time page fd is a dup owned by this reply */
+            reply->writeInt32(rc == 0);
+            if (rc == 0) {
+                reply->writeFileDescriptor(buf_info.time_buf_fd, true);
+                reply->writeInt32(buf_info.time_buf_size);
+            }
+        }
+        reply->writeInt32(rc);
+        break; }
+
+    case SESSION_TRANSACT : {
+        size_t txn_size = 0;
+        uint64_t handle = 0;
+        void *bn_txn;
+        android::Parcel::ReadableBlob blob;
+
+        txn_size = (size_t) data.readUint32();
+        data.readBlob(txn_size, &blob);
+
+        bn_txn = calloc(txn_size, sizeof(uint8_t));
+        if (!bn_txn) {
+            AGM_LOGE("calloc failed\n");
+            rc = -ENOMEM;
+            goto session_transact_fail;
+        }
+
+        memcpy(bn_txn, blob.data(), txn_size);
+        rc = ipc_agm_session_transact(bn_txn, txn_size, &handle);
+        if (handle != 0)
+            agm_add_session_obj_handle(handle);
+
+        free(bn_txn);
+    session_transact_fail:
+        blob.release();
+        reply->writeInt64((long)handle);
+        reply->writeInt32(rc);
+        break; }
+
+    case BLOB_REGISTER : {
+        enum agm_blob_type type;
+        size_t size = 0;
+        uint32_t blob_id = 0;
+        android::Parcel::ReadableBlob blob;
+
+        type = (enum agm_blob_type)data.readUint32();
+        size = (size_t) data.readUint32();
+        data.readBlob(size, &blob);
+        /* the registry keeps its own copy, register straight from the blob */
+        rc = ipc_agm_blob_register(type, (void *)blob.data(), size, &blob_id);
+        blob.release();
+        /* an untracked registration would outlive the client */
+        if (rc == 0) {
+            rc = agm_add_blob(blob_id);
+            if (rc) {
+                ipc_agm_blob_unregister(blob_id);
+                blob_id = 0;
+            }
+        }
+        reply->writeUint32(blob_id);
+        reply->writeInt32(rc);
+        break; }
+
+    case BLOB_UNREGISTER : {
+        uint32_t blob_id = data.readUint32();
+
+        /* a client only drops its own registrations */
+        if (agm_remove_blob(blob_id)) {
+            rc = ipc_agm_blob_unregister(blob_id);
+        } else {
+            AGM_LOGE("blob %u not registered by this client\n", blob_id);
+            rc = -EPERM;
+        }
+        reply->writeInt32(rc);
+        break; }
+
+    case SESSION_SET_BLOB : {
+        uint32_t session_id, aif_id, blob_id;
+
+        session_id = data.readUint32();
+        aif_id = data.readUint32();
+        blob_id = data.readUint32();
+        rc = ipc_agm_session_set_blob(session_id, aif_id, blob_id);
+        reply->writeInt32(rc);
+        break; }
+
+    case SESSION_SET_GAIN : {
+        uint32_t session_id, gain, ramp_duration_ms;
+
+        session_id = data.readUint32();
+        gain = data.readUint32();
+        ramp_duration_ms = data.readUint32();
+        rc = ipc_agm_session_set_gain(session_id, gain, ramp_duration_ms);
+        reply->writeInt32(rc);
+        break; }
+
+    case SESSION_AIF_SET_GAIN : {
+        uint32_t session_id, aif_id, gain, ramp_duration_ms;
+
+        session_id = data.readUint32();
+        aif_id = data.readUint32();
+        gain = data.readUint32();
+        ramp_duration_ms = data.readUint32();
+        rc = ipc_agm_session_aif_set_gain(session_id, aif_id, gain,
+                                          ramp_duration_ms);
+        reply->writeInt32(rc);
+        break; }
+
+    case SESSION_STAGE_PARAMS : {
+        uint32_t session_id;
+        size_t count;
+        android::Parcel::ReadableBlob blob;
+
+        session_id = data.readUint32();
+        count = (size_t) data.readUint32();
+        if (data.readBlob(count, &blob) != android::OK) {
+            reply->writeInt32(-EINVAL);
+            break;
+        }
+
+        /* the service copies what it stages, hand it the blob as is */
+        rc = ipc_agm_session_stage_params(session_id, (void *)blob.data(),
+                                          count);
+        blob.release();
         reply->writeInt32(rc);
         break; }
 
+    case SESSION_AIF_STAGE_PARAMS : {
+        uint32_t session_id, aif_id;
+        size_t count;
+        android::Parcel::ReadableBlob blob;
+
+        session_id = data.readUint32();
+        aif_id = data.readUint32();
+        count = (size_t) data.readUint32();
+        if (data.readBlob(count, &blob) != android::OK) {
+            reply->writeInt32(-EINVAL);
+            break;
+        }
+
+        rc = ipc_agm_session_aif_stage_params(session_id, aif_id,
+                                              (void *)blob.data(), count);
+        blob.release();
+        reply->writeInt32(rc);
+        break; }
+
+    case SESSION_COMMIT_PARAMS : {
+        uint32_t session_id = data.readUint32();
+
+        rc = ipc_agm_session_commit_params(session_id);
+        reply->writeInt32(rc);
+        break; }
+
+    case SESSION_GET_CAL_STATS : {
+        uint32_t session_id = data.readUint32();
+        uint32_t applied = 0, skipped = 0;
+
+        rc = ipc_agm_session_get_cal_stats(session_id, &applied, &skipped);
+        reply->writeInt32(rc);
+        if (!rc) {
+            reply->writeUint32(applied);
+            reply->writeUint32(skipped);
+        }
+        break; }
+
     default:
         return BBinder::onTransact(code, data, reply, flags);
     }
@@ -185,6 +185,13 @@ struct agmctl_priv {
 
     uint32_t total_ctl_cnt;
     struct agm_mixer_controls *controls;
+
+    /*
+     * Open addressed index of controls by name, a slot holds the
+     * control index + 1, 0 if empty. Size is a power of 2.
+     */
+    uint32_t *name_index;
+    uint32_t name_index_size;
 };
 
 static enum agm_media_format alsa_to_agm_fmt(int fmt)
@@ -869,6 +876,76 @@ done:
     return ret;
 }
 
+typedef int (*agmctl_bytes_fn)(struct agm_mixer_controls *control,
+                               unsigned char *data, size_t len);
+typedef int (*agmctl_enum_fn)(struct agm_mixer_controls *control,
+                              unsigned int *item);
+typedef int (*agmctl_int_fn)(struct agm_mixer_controls *control, long *val);
+
+/* handlers of each control, indexed like attr_info, NULL if unsupported */
+static const struct agm_ctl_ops {
+    agmctl_bytes_fn read_bytes;
+    agmctl_bytes_fn write_bytes;
+    agmctl_enum_fn write_enum;
+    agmctl_int_fn write_int;
+} ctl_ops[AGM_BE_CTL_END] = {
+    [AGM_FE_CTL_NAME_METADATA] = {.write_bytes = agmctl_pcm_metadata_put},
+    [AGM_FE_CTL_NAME_SET_PARAM] = {.write_bytes = agmctl_pcm_setparam_put},
+    [AGM_FE_CTL_NAME_SET_PARAM_TAG] = {.write_bytes = agmctl_pcm_setparamtag_put},
+    [AGM_FE_CTL_NAME_CONNECT] = {.write_enum = agmctl_pcm_connect_put},
+    [AGM_FE_CTL_NAME_DISCONNECT] = {.write_enum = agmctl_pcm_connect_put},
+    [AGM_FE_CTL_NAME_CONTROL] = {.write_enum = agmctl_pcm_control_put},
+    [AGM_FE_CTL_NAME_GET_TAG_INFO] = {.read_bytes = agmctl_pcm_tag_info_get},
+    [AGM_FE_CTL_NAME_EVENT] = {.read_bytes = agmctl_pcm_event_get,
+                               .write_bytes = agmctl_pcm_event_put},
+    [AGM_FE_CTL_NAME_SET_CALIBRATION] = {.write_bytes = agmctl_pcm_calibration_put},
+    [AGM_FE_CTL_NAME_GET_PARAM] = {.read_bytes = agmctl_pcm_get_param_get,
+                                   .write_bytes = agmctl_pcm_get_param_put},
+    [AGM_FE_CTL_NAME_BUF_INFO] = {.read_bytes = agmctl_pcm_buf_info_get},
+    [AGM_FE_TX_CTL_NAME_LOOPBACK] = {.write_enum = agmctl_pcm_loopback_put},
+    [AGM_FE_TX_CTL_NAME_ECHOREF] = {.write_enum = agmctl_pcm_ecref_put},
+    [AGM_FE_TX_CTL_NAME_BUF_TSTAMP] = {.read_bytes = agmctl_pcm_buf_timestamp_get},
+    [AGM_BE_CTL_NAME_MEDIA_CONFIG] = {.write_int = agmctl_be_media_config_put},
+    [AGM_BE_CTL_NAME_METADATA] = {.write_bytes = agmctl_be_metadata_put},
+    [AGM_BE_CTL_NAME_SET_PARAM] = {.write_bytes = agmctl_be_setparam_put},
+};
+
+/* FNV-1a */
+static uint32_t agmctl_name_hash(const char *name)
+{
+    uint32_t hash = 2166136261u;
+
+    while (*name) {
+        hash ^= (unsigned char)*name++;
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+static int agmctl_build_name_index(struct agmctl_priv *agmctl)
+{
+    uint32_t size = 1, i, slot;
+
+    /* keep the load factor at or below one half */
+    while (size < 2 * agmctl->total_ctl_cnt)
+        size <<= 1;
+
+    agmctl->name_index = calloc(size, sizeof(*agmctl->name_index));
+    if (!agmctl->name_index)
+        return -ENOMEM;
+    agmctl->name_index_size = size;
+
+    for (i = 0; i < agmctl->total_ctl_cnt; i++) {
+        slot = agmctl_name_hash(agmctl->controls[i].mixer_name) & (size - 1);
+        while (agmctl->name_index[slot])
+            slot = (slot + 1) & (size - 1);
+        agmctl->name_index[slot] = i + 1;
+    }
+
+    return 0;
+}
+
 static int agmctl_elem_count(snd_ctl_ext_t * ext)
 {
     struct agmctl_priv *agmctl = ext->private_data;
@@ -894,19 +971,24 @@ static snd_ctl_ext_key_t agmctl_find_elem(snd_ctl_ext_t * ext,
 {
     const char *name;
     unsigned int numid, i;
+    uint32_t mask, slot;
     struct agmctl_priv *agmctl = ext->private_data;
 
     numid = snd_ctl_elem_id_get_numid(id);
-    if (numid > 0 && numid < agmctl->total_ctl_cnt)
+    if (numid > 0 && numid <= agmctl->total_ctl_cnt)
             return numid - 1;
 
     name = snd_ctl_elem_id_get_name(id);
 
-    for (i = 0; i < agmctl->total_ctl_cnt; i++) {
+    mask = agmctl->name_index_size - 1;
+    slot = agmctl_name_hash(name) & mask;
+    while (agmctl->name_index[slot]) {
+        i = agmctl->name_index[slot] - 1;
         if (strcmp(name, agmctl->controls[i].mixer_name) == 0) {
             snd_ctl_elem_id_set_numid((snd_ctl_elem_id_t *)id, i + 1);
             return i;
         }
+        slot = (slot + 1) & mask;
     }
 
     return SND_CTL_EXT_KEY_NOT_FOUND;
@@ -1045,17 +1127,10 @@ static int agmctl_read_enumerated(snd_ctl_ext_t *ext,
     if (key >= agmctl->total_ctl_cnt)
         return -EINVAL;
 
-    switch (agmctl->controls[key].ctl_id) {
-    case AGM_FE_CTL_NAME_CONNECT:
-    case AGM_FE_CTL_NAME_DISCONNECT:
-    case AGM_FE_CTL_NAME_CONTROL:
-    case AGM_FE_TX_CTL_NAME_LOOPBACK:
-    case AGM_FE_TX_CTL_NAME_ECHOREF:
-        break;
-    default:
+    if (attr_info[agmctl->controls[key].ctl_id].type !=
+        SND_CTL_ELEM_TYPE_ENUMERATED) {
         rc = -EINVAL;
         AGM_LOGE("Unsupported control %d\n", agmctl->controls[key].ctl_id);
-        break;
     }
 
     return rc;
@@ -1066,28 +1141,17 @@ static int agmctl_write_enumerated(snd_ctl_ext_t *ext,
 {
     int rc = 0;
     struct agmctl_priv *agmctl = ext->private_data;
+    agmctl_enum_fn put;
 
     if (key >= agmctl->total_ctl_cnt)
         return -EINVAL;
 
-    switch (agmctl->controls[key].ctl_id) {
-    case AGM_FE_CTL_NAME_CONNECT:
-    case AGM_FE_CTL_NAME_DISCONNECT:
-        rc = agmctl_pcm_connect_put(&agmctl->controls[key], item);
-        break;
-    case AGM_FE_TX_CTL_NAME_LOOPBACK:
-        rc = agmctl_pcm_loopback_put(&agmctl->controls[key], item);
-        break;
-    case AGM_FE_TX_CTL_NAME_ECHOREF:
-        rc = agmctl_pcm_ecref_put(&agmctl->controls[key], item);
-        break;
-    case AGM_FE_CTL_NAME_CONTROL:
-        rc = agmctl_pcm_control_put(&agmctl->controls[key], item);
-        break;
-    default:
+    put = ctl_ops[agmctl->controls[key].ctl_id].write_enum;
+    if (put) {
+        rc = put(&agmctl->controls[key], item);
+    } else {
         rc = -EINVAL;
         AGM_LOGE("Unsupported control %d\n", agmctl->controls[key].ctl_id);
-        break;
     }
 
     return rc;
@@ -1102,13 +1166,10 @@ static int agmctl_read_integer(snd_ctl_ext_t * ext, snd_ctl_ext_key_t key,
     if (key >= agmctl->total_ctl_cnt)
         return -EINVAL;
 
-    switch (agmctl->controls[key].ctl_id) {
-    case AGM_BE_CTL_NAME_MEDIA_CONFIG:
-        break;
-    default:
+    if (attr_info[agmctl->controls[key].ctl_id].type !=
+        SND_CTL_ELEM_TYPE_INTEGER) {
         rc = -EINVAL;
         AGM_LOGE("Unsupported control %d\n", agmctl->controls[key].ctl_id);
-        break;
     }
     return rc;
 }
@@ -1118,18 +1179,17 @@ static int agmctl_write_integer(snd_ctl_ext_t * ext, snd_ctl_ext_key_t key,
 {
     int rc = 0;
     struct agmctl_priv *agmctl = ext->private_data;
+    agmctl_int_fn put;
 
     if (key >= agmctl->total_ctl_cnt)
         return -EINVAL;
 
-    switch (agmctl->controls[key].ctl_id) {
-    case AGM_BE_CTL_NAME_MEDIA_CONFIG:
-        rc = agmctl_be_media_config_put(&agmctl->controls[key], value);
-        break;
-    default:
+    put = ctl_ops[agmctl->controls[key].ctl_id].write_int;
+    if (put) {
+        rc = put(&agmctl->controls[key], value);
+    } else {
         rc = -EINVAL;
         AGM_LOGE("Unsupported control %d\n", agmctl->controls[key].ctl_id);
-        break;
     }
     return rc;
 
@@ -1139,6 +1199,7 @@ static int agmctl_read_bytes(snd_ctl_ext_t *ext, snd_ctl_ext_key_t key,
                              unsigned char *tlv, size_t tlv_size)
 {
     struct agmctl_priv *agmctl = ext->private_data;
+    agmctl_bytes_fn get;
     int rc = 0;
     unsigned char *data;
     size_t len;
@@ -1149,26 +1210,12 @@ static int agmctl_read_bytes(snd_ctl_ext_t *ext, snd_ctl_ext_key_t key,
     len = (size_t)*(tlv + sizeof(unsigned int));
     data = (unsigned char *)(tlv + 2 * sizeof(unsigned int));
 
-    switch (agmctl->controls[key].ctl_id) {
-    case AGM_FE_CTL_NAME_GET_TAG_INFO:
-        rc = agmctl_pcm_tag_info_get(&agmctl->controls[key], data, len);
-        break;
-    case AGM_FE_TX_CTL_NAME_BUF_TSTAMP:
-        rc = agmctl_pcm_buf_timestamp_get(&agmctl->controls[key], data, len);
-        break;
-    case AGM_FE_CTL_NAME_BUF_INFO:
-        rc = agmctl_pcm_buf_info_get(&agmctl->controls[key], data, len);
-        break;
-    case AGM_FE_CTL_NAME_GET_PARAM:
-        rc = agmctl_pcm_get_param_get(&agmctl->controls[key], data, len);
-        break;
-    case AGM_FE_CTL_NAME_EVENT:
-        rc = agmctl_pcm_event_get(&agmctl->controls[key], data, len);
-        break;
-    default:
+    get = ctl_ops[agmctl->controls[key].ctl_id].read_bytes;
+    if (get) {
+        rc = get(&agmctl->controls[key], data, len);
+    } else {
         rc = -EINVAL;
         AGM_LOGE("Unsupported control %d\n", agmctl->controls[key].ctl_id);
-        break;
     }
     return rc;
 }
@@ -1177,6 +1224,7 @@ static int agmctl_write_bytes(snd_ctl_ext_t *ext, snd_ctl_ext_key_t key,
                               unsigned char *tlv, size_t tlv_size)
 {
     struct agmctl_priv *agmctl = ext->private_data;
+    agmctl_bytes_fn put;
     int rc = 0;
     unsigned char *data;
     size_t len;
@@ -1187,35 +1235,12 @@ static int agmctl_write_bytes(snd_ctl_ext_t *ext, snd_ctl_ext_key_t key,
     len = (size_t)*(tlv + sizeof(unsigned int));
     data = (unsigned char *)(tlv + 2 * sizeof(unsigned int));
 
-    switch (agmctl->controls[key].ctl_id) {
-    case AGM_FE_CTL_NAME_METADATA:
-        rc = agmctl_pcm_metadata_put(&agmctl->controls[key], data, len);
-        break;
-    case AGM_FE_CTL_NAME_SET_PARAM:
-        rc = agmctl_pcm_setparam_put(&agmctl->controls[key], data, len);
-        break;
-    case AGM_FE_CTL_NAME_SET_PARAM_TAG:
-        rc = agmctl_pcm_setparamtag_put(&agmctl->controls[key], data, len);
-        break;
-    case AGM_FE_CTL_NAME_EVENT:
-        rc = agmctl_pcm_event_put(&agmctl->controls[key], data, len);
-        break;
-    case AGM_FE_CTL_NAME_SET_CALIBRATION:
-        rc = agmctl_pcm_calibration_put(&agmctl->controls[key], data, len);
-        break;
-    case AGM_FE_CTL_NAME_GET_PARAM:
-        rc = agmctl_pcm_get_param_put(&agmctl->controls[key], data, len);
-        break;
-    case AGM_BE_CTL_NAME_METADATA:
-        rc = agmctl_be_metadata_put(&agmctl->controls[key], data, len);
-        break;
-    case AGM_BE_CTL_NAME_SET_PARAM:
-        rc = agmctl_be_setparam_put(&agmctl->controls[key], data, len);
-        break;
-    default:
+    put = ctl_ops[agmctl->controls[key].ctl_id].write_bytes;
+    if (put) {
+        rc = put(&agmctl->controls[key], data, len);
+    } else {
         rc = -EINVAL;
         AGM_LOGE("Unsupported control %d\n", agmctl->controls[key].ctl_id);
-        break;
     }
     return rc;
 }
@@ -1242,6 +1267,7 @@ static void agmctl_close(snd_ctl_ext_t * ext)
     struct agmctl_priv *agmctl = ext->private_data;
 
     snd_card_def_put_card(agmctl->card_node);
+    free(agmctl->name_index);
     free(agmctl->aif_list);
     free(agmctl);
 }
@@ -1323,6 +1349,10 @@ SND_CTL_PLUGIN_DEFINE_FUNC(agm)
     if (rc)
         goto err_put_card;
 
+    rc = agmctl_build_name_index(ctl);
+    if (rc)
+        goto err_put_card;
+
     ctl->ext.version = SND_CTL_EXT_VERSION;
     ctl->ext.card_idx = 0;
     strlcpy(ctl->ext.id, "agm", sizeof(ctl->ext.id));
@@ -1341,13 +1371,15 @@ SND_CTL_PLUGIN_DEFINE_FUNC(agm)
 
     rc = snd_ctl_ext_create(&ctl->ext, name, mode);
     if (rc < 0)
-            goto err_put_card;
+            goto err_free_index;
 
     AGM_LOGD("%s: exit", __func__);
     *handlep = ctl->ext.handle;
 
     return 0;
 
+err_free_index:
+    free(ctl->name_index);
 err_put_card:
     snd_card_def_put_card(ctl->card_node);
 err_free_aif_list:
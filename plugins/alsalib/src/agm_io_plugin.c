@@ -28,14 +28,18 @@
 **/
 #define LOG_TAG "PLUGIN: AGMIO"
 #include <stdio.h>
+#include <sys/mman.h>
 #include <sys/poll.h>
+#include <unistd.h>
 
 #include <sys/eventfd.h>
+#include <sys/timerfd.h>
 #include <alsa/asoundlib.h>
 #include <alsa/pcm_external.h>
 
 #include <agm/agm_api.h>
 #include <agm/agm_list.h>
+#include <agm/agm_pos_buf.h>
 #include <snd-card-def.h>
 #include "utils.h"
 
@@ -65,7 +69,27 @@ struct agmio_priv {
     unsigned int state;
     snd_pcm_uframes_t hw_pointer;
     snd_pcm_uframes_t boundary;
+    snd_pcm_uframes_t avail_min;
+    /*
+     *Poll descriptor, readable while at least avail_min frames are
+     *available. An eventfd signalled by transfers and data path events, a
+     *timerfd armed for the next period in mmap mode where the DSP sends no
+     *buffer events.
+     */
     int event_fd;
+    /* mmap mode: DSP buffers shared through push pull mode */
+    bool mmap_mode;
+    struct agm_buf_info buf_info;
+    uint8_t *mmap_buf;
+    size_t mmap_len;
+    struct agm_shared_pos_buffer *pos_buf;
+    struct agm_pos_tracker pos_tracker;
+    /* last DSP position, 0 ... buffer_size - 1 */
+    snd_pcm_uframes_t mmap_hw;
+    /* position last returned to alsa-lib by the pointer callback */
+    snd_pcm_uframes_t mmap_hw_reported;
+    /* appl_ptr up to which playback data was copied to the DSP buffer */
+    snd_pcm_uframes_t mmap_appl;
 /* add private variables here */
 };
 
@@ -82,6 +106,255 @@ static int agm_get_session_handle(struct agmio_priv *priv,
     return 0;
 }
 
+static void agm_io_mmap_release(struct agmio_priv *pcm)
+{
+    if (pcm->pos_buf) {
+        munmap(pcm->pos_buf, pcm->buf_info.pos_buf_size);
+        pcm->pos_buf = NULL;
+    }
+    if (pcm->mmap_buf) {
+        munmap(pcm->mmap_buf, pcm->mmap_len);
+        pcm->mmap_buf = NULL;
+    }
+    if (pcm->buf_info.pos_buf_fd != -1 &&
+        pcm->buf_info.pos_buf_fd != pcm->buf_info.data_buf_fd) {
+        close(pcm->buf_info.pos_buf_fd);
+    }
+    pcm->buf_info.pos_buf_fd = -1;
+    if (pcm->buf_info.data_buf_fd != -1) {
+        close(pcm->buf_info.data_buf_fd);
+        pcm->buf_info.data_buf_fd = -1;
+    }
+}
+
+static int agm_io_mmap_setup(struct agmio_priv *pcm)
+{
+    snd_pcm_ioplug_t *io = &pcm->io;
+    void *addr;
+    int ret, retries = 0;
+
+    if (pcm->mmap_buf)
+        return 0;
+
+    ret = agm_session_get_buf_info(pcm->device, &pcm->buf_info,
+                                   DATA_BUF | POS_BUF);
+    if (ret) {
+        AGM_LOGE("%s: failed to get buf info %d\n", __func__, ret);
+        pcm->buf_info.data_buf_fd = -1;
+        pcm->buf_info.pos_buf_fd = -1;
+        return ret;
+    }
+
+    /* alsa-lib offsets are used as is in the DSP buffer */
+    pcm->mmap_len = io->buffer_size * pcm->frame_size;
+    if (pcm->mmap_len > (size_t)pcm->buf_info.data_buf_size) {
+        AGM_LOGE("%s: DSP buffer %d bytes, need %zu\n", __func__,
+                 pcm->buf_info.data_buf_size, pcm->mmap_len);
+        ret = -EINVAL;
+        goto err;
+    }
+
+    addr = mmap(0, pcm->mmap_len, PROT_READ | PROT_WRITE, MAP_SHARED,
+                pcm->buf_info.data_buf_fd, 0);
+    if (addr == MAP_FAILED) {
+        ret = -errno;
+        goto err;
+    }
+    pcm->mmap_buf = addr;
+
+    addr = mmap(0, pcm->buf_info.pos_buf_size, PROT_READ, MAP_SHARED,
+                pcm->buf_info.pos_buf_fd, 0);
+    if (addr == MAP_FAILED) {
+        ret = -errno;
+        goto err;
+    }
+    pcm->pos_buf = addr;
+
+    /* optional, attempts at reading the DSP position, prepare applies it */
+    snd_card_def_get_int(pcm->pcm_node, "pos_buf_retries", &retries);
+    pcm->pos_tracker.retries = retries;
+
+    AGM_LOGD("%s: mapped %zu bytes\n", __func__, pcm->mmap_len);
+    return 0;
+
+err:
+    AGM_LOGE("%s: mmap failed %d\n", __func__, ret);
+    agm_io_mmap_release(pcm);
+    return ret;
+}
+
+/* copy frames between the alsa-lib buffer and the DSP buffer */
+static void agm_io_mmap_copy(struct agmio_priv *pcm,
+                             const snd_pcm_channel_area_t *areas,
+                             snd_pcm_uframes_t from, snd_pcm_uframes_t frames,
+                             bool to_dsp)
+{
+    snd_pcm_uframes_t buffer_size = pcm->io.buffer_size;
+    snd_pcm_uframes_t offset, len;
+    uint8_t *app, *dsp;
+
+    while (frames) {
+        offset = from % buffer_size;
+        len = buffer_size - offset;
+        if (len > frames)
+            len = frames;
+        app = (uint8_t *)areas->addr + (areas->first + areas->step * offset) / 8;
+        dsp = pcm->mmap_buf + offset * pcm->frame_size;
+        if (to_dsp)
+            memcpy(dsp, app, len * pcm->frame_size);
+        else
+            memcpy(app, dsp, len * pcm->frame_size);
+        from += len;
+        frames -= len;
+    }
+}
+
+/* push playback frames committed without a transfer call, as rw access does */
+static void agm_io_mmap_sync_appl(struct agmio_priv *pcm)
+{
+    snd_pcm_ioplug_t *io = &pcm->io;
+    snd_pcm_uframes_t appl_ptr = io->appl_ptr;
+    snd_pcm_uframes_t pending;
+
+    if (appl_ptr == pcm->mmap_appl)
+        return;
+
+    if (appl_ptr > pcm->mmap_appl)
+        pending = appl_ptr - pcm->mmap_appl;
+    else
+        pending = appl_ptr + pcm->boundary - pcm->mmap_appl;
+    if (pending > io->buffer_size)
+        pending = io->buffer_size;
+
+    agm_io_mmap_copy(pcm, snd_pcm_ioplug_mmap_areas(io),
+                     appl_ptr - pending, pending, true);
+    pcm->mmap_appl = appl_ptr;
+}
+
+static snd_pcm_sframes_t agm_io_mmap_pointer(struct agmio_priv *pcm)
+{
+    snd_pcm_ioplug_t *io = &pcm->io;
+    snd_pcm_uframes_t hw_ptr, frames;
+    uint64_t moved = pcm->pos_tracker.frames;
+
+    if (!pcm->pos_buf)
+        return pcm->mmap_hw;
+
+    if (io->stream == SND_PCM_STREAM_PLAYBACK)
+        agm_io_mmap_sync_appl(pcm);
+
+    if (agm_pos_tracker_update(&pcm->pos_tracker, pcm->pos_buf))
+        return pcm->mmap_hw;
+
+    hw_ptr = pcm->pos_tracker.pos;
+    moved = pcm->pos_tracker.frames - moved;
+    if (moved >= io->buffer_size)
+        AGM_LOGD("%s: DSP moved %llu frames since the last pointer\n",
+                 __func__, (unsigned long long)moved);
+
+    if (io->stream == SND_PCM_STREAM_CAPTURE) {
+        frames = (hw_ptr + io->buffer_size - pcm->mmap_hw) % io->buffer_size;
+        agm_io_mmap_copy(pcm, snd_pcm_ioplug_mmap_areas(io), pcm->mmap_hw,
+                         frames, false);
+    }
+    pcm->mmap_hw = hw_ptr;
+
+    return hw_ptr;
+}
+
+static snd_pcm_uframes_t agm_io_avail(struct agmio_priv *pcm)
+{
+    snd_pcm_ioplug_t *io = &pcm->io;
+    snd_pcm_uframes_t hw_ptr = io->hw_ptr;
+    snd_pcm_uframes_t pos;
+
+    /* io->hw_ptr is where alsa-lib last saw the DSP, add what moved since */
+    if (pcm->mmap_mode) {
+        pos = agm_io_mmap_pointer(pcm);
+        hw_ptr += (pos + io->buffer_size - pcm->mmap_hw_reported) %
+                  io->buffer_size;
+        if (pcm->boundary && hw_ptr >= pcm->boundary)
+            hw_ptr -= pcm->boundary;
+    }
+
+    return snd_pcm_ioplug_avail(io, hw_ptr, io->appl_ptr);
+}
+
+static void agm_io_wakeup(struct agmio_priv *pcm)
+{
+    struct itimerspec its = {0};
+    uint64_t val = 1;
+
+    if (pcm->event_fd == -1)
+        return;
+
+    if (pcm->mmap_mode) {
+        its.it_value.tv_nsec = 1;
+        timerfd_settime(pcm->event_fd, 0, &its, NULL);
+    } else if (write(pcm->event_fd, &val, sizeof(val)) < 0) {
+        AGM_LOGE("%s: event_fd write failed %d\n", __func__, errno);
+    }
+}
+
+/*
+ *Leave the poll descriptor readable if avail_min frames are available. In
+ *mmap mode otherwise arm the timer for when the DSP is expected to have
+ *moved that far, in the other mode the next buffer event signals it.
+ */
+static bool agm_io_update_wakeup(struct agmio_priv *pcm)
+{
+    snd_pcm_ioplug_t *io = &pcm->io;
+    struct itimerspec its = {0};
+    snd_pcm_uframes_t avail, avail_min;
+    uint64_t val, ns;
+
+    if (pcm->event_fd == -1)
+        return false;
+
+    /* drain, nothing to read is fine for the non blocking descriptor */
+    if (read(pcm->event_fd, &val, sizeof(val)) < 0 && errno != EAGAIN)
+        AGM_LOGE("%s: event_fd read failed %d\n", __func__, errno);
+
+    /* let waiters see state changes such as xrun or stop */
+    if (io->state != SND_PCM_STATE_RUNNING &&
+        io->state != SND_PCM_STATE_PREPARED) {
+        agm_io_wakeup(pcm);
+        return true;
+    }
+
+    avail_min = pcm->avail_min ? pcm->avail_min : io->period_size;
+    avail = agm_io_avail(pcm);
+    if (avail >= avail_min) {
+        agm_io_wakeup(pcm);
+        return true;
+    }
+
+    if (pcm->mmap_mode && io->state == SND_PCM_STATE_RUNNING) {
+        ns = (uint64_t)(avail_min - avail) * 1000000000ULL / io->rate;
+        its.it_value.tv_sec = ns / 1000000000ULL;
+        its.it_value.tv_nsec = ns % 1000000000ULL;
+        if (!its.it_value.tv_sec && !its.it_value.tv_nsec)
+            its.it_value.tv_nsec = 1;
+        timerfd_settime(pcm->event_fd, 0, &its, NULL);
+    }
+    return false;
+}
+
+static void agm_io_event_cb(uint32_t session_id,
+                            struct agm_event_cb_params *event_params,
+                            void *client_data)
+{
+    struct agmio_priv *pcm = client_data;
+
+    if (!pcm || !event_params)
+        return;
+
+    /* readiness is worked out from the pointers when the client polls */
+    if (event_params->event_id == AGM_EVENT_WRITE_DONE ||
+        event_params->event_id == AGM_EVENT_READ_DONE)
+        agm_io_wakeup(pcm);
+}
+
 static int agm_io_start(snd_pcm_ioplug_t * io)
 {
     struct agmio_priv *pcm = io->private_data;
@@ -106,6 +379,9 @@ static int agm_io_start(snd_pcm_ioplug_t * io)
             pcm->state = AGM_IO_STATE_RUNNING;
     }
 
+    if (!ret && pcm->mmap_mode)
+        agm_io_update_wakeup(pcm);
+
     AGM_LOGD("%s: exit\n", __func__);
     return ret;
 }
@@ -136,6 +412,11 @@ static snd_pcm_sframes_t agm_io_pointer(snd_pcm_ioplug_t * io)
     struct agmio_priv *pcm = io->private_data;
     snd_pcm_sframes_t new_hw_ptr;
 
+    if (pcm->mmap_mode) {
+        pcm->mmap_hw_reported = agm_io_mmap_pointer(pcm);
+        return pcm->mmap_hw_reported;
+    }
+
     new_hw_ptr = pcm->hw_pointer;
     if (io->stream == SND_PCM_STREAM_CAPTURE) {
         if (pcm->hw_pointer == 0)
@@ -162,6 +443,21 @@ static snd_pcm_sframes_t agm_io_transfer(snd_pcm_ioplug_t * io,
     if (ret)
         return ret;
 
+    /*
+     *The DSP reads and writes the shared buffer itself, playback only
+     *copies out of the alsa-lib buffer and capture data is copied in as
+     *the pointer moves. alsa-lib starts the session at start_threshold.
+     */
+    if (pcm->mmap_mode) {
+        if (io->stream == SND_PCM_STREAM_PLAYBACK && pcm->mmap_buf) {
+            agm_io_mmap_copy(pcm, areas, offset, size, true);
+            pcm->mmap_appl = io->appl_ptr + size;
+            if (pcm->boundary && pcm->mmap_appl >= pcm->boundary)
+                pcm->mmap_appl -= pcm->boundary;
+        }
+        return size;
+    }
+
     if (pcm->state != AGM_IO_STATE_RUNNING) {
         ret = agm_io_start(io);
         if (ret)
@@ -183,6 +479,10 @@ static snd_pcm_sframes_t agm_io_transfer(snd_pcm_ioplug_t * io,
     if (pcm->hw_pointer > pcm->boundary)
          pcm->hw_pointer -= pcm->boundary;
 
+    /* a blocking transfer returns once the DSP took the data */
+    if (ret > 0)
+        agm_io_wakeup(pcm);
+
     AGM_LOGD("%s: exit\n", __func__);
     return ret;
 }
@@ -197,8 +497,26 @@ static int agm_io_prepare(snd_pcm_ioplug_t * io)
     if (ret)
         return ret;
 
+    if (pcm->mmap_mode) {
+        ret = agm_io_mmap_setup(pcm);
+        if (ret)
+            return ret;
+    }
+
     ret = agm_session_prepare(handle);
 
+    if (!ret && pcm->mmap_mode) {
+        memset(pcm->mmap_buf, 0, pcm->mmap_len);
+        pcm->mmap_hw = 0;
+        pcm->mmap_hw_reported = 0;
+        agm_pos_tracker_init(&pcm->pos_tracker, pcm->frame_size,
+                             pcm->period_size, pcm->io.buffer_size,
+                             pcm->io.rate, pcm->pos_tracker.retries);
+        pcm->mmap_appl = 0;
+    }
+    if (!ret)
+        agm_io_wakeup(pcm);
+
     AGM_LOGD("%s: exit\n", __func__);
     return ret;
 }
@@ -234,6 +552,11 @@ static int agm_io_hw_params(snd_pcm_ioplug_t * io,
 
     session_config->dir = (io->stream == SND_PCM_STREAM_PLAYBACK) ? RX : TX;
     session_config->sess_mode = sess_mode;
+    if (pcm->mmap_mode) {
+        /* buffers are mapped again for the new geometry at prepare */
+        agm_io_mmap_release(pcm);
+        session_config->data_mode = AGM_DATA_PUSH_PULL;
+    }
     ret = agm_session_set_config(pcm->handle, session_config,
                                  pcm->media_config, pcm->buffer_config);
     if (!ret)
@@ -264,6 +587,7 @@ static int agm_io_sw_params(snd_pcm_ioplug_t *io, snd_pcm_sw_params_t *params)
     snd_pcm_sw_params_get_start_threshold(params, &start_threshold);
     snd_pcm_sw_params_get_stop_threshold(params, &stop_threshold);
     snd_pcm_sw_params_get_boundary(params, &pcm->boundary);
+    snd_pcm_sw_params_get_avail_min(params, &pcm->avail_min);
     session_config->start_threshold = (uint32_t)start_threshold;
     session_config->stop_threshold = (uint32_t)stop_threshold;
     ret = agm_session_set_config(pcm->handle, session_config,
@@ -283,7 +607,11 @@ static int agm_io_close(snd_pcm_ioplug_t * io)
     if (ret)
         return ret;
 
+    agm_session_register_cb(pcm->device, NULL, AGM_EVENT_DATA_PATH, pcm);
+    agm_io_mmap_release(pcm);
     ret = agm_session_close(handle);
+    if (pcm->event_fd != -1)
+        close(pcm->event_fd);
 
     snd_card_def_put_card(pcm->card_node);
     free(pcm->buffer_config);
@@ -316,7 +644,6 @@ static int agm_io_pause(snd_pcm_ioplug_t * io, int enable)
 
 static int agm_io_poll_desc_count(snd_pcm_ioplug_t *io) {
     (void)io;
-    /* TODO : Needed for ULL usecases */
     AGM_LOGD("%s: exit\n", __func__);
     return 1;
 }
@@ -326,18 +653,14 @@ static int agm_io_poll_desc(snd_pcm_ioplug_t *io, struct pollfd *pfd,
 {
     struct agmio_priv *pcm = io->private_data;
 
-    /* TODO : Needed for ULL usecases, Need update */
     if (space != 1) {
         AGM_LOGE("%s space %u is not correct!\n", __func__, space);
         return -EINVAL;
     }
-    if (io->stream == SND_PCM_STREAM_PLAYBACK) {
-        pfd[0].fd = pcm->event_fd;
-        pfd[0].events = POLLOUT;
-    } else {
-        pfd[0].fd = pcm->event_fd;
-        pfd[0].events = POLLIN;
-    }
+
+    /* the descriptor is readable when the pcm is ready in either direction */
+    pfd[0].fd = pcm->event_fd;
+    pfd[0].events = POLLIN;
 
     AGM_LOGD("%s: exit\n", __func__);
     return space;
@@ -348,17 +671,22 @@ static int agm_io_poll_revents(snd_pcm_ioplug_t *io, struct pollfd *pfd,
 {
     struct agmio_priv *pcm = io->private_data;
 
-    /* TODO : Needed for ULL usecases, Need update */
     if (nfds != 1) {
         AGM_LOGE("%s nfds %u is not correct!\n", __func__, nfds);
         return -EINVAL;
     }
 
-    if (pfd[0].revents & POLLIN) {
-        *revents = POLLIN;
-    } else if (pfd[0].revents & POLLOUT) {
-        *revents = POLLOUT;
+    *revents = 0;
+    if (pfd[0].revents & (POLLERR | POLLHUP | POLLNVAL)) {
+        *revents = pfd[0].revents;
+        return 0;
     }
+    if (!(pfd[0].revents & POLLIN))
+        return 0;
+
+    if (agm_io_update_wakeup(pcm))
+        *revents = (io->stream == SND_PCM_STREAM_PLAYBACK) ? POLLOUT : POLLIN;
+
     return 0;
 }
 
@@ -439,6 +767,7 @@ SND_PCM_PLUGIN_DEFINE_FUNC(agm)
     struct agm_buffer_config *buffer_config;
     void *card_node, *pcm_node;
     enum agm_session_mode sess_mode = AGM_SESSION_DEFAULT;
+    bool mmap_mode = false;
     uint64_t handle;
     int ret = 0, session_id = device;
 
@@ -486,6 +815,17 @@ SND_PCM_PLUGIN_DEFINE_FUNC(agm)
             priv->device = device;
             continue;
         }
+        if (strcmp(id, "mmap") == 0) {
+            ret = snd_config_get_bool(n);
+            if (ret < 0) {
+                AGM_LOGE("Invalid type for %s", id);
+                ret = -EINVAL;
+                goto err_free_priv;
+            }
+            mmap_mode = ret;
+            ret = 0;
+            continue;
+        }
     }
 
     card_node = snd_card_def_get_card(card);
@@ -519,10 +859,13 @@ SND_PCM_PLUGIN_DEFINE_FUNC(agm)
     priv->session_config = session_config;
     priv->handle = handle;
     priv->event_fd = -1;
+    priv->mmap_mode = mmap_mode;
+    priv->buf_info.data_buf_fd = -1;
+    priv->buf_info.pos_buf_fd = -1;
     priv->state = AGM_IO_STATE_OPEN;
     priv->io.version = SND_PCM_IOPLUG_VERSION;
     priv->io.name = "AGM PCM I/O Plugin";
-    priv->io.mmap_rw = 0;
+    priv->io.mmap_rw = mmap_mode;
     priv->io.callback = &agm_io_callback;
     priv->io.private_data = priv;
 
@@ -532,12 +875,23 @@ SND_PCM_PLUGIN_DEFINE_FUNC(agm)
         goto err_free_priv;
     }
 
-    if ((priv->event_fd = eventfd(0, EFD_CLOEXEC)) == -1) {
+    if (mmap_mode)
+        priv->event_fd = timerfd_create(CLOCK_MONOTONIC,
+                                        TFD_CLOEXEC | TFD_NONBLOCK);
+    else
+        priv->event_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (priv->event_fd == -1) {
         AGM_LOGE("failed to create event_fd\n");
         ret = -EINVAL;
         goto err_free_priv;
     }
 
+    /* buffer events wake pollers, push pull mode has none */
+    if (!mmap_mode &&
+        agm_session_register_cb(session_id, &agm_io_event_cb,
+                                AGM_EVENT_DATA_PATH, priv))
+        AGM_LOGE("data path events not available, poll relies on transfers\n");
+
     ret = agm_hw_constraint(priv);
     if (ret < 0) {
         snd_pcm_ioplug_delete(&priv->io);
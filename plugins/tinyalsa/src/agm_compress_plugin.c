@@ -47,6 +47,8 @@
 #include <string.h>
 #include <stdarg.h>
 #include <pthread.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
 #include <tinycompress/compress_plugin.h>
 #include <tinycompress/tinycompress.h>
 #include <snd-card-def.h>
@@ -101,6 +103,19 @@ struct agm_compress_priv {
     pthread_mutex_t lock;
     pthread_cond_t poll_cond;
     pthread_mutex_t poll_lock;
+    /* readable while poll would report ready, for client poll loops */
+    int event_fd;
+    bool event_signalled;
+    /* stop or close woke pollers, poll reports an error until restart */
+    bool poll_abort;
+    /*
+     *Playback writes smaller than a fragment are coalesced here and only
+     *whole fragments go to the DSP, partial ones are flushed on drain.
+     *Enabled with "write_staging" in the compress node of the card def.
+     */
+    bool staging;
+    uint8_t *stage_buf;
+    size_t stage_len;
 };
 
 void agm_session_update_codec_options(struct agm_session_config*, struct snd_compr_params *);
@@ -118,6 +133,62 @@ static int agm_get_session_handle(struct agm_compress_priv *priv,
     return 0;
 }
 
+/* readiness of the stream for the next write or read */
+static bool agm_compress_ready(struct agm_compress_priv *priv)
+{
+    bool ready;
+
+    pthread_mutex_lock(&priv->lock);
+    /* capture is ready once a whole fragment came from the DSP unread */
+    if (priv->session_config.dir == TX)
+        ready = priv->bytes_received - priv->bytes_read >=
+                priv->buffer_config.size;
+    else
+        ready = priv->bytes_avail - (int64_t)priv->stage_len >=
+                priv->buffer_config.size;
+    pthread_mutex_unlock(&priv->lock);
+
+    return ready;
+}
+
+/* called with poll_lock held */
+static void agm_compress_update_event_fd_l(struct agm_compress_priv *priv)
+{
+    bool ready = priv->poll_abort || agm_compress_ready(priv);
+    uint64_t val = 1;
+
+    if (priv->event_fd < 0 || ready == priv->event_signalled)
+        return;
+
+    if (ready) {
+        if (write(priv->event_fd, &val, sizeof(val)) < 0)
+            AGM_LOGE("%s: event fd write failed %d\n", __func__, errno);
+    } else {
+        if (read(priv->event_fd, &val, sizeof(val)) < 0)
+            AGM_LOGE("%s: event fd read failed %d\n", __func__, errno);
+    }
+    priv->event_signalled = ready;
+}
+
+static void agm_compress_signal_poll(struct agm_compress_priv *priv,
+                                     bool abort)
+{
+    pthread_mutex_lock(&priv->poll_lock);
+    if (abort)
+        priv->poll_abort = true;
+    agm_compress_update_event_fd_l(priv);
+    pthread_cond_broadcast(&priv->poll_cond);
+    pthread_mutex_unlock(&priv->poll_lock);
+}
+
+static void agm_compress_clear_poll_abort(struct agm_compress_priv *priv)
+{
+    pthread_mutex_lock(&priv->poll_lock);
+    priv->poll_abort = false;
+    agm_compress_update_event_fd_l(priv);
+    pthread_mutex_unlock(&priv->poll_lock);
+}
+
 void agm_compress_event_cb(uint32_t session_id __unused,
                            struct agm_event_cb_params *event_params,
                            void *client_data)
@@ -161,7 +232,10 @@ void agm_compress_event_cb(uint32_t session_id __unused,
             pthread_cond_signal(&priv->drain_cond);
         pthread_mutex_unlock(&priv->drain_lock);
     } else if (event_params->event_id == AGM_EVENT_READ_DONE) {
-        /* Read done cb expected for every DSP read with Fragment size */
+        /*
+         * Read done cb expected for every DSP read with Fragment size,
+         * the captured fragment makes pollers ready once lock is dropped
+         */
         priv->bytes_avail += priv->buffer_config.size;
         priv->bytes_received += priv->buffer_config.size;
     } else if (event_params->event_id == AGM_EVENT_EOS_RENDERED) {
@@ -190,10 +264,112 @@ void agm_compress_event_cb(uint32_t session_id __unused,
            event_params->event_id);
     }
     pthread_mutex_unlock(&priv->lock);
-    /* Signal Poll */
-    pthread_mutex_lock(&priv->poll_lock);
-    pthread_cond_signal(&priv->poll_cond);
-    pthread_mutex_unlock(&priv->poll_lock);
+    agm_compress_signal_poll(priv, false);
+}
+
+/* hand size bytes to the DSP, each started fragment takes a whole one */
+static int agm_compress_submit(struct agm_compress_priv *priv, uint64_t handle,
+                               const void *buff, size_t count)
+{
+    int ret = 0;
+    int64_t size = count, buf_cnt;
+
+    ret = agm_session_write(handle, (void *)buff, (size_t*)&size);
+    if (ret) {
+        errno = ret;
+        return ret;
+    }
+
+    pthread_mutex_lock(&priv->lock);
+    buf_cnt = size / priv->buffer_config.size;
+    if (size % priv->buffer_config.size != 0)
+        buf_cnt +=1;
+
+    /* Avalible buffer size is always multiple of fragment size */
+    priv->bytes_avail -= (buf_cnt * priv->buffer_config.size);
+    if (priv->bytes_avail < 0) {
+        AGM_LOGE("%s: err: bytes_avail = %lld", __func__, (long long) priv->bytes_avail);
+        ret = -EINVAL;
+        goto err;
+    }
+    AGM_LOGV("%s: count = %zu, priv->bytes_avail: %lld\n",
+                     __func__, count, (long long) priv->bytes_avail);
+    priv->bytes_copied += size;
+    ret = size;
+err:
+    pthread_mutex_unlock(&priv->lock);
+
+    return ret;
+}
+
+/* fill the staging fragment first, then send whole fragments as they come */
+static int agm_compress_stage(struct agm_compress_priv *priv, uint64_t handle,
+                              const uint8_t *buff, size_t count)
+{
+    size_t frag = priv->buffer_config.size;
+    size_t len, done = 0;
+    int ret;
+
+    if (priv->stage_len) {
+        len = frag - priv->stage_len;
+        if (len > count)
+            len = count;
+        memcpy(priv->stage_buf + priv->stage_len, buff, len);
+        pthread_mutex_lock(&priv->lock);
+        priv->stage_len += len;
+        pthread_mutex_unlock(&priv->lock);
+        done = len;
+
+        if (priv->stage_len < frag)
+            return done;
+
+        ret = agm_compress_submit(priv, handle, priv->stage_buf, frag);
+        if (ret < 0)
+            return ret;
+        pthread_mutex_lock(&priv->lock);
+        priv->stage_len = 0;
+        pthread_mutex_unlock(&priv->lock);
+    }
+
+    len = ((count - done) / frag) * frag;
+    if (len) {
+        ret = agm_compress_submit(priv, handle, buff + done, len);
+        if (ret < 0)
+            return ret;
+        done += len;
+    }
+
+    if (done < count) {
+        memcpy(priv->stage_buf, buff + done, count - done);
+        pthread_mutex_lock(&priv->lock);
+        priv->stage_len = count - done;
+        pthread_mutex_unlock(&priv->lock);
+        done = count;
+    }
+
+    return done;
+}
+
+/* send a partial staged fragment, before EOS */
+static int agm_compress_flush_stage(struct agm_compress_priv *priv,
+                                    uint64_t handle)
+{
+    int ret;
+
+    if (!priv->stage_len)
+        return 0;
+
+    ret = agm_compress_submit(priv, handle, priv->stage_buf, priv->stage_len);
+    if (ret < 0) {
+        AGM_LOGE("%s: flushing %zu staged bytes failed %d\n", __func__,
+                 priv->stage_len, ret);
+        return ret;
+    }
+
+    pthread_mutex_lock(&priv->lock);
+    priv->stage_len = 0;
+    pthread_mutex_unlock(&priv->lock);
+    return 0;
 }
 
 int agm_compress_write(struct compress_plugin *plugin, const void *buff,
@@ -202,7 +378,6 @@ int agm_compress_write(struct compress_plugin *plugin, const void *buff,
     struct agm_compress_priv *priv = plugin->priv;
     uint64_t handle;
     int ret = 0;
-    int64_t size = count, buf_cnt;
 
     ret = agm_get_session_handle(priv, &handle);
     if (ret)
@@ -211,6 +386,9 @@ int agm_compress_write(struct compress_plugin *plugin, const void *buff,
     if (priv->eos_received)
         priv->eos_received = false;
 
+    if (priv->poll_abort)
+        agm_compress_clear_poll_abort(priv);
+
     if (count > priv->total_buf_size) {
         AGM_LOGE("%s: Size %zu is greater than total buf size %llu\n",
                __func__, count, (unsigned long long) priv->total_buf_size);
@@ -228,30 +406,11 @@ int agm_compress_write(struct compress_plugin *plugin, const void *buff,
         priv->prepared = true;
     }
 
-    ret = agm_session_write(handle, (void *)buff, (size_t*)&size);
-    if (ret) {
-        errno = ret;
-        return ret;
-    }
-
-    pthread_mutex_lock(&priv->lock);
-    buf_cnt = size / priv->buffer_config.size;
-    if (size % priv->buffer_config.size != 0)
-        buf_cnt +=1;
-
-    /* Avalible buffer size is always multiple of fragment size */
-    priv->bytes_avail -= (buf_cnt * priv->buffer_config.size);
-    if (priv->bytes_avail < 0) {
-        AGM_LOGE("%s: err: bytes_avail = %lld", __func__, (long long) priv->bytes_avail);
-        ret = -EINVAL;
-        goto err;
-    }
-    AGM_LOGV("%s: count = %zu, priv->bytes_avail: %lld\n",
-                     __func__, count, (long long) priv->bytes_avail);
-    priv->bytes_copied += size;
-    ret = size;
-err:
-    pthread_mutex_unlock(&priv->lock);
+    if (priv->stage_buf)
+        ret = agm_compress_stage(priv, handle, buff, count);
+    else
+        ret = agm_compress_submit(priv, handle, buff, count);
+    agm_compress_signal_poll(priv, false);
 
     return ret;
 }
@@ -282,6 +441,8 @@ int agm_compress_read(struct compress_plugin *plugin, void *buff, size_t count)
     priv->bytes_read += count;
 
     pthread_mutex_unlock(&priv->lock);
+    /* drain the event fd once no whole fragment is left unread */
+    agm_compress_signal_poll(priv, false);
     AGM_LOGV("Exit: read bytes: %d",count);
     return count;
 }
@@ -336,8 +497,8 @@ int agm_compress_avail(struct compress_plugin *plugin,
     agm_compress_tstamp(plugin, &avail->tstamp);
 
     pthread_mutex_lock(&priv->lock);
-    /* Avail size is always in multiples of fragment size */
-    avail->avail = priv->bytes_avail;
+    /* Avail size is in multiples of fragment size, less what is staged */
+    avail->avail = priv->bytes_avail - priv->stage_len;
     AGM_LOGV("%s: size = %zu, *avail = %llu, pcm_io_frames: %d \
              sampling_rate: %u\n", __func__,
              sizeof(struct snd_compr_avail), avail->avail,
@@ -509,6 +670,15 @@ int agm_compress_set_params(struct compress_plugin *plugin,
     buf_cfg->max_metadata_size = 0;
     priv->total_buf_size = buf_cfg->size * buf_cfg->count;
 
+    free(priv->stage_buf);
+    priv->stage_buf = NULL;
+    priv->stage_len = 0;
+    if (priv->staging && priv->session_config.dir == RX) {
+        priv->stage_buf = calloc(1, buf_cfg->size);
+        if (!priv->stage_buf)
+            return -ENOMEM;
+    }
+
     sess_cfg = &priv->session_config;
 
     if (sess_cfg->dir == RX)
@@ -591,6 +761,7 @@ static int agm_compress_start(struct compress_plugin *plugin)
         priv->prepared = true;
     }
 
+    agm_compress_clear_poll_abort(priv);
     ret = agm_session_start(handle);
     if (ret)
         errno = ret;
@@ -624,10 +795,7 @@ static int agm_compress_stop(struct compress_plugin *plugin)
     }
     pthread_mutex_unlock(&priv->early_eos_lock);
 
-    /* Signal Poll */
-    pthread_mutex_lock(&priv->poll_lock);
-    pthread_cond_signal(&priv->poll_cond);
-    pthread_mutex_unlock(&priv->poll_lock);
+    agm_compress_signal_poll(priv, true);
 
     ret = agm_session_stop(handle);
     if (ret) {
@@ -637,6 +805,7 @@ static int agm_compress_stop(struct compress_plugin *plugin)
     /* stop will reset all the buffers and it called during seek also */
     priv->bytes_avail = priv->total_buf_size;
     priv->bytes_copied = 0;
+    priv->stage_len = 0;
 
     return ret;
 }
@@ -685,6 +854,12 @@ static int agm_compress_drain(struct compress_plugin *plugin)
      * write and EOS cmds are sequential
      */
     /* TODO: how to handle wake up in SSR scenario */
+    ret = agm_compress_flush_stage(priv, handle);
+    if (ret) {
+        errno = ret;
+        return ret;
+    }
+
     pthread_mutex_lock(&priv->eos_lock);
     if (!priv->eos_received) {
         priv->eos = true;
@@ -714,6 +889,10 @@ static int agm_compress_partial_drain(struct compress_plugin *plugin)
     if (ret)
         return ret;
 
+    ret = agm_compress_flush_stage(priv, handle);
+    if (ret)
+        return ret;
+
     // Send EOS command and wait for EARLY EOS event
     pthread_mutex_lock(&priv->early_eos_lock);
     priv->early_eos = true;
@@ -759,6 +938,13 @@ static int agm_compress_ioctl(struct compress_plugin *plugin, int cmd, ...)
     case SNDRV_COMPRESS_SET_METADATA:
         ret = agm_compress_set_metadata(plugin, arg);
         break;
+    case SNDRV_COMPRESS_GET_METADATA:
+        if (((struct snd_compr_metadata *)arg)->key ==
+            AGM_COMPRESS_METADATA_POLL_FD)
+            ((struct snd_compr_metadata *)arg)->value[0] = priv->event_fd;
+        else
+            ret = -EINVAL;
+        break;
     default:
         break;
     }
@@ -772,32 +958,48 @@ static int agm_compress_poll(struct compress_plugin *plugin,
 {
     struct agm_compress_priv *priv = plugin->priv;
     uint64_t handle;
-    struct timespec poll_ts;
+    struct timespec deadline;
+    short events;
     int ret = 0;
 
     ret = agm_get_session_handle(priv, &handle);
     if (ret)
         return ret;
 
-    clock_gettime(CLOCK_MONOTONIC, &poll_ts);
-    poll_ts.tv_sec += timeout/1000;
-    /* Unblock poll wait if avail bytes to write/read is more than one fragment */
+    if (timeout > 0) {
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_sec += timeout / 1000;
+        deadline.tv_nsec += (timeout % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+    }
+
+    /* Wait until a fragment can be written/read, stop or close */
     pthread_mutex_lock(&priv->poll_lock);
-    /* If timeout is -1 then its infinite wait */
-    if (timeout < 0)
-        ret = pthread_cond_wait(&priv->poll_cond, &priv->poll_lock);
-    else
-        ret = pthread_cond_timedwait(&priv->poll_cond, &priv->poll_lock, &poll_ts);
+    while (!priv->poll_abort && !agm_compress_ready(priv)) {
+        /* If timeout is -1 then its infinite wait */
+        if (timeout < 0)
+            ret = pthread_cond_wait(&priv->poll_cond, &priv->poll_lock);
+        else if (timeout == 0)
+            ret = ETIMEDOUT;
+        else
+            ret = pthread_cond_timedwait(&priv->poll_cond, &priv->poll_lock,
+                                         &deadline);
+        if (ret == ETIMEDOUT)
+            break;
+    }
+
+    events = (priv->session_config.dir == RX) ? POLLOUT : POLLIN;
+    if (priv->poll_abort)
+        fds->revents |= events | POLLERR;
+    else if (ret != ETIMEDOUT)
+        fds->revents |= events;
     pthread_mutex_unlock(&priv->poll_lock);
 
-    if (ret == ETIMEDOUT) {
-        /* Poll() expects 0 return value in case of timeout */
-        ret = 0;
-    } else {
-        fds->revents |= POLLOUT;
-        ret = POLLOUT;
-    }
-    return ret;
+    /* Poll() expects 0 return value in case of timeout */
+    return fds->revents ? 1 : 0;
 }
 
 void agm_compress_close(struct compress_plugin *plugin)
@@ -839,10 +1041,10 @@ void agm_compress_close(struct compress_plugin *plugin)
     }
     pthread_mutex_unlock(&priv->early_eos_lock);
 
-    /* Signal Poll */
-    pthread_mutex_lock(&priv->poll_lock);
-    pthread_cond_signal(&priv->poll_cond);
-    pthread_mutex_unlock(&priv->poll_lock);
+    agm_compress_signal_poll(priv, true);
+    if (priv->event_fd >= 0)
+        close(priv->event_fd);
+    free(priv->stage_buf);
 
     /* Make sure callbacks are not running at this point */
     free(plugin->priv);
@@ -911,8 +1113,9 @@ COMPRESS_PLUGIN_OPEN_FN(agm_compress_plugin)
     struct agm_compress_priv *priv;
     uint64_t handle;
     int ret = 0, session_id = device;
-    int is_playback = 0, is_capture = 0, sess_mode = 0;
+    int is_playback = 0, is_capture = 0, sess_mode = 0, write_staging = 0;
     void *card_node, *compr_node;
+    pthread_condattr_t cond_attr;
 
     AGM_LOGV("%s: session_id: %d \n", __func__, device);
     agm_compress_plugin = calloc(1, sizeof(struct compress_plugin));
@@ -958,6 +1161,11 @@ COMPRESS_PLUGIN_OPEN_FN(agm_compress_plugin)
     if (ret)
        goto err_card_put;
 
+    /* optional, off unless the card def asks for it */
+    if (!snd_card_def_get_int(agm_compress_plugin->node, "write_staging",
+                              &write_staging))
+        priv->staging = !!write_staging;
+
     priv->session_config.sess_mode = sess_mode;
     priv->session_config.dir = (flags & COMPRESS_IN) ? RX : TX;
     priv->session_id = session_id;
@@ -975,10 +1183,17 @@ COMPRESS_PLUGIN_OPEN_FN(agm_compress_plugin)
         goto err_card_put;
     }
 
+    priv->event_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (priv->event_fd < 0) {
+        ret = -errno;
+        AGM_LOGE("%s: failed to create event fd %d\n", __func__, ret);
+        goto err_card_put;
+    }
+
     ret = agm_session_open(session_id, sess_mode, &handle);
     if (ret) {
         errno = ret;
-        goto err_card_put;
+        goto err_event_fd;
     }
 
     // TODO introduce nonblock flag here
@@ -1008,11 +1223,20 @@ COMPRESS_PLUGIN_OPEN_FN(agm_compress_plugin)
     pthread_mutex_init(&priv->drain_lock, (const pthread_mutexattr_t *) NULL);
     pthread_mutex_init(&priv->poll_lock, (const pthread_mutexattr_t *) NULL);
     pthread_mutex_init(&priv->early_eos_lock, (const pthread_mutexattr_t *) NULL);
+    /* poll deadlines are on the monotonic clock */
+    pthread_condattr_init(&cond_attr);
+    pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&priv->poll_cond, &cond_attr);
+    pthread_condattr_destroy(&cond_attr);
+    /* playback can take a fragment right away */
+    agm_compress_signal_poll(priv, false);
 
     return 0;
 
 err_sess_cls:
     agm_session_close(handle);
+err_event_fd:
+    close(priv->event_fd);
 err_card_put:
     snd_card_def_put_card(card_node);
 err_priv_free:
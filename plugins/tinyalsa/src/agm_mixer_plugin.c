@@ -40,6 +40,8 @@
 #include <sys/ioctl.h>
 #include <sys/time.h>
 #include <limits.h>
+#include <pthread.h>
+#include <dlfcn.h>
 #include <linux/ioctl.h>
 
 #include <sound/asound.h>
@@ -48,6 +50,7 @@
 #include <tinyalsa/mixer_plugin.h>
 
 #include <agm/agm_api.h>
+#include <agm/agm_xrun.h>
 #include <snd-card-def.h>
 
 #include <agm/agm_list.h>
@@ -113,6 +116,8 @@ enum {
     PCM_CTL_NAME_SET_CALIBRATION,
     PCM_CTL_NAME_GET_PARAM,
     PCM_CTL_NAME_BUF_INFO,
+    PCM_CTL_NAME_TRANSACTION,
+    PCM_CTL_NAME_XRUN,
     /* Add new ones here */
 };
 
@@ -130,6 +135,8 @@ static char *amp_pcm_ctl_name_extn[] = {
     "setCalibration",
     "getParam",
     "getBufInfo",
+    "transaction",
+    "xrun",
     /* Add new ones below, be sure to update enum as well */
 };
 
@@ -168,22 +175,73 @@ struct amp_dev_info {
     char **names;
     int *idx_arr;
     int count;
+    /* position in names/idx_arr of each PCM id, 0 if none, PCMs only */
+    int *id_to_pos;
+    int max_id;
+    /* enum amp_event_policy of each PCM, from "event_policy" in card def */
+    int *event_policy;
     struct snd_value_enum dev_enum;
     enum direction dir;
+};
+
+/*
+ * DSP events of a PCM wait in a ring of AMP_EVENT_RING_SLOTS until the
+ * "<pcm> event" control is read. What happens to an event arriving at a
+ * full ring is set per PCM by "event_policy" in the card def:
+ *   fifo     - the oldest pending event is dropped (default)
+ *   drop     - the new event is dropped
+ *   coalesce - the new event replaces a pending one from the same module
+ *              with the same event id, else it is handled as fifo
+ */
+#define AMP_EVENT_RING_SLOTS    8
+#define AMP_EVENT_MAX_PAYLOAD   (128 * 1024 - sizeof(struct agm_event_cb_params))
+
+enum amp_event_policy {
+    AMP_EVENT_POLICY_FIFO = 0,
+    AMP_EVENT_POLICY_DROP,
+    AMP_EVENT_POLICY_COALESCE,
+};
+
+static char *amp_event_policy_names[] = {
+    [AMP_EVENT_POLICY_FIFO] = "fifo",
+    [AMP_EVENT_POLICY_DROP] = "drop",
+    [AMP_EVENT_POLICY_COALESCE] = "coalesce",
+};
 
+struct amp_event_slot {
+    struct agm_event_cb_params *params;
+    /* payload bytes params has room for, buffers only grow */
+    uint32_t payload_cap;
+};
+
+struct amp_event_ring {
+    uint32_t session_id;
+    enum amp_event_policy policy;
+    struct amp_event_slot slots[AMP_EVENT_RING_SLOTS];
+    uint32_t head;
+    uint32_t count;
+    uint32_t dropped;
+    /* ring is in the notification queue of the mixer */
+    bool notify_pending;
+    char ctl_name[SNDRV_CTL_ELEM_ID_NAME_MAXLEN];
+};
+
+/* Values the controls of one amp_dev_info hold, kept per mixer */
+struct amp_ctl_cache {
     /*
      * Mixer ctl data cache for
      * "pcm<id> metadata_control"
-     * Unused for BE devs
      */
     int *pcm_mtd_ctl;
 
     /*
      * Mixer ctl data cache for
      * "pcm<id> getParam"
-     * Unused for BE devs
      */
     struct amp_get_param_info *get_param_info;
+
+    /* event ring of each pcm, indexed like the pcm dev info */
+    struct amp_event_ring *event_rings;
 };
 
 struct amp_be_group_info {
@@ -192,13 +250,18 @@ struct amp_be_group_info {
     int count;
 };
 
-struct amp_priv {
+/*
+ * Device info and controls of a card. They only depend on the card def
+ * and the AGM backends, so they are formed by the first mixer opened on
+ * the card and shared by all mixers of the card until the last one closes.
+ */
+struct amp_card_ctls {
+    struct listnode node;
     unsigned int card;
+    int refs;
     void *card_node;
 
     struct aif_info *aif_list;
-    struct listnode events_list;
-    struct listnode events_paramlist;
 
     struct amp_dev_info rx_be_devs;
     struct amp_dev_info tx_be_devs;
@@ -211,6 +274,24 @@ struct amp_priv {
     struct snd_control *ctls;
     char (*ctl_names)[AIF_NAME_MAX_LEN + 16];
     int ctl_count;
+};
+
+static pthread_mutex_t amp_card_ctls_lock = PTHREAD_MUTEX_INITIALIZER;
+static list_declare(amp_card_ctls_list);
+
+struct amp_priv {
+    unsigned int card;
+    struct amp_card_ctls *card_ctls;
+
+    /* rings with events not yet notified, in arrival order */
+    struct amp_event_ring **notify_queue;
+    uint32_t notify_size;
+    uint32_t notify_head;
+    uint32_t notify_count;
+
+    struct amp_ctl_cache rx_pcm_cache;
+    struct amp_ctl_cache tx_pcm_cache;
+    struct amp_ctl_cache acdb_cache;
 
     struct snd_value_enum tx_be_enum;
     struct snd_value_enum rx_be_enum;
@@ -219,17 +300,6 @@ struct amp_priv {
     pthread_mutex_t lock;
 };
 
-struct event_params_node {
-    uint32_t session_id;
-    struct listnode node;
-    struct agm_event_cb_params event_params;
-};
-
-struct mixer_plugin_event_data {
-    struct ctl_event ev;
-    struct listnode node;
-};
-
 static enum agm_media_format alsa_to_agm_fmt(int fmt)
 {
     enum agm_media_format agm_pcm_fmt = AGM_FORMAT_INVALID;
@@ -259,9 +329,24 @@ static struct amp_dev_info *amp_get_be_adi(struct amp_priv *amp_priv,
                 enum direction dir)
 {
     if (dir == RX)
-        return &amp_priv->rx_be_devs;
+        return &amp_priv->card_ctls->rx_be_devs;
     else if (dir == TX)
-        return &amp_priv->tx_be_devs;
+        return &amp_priv->card_ctls->tx_be_devs;
+
+    return NULL;
+}
+
+static struct amp_ctl_cache *amp_get_ctl_cache(struct amp_priv *amp_priv,
+                struct amp_dev_info *adi)
+{
+    struct amp_card_ctls *card_ctls = amp_priv->card_ctls;
+
+    if (adi == &card_ctls->rx_pcm_devs)
+        return &amp_priv->rx_pcm_cache;
+    else if (adi == &card_ctls->tx_pcm_devs)
+        return &amp_priv->tx_pcm_cache;
+    else if (adi == &card_ctls->acdb_tunnels)
+        return &amp_priv->acdb_cache;
 
     return NULL;
 }
@@ -278,33 +363,101 @@ static void amp_free_dev_info(struct amp_dev_info *adi)
         adi->idx_arr = NULL;
     }
 
-    if (adi->pcm_mtd_ctl) {
-        free(adi->pcm_mtd_ctl);
-        adi->pcm_mtd_ctl = NULL;
+    if (adi->id_to_pos) {
+        free(adi->id_to_pos);
+        adi->id_to_pos = NULL;
     }
 
-    if (adi->get_param_info) {
-        free(adi->get_param_info);
-        adi->get_param_info = NULL;
+    if (adi->event_policy) {
+        free(adi->event_policy);
+        adi->event_policy = NULL;
     }
 
     adi->count = 0;
+    adi->max_id = 0;
+}
+
+static void amp_free_ctl_cache(struct amp_ctl_cache *cache, int count)
+{
+    int i, j;
+
+    if (cache->pcm_mtd_ctl) {
+        free(cache->pcm_mtd_ctl);
+        cache->pcm_mtd_ctl = NULL;
+    }
+
+    if (cache->get_param_info) {
+        for (i = 0; i < count; i++)
+            free(cache->get_param_info[i].get_param_payload);
+        free(cache->get_param_info);
+        cache->get_param_info = NULL;
+    }
+
+    if (cache->event_rings) {
+        for (i = 0; i < count; i++) {
+            for (j = 0; j < AMP_EVENT_RING_SLOTS; j++)
+                free(cache->event_rings[i].slots[j].params);
+        }
+        free(cache->event_rings);
+        cache->event_rings = NULL;
+    }
+}
+
+static int amp_alloc_ctl_cache(struct amp_ctl_cache *cache, int count,
+                bool mtd_ctl)
+{
+    if (mtd_ctl) {
+        cache->pcm_mtd_ctl = calloc(count, sizeof(int));
+        if (!cache->pcm_mtd_ctl)
+            return -ENOMEM;
+    }
+
+    cache->get_param_info = (struct amp_get_param_info *)calloc(count,
+                                sizeof(struct amp_get_param_info));
+    if (!cache->get_param_info) {
+        amp_free_ctl_cache(cache, 0);
+        return -ENOMEM;
+    }
+
+    return 0;
+}
+
+static int amp_alloc_event_rings(struct amp_ctl_cache *cache,
+                struct amp_dev_info *adi)
+{
+    struct amp_event_ring *ring;
+    int i;
+
+    cache->event_rings = calloc(adi->count, sizeof(*cache->event_rings));
+    if (!cache->event_rings)
+        return -ENOMEM;
+
+    /* entry 0 is the ZERO device and never gets events */
+    for (i = 1; i < adi->count; i++) {
+        ring = &cache->event_rings[i];
+        ring->session_id = adi->idx_arr[i];
+        ring->policy = adi->event_policy[i];
+        snprintf(ring->ctl_name, sizeof(ring->ctl_name), "%s %s",
+                 adi->names[i], amp_pcm_ctl_name_extn[PCM_CTL_NAME_EVENT]);
+    }
+
+    return 0;
 }
 
-static void amp_free_be_dev_info(struct amp_priv *amp_priv)
+static void amp_free_be_dev_info(struct amp_card_ctls *card_ctls)
 {
-    amp_free_dev_info(&amp_priv->rx_be_devs);
-    amp_free_dev_info(&amp_priv->tx_be_devs);
+    amp_free_dev_info(&card_ctls->rx_be_devs);
+    amp_free_dev_info(&card_ctls->tx_be_devs);
 
-    if (amp_priv->aif_list) {
-        free(amp_priv->aif_list);
-        amp_priv->aif_list = NULL;
+    if (card_ctls->aif_list) {
+        free(card_ctls->aif_list);
+        card_ctls->aif_list = NULL;
     }
 }
 
-static void amp_free_group_be_dev_info(struct amp_priv *amp_priv)
+static void amp_free_group_be_dev_info(struct amp_card_ctls *card_ctls)
 {
-    struct amp_be_group_info *grp_info = &amp_priv->group_be_devs;
+    struct amp_be_group_info *grp_info = &card_ctls->group_be_devs;
     int i;
 
     if (grp_info->names) {
@@ -322,52 +475,132 @@ static void amp_free_group_be_dev_info(struct amp_priv *amp_priv)
     }
 }
 
-static void amp_free_acdb_dev_info(struct amp_priv *amp_priv)
+static void amp_free_acdb_dev_info(struct amp_card_ctls *card_ctls)
 {
-    amp_free_dev_info(&amp_priv->acdb_tunnels);
+    amp_free_dev_info(&card_ctls->acdb_tunnels);
 }
 
-static void amp_free_pcm_dev_info(struct amp_priv *amp_priv)
+static void amp_free_pcm_dev_info(struct amp_card_ctls *card_ctls)
 {
-    amp_free_dev_info(&amp_priv->rx_pcm_devs);
-    amp_free_dev_info(&amp_priv->tx_pcm_devs);
+    amp_free_dev_info(&card_ctls->rx_pcm_devs);
+    amp_free_dev_info(&card_ctls->tx_pcm_devs);
 }
 
-static void amp_free_ctls(struct amp_priv *amp_priv)
+static void amp_free_ctls(struct amp_card_ctls *card_ctls)
 {
-    if (amp_priv->ctl_names) {
-        free(amp_priv->ctl_names);
-        amp_priv->ctl_names = NULL;
+    if (card_ctls->ctl_names) {
+        free(card_ctls->ctl_names);
+        card_ctls->ctl_names = NULL;
     }
 
-    if (amp_priv->ctls) {
-        free(amp_priv->ctls);
-        amp_priv->ctls = NULL;
+    if (card_ctls->ctls) {
+        free(card_ctls->ctls);
+        card_ctls->ctls = NULL;
     }
 
-    amp_priv->ctl_count = 0;
+    card_ctls->ctl_count = 0;
+}
+
+/* called with amp_priv lock held */
+static void amp_queue_event_notify(struct amp_priv *amp_priv,
+                                   struct amp_event_ring *ring)
+{
+    uint32_t tail;
+
+    if (ring->notify_pending)
+        return;
+
+    tail = (amp_priv->notify_head + amp_priv->notify_count) %
+           amp_priv->notify_size;
+    amp_priv->notify_queue[tail] = ring;
+    amp_priv->notify_count++;
+    ring->notify_pending = true;
 }
 
-static void amp_add_event_params(struct amp_priv *amp_priv,
-                                 uint32_t session_id,
+/* called with amp_priv lock held, returns false if the event was dropped */
+static bool amp_add_event_params(struct amp_event_ring *ring,
                                  struct agm_event_cb_params *event_params)
 {
-    struct event_params_node *event_node;
     struct agm_event_cb_params *eparams;
+    struct amp_event_slot *slot = NULL;
     uint32_t len = event_params->event_payload_size;
+    bool added = false;
+    uint32_t i;
+
+    if (len > AMP_EVENT_MAX_PAYLOAD)
+        return false;
+
+    if (ring->policy == AMP_EVENT_POLICY_COALESCE) {
+        for (i = 0; i < ring->count; i++) {
+            eparams = ring->slots[(ring->head + i) % AMP_EVENT_RING_SLOTS].params;
+            if (eparams->source_module_id == event_params->source_module_id &&
+                eparams->event_id == event_params->event_id) {
+                slot = &ring->slots[(ring->head + i) % AMP_EVENT_RING_SLOTS];
+                break;
+            }
+        }
+    }
 
-    event_node = calloc(1, sizeof(struct event_params_node) + len);
-    if (!event_node)
-        return;
+    if (!slot && ring->count == AMP_EVENT_RING_SLOTS) {
+        if (ring->policy == AMP_EVENT_POLICY_DROP)
+            return false;
+        /* make room by dropping the oldest */
+        ring->head = (ring->head + 1) % AMP_EVENT_RING_SLOTS;
+        ring->count--;
+        ring->dropped++;
+    }
+
+    if (!slot) {
+        slot = &ring->slots[(ring->head + ring->count) % AMP_EVENT_RING_SLOTS];
+        ring->count++;
+        added = true;
+    }
+
+    if (!slot->params || slot->payload_cap < len) {
+        eparams = realloc(slot->params,
+                          sizeof(struct agm_event_cb_params) + len);
+        if (!eparams) {
+            /* a new slot is the newest one, give it back */
+            if (added)
+                ring->count--;
+            return false;
+        }
+        slot->params = eparams;
+        slot->payload_cap = len;
+    }
 
-    event_node->session_id = session_id;
-    eparams = &event_node->event_params;
+    eparams = slot->params;
     eparams->source_module_id = event_params->source_module_id;
     eparams->event_id = event_params->event_id;
     eparams->event_payload_size = len;
-
     memcpy(&eparams->event_payload, &event_params->event_payload, len);
-    list_add_tail(&amp_priv->events_paramlist, &event_node->node);
+
+    return true;
+}
+
+/* called with amp_priv lock held */
+static struct amp_event_ring *amp_get_event_ring(struct amp_priv *amp_priv,
+                                                 uint32_t session_id)
+{
+    struct amp_card_ctls *card_ctls = amp_priv->card_ctls;
+    struct amp_dev_info *adi;
+    int pos;
+
+    adi = &card_ctls->rx_pcm_devs;
+    if (session_id <= adi->max_id) {
+        pos = adi->id_to_pos[session_id];
+        if (pos > 0)
+            return &amp_priv->rx_pcm_cache.event_rings[pos];
+    }
+
+    adi = &card_ctls->tx_pcm_devs;
+    if (session_id <= adi->max_id) {
+        pos = adi->id_to_pos[session_id];
+        if (pos > 0)
+            return &amp_priv->tx_pcm_cache.event_rings[pos];
+    }
+
+    return NULL;
 }
 
 void amp_event_cb(uint32_t session_id, struct agm_event_cb_params *event_params,
@@ -375,13 +608,8 @@ void amp_event_cb(uint32_t session_id, struct agm_event_cb_params *event_params,
 {
     struct mixer_plugin *plugin = client_data;
     struct amp_priv *amp_priv;
-    struct ctl_event event;
-    struct mixer_plugin_event_data *data;
-    char *stream = NULL;
-    char *ctl_name = "event";
-    char *mixer_str = NULL;
-    int ctl_len, i;
-    struct amp_dev_info *adi = NULL;
+    struct amp_event_ring *ring;
+    bool added;
 
     if (!plugin)
         return;
@@ -393,56 +621,26 @@ void amp_event_cb(uint32_t session_id, struct agm_event_cb_params *event_params,
     if (!amp_priv)
         return;
 
-    /* Get device node name
-     * Check Rx device nodes followed by Tx.
-     */
-    adi = &amp_priv->rx_pcm_devs;
-    for (i = 0; i < adi->count; i++) {
-        if(adi->idx_arr[i] == session_id) {
-            stream = adi->names[i];
-            goto found;
-        }
-    }
-
-    adi = &amp_priv->tx_pcm_devs;
-    for (i = 0; i < adi->count; i++) {
-        if(adi->idx_arr[i] == session_id) {
-            stream = adi->names[i];
-            goto found;
-        }
-    }
-
-    if (!stream)
-        return;
-found:
     pthread_mutex_lock(&amp_priv->lock);
-    amp_add_event_params(amp_priv, session_id, event_params);
-    event.type = SNDRV_CTL_EVENT_ELEM;
-    ctl_len = (int)(strlen(stream) + 1 + strlen(ctl_name) + 1);
-    mixer_str = calloc(1, ctl_len);
-    if (!mixer_str) {
+    ring = amp_get_event_ring(amp_priv, session_id);
+    if (!ring) {
         pthread_mutex_unlock(&amp_priv->lock);
         return;
     }
 
-    snprintf(mixer_str, ctl_len, "%s %s", stream, ctl_name);
-    strlcpy((char*)event.data.elem.id.name, mixer_str, sizeof(event.data.elem.id.name));
-
-    data = calloc(1, sizeof(struct mixer_plugin_event_data));
-    if (!data) {
-        pthread_mutex_unlock(&amp_priv->lock);
-        goto done;
+    added = amp_add_event_params(ring, event_params);
+    if (!added) {
+        ring->dropped++;
+        AGM_LOGV("%s: event %x of module %x dropped for %s, %u so far\n",
+                 __func__, event_params->event_id,
+                 event_params->source_module_id, ring->ctl_name,
+                 ring->dropped);
     }
-
-    data->ev = event;
-    list_add_tail(&amp_priv->events_list, &data->node);
+    amp_queue_event_notify(amp_priv, ring);
     pthread_mutex_unlock(&amp_priv->lock);
 
-    if (amp_priv->event_cb)
+    if (added && amp_priv->event_cb)
         amp_priv->event_cb(plugin);
-
-done:
-    free(mixer_str);
 }
 
 static void amp_copy_be_names_from_aif_list(struct aif_info *aif_list,
@@ -486,10 +684,10 @@ static void amp_copy_group_be_names_from_aif_list(struct aif_info *aif_list,
     }
 }
 
-static int amp_get_be_info(struct amp_priv *amp_priv)
+static int amp_get_be_info(struct amp_card_ctls *card_ctls)
 {
-    struct amp_dev_info *rx_adi = &amp_priv->rx_be_devs;
-    struct amp_dev_info *tx_adi = &amp_priv->tx_be_devs;
+    struct amp_dev_info *rx_adi = &card_ctls->rx_be_devs;
+    struct amp_dev_info *tx_adi = &card_ctls->tx_be_devs;
     struct aif_info *aif_list, *aif_info;
     size_t be_count = 0;
     int ret = 0, i;
@@ -533,19 +731,19 @@ static int amp_get_be_info(struct amp_priv *amp_priv)
     amp_copy_be_names_from_aif_list(aif_list, be_count, rx_adi, RX);
     amp_copy_be_names_from_aif_list(aif_list, be_count, tx_adi, TX);
 
-    amp_priv->aif_list = aif_list;
+    card_ctls->aif_list = aif_list;
     return 0;
 
 err_backends_get:
     if (aif_list)
         free(aif_list);
-    amp_free_be_dev_info(amp_priv);
+    amp_free_be_dev_info(card_ctls);
     return ret;
 }
 
-static int amp_get_group_be_info(struct amp_priv *amp_priv)
+static int amp_get_group_be_info(struct amp_card_ctls *card_ctls)
 {
-    struct amp_be_group_info *grp_info = &amp_priv->group_be_devs;
+    struct amp_be_group_info *grp_info = &card_ctls->group_be_devs;
     struct aif_info *aif_list = NULL;
     size_t group_be_count = 0;
     int ret = 0, i;
@@ -581,14 +779,15 @@ static int amp_get_group_be_info(struct amp_priv *amp_priv)
 err_backends_get:
     if (aif_list)
         free(aif_list);
-    amp_free_group_be_dev_info(amp_priv);
+    amp_free_group_be_dev_info(card_ctls);
     return ret;
 }
 
 static int amp_create_pcm_info_from_card(struct amp_dev_info *adi,
             const char *dir, int num_pcms, void **pcm_node_list)
 {
-    int ret, i, val = 0, idx = 0;
+    int ret, i, j, val = 0, idx = 0;
+    char *policy;
 
     adi->names[idx] =  "ZERO";
     adi->idx_arr[idx] = 0;
@@ -617,29 +816,51 @@ static int amp_create_pcm_info_from_card(struct amp_dev_info *adi,
             return -EINVAL;
         }
 
+        /* optional, fifo unless the card def asks otherwise */
+        if (!snd_card_def_get_str(pcm_node, "event_policy", &policy)) {
+            for (j = 0; j < (int)ARRAY_SIZE(amp_event_policy_names); j++) {
+                if (!strcmp(policy, amp_event_policy_names[j]))
+                    adi->event_policy[idx] = j;
+            }
+        }
+
         idx++;
     }
 
     adi->count = idx;
 
+    for (i = 1; i < adi->count; i++) {
+        if (adi->idx_arr[i] > adi->max_id)
+            adi->max_id = adi->idx_arr[i];
+    }
+
+    adi->id_to_pos = calloc(adi->max_id + 1, sizeof(*adi->id_to_pos));
+    if (!adi->id_to_pos)
+        return -ENOMEM;
+
+    for (i = 1; i < adi->count; i++) {
+        if (adi->idx_arr[i] >= 0)
+            adi->id_to_pos[adi->idx_arr[i]] = i;
+    }
+
     return 0;
 }
 
-static int amp_get_pcm_info(struct amp_priv *amp_priv)
+static int amp_get_pcm_info(struct amp_card_ctls *card_ctls)
 {
-    struct amp_dev_info *rx_adi = &amp_priv->rx_pcm_devs;
-    struct amp_dev_info *tx_adi = &amp_priv->tx_pcm_devs;
+    struct amp_dev_info *rx_adi = &card_ctls->rx_pcm_devs;
+    struct amp_dev_info *tx_adi = &card_ctls->tx_pcm_devs;
     void **pcm_node_list = NULL;
     int num_pcms = 0, num_compr = 0, total_pcms, ret, val = 0, i;
 
     /* Get both pcm and compressed node count */
-    num_pcms = snd_card_def_get_num_node(amp_priv->card_node,
+    num_pcms = snd_card_def_get_num_node(card_ctls->card_node,
                                          SND_NODE_TYPE_PCM);
-    num_compr = snd_card_def_get_num_node(amp_priv->card_node,
+    num_compr = snd_card_def_get_num_node(card_ctls->card_node,
                                           SND_NODE_TYPE_COMPR);
     if (num_pcms <= 0 && num_compr <= 0) {
         AGM_LOGE("%s: no pcms(%d)/compr(%d) nodes found for card %u\n",
-               __func__, num_pcms, num_compr, amp_priv->card);
+               __func__, num_pcms, num_compr, card_ctls->card);
         ret = -EINVAL;
         goto done;
     }
@@ -661,7 +882,7 @@ static int amp_get_pcm_info(struct amp_priv *amp_priv)
     }
 
     if (num_pcms > 0) {
-        ret = snd_card_def_get_nodes_for_type(amp_priv->card_node,
+        ret = snd_card_def_get_nodes_for_type(card_ctls->card_node,
                                               SND_NODE_TYPE_PCM,
                                               pcm_node_list, num_pcms);
         if (ret) {
@@ -672,7 +893,7 @@ static int amp_get_pcm_info(struct amp_priv *amp_priv)
     }
 
     if (num_compr > 0) {
-        ret = snd_card_def_get_nodes_for_type(amp_priv->card_node,
+        ret = snd_card_def_get_nodes_for_type(card_ctls->card_node,
                                               SND_NODE_TYPE_COMPR,
                                               &pcm_node_list[num_pcms],
                                               num_compr);
@@ -707,9 +928,14 @@ static int amp_get_pcm_info(struct amp_priv *amp_priv)
     rx_adi->idx_arr = calloc(rx_adi->count + 1, sizeof(*rx_adi->idx_arr));
     tx_adi->names = calloc(tx_adi->count + 1, sizeof(*tx_adi->names));
     tx_adi->idx_arr = calloc(tx_adi->count + 1, sizeof(*tx_adi->idx_arr));
+    rx_adi->event_policy = calloc(rx_adi->count + 1,
+                                  sizeof(*rx_adi->event_policy));
+    tx_adi->event_policy = calloc(tx_adi->count + 1,
+                                  sizeof(*tx_adi->event_policy));
 
     if (!rx_adi->names || !tx_adi->names ||
-        !rx_adi->idx_arr || !tx_adi->idx_arr) {
+        !rx_adi->idx_arr || !tx_adi->idx_arr ||
+        !rx_adi->event_policy || !tx_adi->event_policy) {
         ret = -ENOMEM;
         goto err_alloc_rx_tx;
     }
@@ -733,7 +959,7 @@ static int amp_get_pcm_info(struct amp_priv *amp_priv)
     goto done;
 
 err_alloc_rx_tx:
-    amp_free_pcm_dev_info(amp_priv);
+    amp_free_pcm_dev_info(card_ctls);
 
 done:
     if (pcm_node_list)
@@ -742,9 +968,9 @@ done:
     return ret;
 }
 
-static int amp_get_acdb_info(struct amp_priv *amp_priv)
+static int amp_get_acdb_info(struct amp_card_ctls *card_ctls)
 {
-    struct amp_dev_info *acdb_adi = &amp_priv->acdb_tunnels;
+    struct amp_dev_info *acdb_adi = &card_ctls->acdb_tunnels;
     void **pcm_node_list = NULL;
     int total_pcms, ret = 0;
 
@@ -769,7 +995,7 @@ static int amp_get_acdb_info(struct amp_priv *amp_priv)
     goto done;
 
 err_alloc_rx_tx:
-    amp_free_pcm_dev_info(amp_priv);
+    amp_free_pcm_dev_info(card_ctls);
 
 done:
     if (pcm_node_list)
@@ -781,8 +1007,8 @@ done:
 static void amp_register_event_callback(struct mixer_plugin *plugin, int enable)
 {
     struct amp_priv *amp_priv = plugin->priv;
-    struct amp_dev_info *rx_adi = &amp_priv->rx_pcm_devs;
-    struct amp_dev_info *tx_adi = &amp_priv->tx_pcm_devs;
+    struct amp_dev_info *rx_adi = &amp_priv->card_ctls->rx_pcm_devs;
+    struct amp_dev_info *tx_adi = &amp_priv->card_ctls->tx_pcm_devs;
     agm_event_cb cb;
     int idx, session_id;
 
@@ -802,10 +1028,10 @@ static void amp_register_event_callback(struct mixer_plugin *plugin, int enable)
     }
 }
 
-static int amp_get_be_ctl_count(struct amp_priv *amp_priv)
+static int amp_get_be_ctl_count(struct amp_card_ctls *card_ctls)
 {
-    struct amp_dev_info *rx_adi = &amp_priv->rx_be_devs;
-    struct amp_dev_info *tx_adi = &amp_priv->tx_be_devs;
+    struct amp_dev_info *rx_adi = &card_ctls->rx_be_devs;
+    struct amp_dev_info *tx_adi = &card_ctls->tx_be_devs;
     int count, ctl_per_be;
 
     ctl_per_be = (int)ARRAY_SIZE(amp_be_ctl_name_extn);
@@ -819,9 +1045,9 @@ static int amp_get_be_ctl_count(struct amp_priv *amp_priv)
     return count;
 }
 
-static int amp_get_group_be_ctl_count(struct amp_priv *amp_priv)
+static int amp_get_group_be_ctl_count(struct amp_card_ctls *card_ctls)
 {
-    struct amp_be_group_info *grp_info = &amp_priv->group_be_devs;
+    struct amp_be_group_info *grp_info = &card_ctls->group_be_devs;
     int count = 0, ctl_per_be_group;
 
     ctl_per_be_group = (int)ARRAY_SIZE(amp_group_be_ctl_name_extn);
@@ -831,10 +1057,10 @@ static int amp_get_group_be_ctl_count(struct amp_priv *amp_priv)
     return count;
 }
 
-static int amp_get_pcm_ctl_count(struct amp_priv *amp_priv)
+static int amp_get_pcm_ctl_count(struct amp_card_ctls *card_ctls)
 {
-    struct amp_dev_info *rx_adi = &amp_priv->rx_pcm_devs;
-    struct amp_dev_info *tx_adi = &amp_priv->tx_pcm_devs;
+    struct amp_dev_info *rx_adi = &card_ctls->rx_pcm_devs;
+    struct amp_dev_info *tx_adi = &card_ctls->tx_pcm_devs;
     int count, ctl_per_pcm;
 
     count = 0;
@@ -855,24 +1081,23 @@ static int amp_get_pcm_ctl_count(struct amp_priv *amp_priv)
     return count;
 }
 
-static int amp_pcm_get_control_value(struct amp_priv *amp_priv __unused,
+static int amp_pcm_get_control_value(struct amp_priv *amp_priv,
                 int pcm_idx, struct amp_dev_info *pcm_adi)
 {
-    int mtd_idx;
+    struct amp_ctl_cache *cache = amp_get_ctl_cache(amp_priv, pcm_adi);
+    int mtd_idx = 0;
 
     /* Find the index for metadata_ctl for this pcm */
-    for (mtd_idx = 1; mtd_idx < pcm_adi->count; mtd_idx++) {
-        if (pcm_idx == pcm_adi->idx_arr[mtd_idx])
-            break;
-    }
+    if (pcm_idx >= 0 && pcm_idx <= pcm_adi->max_id)
+        mtd_idx = pcm_adi->id_to_pos[pcm_idx];
 
-    if (mtd_idx >= pcm_adi->count) {
+    if (mtd_idx <= 0) {
         AGM_LOGE("%s: metadata index not found for pcm_idx %d",
                __func__, pcm_idx);
         return -EINVAL;
     }
 
-    return pcm_adi->pcm_mtd_ctl[mtd_idx];
+    return cache->pcm_mtd_ctl[mtd_idx];
 }
 
 static int amp_be_media_fmt_get(struct mixer_plugin *plugin __unused,
@@ -960,6 +1185,40 @@ static int amp_pcm_buf_info_put(struct mixer_plugin *plugin __unused,
     return 0;
 }
 
+/*
+ *The pcm plugin keeps the xrun stats of the streams it opened, it is only
+ *asked if this process already loaded it.
+ */
+static int amp_pcm_xrun_get(struct mixer_plugin *plugin,
+    struct snd_control *ctl, struct snd_ctl_elem_value *ev)
+{
+    struct amp_priv *amp_priv = plugin->priv;
+    struct agm_xrun_stats *stats;
+    agm_pcm_plugin_get_xrun_stats_t get_stats;
+    void *lib;
+
+    stats = (struct agm_xrun_stats *) ev->value.bytes.data;
+    memset(stats, 0, sizeof(*stats));
+
+    lib = dlopen(AGM_PCM_PLUGIN_LIB, RTLD_NOW | RTLD_NOLOAD);
+    if (!lib)
+        return 0;
+
+    get_stats = (agm_pcm_plugin_get_xrun_stats_t)dlsym(lib,
+                                        AGM_PCM_PLUGIN_XRUN_STATS_FN);
+    if (get_stats)
+        get_stats(amp_priv->card_ctls->card, ctl->private_value, stats);
+    dlclose(lib);
+
+    return 0;
+}
+
+static int amp_pcm_xrun_put(struct mixer_plugin *plugin __unused,
+    struct snd_control *ctl __unused, struct snd_ctl_elem_value *ev __unused)
+{
+    return -EPERM;
+}
+
 static int amp_be_set_param_get(struct mixer_plugin *plugin __unused,
                 struct snd_control *ctl __unused, struct snd_ctl_tlv *ev __unused)
 {
@@ -1037,8 +1296,9 @@ static int amp_pcm_aif_connect_get(struct mixer_plugin *plugin __unused,
     return 0;
 }
 
-static int amp_pcm_aif_connect_put(struct mixer_plugin *plugin,
-                struct snd_control *ctl, struct snd_ctl_elem_value *ev)
+static int amp_pcm_aif_connect(struct mixer_plugin *plugin,
+                struct snd_control *ctl, struct snd_ctl_elem_value *ev,
+                bool state)
 {
     struct amp_priv *amp_priv = plugin->priv;
     struct amp_dev_info *pcm_adi = ctl->private_data;
@@ -1046,7 +1306,6 @@ static int amp_pcm_aif_connect_put(struct mixer_plugin *plugin,
     int be_idx, pcm_idx = ctl->private_value;
     unsigned int val;
     int ret;
-    bool state;
 
     AGM_LOGV("%s: enter\n", __func__);
     be_adi = amp_get_be_adi(amp_priv, pcm_adi->dir);
@@ -1059,16 +1318,6 @@ static int amp_pcm_aif_connect_put(struct mixer_plugin *plugin,
     if (val == 0)
         return 0;
 
-    /*
-     * same function caters to connect and disconnect mixer ctl.
-     * try to find "disconnect" in the ctl name to differentiate
-     * between connect and disconnect mixer ctl.
-     */
-    if (strstr(ctl->name, "disconnect"))
-        state = false;
-    else
-        state = true;
-
     be_idx = be_adi->idx_arr[val];
     ret = agm_session_aif_connect(pcm_idx, be_idx, state);
     if (ret == -EALREADY)
@@ -1081,28 +1330,42 @@ static int amp_pcm_aif_connect_put(struct mixer_plugin *plugin,
     return ret;
 }
 
-static int amp_pcm_mtd_control_get(struct mixer_plugin *plugin __unused,
+static int amp_pcm_aif_connect_put(struct mixer_plugin *plugin,
+                struct snd_control *ctl, struct snd_ctl_elem_value *ev)
+{
+    return amp_pcm_aif_connect(plugin, ctl, ev, true);
+}
+
+static int amp_pcm_aif_disconnect_put(struct mixer_plugin *plugin,
+                struct snd_control *ctl, struct snd_ctl_elem_value *ev)
+{
+    return amp_pcm_aif_connect(plugin, ctl, ev, false);
+}
+
+static int amp_pcm_mtd_control_get(struct mixer_plugin *plugin,
                 struct snd_control *ctl, struct snd_ctl_elem_value *ev)
 {
     struct amp_dev_info *pcm_adi = ctl->private_data;
+    struct amp_ctl_cache *cache = amp_get_ctl_cache(plugin->priv, pcm_adi);
     int idx    = ctl->private_value;
 
-    ev->value.enumerated.item[0] = pcm_adi->pcm_mtd_ctl[idx];
+    ev->value.enumerated.item[0] = cache->pcm_mtd_ctl[idx];
 
     AGM_LOGV("%s: enter, val = %u\n", __func__,
             ev->value.enumerated.item[0]);
     return 0;
 }
 
-static int amp_pcm_mtd_control_put(struct mixer_plugin *plugin __unused,
+static int amp_pcm_mtd_control_put(struct mixer_plugin *plugin,
                struct snd_control *ctl, struct snd_ctl_elem_value *ev)
 {
     struct amp_dev_info *pcm_adi = ctl->private_data;
+    struct amp_ctl_cache *cache = amp_get_ctl_cache(plugin->priv, pcm_adi);
     int idx = ctl->private_value;
     unsigned int val;
 
     val = ev->value.enumerated.item[0];
-    pcm_adi->pcm_mtd_ctl[idx] = val;
+    cache->pcm_mtd_ctl[idx] = val;
 
     AGM_LOGV("%s: value = %u\n", __func__, val);
     return 0;
@@ -1112,8 +1375,7 @@ static int amp_pcm_event_get(struct mixer_plugin *plugin,
                 struct snd_control *ctl, struct snd_ctl_tlv *tlv)
 {
     struct amp_priv *amp_priv = plugin->priv;
-    struct listnode *eparams_node, *temp;
-    struct event_params_node *event_node;
+    struct amp_event_ring *ring;
     struct agm_event_cb_params *eparams;
     int session_id = ctl->private_value;
     uint32_t tlv_size, event_payload_size;
@@ -1131,24 +1393,24 @@ static int amp_pcm_event_get(struct mixer_plugin *plugin,
         return -EINVAL;
     }
     pthread_mutex_lock(&amp_priv->lock);
-    list_for_each_safe(eparams_node, temp, &amp_priv->events_paramlist) {
-        event_node = node_to_item(eparams_node, struct event_params_node, node);
-        if (event_node->session_id == session_id) {
-            eparams = &event_node->event_params;
-            event_payload_size = sizeof(struct agm_event_cb_params) + eparams->event_payload_size;
-            if (tlv_size < event_payload_size) {
-                AGM_LOGE("Expected %d size, received %d\n", event_payload_size, tlv_size);
-                ret = -EINVAL;
-                goto done;
-            }
-            memcpy(payload, eparams,
-                   sizeof(struct agm_event_cb_params)
-                   + eparams->event_payload_size);
-            list_remove(&event_node->node);
-            free(event_node);
-            goto done;
-        }
+    ring = amp_get_event_ring(amp_priv, session_id);
+    if (!ring || ring->count == 0)
+        goto done;
+
+    eparams = ring->slots[ring->head].params;
+    event_payload_size = sizeof(struct agm_event_cb_params) + eparams->event_payload_size;
+    if (tlv_size < event_payload_size) {
+        AGM_LOGE("Expected %d size, received %d\n", event_payload_size, tlv_size);
+        ret = -EINVAL;
+        goto done;
     }
+    memcpy(payload, eparams, event_payload_size);
+    ring->head = (ring->head + 1) % AMP_EVENT_RING_SLOTS;
+    ring->count--;
+
+    /* one notification per read, so clients come back for the rest */
+    if (ring->count)
+        amp_queue_event_notify(amp_priv, ring);
 
 done:
     pthread_mutex_unlock(&amp_priv->lock);
@@ -1324,10 +1586,11 @@ static int amp_pcm_set_acdb_tunnel_put(struct mixer_plugin *plugin,
     return ret;
 }
 
-static int amp_pcm_get_acdb_tunnel_get(struct mixer_plugin *plugin ,
+static int amp_pcm_get_acdb_tunnel_get(struct mixer_plugin *plugin,
                 struct snd_control *ctl, struct snd_ctl_tlv *tlv)
 {
     struct amp_dev_info *pcm_adi = ctl->private_data;
+    struct amp_ctl_cache *cache = amp_get_ctl_cache(plugin->priv, pcm_adi);
     struct amp_dev_info *be_adi;
     void *payload;
     int pcm_idx = ctl->private_value;
@@ -1337,7 +1600,7 @@ static int amp_pcm_get_acdb_tunnel_get(struct mixer_plugin *plugin ,
 
     AGM_LOGV("%s: enter\n", __func__);
 
-    if (!pcm_adi->get_param_info[pcm_idx].get_param_payload) {
+    if (!cache->get_param_info[pcm_idx].get_param_payload) {
         AGM_LOGE("%s: put() for getParam not called\n", __func__);
         return -EINVAL;
     }
@@ -1345,21 +1608,21 @@ static int amp_pcm_get_acdb_tunnel_get(struct mixer_plugin *plugin ,
     payload = &tlv->tlv[0];
     tlv_size = tlv->length;
 
-    if (tlv_size < pcm_adi->get_param_info[pcm_idx].get_param_payload_size) {
+    if (tlv_size < cache->get_param_info[pcm_idx].get_param_payload_size) {
         AGM_LOGE("%s: Buffer size less than expected\n", __func__);
         return -EINVAL;
     }
 
-    memcpy(payload, pcm_adi->get_param_info[pcm_idx].get_param_payload,
-        pcm_adi->get_param_info[pcm_idx].get_param_payload_size);
+    memcpy(payload, cache->get_param_info[pcm_idx].get_param_payload,
+        cache->get_param_info[pcm_idx].get_param_payload_size);
     ret = agm_get_params_from_acdb_tunnel(payload, &tlv_size);
 
     if (ret)
         AGM_LOGE("%s: failed err %d for %s\n", __func__, ret, ctl->name);
 
-    free(pcm_adi->get_param_info[pcm_idx].get_param_payload);
-    pcm_adi->get_param_info[pcm_idx].get_param_payload = NULL;
-    pcm_adi->get_param_info[pcm_idx].get_param_payload_size = 0;
+    free(cache->get_param_info[pcm_idx].get_param_payload);
+    cache->get_param_info[pcm_idx].get_param_payload = NULL;
+    cache->get_param_info[pcm_idx].get_param_payload_size = 0;
 
     return ret;
 }
@@ -1368,23 +1631,24 @@ static int amp_pcm_get_acdb_tunnel_put(struct mixer_plugin *plugin,
                 struct snd_control *ctl, struct snd_ctl_tlv *tlv)
 {
     struct amp_dev_info *pcm_adi = ctl->private_data;
+    struct amp_ctl_cache *cache = amp_get_ctl_cache(plugin->priv, pcm_adi);
     int pcm_idx = ctl->private_value;
     void *payload;
 
-    if (pcm_adi->get_param_info[pcm_idx].get_param_payload) {
-        free(pcm_adi->get_param_info[pcm_idx].get_param_payload);
-        pcm_adi->get_param_info[pcm_idx].get_param_payload = NULL;
+    if (cache->get_param_info[pcm_idx].get_param_payload) {
+        free(cache->get_param_info[pcm_idx].get_param_payload);
+        cache->get_param_info[pcm_idx].get_param_payload = NULL;
     }
     payload = &tlv->tlv[0];
 
-    pcm_adi->get_param_info[pcm_idx].get_param_payload_size = tlv->length;
-    pcm_adi->get_param_info[pcm_idx].get_param_payload =
-        calloc(1, pcm_adi->get_param_info[pcm_idx].get_param_payload_size);
-    if (!pcm_adi->get_param_info[pcm_idx].get_param_payload)
+    cache->get_param_info[pcm_idx].get_param_payload_size = tlv->length;
+    cache->get_param_info[pcm_idx].get_param_payload =
+        calloc(1, cache->get_param_info[pcm_idx].get_param_payload_size);
+    if (!cache->get_param_info[pcm_idx].get_param_payload)
         return -ENOMEM;
 
-    memcpy(pcm_adi->get_param_info[pcm_idx].get_param_payload, payload,
-        pcm_adi->get_param_info[pcm_idx].get_param_payload_size);
+    memcpy(cache->get_param_info[pcm_idx].get_param_payload, payload,
+        cache->get_param_info[pcm_idx].get_param_payload_size);
 
     return 0;
 }
@@ -1397,8 +1661,15 @@ static int amp_pcm_set_param_get(struct mixer_plugin *plugin __unused,
     return 0;
 }
 
-static int amp_pcm_set_param_put(struct mixer_plugin *plugin,
-                struct snd_control *ctl, struct snd_ctl_tlv *tlv)
+enum amp_set_param_kind {
+    AMP_SET_PARAM,
+    AMP_SET_PARAM_TAG,
+    AMP_SET_PARAM_TAG_ACDB,
+};
+
+static int amp_pcm_set_param(struct mixer_plugin *plugin,
+                struct snd_control *ctl, struct snd_ctl_tlv *tlv,
+                enum amp_set_param_kind kind)
 {
     struct amp_dev_info *pcm_adi = ctl->private_data;
     struct amp_dev_info *be_adi;
@@ -1406,17 +1677,9 @@ static int amp_pcm_set_param_put(struct mixer_plugin *plugin,
     int pcm_idx = ctl->private_value;
     int pcm_control, be_idx = -1, ret = 0;
     size_t tlv_size;
-    bool is_param_tag = false;
-    bool is_param_tag_acdb = false;
 
     AGM_LOGV("%s: enter\n", __func__);
 
-    if (strstr(ctl->name, "setParamTag"))
-        is_param_tag = true;
-
-    if (strstr(ctl->name, "setParamTagACDB"))
-        is_param_tag_acdb = true;
-
     payload = &tlv->tlv[0];
     tlv_size = tlv->length;
     pcm_control = amp_pcm_get_control_value(plugin->priv, pcm_idx, pcm_adi);
@@ -1429,18 +1692,22 @@ static int amp_pcm_set_param_put(struct mixer_plugin *plugin,
         be_idx = be_adi->idx_arr[pcm_control];
     }
 
-    if (is_param_tag_acdb) {
+    switch (kind) {
+    case AMP_SET_PARAM_TAG_ACDB:
         ret = agm_set_params_with_tag_to_acdb(pcm_idx, be_idx,
                                         payload, tlv_size);
-    } else if (is_param_tag) {
+        break;
+    case AMP_SET_PARAM_TAG:
         ret = agm_set_params_with_tag(pcm_idx, be_idx, payload);
-    } else {
+        break;
+    default:
         if (pcm_control == 0) {
             ret = agm_session_set_params(pcm_idx, payload, tlv_size);
         } else {
             ret = agm_session_aif_set_params(pcm_idx, be_idx,
                             payload, tlv_size);
         }
+        break;
     }
 
     if (ret == -EALREADY)
@@ -1448,14 +1715,75 @@ static int amp_pcm_set_param_put(struct mixer_plugin *plugin,
 
     if (ret)
         AGM_LOGE("%s: set_params failed err %d for %s is_param_tag %s\n",
-               __func__, ret, ctl->name, is_param_tag ? "true" : "false");
+               __func__, ret, ctl->name,
+               kind != AMP_SET_PARAM ? "true" : "false");
+    return ret;
+}
+
+static int amp_pcm_set_param_put(struct mixer_plugin *plugin,
+                struct snd_control *ctl, struct snd_ctl_tlv *tlv)
+{
+    return amp_pcm_set_param(plugin, ctl, tlv, AMP_SET_PARAM);
+}
+
+static int amp_pcm_set_param_tag_put(struct mixer_plugin *plugin,
+                struct snd_control *ctl, struct snd_ctl_tlv *tlv)
+{
+    return amp_pcm_set_param(plugin, ctl, tlv, AMP_SET_PARAM_TAG);
+}
+
+static int amp_pcm_set_param_tag_acdb_put(struct mixer_plugin *plugin,
+                struct snd_control *ctl, struct snd_ctl_tlv *tlv)
+{
+    return amp_pcm_set_param(plugin, ctl, tlv, AMP_SET_PARAM_TAG_ACDB);
+}
+
+static int amp_pcm_transaction_get(struct mixer_plugin *plugin __unused,
+                struct snd_control *ctl __unused, struct snd_ctl_tlv *ev __unused)
+{
+    /* get of transaction not implemented */
+    return 0;
+}
+
+static int amp_pcm_transaction_put(struct mixer_plugin *plugin __unused,
+                struct snd_control *ctl, struct snd_ctl_tlv *tlv)
+{
+    struct agm_session_txn *txn;
+    int pcm_idx = ctl->private_value;
+    uint64_t handle = 0;
+    int ret = 0;
+
+    AGM_LOGV("%s: enter\n", __func__);
+
+    if (tlv->length < sizeof(struct agm_session_txn)) {
+        AGM_LOGE("%s: invalid array size %d\n", __func__, tlv->length);
+        return -EINVAL;
+    }
+
+    /*
+     * The session handle belongs to the pcm plugin, records may be staged
+     * here in one call but open/prepare/start stay with the pcm device.
+     */
+    txn = (struct agm_session_txn *)&tlv->tlv[0];
+    if (txn->flags & (AGM_SESSION_TXN_OPEN | AGM_SESSION_TXN_PREPARE |
+                      AGM_SESSION_TXN_START)) {
+        AGM_LOGE("%s: %s can not open a session\n", __func__, ctl->name);
+        return -EINVAL;
+    }
+
+    txn->session_id = pcm_idx;
+    ret = agm_session_transact(txn, tlv->length, &handle);
+    if (ret)
+        AGM_LOGE("%s: transaction failed err %d for %s\n",
+                 __func__, ret, ctl->name);
     return ret;
 }
 
-static int amp_pcm_get_param_get(struct mixer_plugin *plugin __unused,
+static int amp_pcm_get_param_get(struct mixer_plugin *plugin,
                 struct snd_control *ctl, struct snd_ctl_tlv *tlv)
 {
     struct amp_dev_info *pcm_adi = ctl->private_data;
+    struct amp_ctl_cache *cache = amp_get_ctl_cache(plugin->priv, pcm_adi);
     void *payload;
     int pcm_idx;
     int idx = ctl->private_value;
@@ -1468,18 +1796,18 @@ static int amp_pcm_get_param_get(struct mixer_plugin *plugin __unused,
     tlv_size = tlv->length;
     pcm_idx = pcm_adi->idx_arr[idx];
 
-    if (!pcm_adi->get_param_info[idx].get_param_payload) {
+    if (!cache->get_param_info[idx].get_param_payload) {
         AGM_LOGE("%s: put() for getParam not called\n", __func__);
         return -EINVAL;
     }
 
-    if (tlv_size < pcm_adi->get_param_info[idx].get_param_payload_size) {
+    if (tlv_size < cache->get_param_info[idx].get_param_payload_size) {
         AGM_LOGE("%s: Buffer size less than expected\n", __func__);
         return -EINVAL;
     }
 
-    memcpy(payload, pcm_adi->get_param_info[idx].get_param_payload,
-                    pcm_adi->get_param_info[idx].get_param_payload_size);
+    memcpy(payload, cache->get_param_info[idx].get_param_payload,
+                    cache->get_param_info[idx].get_param_payload_size);
     ret = agm_session_get_params(pcm_idx, payload, tlv_size);
 
     if (ret == -EALREADY)
@@ -1488,36 +1816,37 @@ static int amp_pcm_get_param_get(struct mixer_plugin *plugin __unused,
     if (ret)
         AGM_LOGE("%s: failed err %d for %s\n", __func__, ret, ctl->name);
 
-    free(pcm_adi->get_param_info[idx].get_param_payload);
-    pcm_adi->get_param_info[idx].get_param_payload = NULL;
-    pcm_adi->get_param_info[idx].get_param_payload_size = 0;
+    free(cache->get_param_info[idx].get_param_payload);
+    cache->get_param_info[idx].get_param_payload = NULL;
+    cache->get_param_info[idx].get_param_payload_size = 0;
     errno = ret;
     return ret;
 }
 
-static int amp_pcm_get_param_put(struct mixer_plugin *plugin __unused,
+static int amp_pcm_get_param_put(struct mixer_plugin *plugin,
                 struct snd_control *ctl, struct snd_ctl_tlv *tlv)
 {
     struct amp_dev_info *pcm_adi = ctl->private_data;
+    struct amp_ctl_cache *cache = amp_get_ctl_cache(plugin->priv, pcm_adi);
     int idx = ctl->private_value;
     void *payload;
 
     AGM_LOGV("%s: enter\n", __func__);
 
-    if (pcm_adi->get_param_info[idx].get_param_payload) {
-        free(pcm_adi->get_param_info[idx].get_param_payload);
-        pcm_adi->get_param_info[idx].get_param_payload = NULL;
+    if (cache->get_param_info[idx].get_param_payload) {
+        free(cache->get_param_info[idx].get_param_payload);
+        cache->get_param_info[idx].get_param_payload = NULL;
     }
     payload = &tlv->tlv[0];
-    pcm_adi->get_param_info[idx].get_param_payload_size = tlv->length;
+    cache->get_param_info[idx].get_param_payload_size = tlv->length;
 
-    pcm_adi->get_param_info[idx].get_param_payload = calloc(1,
-                                                         pcm_adi->get_param_info[idx].get_param_payload_size);
-    if (!pcm_adi->get_param_info[idx].get_param_payload)
+    cache->get_param_info[idx].get_param_payload = calloc(1,
+                                                         cache->get_param_info[idx].get_param_payload_size);
+    if (!cache->get_param_info[idx].get_param_payload)
         return -ENOMEM;
 
-    memcpy(pcm_adi->get_param_info[idx].get_param_payload, payload,
-                      pcm_adi->get_param_info[idx].get_param_payload_size);
+    memcpy(cache->get_param_info[idx].get_param_payload, payload,
+                      cache->get_param_info[idx].get_param_payload_size);
 
     return 0;
 }
@@ -1583,7 +1912,7 @@ static int amp_pcm_loopback_put(struct mixer_plugin *plugin,
     int ret;
 
     AGM_LOGV("%s: enter\n", __func__);
-    pcm_rx_adi = &amp_priv->rx_pcm_devs;
+    pcm_rx_adi = &amp_priv->card_ctls->rx_pcm_devs;
     if (!pcm_rx_adi)
         return -EINVAL;
 
@@ -1719,9 +2048,9 @@ static struct snd_value_tlv_bytes pcm_metadata_bytes =
 static struct snd_value_tlv_bytes pcm_taginfo_bytes =
     SND_VALUE_TLV_BYTES(1024, amp_pcm_tag_info_get, amp_pcm_tag_info_put);
 static struct snd_value_tlv_bytes pcm_setparamtag_bytes =
-    SND_VALUE_TLV_BYTES(256 * 1024, amp_pcm_set_param_get, amp_pcm_set_param_put);
+    SND_VALUE_TLV_BYTES(256 * 1024, amp_pcm_set_param_get, amp_pcm_set_param_tag_put);
 static struct snd_value_tlv_bytes pcm_setparamtagacdb_bytes =
-    SND_VALUE_TLV_BYTES(256 * 1024, amp_pcm_set_param_get, amp_pcm_set_param_put);
+    SND_VALUE_TLV_BYTES(256 * 1024, amp_pcm_set_param_get, amp_pcm_set_param_tag_acdb_put);
 static struct snd_value_tlv_bytes pcm_setacdbtunnel_bytes =
     SND_VALUE_TLV_BYTES(256 * 1024, amp_pcm_set_acdb_tunnel_get, amp_pcm_set_acdb_tunnel_put);
 static struct snd_value_tlv_bytes pcm_getacdbtunnel_bytes =
@@ -1734,6 +2063,10 @@ static struct snd_value_tlv_bytes pcm_event_bytes =
     SND_VALUE_TLV_BYTES(128 * 1024, amp_pcm_event_get, amp_pcm_event_put);
 static struct snd_value_bytes pcm_buf_info_bytes =
     SND_VALUE_BYTES(512 - 16);
+static struct snd_value_tlv_bytes pcm_transaction_bytes =
+    SND_VALUE_TLV_BYTES(512 * 1024, amp_pcm_transaction_get, amp_pcm_transaction_put);
+static struct snd_value_bytes pcm_xrun_bytes =
+    SND_VALUE_BYTES(sizeof(struct agm_xrun_stats));
 static struct snd_value_bytes pcm_write_datapath_params_bytes =
     SND_VALUE_BYTES(512 - 16);
 
@@ -1750,12 +2083,12 @@ static struct snd_value_tlv_bytes be_setparam_bytes =
     SND_VALUE_TLV_BYTES(64 * 1024, amp_be_set_param_get, amp_be_set_param_put);
 
 /* PCM related mixer controls here */
-static void amp_create_connect_ctl(struct amp_priv *amp_priv,
+static void amp_create_connect_ctl(struct amp_card_ctls *card_ctls,
             char *pname, int ctl_idx, struct snd_value_enum *e,
             int pval, void *pdata)
 {
-    struct snd_control *ctl = AMP_PRIV_GET_CTL_PTR(amp_priv, ctl_idx);
-    char *ctl_name = AMP_PRIV_GET_CTL_NAME_PTR(amp_priv, ctl_idx);
+    struct snd_control *ctl = AMP_PRIV_GET_CTL_PTR(card_ctls, ctl_idx);
+    char *ctl_name = AMP_PRIV_GET_CTL_NAME_PTR(card_ctls, ctl_idx);
 
     snprintf(ctl_name, AIF_NAME_MAX_LEN + 16, "%s %s",
              pname, amp_pcm_ctl_name_extn[PCM_CTL_NAME_CONNECT]);
@@ -1763,25 +2096,25 @@ static void amp_create_connect_ctl(struct amp_priv *amp_priv,
                     amp_pcm_aif_connect_put, e, pval, pdata);
 }
 
-static void amp_create_disconnect_ctl(struct amp_priv *amp_priv,
+static void amp_create_disconnect_ctl(struct amp_card_ctls *card_ctls,
             char *pname, int ctl_idx, struct snd_value_enum *e,
             int pval, void *pdata)
 {
-    struct snd_control *ctl = AMP_PRIV_GET_CTL_PTR(amp_priv, ctl_idx);
-    char *ctl_name = AMP_PRIV_GET_CTL_NAME_PTR(amp_priv, ctl_idx);
+    struct snd_control *ctl = AMP_PRIV_GET_CTL_PTR(card_ctls, ctl_idx);
+    char *ctl_name = AMP_PRIV_GET_CTL_NAME_PTR(card_ctls, ctl_idx);
 
     snprintf(ctl_name, AIF_NAME_MAX_LEN + 16, "%s %s",
              pname, amp_pcm_ctl_name_extn[PCM_CTL_NAME_DISCONNECT]);
     INIT_SND_CONTROL_ENUM(ctl, ctl_name, amp_pcm_aif_connect_get,
-                    amp_pcm_aif_connect_put, e, pval, pdata);
+                    amp_pcm_aif_disconnect_put, e, pval, pdata);
 }
 
-static void amp_create_mtd_control_ctl(struct amp_priv *amp_priv,
+static void amp_create_mtd_control_ctl(struct amp_card_ctls *card_ctls,
                 char *pname, int ctl_idx, struct snd_value_enum *e,
                 int pval, void *pdata)
 {
-    struct snd_control *ctl = AMP_PRIV_GET_CTL_PTR(amp_priv, ctl_idx);
-    char *ctl_name = AMP_PRIV_GET_CTL_NAME_PTR(amp_priv, ctl_idx);
+    struct snd_control *ctl = AMP_PRIV_GET_CTL_PTR(card_ctls, ctl_idx);
+    char *ctl_name = AMP_PRIV_GET_CTL_NAME_PTR(card_ctls, ctl_idx);
 
     snprintf(ctl_name, AIF_NAME_MAX_LEN + 16, "%s %s",
              pname, amp_pcm_ctl_name_extn[PCM_CTL_NAME_MTD_CONTROL]);
@@ -1790,11 +2123,11 @@ static void amp_create_mtd_control_ctl(struct amp_priv *amp_priv,
 
 }
 
-static void amp_create_pcm_event_ctl(struct amp_priv *amp_priv,
+static void amp_create_pcm_event_ctl(struct amp_card_ctls *card_ctls,
                 char *name, int ctl_idx, int pval, void *pdata)
 {
-    struct snd_control *ctl = AMP_PRIV_GET_CTL_PTR(amp_priv, ctl_idx);
-    char *ctl_name = AMP_PRIV_GET_CTL_NAME_PTR(amp_priv, ctl_idx);
+    struct snd_control *ctl = AMP_PRIV_GET_CTL_PTR(card_ctls, ctl_idx);
+    char *ctl_name = AMP_PRIV_GET_CTL_NAME_PTR(card_ctls, ctl_idx);
 
     snprintf(ctl_name, AIF_NAME_MAX_LEN + 16, "%s %s",
              name, amp_pcm_ctl_name_extn[PCM_CTL_NAME_EVENT]);
@@ -1803,11 +2136,11 @@ static void amp_create_pcm_event_ctl(struct amp_priv *amp_priv,
                     pval, pdata);
 }
 
-static void amp_create_pcm_metadata_ctl(struct amp_priv *amp_priv,
+static void amp_create_pcm_metadata_ctl(struct amp_card_ctls *card_ctls,
                 char *name, int ctl_idx, int pval, void *pdata)
 {
-    struct snd_control *ctl = AMP_PRIV_GET_CTL_PTR(amp_priv, ctl_idx);
-    char *ctl_name = AMP_PRIV_GET_CTL_NAME_PTR(amp_priv, ctl_idx);
+    struct snd_control *ctl = AMP_PRIV_GET_CTL_PTR(card_ctls, ctl_idx);
+    char *ctl_name = AMP_PRIV_GET_CTL_NAME_PTR(card_ctls, ctl_idx);
 
     snprintf(ctl_name, AIF_NAME_MAX_LEN + 16, "%s %s",
              name, amp_pcm_ctl_name_extn[PCM_CTL_NAME_METADATA]);
@@ -1816,12 +2149,12 @@ static void amp_create_pcm_metadata_ctl(struct amp_priv *amp_priv,
                     pval, pdata);
 }
 
-static void amp_create_pcm_set_param_ctl(struct amp_priv *amp_priv,
+static void amp_create_pcm_set_param_ctl(struct amp_card_ctls *card_ctls,
                 char *name, int ctl_idx, int pval, void *pdata,
                 bool istagged_setparam, bool is_acdb)
 {
-    struct snd_control *ctl = AMP_PRIV_GET_CTL_PTR(amp_priv, ctl_idx);
-    char *ctl_name = AMP_PRIV_GET_CTL_NAME_PTR(amp_priv, ctl_idx);
+    struct snd_control *ctl = AMP_PRIV_GET_CTL_PTR(card_ctls, ctl_idx);
+    char *ctl_name = AMP_PRIV_GET_CTL_NAME_PTR(card_ctls, ctl_idx);
 
     if (!istagged_setparam) {
         snprintf(ctl_name, AIF_NAME_MAX_LEN + 16, "%s %s",
@@ -1844,11 +2177,11 @@ static void amp_create_pcm_set_param_ctl(struct amp_priv *amp_priv,
 
 }
 
-static void amp_create_pcm_get_param_ctl(struct amp_priv *amp_priv,
+static void amp_create_pcm_get_param_ctl(struct amp_card_ctls *card_ctls,
                 char *name, int ctl_idx, int pval, void *pdata)
 {
-    struct snd_control *ctl = AMP_PRIV_GET_CTL_PTR(amp_priv, ctl_idx);
-    char *ctl_name = AMP_PRIV_GET_CTL_NAME_PTR(amp_priv, ctl_idx);
+    struct snd_control *ctl = AMP_PRIV_GET_CTL_PTR(card_ctls, ctl_idx);
+    char *ctl_name = AMP_PRIV_GET_CTL_NAME_PTR(card_ctls, ctl_idx);
 
     snprintf(ctl_name, AIF_NAME_MAX_LEN + 16, "%s %s",
          name, amp_pcm_ctl_name_extn[PCM_CTL_NAME_GET_PARAM]);
@@ -1857,11 +2190,11 @@ static void amp_create_pcm_get_param_ctl(struct amp_priv *amp_priv,
 
 }
 
-static void amp_create_pcm_get_tag_info_ctl(struct amp_priv *amp_priv,
+static void amp_create_pcm_get_tag_info_ctl(struct amp_card_ctls *card_ctls,
                 char *name, int ctl_idx, int pval, void *pdata)
 {
-    struct snd_control *ctl = AMP_PRIV_GET_CTL_PTR(amp_priv, ctl_idx);
-    char *ctl_name = AMP_PRIV_GET_CTL_NAME_PTR(amp_priv, ctl_idx);
+    struct snd_control *ctl = AMP_PRIV_GET_CTL_PTR(card_ctls, ctl_idx);
+    char *ctl_name = AMP_PRIV_GET_CTL_NAME_PTR(card_ctls, ctl_idx);
 
     snprintf(ctl_name, AIF_NAME_MAX_LEN + 16, "%s %s",
              name, amp_pcm_ctl_name_extn[PCM_CTL_NAME_GET_TAG_INFO]);
@@ -1871,12 +2204,12 @@ static void amp_create_pcm_get_tag_info_ctl(struct amp_priv *amp_priv,
 }
 
 /* TX only mixer control creations here */
-static void amp_create_pcm_loopback_ctl(struct amp_priv *amp_priv,
+static void amp_create_pcm_loopback_ctl(struct amp_card_ctls *card_ctls,
             char *pname, int ctl_idx, struct snd_value_enum *e,
             int pval, void *pdata)
 {
-    struct snd_control *ctl = AMP_PRIV_GET_CTL_PTR(amp_priv, ctl_idx);
-    char *ctl_name = AMP_PRIV_GET_CTL_NAME_PTR(amp_priv, ctl_idx);
+    struct snd_control *ctl = AMP_PRIV_GET_CTL_PTR(card_ctls, ctl_idx);
+    char *ctl_name = AMP_PRIV_GET_CTL_NAME_PTR(card_ctls, ctl_idx);
 
     snprintf(ctl_name, AIF_NAME_MAX_LEN + 16, "%s %s",
              pname, amp_pcm_tx_ctl_names[PCM_TX_CTL_NAME_LOOPBACK]);
@@ -1884,12 +2217,12 @@ static void amp_create_pcm_loopback_ctl(struct amp_priv *amp_priv,
                     amp_pcm_loopback_put, e, pval, pdata);
 }
 
-static void amp_create_pcm_echoref_ctl(struct amp_priv *amp_priv,
+static void amp_create_pcm_echoref_ctl(struct amp_card_ctls *card_ctls,
             char *pname, int ctl_idx, struct snd_value_enum *e,
             int pval, void *pdata)
 {
-    struct snd_control *ctl = AMP_PRIV_GET_CTL_PTR(amp_priv, ctl_idx);
-    char *ctl_name = AMP_PRIV_GET_CTL_NAME_PTR(amp_priv, ctl_idx);
+    struct snd_control *ctl = AMP_PRIV_GET_CTL_PTR(card_ctls, ctl_idx);
+    char *ctl_name = AMP_PRIV_GET_CTL_NAME_PTR(card_ctls, ctl_idx);
 
     snprintf(ctl_name, AIF_NAME_MAX_LEN + 16, "%s %s",
              pname, amp_pcm_tx_ctl_names[PCM_TX_CTL_NAME_ECHOREF]);
@@ -1898,12 +2231,12 @@ static void amp_create_pcm_echoref_ctl(struct amp_priv *amp_priv,
 }
 
 /* RX only mixer control creations here */
-static void amp_create_pcm_sidetone_ctl(struct amp_priv *amp_priv,
+static void amp_create_pcm_sidetone_ctl(struct amp_card_ctls *card_ctls,
             char *pname, int ctl_idx, struct snd_value_enum *e,
             int pval, void *pdata)
 {
-    struct snd_control *ctl = AMP_PRIV_GET_CTL_PTR(amp_priv, ctl_idx);
-    char *ctl_name = AMP_PRIV_GET_CTL_NAME_PTR(amp_priv, ctl_idx);
+    struct snd_control *ctl = AMP_PRIV_GET_CTL_PTR(card_ctls, ctl_idx);
+    char *ctl_name = AMP_PRIV_GET_CTL_NAME_PTR(card_ctls, ctl_idx);
 
     snprintf(ctl_name, AIF_NAME_MAX_LEN + 16, "%s %s",
              pname, amp_pcm_rx_ctl_names[PCM_RX_CTL_NAME_SIDETONE]);
@@ -1912,11 +2245,11 @@ static void amp_create_pcm_sidetone_ctl(struct amp_priv *amp_priv,
 }
 
 
-static void amp_create_pcm_calibration_ctl(struct amp_priv *amp_priv,
+static void amp_create_pcm_calibration_ctl(struct amp_card_ctls *card_ctls,
                 char *name, int ctl_idx, int pval, void *pdata)
 {
-    struct snd_control *ctl = AMP_PRIV_GET_CTL_PTR(amp_priv, ctl_idx);
-    char *ctl_name = AMP_PRIV_GET_CTL_NAME_PTR(amp_priv, ctl_idx);
+    struct snd_control *ctl = AMP_PRIV_GET_CTL_PTR(card_ctls, ctl_idx);
+    char *ctl_name = AMP_PRIV_GET_CTL_NAME_PTR(card_ctls, ctl_idx);
 
     snprintf(ctl_name, AIF_NAME_MAX_LEN + 16, "%s %s",
              name, amp_pcm_ctl_name_extn[PCM_CTL_NAME_SET_CALIBRATION]);
@@ -1926,11 +2259,11 @@ static void amp_create_pcm_calibration_ctl(struct amp_priv *amp_priv,
                     pval, pdata);
 }
 
-static void amp_create_pcm_buf_tstamp_ctl(struct amp_priv *amp_priv,
+static void amp_create_pcm_buf_tstamp_ctl(struct amp_card_ctls *card_ctls,
                 char *name, int ctl_idx, int pval, void *pdata)
 {
-    struct snd_control *ctl = AMP_PRIV_GET_CTL_PTR(amp_priv, ctl_idx);
-    char *ctl_name = AMP_PRIV_GET_CTL_NAME_PTR(amp_priv, ctl_idx);
+    struct snd_control *ctl = AMP_PRIV_GET_CTL_PTR(card_ctls, ctl_idx);
+    char *ctl_name = AMP_PRIV_GET_CTL_NAME_PTR(card_ctls, ctl_idx);
 
     snprintf(ctl_name, AIF_NAME_MAX_LEN + 16, "%s %s",
              name, amp_pcm_tx_ctl_names[PCM_CTL_NAME_BUF_TSTAMP]);
@@ -1940,11 +2273,11 @@ static void amp_create_pcm_buf_tstamp_ctl(struct amp_priv *amp_priv,
                     pval, pdata);
 }
 
-static void amp_create_pcm_bufinfo_ctl(struct amp_priv *amp_priv,
+static void amp_create_pcm_bufinfo_ctl(struct amp_card_ctls *card_ctls,
     char *name, int ctl_idx, int pval, void *pdata)
 {
-    struct snd_control *ctl = AMP_PRIV_GET_CTL_PTR(amp_priv, ctl_idx);
-    char *ctl_name = AMP_PRIV_GET_CTL_NAME_PTR(amp_priv, ctl_idx);
+    struct snd_control *ctl = AMP_PRIV_GET_CTL_PTR(card_ctls, ctl_idx);
+    char *ctl_name = AMP_PRIV_GET_CTL_NAME_PTR(card_ctls, ctl_idx);
 
     snprintf(ctl_name, AIF_NAME_MAX_LEN + 16, "%s %s",
             name, amp_pcm_ctl_name_extn[PCM_CTL_NAME_BUF_INFO]);
@@ -1954,11 +2287,38 @@ static void amp_create_pcm_bufinfo_ctl(struct amp_priv *amp_priv,
             pval, pdata);
 }
 
-static void amp_create_pcm_write_with_metadata_ctl(struct amp_priv *amp_priv,
+static void amp_create_pcm_transaction_ctl(struct amp_card_ctls *card_ctls,
+    char *name, int ctl_idx, int pval, void *pdata)
+{
+    struct snd_control *ctl = AMP_PRIV_GET_CTL_PTR(card_ctls, ctl_idx);
+    char *ctl_name = AMP_PRIV_GET_CTL_NAME_PTR(card_ctls, ctl_idx);
+
+    snprintf(ctl_name, AIF_NAME_MAX_LEN + 16, "%s %s",
+            name, amp_pcm_ctl_name_extn[PCM_CTL_NAME_TRANSACTION]);
+
+    INIT_SND_CONTROL_TLV_BYTES(ctl, ctl_name, pcm_transaction_bytes,
+            pval, pdata);
+}
+
+static void amp_create_pcm_xrun_ctl(struct amp_card_ctls *card_ctls,
+    char *name, int ctl_idx, int pval, void *pdata)
+{
+    struct snd_control *ctl = AMP_PRIV_GET_CTL_PTR(card_ctls, ctl_idx);
+    char *ctl_name = AMP_PRIV_GET_CTL_NAME_PTR(card_ctls, ctl_idx);
+
+    snprintf(ctl_name, AIF_NAME_MAX_LEN + 16, "%s %s",
+            name, amp_pcm_ctl_name_extn[PCM_CTL_NAME_XRUN]);
+
+    INIT_SND_CONTROL_BYTES(ctl, ctl_name, amp_pcm_xrun_get,
+            amp_pcm_xrun_put, pcm_xrun_bytes,
+            pval, pdata);
+}
+
+static void amp_create_pcm_write_with_metadata_ctl(struct amp_card_ctls *card_ctls,
     char *name, int ctl_idx, int pval, void *pdata)
 {
-    struct snd_control *ctl = AMP_PRIV_GET_CTL_PTR(amp_priv, ctl_idx);
-    char *ctl_name = AMP_PRIV_GET_CTL_NAME_PTR(amp_priv, ctl_idx);
+    struct snd_control *ctl = AMP_PRIV_GET_CTL_PTR(card_ctls, ctl_idx);
+    char *ctl_name = AMP_PRIV_GET_CTL_NAME_PTR(card_ctls, ctl_idx);
 
     snprintf(ctl_name, AIF_NAME_MAX_LEN + 16, "%s %s",
             name, amp_pcm_rx_ctl_names[PCM_RX_CTL_NAME_DATAPATH_PARAMS]);
@@ -1969,31 +2329,31 @@ static void amp_create_pcm_write_with_metadata_ctl(struct amp_priv *amp_priv,
 }
 
 /* static mixer control for ACDB parameter set */
-static void amp_create_acdb_tunnel_set_ctl(struct amp_priv *amp_priv,
+static void amp_create_acdb_tunnel_set_ctl(struct amp_card_ctls *card_ctls,
                 int ctl_idx, int pval, void *pdata)
 {
-    struct snd_control *ctl = AMP_PRIV_GET_CTL_PTR(amp_priv, ctl_idx);
+    struct snd_control *ctl = AMP_PRIV_GET_CTL_PTR(card_ctls, ctl_idx);
 
     INIT_SND_CONTROL_TLV_BYTES(ctl,
             static_acdb_ctl_name_extn[STATIC_CTL_SET_ACDB_TUNNEL],
             pcm_setacdbtunnel_bytes, pval, pdata);
 }
 
-static void amp_create_acdb_tunnel_get_ctl(struct amp_priv *amp_priv,
+static void amp_create_acdb_tunnel_get_ctl(struct amp_card_ctls *card_ctls,
             int ctl_idx, int pval, void *pdata)
 {
-    struct snd_control *ctl = AMP_PRIV_GET_CTL_PTR(amp_priv, ctl_idx);
+    struct snd_control *ctl = AMP_PRIV_GET_CTL_PTR(card_ctls, ctl_idx);
 
     INIT_SND_CONTROL_TLV_BYTES(ctl,
             static_acdb_ctl_name_extn[STATIC_CTL_GET_ACDB_TUNNEL],
             pcm_getacdbtunnel_bytes, pval, pdata);
 }
 
-static void amp_create_pcm_flush_ctl(struct amp_priv *amp_priv,
+static void amp_create_pcm_flush_ctl(struct amp_card_ctls *card_ctls,
     char *name, int ctl_idx, int pval, void *pdata)
 {
-    struct snd_control *ctl = AMP_PRIV_GET_CTL_PTR(amp_priv, ctl_idx);
-    char *ctl_name = AMP_PRIV_GET_CTL_NAME_PTR(amp_priv, ctl_idx);
+    struct snd_control *ctl = AMP_PRIV_GET_CTL_PTR(card_ctls, ctl_idx);
+    char *ctl_name = AMP_PRIV_GET_CTL_NAME_PTR(card_ctls, ctl_idx);
 
     snprintf(ctl_name, AIF_NAME_MAX_LEN + 16, "%s %s",
             name, amp_pcm_rx_ctl_names[PCM_RX_CTL_NAME_FLUSH]);
@@ -2003,11 +2363,11 @@ static void amp_create_pcm_flush_ctl(struct amp_priv *amp_priv,
 }
 
 /* BE related mixer control creations here */
-static void amp_create_metadata_ctl(struct amp_priv *amp_priv,
+static void amp_create_metadata_ctl(struct amp_card_ctls *card_ctls,
                 char *be_name, int ctl_idx, int pval, void *pdata)
 {
-    struct snd_control *ctl = AMP_PRIV_GET_CTL_PTR(amp_priv, ctl_idx);
-    char *ctl_name = AMP_PRIV_GET_CTL_NAME_PTR(amp_priv, ctl_idx);
+    struct snd_control *ctl = AMP_PRIV_GET_CTL_PTR(card_ctls, ctl_idx);
+    char *ctl_name = AMP_PRIV_GET_CTL_NAME_PTR(card_ctls, ctl_idx);
 
     snprintf(ctl_name, AIF_NAME_MAX_LEN + 16, "%s %s",
              be_name, amp_be_ctl_name_extn[BE_CTL_NAME_METADATA]);
@@ -2016,11 +2376,11 @@ static void amp_create_metadata_ctl(struct amp_priv *amp_priv,
                     pval, pdata);
 }
 
-static void amp_create_media_fmt_ctl(struct amp_priv *amp_priv,
+static void amp_create_media_fmt_ctl(struct amp_card_ctls *card_ctls,
                 char *be_name, int ctl_idx, int pval, void *pdata)
 {
-    struct snd_control *ctl = AMP_PRIV_GET_CTL_PTR(amp_priv, ctl_idx);
-    char *ctl_name = AMP_PRIV_GET_CTL_NAME_PTR(amp_priv, ctl_idx);
+    struct snd_control *ctl = AMP_PRIV_GET_CTL_PTR(card_ctls, ctl_idx);
+    char *ctl_name = AMP_PRIV_GET_CTL_NAME_PTR(card_ctls, ctl_idx);
 
     snprintf(ctl_name, AIF_NAME_MAX_LEN + 16, "%s %s",
              be_name, amp_be_ctl_name_extn[BE_CTL_NAME_MEDIA_CONFIG]);
@@ -2028,11 +2388,11 @@ static void amp_create_media_fmt_ctl(struct amp_priv *amp_priv,
                     amp_be_media_fmt_put, media_fmt_int, pval, pdata);
 }
 
-static void amp_create_be_set_param_ctl(struct amp_priv *amp_priv,
+static void amp_create_be_set_param_ctl(struct amp_card_ctls *card_ctls,
                 char *be_name, int ctl_idx, int pval, void *pdata)
 {
-    struct snd_control *ctl = AMP_PRIV_GET_CTL_PTR(amp_priv, ctl_idx);
-    char *ctl_name = AMP_PRIV_GET_CTL_NAME_PTR(amp_priv, ctl_idx);
+    struct snd_control *ctl = AMP_PRIV_GET_CTL_PTR(card_ctls, ctl_idx);
+    char *ctl_name = AMP_PRIV_GET_CTL_NAME_PTR(card_ctls, ctl_idx);
 
     snprintf(ctl_name, AIF_NAME_MAX_LEN + 16, "%s %s",
          be_name, amp_be_ctl_name_extn[BE_CTL_NAME_SET_PARAM]);
@@ -2040,32 +2400,32 @@ static void amp_create_be_set_param_ctl(struct amp_priv *amp_priv,
                 pval, pdata);
 }
 
-static int amp_form_be_ctls(struct amp_priv *amp_priv, int ctl_idx, int ctl_cnt __unused)
+static int amp_form_be_ctls(struct amp_card_ctls *card_ctls, int ctl_idx, int ctl_cnt __unused)
 {
-    struct amp_dev_info *rx_adi = &amp_priv->rx_be_devs;
-    struct amp_dev_info *tx_adi = &amp_priv->tx_be_devs;
+    struct amp_dev_info *rx_adi = &card_ctls->rx_be_devs;
+    struct amp_dev_info *tx_adi = &card_ctls->tx_be_devs;
     int i;
 
     for (i = 1; i < rx_adi->count; i++) {
-        amp_create_media_fmt_ctl(amp_priv, rx_adi->names[i], ctl_idx,
+        amp_create_media_fmt_ctl(card_ctls, rx_adi->names[i], ctl_idx,
                                  rx_adi->idx_arr[i], rx_adi);
         ctl_idx++;
-        amp_create_metadata_ctl(amp_priv, rx_adi->names[i], ctl_idx,
+        amp_create_metadata_ctl(card_ctls, rx_adi->names[i], ctl_idx,
                                 rx_adi->idx_arr[i], rx_adi);
         ctl_idx++;
-        amp_create_be_set_param_ctl(amp_priv, rx_adi->names[i], ctl_idx,
+        amp_create_be_set_param_ctl(card_ctls, rx_adi->names[i], ctl_idx,
                                 rx_adi->idx_arr[i], rx_adi);
         ctl_idx++;
     }
 
     for (i = 1; i < tx_adi->count; i++) {
-        amp_create_media_fmt_ctl(amp_priv, tx_adi->names[i], ctl_idx,
+        amp_create_media_fmt_ctl(card_ctls, tx_adi->names[i], ctl_idx,
                                  tx_adi->idx_arr[i], tx_adi);
         ctl_idx++;
-        amp_create_metadata_ctl(amp_priv, tx_adi->names[i], ctl_idx,
+        amp_create_metadata_ctl(card_ctls, tx_adi->names[i], ctl_idx,
                                 tx_adi->idx_arr[i], tx_adi);
         ctl_idx++;
-        amp_create_be_set_param_ctl(amp_priv, tx_adi->names[i], ctl_idx,
+        amp_create_be_set_param_ctl(card_ctls, tx_adi->names[i], ctl_idx,
                                 tx_adi->idx_arr[i], tx_adi);
         ctl_idx++;
     }
@@ -2073,11 +2433,11 @@ static int amp_form_be_ctls(struct amp_priv *amp_priv, int ctl_idx, int ctl_cnt
     return 0;
 }
 
-static void amp_create_group_be_media_fmt_ctl(struct amp_priv *amp_priv,
+static void amp_create_group_be_media_fmt_ctl(struct amp_card_ctls *card_ctls,
                 char *group_be_name, int ctl_idx, int pval, void *pdata)
 {
-    struct snd_control *ctl = AMP_PRIV_GET_CTL_PTR(amp_priv, ctl_idx);
-    char *ctl_name = AMP_PRIV_GET_CTL_NAME_PTR(amp_priv, ctl_idx);
+    struct snd_control *ctl = AMP_PRIV_GET_CTL_PTR(card_ctls, ctl_idx);
+    char *ctl_name = AMP_PRIV_GET_CTL_NAME_PTR(card_ctls, ctl_idx);
 
     snprintf(ctl_name, AIF_NAME_MAX_LEN + 16, "%s %s",
              group_be_name, amp_group_be_ctl_name_extn[BE_GROUP_CTL_NAME_MEDIA_CONFIG]);
@@ -2085,71 +2445,65 @@ static void amp_create_group_be_media_fmt_ctl(struct amp_priv *amp_priv,
                     amp_group_be_media_fmt_put, group_media_fmt_int, pval, pdata);
 }
 
-static int amp_form_group_be_ctls(struct amp_priv *amp_priv, int ctl_idx, int ctl_cnt __unused)
+static int amp_form_group_be_ctls(struct amp_card_ctls *card_ctls, int ctl_idx, int ctl_cnt __unused)
 {
-    struct amp_be_group_info *grp_info = &amp_priv->group_be_devs;
+    struct amp_be_group_info *grp_info = &card_ctls->group_be_devs;
     int i;
 
     for (i = 0; i < grp_info->count; i++) {
-        amp_create_group_be_media_fmt_ctl(amp_priv, grp_info->names[i], ctl_idx,
+        amp_create_group_be_media_fmt_ctl(card_ctls, grp_info->names[i], ctl_idx,
                                  grp_info->idx_arr[i], grp_info);
         ctl_idx++;
     }
     return 0;
 }
 
-static int amp_form_common_pcm_ctls(struct amp_priv *amp_priv, int *ctl_idx,
+static int amp_form_common_pcm_ctls(struct amp_card_ctls *card_ctls, int *ctl_idx,
                 struct amp_dev_info *pcm_adi, struct amp_dev_info *be_adi)
 {
     int i;
 
-    pcm_adi->pcm_mtd_ctl = calloc(pcm_adi->count, sizeof(int));
-    if (!pcm_adi->pcm_mtd_ctl)
-        return -ENOMEM;
-
-    pcm_adi->get_param_info = (struct amp_get_param_info *)calloc(pcm_adi->count, sizeof(struct amp_get_param_info));
-    if (!pcm_adi->get_param_info) {
-        free(pcm_adi->pcm_mtd_ctl);
-        return -ENOMEM;
-    }
-
     for (i = 1; i < pcm_adi->count; i++) {
         char *name = pcm_adi->names[i];
         int idx = pcm_adi->idx_arr[i];
-        amp_create_connect_ctl(amp_priv, name, (*ctl_idx)++,
+        amp_create_connect_ctl(card_ctls, name, (*ctl_idx)++,
                         &be_adi->dev_enum, idx, pcm_adi);
-        amp_create_disconnect_ctl(amp_priv, name, (*ctl_idx)++,
+        amp_create_disconnect_ctl(card_ctls, name, (*ctl_idx)++,
                         &be_adi->dev_enum, idx, pcm_adi);
-        amp_create_mtd_control_ctl(amp_priv, name, (*ctl_idx)++,
+        amp_create_mtd_control_ctl(card_ctls, name, (*ctl_idx)++,
                         &be_adi->dev_enum, i, pcm_adi);
-        amp_create_pcm_metadata_ctl(amp_priv, name, (*ctl_idx)++,
+        amp_create_pcm_metadata_ctl(card_ctls, name, (*ctl_idx)++,
                         idx, pcm_adi);
-        amp_create_pcm_set_param_ctl(amp_priv, name, (*ctl_idx)++,
+        amp_create_pcm_set_param_ctl(card_ctls, name, (*ctl_idx)++,
                         idx, pcm_adi, false, false);
-        amp_create_pcm_set_param_ctl(amp_priv, name, (*ctl_idx)++,
+        amp_create_pcm_set_param_ctl(card_ctls, name, (*ctl_idx)++,
                         idx, pcm_adi, true, false);
-        amp_create_pcm_set_param_ctl(amp_priv, name, (*ctl_idx)++,
+        amp_create_pcm_set_param_ctl(card_ctls, name, (*ctl_idx)++,
                         idx, pcm_adi, true, true);
-        amp_create_pcm_get_tag_info_ctl(amp_priv, name, (*ctl_idx)++,
+        amp_create_pcm_get_tag_info_ctl(card_ctls, name, (*ctl_idx)++,
                         idx, pcm_adi);
-        amp_create_pcm_event_ctl(amp_priv, name, (*ctl_idx)++,
+        amp_create_pcm_event_ctl(card_ctls, name, (*ctl_idx)++,
                         idx, pcm_adi);
-        amp_create_pcm_calibration_ctl(amp_priv, name, (*ctl_idx)++,
+        amp_create_pcm_calibration_ctl(card_ctls, name, (*ctl_idx)++,
                         idx, pcm_adi);
-        amp_create_pcm_get_param_ctl(amp_priv, name, (*ctl_idx)++,
+        amp_create_pcm_get_param_ctl(card_ctls, name, (*ctl_idx)++,
                         i, pcm_adi);
-        amp_create_pcm_bufinfo_ctl(amp_priv, name, (*ctl_idx)++,
+        amp_create_pcm_bufinfo_ctl(card_ctls, name, (*ctl_idx)++,
+                        idx, pcm_adi);
+        amp_create_pcm_transaction_ctl(card_ctls, name, (*ctl_idx)++,
+                        idx, pcm_adi);
+        amp_create_pcm_xrun_ctl(card_ctls, name, (*ctl_idx)++,
                         idx, pcm_adi);
     }
 
     return 0;
 }
 
-static int amp_form_tx_pcm_ctls(struct amp_priv *amp_priv, int *ctl_idx)
+static int amp_form_tx_pcm_ctls(struct amp_card_ctls *card_ctls, int *ctl_idx)
 {
-    struct amp_dev_info *rx_adi = &amp_priv->rx_pcm_devs;
-    struct amp_dev_info *tx_adi = &amp_priv->tx_pcm_devs;
-    struct amp_dev_info *be_rx_adi = &amp_priv->rx_be_devs;
+    struct amp_dev_info *rx_adi = &card_ctls->rx_pcm_devs;
+    struct amp_dev_info *tx_adi = &card_ctls->tx_pcm_devs;
+    struct amp_dev_info *be_rx_adi = &card_ctls->rx_be_devs;
     int i;
 
     for (i = 1; i < tx_adi->count; i++) {
@@ -2157,22 +2511,22 @@ static int amp_form_tx_pcm_ctls(struct amp_priv *amp_priv, int *ctl_idx)
         int idx = tx_adi->idx_arr[i];
 
         /* create loopback controls, enum values are RX PCMs*/
-        amp_create_pcm_loopback_ctl(amp_priv, name, (*ctl_idx)++,
+        amp_create_pcm_loopback_ctl(card_ctls, name, (*ctl_idx)++,
                         &rx_adi->dev_enum, idx, tx_adi);
         /* Echo Reference has backend RX as enum values */
-        amp_create_pcm_echoref_ctl(amp_priv, name, (*ctl_idx)++,
+        amp_create_pcm_echoref_ctl(card_ctls, name, (*ctl_idx)++,
                         &be_rx_adi->dev_enum, idx, tx_adi);
-        amp_create_pcm_buf_tstamp_ctl(amp_priv, name, (*ctl_idx)++,
+        amp_create_pcm_buf_tstamp_ctl(card_ctls, name, (*ctl_idx)++,
                         idx, tx_adi);
     }
 
     return 0;
 }
 
-static int amp_form_rx_pcm_ctls(struct amp_priv *amp_priv, int *ctl_idx)
+static int amp_form_rx_pcm_ctls(struct amp_card_ctls *card_ctls, int *ctl_idx)
 {
-    struct amp_dev_info *rx_adi = &amp_priv->rx_pcm_devs;
-    struct amp_dev_info *be_tx_adi = &amp_priv->tx_be_devs;
+    struct amp_dev_info *rx_adi = &card_ctls->rx_pcm_devs;
+    struct amp_dev_info *be_tx_adi = &card_ctls->tx_be_devs;
     int i;
 
     for (i = 1; i < rx_adi->count; i++) {
@@ -2180,61 +2534,55 @@ static int amp_form_rx_pcm_ctls(struct amp_priv *amp_priv, int *ctl_idx)
         int idx = rx_adi->idx_arr[i];
 
         /* Create sidetone control, enum values are TX backends */
-        amp_create_pcm_sidetone_ctl(amp_priv, name, (*ctl_idx)++,
+        amp_create_pcm_sidetone_ctl(card_ctls, name, (*ctl_idx)++,
                         &be_tx_adi->dev_enum, idx, rx_adi);
-        amp_create_pcm_write_with_metadata_ctl(amp_priv, name, (*ctl_idx)++,
+        amp_create_pcm_write_with_metadata_ctl(card_ctls, name, (*ctl_idx)++,
                         idx, rx_adi);
-        amp_create_pcm_flush_ctl(amp_priv, name, (*ctl_idx)++,
+        amp_create_pcm_flush_ctl(card_ctls, name, (*ctl_idx)++,
                         idx, rx_adi);
     }
 
     return 0;
 }
 
-static int amp_form_pcm_ctls(struct amp_priv *amp_priv, int ctl_idx, int ctl_cnt __unused)
+static int amp_form_pcm_ctls(struct amp_card_ctls *card_ctls, int ctl_idx, int ctl_cnt __unused)
 {
-    struct amp_dev_info *rx_adi = &amp_priv->rx_pcm_devs;
-    struct amp_dev_info *tx_adi = &amp_priv->tx_pcm_devs;
-    struct amp_dev_info *be_rx_adi = &amp_priv->rx_be_devs;
-    struct amp_dev_info *be_tx_adi = &amp_priv->tx_be_devs;
+    struct amp_dev_info *rx_adi = &card_ctls->rx_pcm_devs;
+    struct amp_dev_info *tx_adi = &card_ctls->tx_pcm_devs;
+    struct amp_dev_info *be_rx_adi = &card_ctls->rx_be_devs;
+    struct amp_dev_info *be_tx_adi = &card_ctls->tx_be_devs;
     int ret;
 
     /* Form common controls for RX pcms */
-    ret = amp_form_common_pcm_ctls(amp_priv, &ctl_idx, rx_adi, be_rx_adi);
+    ret = amp_form_common_pcm_ctls(card_ctls, &ctl_idx, rx_adi, be_rx_adi);
     if (ret)
         return ret;
 
     /* Form RX PCM specific mixer controls */
-    ret = amp_form_rx_pcm_ctls(amp_priv, &ctl_idx);
+    ret = amp_form_rx_pcm_ctls(card_ctls, &ctl_idx);
     if (ret)
         return ret;
 
     /* Form common controls for TX pcms */
-    ret = amp_form_common_pcm_ctls(amp_priv, &ctl_idx, tx_adi, be_tx_adi);
+    ret = amp_form_common_pcm_ctls(card_ctls, &ctl_idx, tx_adi, be_tx_adi);
     if (ret)
         return ret;
 
     /* Form TX PCM specific mixer controls */
-    ret = amp_form_tx_pcm_ctls(amp_priv, &ctl_idx);
+    ret = amp_form_tx_pcm_ctls(card_ctls, &ctl_idx);
     if (ret)
         return ret;
 
     return 0;
 }
 
-static int amp_form_acdb_ctls(struct amp_priv *amp_priv, int ctl_idx)
+static int amp_form_acdb_ctls(struct amp_card_ctls *card_ctls, int ctl_idx)
 {
-    struct amp_dev_info *acdb_adi = &amp_priv->acdb_tunnels;
-    acdb_adi->get_param_info =
-        (struct amp_get_param_info *)calloc(acdb_adi->count,
-        sizeof(struct amp_get_param_info));
-
-    if (!acdb_adi->get_param_info)
-        return -ENOMEM;
+    struct amp_dev_info *acdb_adi = &card_ctls->acdb_tunnels;
 
-    amp_create_acdb_tunnel_set_ctl(amp_priv, ctl_idx++, acdb_adi->idx_arr[0],
+    amp_create_acdb_tunnel_set_ctl(card_ctls, ctl_idx++, acdb_adi->idx_arr[0],
                                     acdb_adi);
-    amp_create_acdb_tunnel_get_ctl(amp_priv, ctl_idx, acdb_adi->idx_arr[1],
+    amp_create_acdb_tunnel_get_ctl(card_ctls, ctl_idx, acdb_adi->idx_arr[1],
                                     acdb_adi);
 
     return 0;
@@ -2244,62 +2592,269 @@ static ssize_t amp_read_event(struct mixer_plugin *plugin,
                               struct ctl_event *ev, size_t size)
 {
     struct amp_priv *amp_priv = plugin->priv;
+    struct amp_event_ring *ring;
     ssize_t result = 0;
 
-    while (size >= sizeof(struct ctl_event)) {
-        struct mixer_plugin_event_data *data;
-
-        pthread_mutex_lock(&amp_priv->lock);
-        if (list_empty(&amp_priv->events_list)) {
-            pthread_mutex_unlock(&amp_priv->lock);
-            return result;
-        }
-
-        data = node_to_item(amp_priv->events_list.next,
-                            struct mixer_plugin_event_data, node);
-        memcpy(ev, &data->ev, sizeof(struct ctl_event));
-
-        list_remove(&data->node);
-        free(data);
-        pthread_mutex_unlock(&amp_priv->lock);
-
-        ev += sizeof(struct ctl_event);
+    pthread_mutex_lock(&amp_priv->lock);
+    while (size >= sizeof(struct ctl_event) && amp_priv->notify_count) {
+        ring = amp_priv->notify_queue[amp_priv->notify_head];
+        amp_priv->notify_head = (amp_priv->notify_head + 1) %
+                                amp_priv->notify_size;
+        amp_priv->notify_count--;
+        ring->notify_pending = false;
+
+        memset(ev, 0, sizeof(struct ctl_event));
+        ev->type = SNDRV_CTL_EVENT_ELEM;
+        strlcpy((char *)ev->data.elem.id.name, ring->ctl_name,
+                sizeof(ev->data.elem.id.name));
+
+        ev++;
         size -= sizeof(struct ctl_event);
         result += sizeof(struct ctl_event);
     }
+    pthread_mutex_unlock(&amp_priv->lock);
 
     return result;
 }
 
+static void amp_clear_event_rings(struct amp_ctl_cache *cache, int count)
+{
+    int i;
+
+    for (i = 0; i < count; i++) {
+        cache->event_rings[i].head = 0;
+        cache->event_rings[i].count = 0;
+        cache->event_rings[i].notify_pending = false;
+    }
+}
+
 static int amp_subscribe_events(struct mixer_plugin *plugin,
                                   event_callback event_cb)
 {
     struct amp_priv *amp_priv = plugin->priv;
-    struct listnode *eparams_node, *ev_node, *temp, *temp2;
-    struct event_params_node *event_node;
-    struct mixer_plugin_event_data *ev_data;
+    struct amp_card_ctls *card_ctls = amp_priv->card_ctls;
 
     AGM_LOGV("%s: enter\n", __func__);
 
     amp_priv->event_cb = event_cb;
 
-    /* clear all event params on unsubscribe */
+    /* clear all pending events on unsubscribe */
     if (event_cb == NULL) {
-        list_for_each_safe(eparams_node, temp, &amp_priv->events_paramlist) {
-            event_node = node_to_item(eparams_node, struct event_params_node, node);
-            list_remove(&event_node->node);
-            free(event_node);
-        }
+        pthread_mutex_lock(&amp_priv->lock);
+        amp_clear_event_rings(&amp_priv->rx_pcm_cache,
+                              card_ctls->rx_pcm_devs.count);
+        amp_clear_event_rings(&amp_priv->tx_pcm_cache,
+                              card_ctls->tx_pcm_devs.count);
+        amp_priv->notify_head = 0;
+        amp_priv->notify_count = 0;
+        pthread_mutex_unlock(&amp_priv->lock);
+    }
+    return 0;
+}
+
+static void amp_free_ctl_caches(struct amp_priv *amp_priv)
+{
+    struct amp_card_ctls *card_ctls = amp_priv->card_ctls;
+
+    amp_free_ctl_cache(&amp_priv->rx_pcm_cache, card_ctls->rx_pcm_devs.count);
+    amp_free_ctl_cache(&amp_priv->tx_pcm_cache, card_ctls->tx_pcm_devs.count);
+    amp_free_ctl_cache(&amp_priv->acdb_cache, card_ctls->acdb_tunnels.count);
+    free(amp_priv->notify_queue);
+    amp_priv->notify_queue = NULL;
+}
+
+static int amp_alloc_ctl_caches(struct amp_priv *amp_priv)
+{
+    struct amp_card_ctls *card_ctls = amp_priv->card_ctls;
+    int ret;
+
+    ret = amp_alloc_ctl_cache(&amp_priv->rx_pcm_cache,
+                              card_ctls->rx_pcm_devs.count, true);
+    if (ret)
+        goto err;
+
+    ret = amp_alloc_ctl_cache(&amp_priv->tx_pcm_cache,
+                              card_ctls->tx_pcm_devs.count, true);
+    if (ret)
+        goto err;
+
+    ret = amp_alloc_ctl_cache(&amp_priv->acdb_cache,
+                              card_ctls->acdb_tunnels.count, false);
+    if (ret)
+        goto err;
+
+    ret = amp_alloc_event_rings(&amp_priv->rx_pcm_cache,
+                                &card_ctls->rx_pcm_devs);
+    if (ret)
+        goto err;
+
+    ret = amp_alloc_event_rings(&amp_priv->tx_pcm_cache,
+                                &card_ctls->tx_pcm_devs);
+    if (ret)
+        goto err;
+
+    /* each ring is queued at most once */
+    amp_priv->notify_size = card_ctls->rx_pcm_devs.count +
+                            card_ctls->tx_pcm_devs.count;
+    amp_priv->notify_queue = calloc(amp_priv->notify_size,
+                                    sizeof(*amp_priv->notify_queue));
+    if (!amp_priv->notify_queue) {
+        ret = -ENOMEM;
+        goto err;
+    }
+
+    return 0;
+
+err:
+    amp_free_ctl_caches(amp_priv);
+    return ret;
+}
 
-        list_for_each_safe(ev_node, temp2, &amp_priv->events_list) {
-            ev_data = node_to_item(ev_node, struct mixer_plugin_event_data, node);
-            list_remove(&ev_data->node);
-            free(ev_data);
+static void amp_card_ctls_free(struct amp_card_ctls *card_ctls)
+{
+    amp_free_ctls(card_ctls);
+    amp_free_acdb_dev_info(card_ctls);
+    amp_free_pcm_dev_info(card_ctls);
+    amp_free_group_be_dev_info(card_ctls);
+    amp_free_be_dev_info(card_ctls);
+    if (card_ctls->card_node)
+        snd_card_def_put_card(card_ctls->card_node);
+    free(card_ctls);
+}
+
+static int amp_card_ctls_create(unsigned int card,
+                struct amp_card_ctls **card_ctls_out)
+{
+    struct amp_card_ctls *card_ctls;
+    int be_ctl_cnt, pcm_ctl_cnt, total_ctl_cnt = 0;
+    int be_grp_ctl_cnt = 0;
+    int ret = 0;
+
+    card_ctls = calloc(1, sizeof(*card_ctls));
+    if (!card_ctls)
+        return -ENOMEM;
+
+    card_ctls->card = card;
+    card_ctls->card_node = snd_card_def_get_card(card);
+    if (!card_ctls->card_node) {
+        AGM_LOGE("%s: card node not found for card %d\n",
+               __func__, card);
+        ret = -EINVAL;
+        goto err;
+    }
+
+    card_ctls->rx_be_devs.dir = RX;
+    card_ctls->tx_be_devs.dir = TX;
+    card_ctls->rx_pcm_devs.dir = RX;
+    card_ctls->tx_pcm_devs.dir = TX;
+
+    ret = amp_get_be_info(card_ctls);
+    if (ret)
+        goto err;
+
+    ret = amp_get_group_be_info(card_ctls);
+    if (ret)
+        goto err;
+
+    ret = amp_get_pcm_info(card_ctls);
+    if (ret)
+        goto err;
+
+    ret = amp_get_acdb_info(card_ctls);
+    if (ret)
+        goto err;
+
+    /* Get total count of controls to be registered */
+    be_ctl_cnt = amp_get_be_ctl_count(card_ctls);
+    total_ctl_cnt += be_ctl_cnt;
+    be_grp_ctl_cnt = amp_get_group_be_ctl_count(card_ctls);
+    total_ctl_cnt += be_grp_ctl_cnt;
+    pcm_ctl_cnt = amp_get_pcm_ctl_count(card_ctls);
+    total_ctl_cnt += pcm_ctl_cnt;
+    /* add two static mixer control for acdb param set and get*/
+    total_ctl_cnt += 2;
+    /*
+     * Create the controls to be registered
+     * When changing this code, be careful to make sure to create
+     * exactly the same number of controls as of total_ctl_cnt;
+     */
+    card_ctls->ctls = calloc(total_ctl_cnt, sizeof(*card_ctls->ctls));
+    card_ctls->ctl_names = calloc(total_ctl_cnt, sizeof(*card_ctls->ctl_names));
+    if (!card_ctls->ctls || !card_ctls->ctl_names) {
+        ret = -ENOMEM;
+        goto err;
+    }
+
+    ret = amp_form_be_ctls(card_ctls, 0, be_ctl_cnt);
+    if (ret)
+        goto err;
+
+    if (be_grp_ctl_cnt) {
+        ret = amp_form_group_be_ctls(card_ctls, be_ctl_cnt, be_grp_ctl_cnt);
+        if (ret)
+            goto err;
+    }
+
+    ret = amp_form_pcm_ctls(card_ctls, be_ctl_cnt + be_grp_ctl_cnt, pcm_ctl_cnt);
+    if (ret)
+        goto err;
+
+    ret = amp_form_acdb_ctls(card_ctls, be_ctl_cnt + be_grp_ctl_cnt + pcm_ctl_cnt);
+    if (ret)
+        goto err;
+
+    card_ctls->ctl_count = total_ctl_cnt;
+    AGM_LOGV("%s: card %u total_ctl_cnt = %d\n", __func__, card, total_ctl_cnt);
+
+    *card_ctls_out = card_ctls;
+    return 0;
+
+err:
+    amp_card_ctls_free(card_ctls);
+    return ret;
+}
+
+/* controls of the card, formed by the first mixer opened on it */
+static int amp_card_ctls_get(unsigned int card,
+                struct amp_card_ctls **card_ctls_out)
+{
+    struct amp_card_ctls *card_ctls;
+    struct listnode *node;
+    int ret;
+
+    pthread_mutex_lock(&amp_card_ctls_lock);
+    list_for_each(node, &amp_card_ctls_list) {
+        card_ctls = node_to_item(node, struct amp_card_ctls, node);
+        if (card_ctls->card == card) {
+            card_ctls->refs++;
+            goto done;
         }
     }
+
+    ret = amp_card_ctls_create(card, &card_ctls);
+    if (ret) {
+        pthread_mutex_unlock(&amp_card_ctls_lock);
+        return ret;
+    }
+    card_ctls->refs = 1;
+    list_add_tail(&amp_card_ctls_list, &card_ctls->node);
+
+done:
+    pthread_mutex_unlock(&amp_card_ctls_lock);
+    *card_ctls_out = card_ctls;
     return 0;
 }
 
+static void amp_card_ctls_put(struct amp_card_ctls *card_ctls)
+{
+    pthread_mutex_lock(&amp_card_ctls_lock);
+    if (--card_ctls->refs == 0) {
+        list_remove(&card_ctls->node);
+        amp_card_ctls_free(card_ctls);
+    }
+    pthread_mutex_unlock(&amp_card_ctls_lock);
+}
+
 static void amp_close(struct mixer_plugin **plugin)
 {
     struct mixer_plugin *amp = *plugin;
@@ -2310,11 +2865,8 @@ static void amp_close(struct mixer_plugin **plugin)
         amp_priv->event_cb(amp);
     amp_register_event_callback(amp, 0);
     amp_subscribe_events(amp, NULL);
-    snd_card_def_put_card(amp_priv->card_node);
-    amp_free_pcm_dev_info(amp_priv);
-    amp_free_group_be_dev_info(amp_priv);
-    amp_free_be_dev_info(amp_priv);
-    amp_free_ctls(amp_priv);
+    amp_free_ctl_caches(amp_priv);
+    amp_card_ctls_put(amp_priv->card_ctls);
     pthread_mutex_destroy(&amp_priv->lock);
     free(amp_priv);
     free(*plugin);
@@ -2331,10 +2883,8 @@ MIXER_PLUGIN_OPEN_FN(agm_mixer_plugin)
 {
     struct mixer_plugin *amp;
     struct amp_priv *amp_priv;
-    struct pcm_adi;
+    struct amp_card_ctls *card_ctls;
     int ret = 0;
-    int be_ctl_cnt, pcm_ctl_cnt, total_ctl_cnt = 0;
-    int be_grp_ctl_cnt = 0;
 
     AGM_LOGI("%s: enter, card %u\n", __func__, card);
 #ifdef AGM_NO_IPC
@@ -2359,112 +2909,38 @@ MIXER_PLUGIN_OPEN_FN(agm_mixer_plugin)
     }
 
     amp_priv->card = card;
-    amp_priv->card_node = snd_card_def_get_card(amp_priv->card);
-    if (!amp_priv->card_node) {
-        AGM_LOGE("%s: card node not found for card %d\n",
-               __func__, amp_priv->card);
-        ret = -EINVAL;
-        goto err_get_card;
-    }
-
-    amp_priv->rx_be_devs.dir = RX;
-    amp_priv->tx_be_devs.dir = TX;
-    amp_priv->rx_pcm_devs.dir = RX;
-    amp_priv->tx_pcm_devs.dir = TX;
-
-    ret = amp_get_be_info(amp_priv);
-    if (ret)
-        goto err_get_be_info;
-
-    ret = amp_get_group_be_info(amp_priv);
-    if (ret)
-        goto err_get_be_group_info;
-
-    ret = amp_get_pcm_info(amp_priv);
+    ret = amp_card_ctls_get(card, &card_ctls);
     if (ret)
-        goto err_get_pcm_info;
+        goto err_card_ctls_get;
+    amp_priv->card_ctls = card_ctls;
 
-    ret = amp_get_acdb_info(amp_priv);
+    ret = amp_alloc_ctl_caches(amp_priv);
     if (ret)
-        goto err_get_acdb_info;
-
-    /* Get total count of controls to be registered */
-    be_ctl_cnt = amp_get_be_ctl_count(amp_priv);
-    total_ctl_cnt += be_ctl_cnt;
-    be_grp_ctl_cnt = amp_get_group_be_ctl_count(amp_priv);
-    total_ctl_cnt += be_grp_ctl_cnt;
-    pcm_ctl_cnt = amp_get_pcm_ctl_count(amp_priv);
-    total_ctl_cnt += pcm_ctl_cnt;
-    /* add two static mixer control for acdb param set and get*/
-    total_ctl_cnt += 2;
-    /*
-     * Create the controls to be registered
-     * When changing this code, be careful to make sure to create
-     * exactly the same number of controls as of total_ctl_cnt;
-     */
-    amp_priv->ctls = calloc(total_ctl_cnt, sizeof(*amp_priv->ctls));
-    amp_priv->ctl_names = calloc(total_ctl_cnt, sizeof(*amp_priv->ctl_names));
-    if (!amp_priv->ctls || !amp_priv->ctl_names)
-            goto err_ctls_alloc;
-
-    ret = amp_form_be_ctls(amp_priv, 0, be_ctl_cnt);
-    if (ret)
-        goto err_ctls_alloc;
-
-    if (be_grp_ctl_cnt) {
-        ret = amp_form_group_be_ctls(amp_priv, be_ctl_cnt, be_grp_ctl_cnt);
-        if (ret)
-            goto err_ctls_alloc;
-    }
-
-    ret = amp_form_pcm_ctls(amp_priv, be_ctl_cnt + be_grp_ctl_cnt, pcm_ctl_cnt);
-    if (ret)
-        goto err_ctls_alloc;
-
-    ret = amp_form_acdb_ctls(amp_priv, be_ctl_cnt + be_grp_ctl_cnt + pcm_ctl_cnt);
-    if (ret)
-        goto err_ctls_alloc;
+        goto err_ctl_caches;
 
     /* Register the controls */
-    if (total_ctl_cnt > 0) {
-        amp_priv->ctl_count = total_ctl_cnt;
-        amp->controls = amp_priv->ctls;
-        amp->num_controls = amp_priv->ctl_count;
+    if (card_ctls->ctl_count > 0) {
+        amp->controls = card_ctls->ctls;
+        amp->num_controls = card_ctls->ctl_count;
     }
 
     amp->ops = &amp_ops;
     amp->priv = amp_priv;
     *plugin = amp;
 
-    amp_register_event_callback(amp, 1);
-    list_init(&amp_priv->events_paramlist);
-    list_init(&amp_priv->events_list);
     pthread_mutex_init(&amp_priv->lock, (const pthread_mutexattr_t *) NULL);
-    AGM_LOGV("%s: total_ctl_cnt = %d\n", __func__, total_ctl_cnt);
+    amp_register_event_callback(amp, 1);
+    AGM_LOGV("%s: total_ctl_cnt = %d\n", __func__, card_ctls->ctl_count);
 
     return 0;
 
-err_ctls_alloc:
-    amp_free_ctls(amp_priv);
-    amp_free_acdb_dev_info(amp_priv);
+err_ctl_caches:
+    amp_card_ctls_put(card_ctls);
 
-err_get_acdb_info:
-    amp_free_pcm_dev_info(amp_priv);
-
-err_get_pcm_info:
-    if (be_grp_ctl_cnt)
-        amp_free_group_be_dev_info(amp_priv);
-
-err_get_be_group_info:
-    amp_free_be_dev_info(amp_priv);
-
-err_get_be_info:
-    snd_card_def_put_card(amp_priv->card_node);
-
-err_get_card:
+err_card_ctls_get:
     free(amp_priv);
 
 err_priv_alloc:
     free(amp);
-    return -ENOMEM;
+    return ret;
 }
@@ -36,8 +36,12 @@
 #define LOG_TAG "PLUGIN: pcm"
 
 #include <agm/agm_api.h>
+#include <agm/agm_pos_buf.h>
+#include <agm/agm_xrun.h>
+#include <agm/agm_list.h>
 #include <errno.h>
 #include <limits.h>
+#include <pthread.h>
 #include <linux/ioctl.h>
 #include <sys/time.h>
 #include <sys/mman.h>
@@ -61,32 +65,17 @@
 #define PCM_MASK_SIZE (2)
 #define PCM_FORMAT_BIT(x) ((uint64_t)1 << x)
 
-/* pull-push mode macros */
-#define AGM_PULL_PUSH_IDX_RETRY_COUNT 2
-#define AGM_PULL_PUSH_FRAME_CNT_RETRY_COUNT 5
-
 /* multiplier of timeout for wating for mmap buffers */
 #define MMAP_TOUT_MULTI 4
 
-struct agm_shared_pos_buffer {
-    volatile uint32_t frame_counter;
-    volatile uint32_t read_index;
-    volatile uint32_t wall_clock_us_lsw;
-    volatile uint32_t wall_clock_us_msw;
-};
-
 struct pcm_plugin_pos_buf_info {
     void *pos_buf_addr;
     unsigned int boundary;       /* pcm boundary */
     snd_pcm_uframes_t hw_ptr;    /* RO: hw ptr (0...boundary-1) */
-    snd_pcm_uframes_t hw_ptr_base;
-    unsigned int crossed_boundary_cnt;
+    struct agm_pos_tracker tracker;
     struct timespec tstamp;
     snd_pcm_uframes_t appl_ptr;  /* RW: appl ptr (0...boundary-1) */
     snd_pcm_uframes_t avail_min; /* RW: min available frames for wakeup */
-    uint32_t wall_clk_msw;
-    uint32_t wall_clk_lsw;
-    uint32_t frame_counter;
 };
 
 struct agm_mmap_buffer_port {
@@ -109,8 +98,18 @@ struct agm_pcm_priv {
     struct agm_mmap_buffer_port mmap_buffer_port[2];
     bool mmap_status;
     uint32_t mmap_buf_tout;
+    /* node in agm_pcm_list, for the xrun stats of the stream */
+    struct listnode list;
+    unsigned int card;
+    struct agm_xrun_stats xrun;
+    /* avail is still past the buffer since the last xrun */
+    bool in_xrun;
 };
 
+/* open streams, xrun stats are read by the mixer plugin */
+static pthread_mutex_t agm_pcm_list_lock = PTHREAD_MUTEX_INITIALIZER;
+static list_declare(agm_pcm_list);
+
 struct pcm_plugin_hw_constraints agm_pcm_constrs = {
     .access = 0,
     .format = 0,
@@ -288,131 +287,107 @@ static snd_pcm_uframes_t agm_pcm_plugin_get_hw_ptr(struct agm_pcm_priv *priv)
     return pos->hw_ptr;
 }
 
-static int agm_pcm_plugin_get_shared_pos(struct pcm_plugin_pos_buf_info *pos_buf,
-        uint32_t *read_index, uint32_t *wall_clk_msw,
-        uint32_t *wall_clk_lsw)
+static int agm_pcm_plugin_update_hw_ptr(struct agm_pcm_priv *priv)
 {
-    struct agm_shared_pos_buffer *buf;
-    int i, j;
-    uint32_t frame_cnt1, frame_cnt2;
-
-    buf = (struct agm_shared_pos_buffer *)pos_buf->pos_buf_addr;
-    for (i = 0; i < AGM_PULL_PUSH_IDX_RETRY_COUNT; ++i) {
-        for (j = 0; j < AGM_PULL_PUSH_FRAME_CNT_RETRY_COUNT; ++j) {
-            frame_cnt1 = buf->frame_counter;
-            if (frame_cnt1 != 0)
-                break;
-        }
-        *wall_clk_msw = buf->wall_clock_us_msw;
-        *wall_clk_lsw = buf->wall_clock_us_lsw;
-        *read_index = buf->read_index; /* 0,.... Circ_buf_size-1 */
-        frame_cnt2 = buf->frame_counter;
+    struct pcm_plugin_pos_buf_info *pos = priv->pos_buf;
+    uint64_t frames = pos->tracker.frames;
+    uint32_t failures = pos->tracker.read_failures;
+    int ret;
 
-        if (frame_cnt1 != frame_cnt2)
-            continue;
+    ret = agm_pos_tracker_update(&pos->tracker, pos->pos_buf_addr);
+    if (ret == 0) {
+        pos->hw_ptr = agm_pos_to_ptr(pos->tracker.frames, pos->boundary);
+        clock_gettime(CLOCK_MONOTONIC, &pos->tstamp);
+    }
 
-        pos_buf->frame_counter = frame_cnt1;
-        return 0;
+    if (pos->tracker.frames - frames >= priv->total_size_frames ||
+        pos->tracker.read_failures != failures) {
+        pthread_mutex_lock(&agm_pcm_list_lock);
+        if (pos->tracker.frames - frames >= priv->total_size_frames)
+            priv->xrun.pos_gaps++;
+        priv->xrun.pos_read_failures = pos->tracker.read_failures;
+        pthread_mutex_unlock(&agm_pcm_list_lock);
     }
 
-    return -EAGAIN;
+    return ret;
 }
 
-static int agm_pcm_plugin_update_hw_ptr(struct agm_pcm_priv *priv)
+static snd_pcm_sframes_t agm_pcm_get_avail(struct pcm_plugin *plugin)
 {
-    int retries = 10;
-    snd_pcm_sframes_t circ_buf_pos;
-    snd_pcm_uframes_t pos, old_hw_ptr, new_hw_ptr, hw_base;
-    uint32_t read_index, wall_clk_msw, wall_clk_lsw;
-    int64_t delta_wall_clk_us = 0;
-    uint32_t delta_wall_clk_frames = 0;
-    uint64_t sub_res = 0;
-    int ret = 0;
-    uint32_t period_size = priv->period_size; /** in frames */
-    uint32_t crossed_boundary = 0;
-    snd_pcm_uframes_t boundary = 0;
-    uint32_t old_frame_counter = priv->pos_buf->frame_counter;
+    struct agm_pcm_priv *priv = plugin->priv;
+    struct pcm_plugin_pos_buf_info *pos = priv->pos_buf;
 
-    do {
-        ret = agm_pcm_plugin_get_shared_pos(priv->pos_buf,
-                &read_index, &wall_clk_msw, &wall_clk_lsw);
-    } while (ret == -EAGAIN && --retries);
+    return (snd_pcm_sframes_t)agm_pos_avail(pos->hw_ptr, pos->appl_ptr,
+                                            priv->total_size_frames,
+                                            pos->boundary,
+                                            !(plugin->mode & PCM_IN));
+}
 
-    if (ret == 0) {
-        circ_buf_pos = agm_pcm_bytes_to_frames(read_index, priv->media_config);
-        pos = (circ_buf_pos / period_size) * period_size;
-        old_hw_ptr = agm_pcm_plugin_get_hw_ptr(priv);
-        hw_base = priv->pos_buf->hw_ptr_base;
-
-        // Update new_hw_ptr
-        __builtin_uaddl_overflow(hw_base, pos, &new_hw_ptr);
-        __builtin_umull_overflow(priv->pos_buf->boundary,
-                                 priv->pos_buf->crossed_boundary_cnt, &boundary);
-        __builtin_uaddl_overflow(new_hw_ptr, boundary, &new_hw_ptr);
-
-        // Set delta_wall_clk_us only if cached wall clk is non-zero
-        if (priv->pos_buf->wall_clk_msw || priv->pos_buf->wall_clk_lsw) {
-            uint64_t dsp_wall_clk =  (((uint64_t)wall_clk_msw) << 32 | wall_clk_lsw);
-            uint64_t cached_wall_clk = (((uint64_t)priv->pos_buf->wall_clk_msw) << 32 |
-                                         priv->pos_buf->wall_clk_lsw);
-            // Compute delta only if diff is greater than zero
-            if (dsp_wall_clk > cached_wall_clk) {
-                __builtin_usubl_overflow(dsp_wall_clk,cached_wall_clk,&sub_res);
-                delta_wall_clk_us = (int64_t)sub_res;
-            }
-        }
-        // Identify the number of times of shared buffer length that the
-        // hw ptr has jumped through by checking wall clock time delta
-        // and assuming read ptr moved at a constant rate
-        if (delta_wall_clk_us > 0 ) {
-            __builtin_mul_overflow(delta_wall_clk_us / 1000000,
-                (priv->media_config->rate * priv->media_config->channels),
-                 &delta_wall_clk_frames);
-            crossed_boundary = delta_wall_clk_frames / priv->total_size_frames;
-        }
+static uint64_t agm_pcm_now_us(void)
+{
+    struct timespec ts;
 
-        // More than 1 loop of shared buffer completed by hw_ptr
-        // No need to check if new_hw_ptr < old_hw_ptr, as new_hw_ptr
-        // has crossed old_hw_ptr atleast once if not more
-        if (crossed_boundary > 0) {
-            hw_base += (crossed_boundary * priv->total_size_frames);
-            if (hw_base >= priv->pos_buf->boundary) {
-                priv->pos_buf->crossed_boundary_cnt += hw_base / priv->pos_buf->boundary;
-                hw_base = 0;
-            }
-            __builtin_uaddl_overflow(hw_base, pos, &new_hw_ptr);
-            __builtin_uaddl_overflow(new_hw_ptr,
-                priv->pos_buf->boundary * priv->pos_buf->crossed_boundary_cnt, &new_hw_ptr);
-            priv->pos_buf->hw_ptr_base = hw_base;
-            AGM_LOGD("%s: crossed_boundary = %u, new_hw_ptr=%ld \n",
-                                                __func__, crossed_boundary, new_hw_ptr);
-            AGM_LOGD("%s: delta_wall_clk_frames = %lx, delta_wall_clk_us=%ld \n",
-                                                __func__, delta_wall_clk_frames, delta_wall_clk_us);
-            AGM_LOGD("%s: shared buffer length = %lx \n",
-                                                __func__, priv->total_size_frames);
-        } else {
-            if (new_hw_ptr < old_hw_ptr) {
-                hw_base += priv->total_size_frames;
-                if (hw_base >= priv->pos_buf->boundary) {
-                    hw_base = 0;
-                    priv->pos_buf->crossed_boundary_cnt += 1;
-                }
-                __builtin_uaddl_overflow(hw_base, pos, &new_hw_ptr);
-                __builtin_umull_overflow(priv->pos_buf->boundary,
-                                         priv->pos_buf->crossed_boundary_cnt, &boundary);
-                __builtin_uaddl_overflow(new_hw_ptr, boundary, &new_hw_ptr);
-                priv->pos_buf->hw_ptr_base = hw_base;
-            }
-        }
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
 
-        priv->pos_buf->hw_ptr = new_hw_ptr;
-        // cache wall clk only when there's data update in shared buffer
-        if (priv->pos_buf->frame_counter != old_frame_counter) {
-            priv->pos_buf->wall_clk_lsw = wall_clk_lsw;
-            priv->pos_buf->wall_clk_msw = wall_clk_msw;
+/*
+ *Count an xrun when avail first grows past the buffer. The DSP keeps the
+ *session running, so the stream state is left alone and the xrun is only
+ *reported through agm_pcm_plugin_get_xrun_stats().
+ */
+static void agm_pcm_check_xrun(struct pcm_plugin *plugin,
+                               snd_pcm_sframes_t avail)
+{
+    struct agm_pcm_priv *priv = plugin->priv;
+    snd_pcm_uframes_t excess;
+
+    if (avail <= (snd_pcm_sframes_t)priv->total_size_frames) {
+        priv->in_xrun = false;
+        return;
+    }
+    if (priv->in_xrun)
+        return;
+
+    priv->in_xrun = true;
+    excess = avail - priv->total_size_frames;
+    pthread_mutex_lock(&agm_pcm_list_lock);
+    priv->xrun.xruns++;
+    if (excess > priv->xrun.xrun_frames_max)
+        priv->xrun.xrun_frames_max = excess;
+    priv->xrun.last_xrun_us = agm_pcm_now_us();
+    pthread_mutex_unlock(&agm_pcm_list_lock);
+
+    AGM_LOGD("%s: session %d %s, avail %ld of %lu frames\n", __func__,
+             priv->session_id, (plugin->mode & PCM_IN) ? "overrun" : "underrun",
+             (long)avail, (unsigned long)priv->total_size_frames);
+}
+
+static void agm_pcm_count_error(struct agm_pcm_priv *priv, uint32_t *counter)
+{
+    pthread_mutex_lock(&agm_pcm_list_lock);
+    (*counter)++;
+    priv->xrun.last_error_us = agm_pcm_now_us();
+    pthread_mutex_unlock(&agm_pcm_list_lock);
+}
+
+int agm_pcm_plugin_get_xrun_stats(unsigned int card, unsigned int device,
+                                  struct agm_xrun_stats *stats)
+{
+    struct agm_pcm_priv *priv;
+    struct listnode *node;
+    int ret = -ENODEV;
+
+    pthread_mutex_lock(&agm_pcm_list_lock);
+    list_for_each(node, &agm_pcm_list) {
+        priv = node_to_item(node, struct agm_pcm_priv, list);
+        if (priv->card == card && priv->session_id == (int)device) {
+            *stats = priv->xrun;
+            ret = 0;
+            break;
         }
-        clock_gettime(CLOCK_MONOTONIC, &priv->pos_buf->tstamp);
     }
+    pthread_mutex_unlock(&agm_pcm_list_lock);
 
     return ret;
 }
@@ -454,11 +429,8 @@ static int agm_pcm_plugin_reset(struct pcm_plugin *plugin)
         ret = -EINVAL;
     }
     agm_pcm_plugin_update_hw_ptr(priv);
-    priv->pos_buf->hw_ptr = (snd_pcm_uframes_t)(priv->pos_buf->hw_ptr % priv->total_size_frames);
-    priv->pos_buf->hw_ptr_base = 0;
-    priv->pos_buf->wall_clk_msw = 0;
-    priv->pos_buf->wall_clk_lsw = 0;
-    priv->pos_buf->crossed_boundary_cnt = 0;
+    agm_pos_tracker_reset(&priv->pos_buf->tracker);
+    priv->pos_buf->hw_ptr = priv->pos_buf->tracker.frames;
     AGM_LOGD("%s: reset hw_ptr to %d \n", __func__, priv->pos_buf->hw_ptr);
     return ret;
 }
@@ -570,6 +542,7 @@ static int agm_pcm_sync_ptr(struct pcm_plugin *plugin,
 
     sync_ptr->s.status.hw_ptr = agm_pcm_plugin_get_hw_ptr(priv);
     sync_ptr->s.status.tstamp = priv->pos_buf->tstamp;
+    agm_pcm_check_xrun(plugin, agm_pcm_get_avail(plugin));
 
     return ret;
 }
@@ -592,6 +565,8 @@ static int agm_pcm_writei_frames(struct pcm_plugin *plugin, struct snd_xferi *x)
 
     ret = agm_session_write(handle, buff, &count);
     errno = ret;
+    if (ret)
+        agm_pcm_count_error(priv, &priv->xrun.transfer_errors);
 
     return ret;
 }
@@ -613,6 +588,8 @@ static int agm_pcm_readi_frames(struct pcm_plugin *plugin, struct snd_xferi *x)
             agm_format_to_bits(priv->media_config->format) / 8);
     ret = agm_session_read(handle, buff, &count);
     errno = ret;
+    if (ret)
+        agm_pcm_count_error(priv, &priv->xrun.transfer_errors);
 
     return ret;
 }
@@ -637,10 +614,9 @@ static int agm_pcm_prepare(struct pcm_plugin *plugin)
     struct agm_pcm_priv *priv = plugin->priv;
     int ret = 0;
 
-    if (priv->pos_buf) {
-        priv->pos_buf->wall_clk_msw = 0;
-        priv->pos_buf->wall_clk_lsw = 0;
-    }
+    if (priv->pos_buf)
+        priv->pos_buf->tracker.wall_clock_us = 0;
+    priv->in_xrun = false;
 
     ret = agm_get_session_handle(priv, &handle);
     if (ret)
@@ -698,6 +674,17 @@ static int agm_pcm_close(struct pcm_plugin *plugin)
     ret = agm_session_close(handle);
     errno = ret;
 
+    pthread_mutex_lock(&agm_pcm_list_lock);
+    list_remove(&priv->list);
+    pthread_mutex_unlock(&agm_pcm_list_lock);
+    if (priv->xrun.xruns || priv->xrun.pos_gaps || priv->xrun.timeouts ||
+        priv->xrun.transfer_errors)
+        AGM_LOGD("%s: session %d xruns %u, position gaps %u, late wakeups %u, "
+                 "timeouts %u, transfer errors %u\n", __func__,
+                 priv->session_id, priv->xrun.xruns, priv->xrun.pos_gaps,
+                 priv->xrun.late_wakeups, priv->xrun.timeouts,
+                 priv->xrun.transfer_errors);
+
     snd_card_def_put_card(priv->card_node);
     free(priv->buffer_config);
     free(priv->media_config);
@@ -728,39 +715,6 @@ static int agm_pcm_close(struct pcm_plugin *plugin)
     return ret;
 }
 
-static snd_pcm_sframes_t agm_pcm_get_avail(struct pcm_plugin *plugin)
-{
-    struct agm_pcm_priv *priv = plugin->priv;
-    snd_pcm_sframes_t avail = 0;
-    enum direction dir;
-
-    dir = (plugin->mode & PCM_IN) ? TX : RX;
-
-    if (dir == RX) {
-        snd_pcm_uframes_t temp_value = 0;
-        // In first condition, if there is no overflow, temp_value holds the addition result;
-        // if there is overflow, __builtin_add_overflow returns true, then exit if clause.
-        // In second condition, if there is overflow, __builtin_sub_overflow returns true and
-        // we reset avail to 0. If there is no overflow, avail holds the final result and exit.
-        if (!__builtin_add_overflow(priv->pos_buf->hw_ptr, priv->total_size_frames,
-                &temp_value) &&
-            __builtin_sub_overflow(temp_value, priv->pos_buf->appl_ptr, &avail)) {
-            avail = 0;
-        }
-
-        if (avail < 0)
-            avail += priv->pos_buf->boundary;
-        else if ((snd_pcm_uframes_t)avail >= priv->pos_buf->boundary)
-            avail -= priv->pos_buf->boundary;
-    } else if (dir == TX) {
-        __builtin_sub_overflow(priv->pos_buf->hw_ptr, priv->pos_buf->appl_ptr, &avail);
-        if (avail < 0)
-            avail += priv->pos_buf->boundary;
-    }
-
-    return avail;
-}
-
 static int agm_pcm_poll(struct pcm_plugin *plugin, struct pollfd *pfd,
         nfds_t nfds __attribute__ ((unused)), int timeout)
 {
@@ -769,17 +723,32 @@ static int agm_pcm_poll(struct pcm_plugin *plugin, struct pollfd *pfd,
     snd_pcm_sframes_t avail;
     int ret = 0;
     uint32_t period_to_msec = period_size / (priv->media_config->rate / 1000);
+    uint64_t start_us, late_us;
 
     avail = agm_pcm_get_avail(plugin);
 
     if (avail < period_size) {
         if (timeout == 0) //wait for 1msec
             timeout = 1;
+        start_us = agm_pcm_now_us();
         usleep(timeout * 1000);
+        late_us = agm_pcm_now_us() - start_us;
+        late_us = late_us > (uint64_t)timeout * 1000 ?
+                  late_us - (uint64_t)timeout * 1000 : 0;
+        /* woken a period or more after asked, the DSP may have starved */
+        if (late_us >= (uint64_t)period_size * 1000000 / priv->media_config->rate) {
+            pthread_mutex_lock(&agm_pcm_list_lock);
+            priv->xrun.late_wakeups++;
+            if (late_us > priv->xrun.late_wakeup_max_us)
+                priv->xrun.late_wakeup_max_us = (uint32_t)late_us;
+            priv->xrun.last_late_wakeup_us = start_us + timeout * 1000 + late_us;
+            pthread_mutex_unlock(&agm_pcm_list_lock);
+        }
         ret = agm_pcm_plugin_update_hw_ptr(priv);
         if (ret == 0)
             avail = agm_pcm_get_avail(plugin);
     }
+    agm_pcm_check_xrun(plugin, avail);
 
     if (avail >= period_size) {
         if (plugin->mode & PCM_IN) {
@@ -796,6 +765,7 @@ static int agm_pcm_poll(struct pcm_plugin *plugin, struct pollfd *pfd,
         if (priv->mmap_buf_tout > (period_to_msec * MMAP_TOUT_MULTI)) {
             AGM_LOGE("timeout in waiting for mmap buffer");
             priv->mmap_buf_tout = 0;
+            agm_pcm_count_error(priv, &priv->xrun.timeouts);
             errno = ETIMEDOUT;
             return -ETIMEDOUT;
         }
@@ -814,6 +784,7 @@ static void* agm_pcm_mmap(struct pcm_plugin *plugin, void *addr __unused, size_t
     int flag = DATA_BUF;
     int ret = 0;
     unsigned int boundary;
+    int retries = 0;
     void *mmap_addr = NULL;
     enum direction dir;
     if (offset != 0)
@@ -855,6 +826,13 @@ static void* agm_pcm_mmap(struct pcm_plugin *plugin, void *addr __unused, size_t
                 boundary *= 2;
 
             priv->pos_buf->boundary = boundary;
+
+            /* optional, attempts at reading the DSP position */
+            snd_card_def_get_int(plugin->node, "pos_buf_retries", &retries);
+            agm_pos_tracker_init(&priv->pos_buf->tracker,
+                    agm_pcm_frames_to_bytes(priv->media_config, 1),
+                    priv->period_size, priv->total_size_frames,
+                    priv->media_config->rate, retries);
             AGM_LOGE("%s: boundary: 0x%x, size_frames: 0x%lx\n",
                     __func__, boundary, priv->total_size_frames);
         }
@@ -1015,6 +993,10 @@ PCM_PLUGIN_OPEN_FN(agm_pcm_plugin)
         goto err_card_put;
     }
     priv->handle = handle;
+    priv->card = card;
+    pthread_mutex_lock(&agm_pcm_list_lock);
+    list_add_tail(&agm_pcm_list, &priv->list);
+    pthread_mutex_unlock(&agm_pcm_list_lock);
     *plugin = agm_pcm_plugin;
 
     return 0;
@@ -0,0 +1,156 @@
+/*
+** Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+** SPDX-License-Identifier: BSD-3-Clause-Clear
+*/
+
+#include <tinyalsa/asoundlib.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "agmmixer.h"
+
+/*
+ * Rate of writes to the AGM virtual mixer controls of one stream:
+ *   control      - "PCM<id> control" enum, handled in the mixer plugin
+ *   lookup       - same, but the control is looked up by name every time
+ *   metadata     - "PCM<id> metadata" with an empty payload, goes to AGM
+ */
+
+void usage()
+{
+    printf(" Usage: agmmixerbench [-D card] [-d device] [-i intf_name] [-n iterations]\n"
+           " Measures mixer control writes per second on the AGM virtual mixer.\n"
+           " -i selects the backend written to the control ctl, ZERO by default.\n");
+}
+
+static double elapsed_s(struct timespec *start)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) +
+           (now.tv_nsec - start->tv_nsec) / 1000000000.0;
+}
+
+static void report(const char *name, unsigned int count, unsigned int errors,
+                   double secs)
+{
+    printf("%-10s %8u writes %6u errors %10.0f writes/s %8.2f us/write\n",
+           name, count, errors, secs > 0 ? count / secs : 0.0,
+           count ? secs * 1000000.0 / count : 0.0);
+}
+
+static int bench_control(struct mixer *mixer, char *ctl_name, char *intf_name,
+                         unsigned int iterations, bool lookup)
+{
+    struct mixer_ctl *ctl = NULL;
+    struct timespec start;
+    unsigned int i, errors = 0;
+
+    if (!lookup) {
+        ctl = mixer_get_ctl_by_name(mixer, ctl_name);
+        if (!ctl) {
+            printf("Invalid mixer control: %s\n", ctl_name);
+            return -ENOENT;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < iterations; i++) {
+        if (lookup)
+            ctl = mixer_get_ctl_by_name(mixer, ctl_name);
+        if (!ctl || mixer_ctl_set_enum_by_string(ctl, (i & 1) ? "ZERO" : intf_name))
+            errors++;
+    }
+    report(lookup ? "lookup" : "control", iterations, errors, elapsed_s(&start));
+
+    return 0;
+}
+
+static int bench_metadata(struct mixer *mixer, char *ctl_name,
+                          unsigned int iterations)
+{
+    struct mixer_ctl *ctl;
+    struct timespec start;
+    /* no gkv, no ckv and a property with no values */
+    uint32_t metadata[4] = {0};
+    unsigned int i, errors = 0;
+
+    ctl = mixer_get_ctl_by_name(mixer, ctl_name);
+    if (!ctl) {
+        printf("Invalid mixer control: %s\n", ctl_name);
+        return -ENOENT;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < iterations; i++) {
+        if (mixer_ctl_set_array(ctl, metadata, sizeof(metadata)))
+            errors++;
+    }
+    report("metadata", iterations, errors, elapsed_s(&start));
+
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned int card = 100;
+    unsigned int device = 100;
+    unsigned int iterations = 10000;
+    char *intf_name = "ZERO";
+    char ctl_name[64];
+    struct mixer *mixer;
+    int ret = 0;
+
+    argv += 1;
+    while (*argv) {
+        if (strcmp(*argv, "-D") == 0) {
+            argv++;
+            if (*argv)
+                card = atoi(*argv);
+        } else if (strcmp(*argv, "-d") == 0) {
+            argv++;
+            if (*argv)
+                device = atoi(*argv);
+        } else if (strcmp(*argv, "-i") == 0) {
+            argv++;
+            if (*argv)
+                intf_name = *argv;
+        } else if (strcmp(*argv, "-n") == 0) {
+            argv++;
+            if (*argv)
+                iterations = atoi(*argv);
+        } else if (strcmp(*argv, "-h") == 0) {
+            usage();
+            return 0;
+        }
+        if (*argv)
+            argv++;
+    }
+
+    mixer = mixer_open(card);
+    if (!mixer) {
+        printf("Failed to open mixer\n");
+        return 1;
+    }
+
+    snprintf(ctl_name, sizeof(ctl_name), "PCM%u control", device);
+    ret = bench_control(mixer, ctl_name, intf_name, iterations, false);
+    if (ret)
+        goto done;
+
+    ret = bench_control(mixer, ctl_name, intf_name, iterations, true);
+    if (ret)
+        goto done;
+
+    snprintf(ctl_name, sizeof(ctl_name), "PCM%u metadata", device);
+    ret = bench_metadata(mixer, ctl_name, iterations);
+
+done:
+    mixer_close(mixer);
+    return ret ? 1 : 0;
+}
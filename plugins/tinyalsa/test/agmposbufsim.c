@@ -0,0 +1,325 @@
+/*
+** Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+** SPDX-License-Identifier: BSD-3-Clause-Clear
+*/
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <agm/agm_pos_buf.h>
+
+/*
+ *Replays DSP position buffer updates against the reader of agm_pos_buf.h
+ *and checks the frame count it keeps against where the DSP really is.
+ *Generated traces move one period per update with jittered DSP time, the
+ *reader skips a random number of updates to cover laps of the buffer it
+ *does not see. Trace files have one update per line:
+ *    <wall clock us> <read index bytes> [frames, checked if present]
+ *Frames are 4 bytes, as for 16 bit stereo.
+ */
+
+#define SIM_FRAME_SIZE 4
+
+struct sim {
+    struct agm_shared_pos_buffer buf;
+    struct agm_pos_tracker tracker;
+    uint32_t rate;
+    uint32_t period_frames;
+    uint32_t buffer_frames;
+    uint32_t counter;
+    uint64_t seed;
+    /* results */
+    unsigned int updates;
+    unsigned int reads;
+    unsigned int errors;
+    unsigned int torn;
+    uint64_t max_error;
+};
+
+void usage()
+{
+    printf(" Usage: agmposbufsim [-r rate] [-p period_frames] [-n periods]\n"
+           "                     [-u updates] [-j jitter_us] [-s seed]\n"
+           "                     [-f trace_file] [-t stress_seconds]\n"
+           " Replays DSP position updates and reports the accuracy and cost\n"
+           " of the position reader. -t also races a writer thread against\n"
+           " the reader to look for torn reads.\n");
+}
+
+/* same sequence on every run for a seed */
+static uint32_t sim_rand(struct sim *sim)
+{
+    sim->seed = sim->seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (uint32_t)(sim->seed >> 33);
+}
+
+static void sim_publish(struct agm_shared_pos_buffer *buf, uint32_t *counter,
+                        uint32_t read_index, uint64_t wall_clock_us)
+{
+    /* as the DSP does, 0 while the other fields change */
+    __atomic_store_n(&buf->frame_counter, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    buf->read_index = read_index;
+    buf->wall_clock_us_lsw = (uint32_t)wall_clock_us;
+    buf->wall_clock_us_msw = (uint32_t)(wall_clock_us >> 32);
+    if (++*counter == 0)
+        *counter = 1;
+    __atomic_store_n(&buf->frame_counter, *counter, __ATOMIC_RELEASE);
+}
+
+static void sim_check(struct sim *sim, uint64_t frames)
+{
+    uint64_t err;
+
+    sim->reads++;
+    if (agm_pos_tracker_update(&sim->tracker, &sim->buf)) {
+        sim->torn++;
+        return;
+    }
+
+    err = sim->tracker.frames > frames ? sim->tracker.frames - frames :
+                                         frames - sim->tracker.frames;
+    if (err) {
+        if (!sim->errors)
+            printf("first error at update %u: tracked %llu, DSP at %llu\n",
+                   sim->updates, (unsigned long long)sim->tracker.frames,
+                   (unsigned long long)frames);
+        sim->errors++;
+    }
+    if (err > sim->max_error)
+        sim->max_error = err;
+}
+
+static void sim_generated(struct sim *sim, unsigned int updates,
+                          uint32_t jitter_us)
+{
+    uint64_t frames = 0, wall_us, base_us = 1000000;
+    unsigned int skip = 0;
+    int32_t jitter;
+
+    while (sim->updates < updates) {
+        frames += sim->period_frames;
+        wall_us = base_us + frames * 1000000 / sim->rate;
+        if (jitter_us) {
+            jitter = (int32_t)(sim_rand(sim) % (2 * jitter_us + 1)) -
+                     (int32_t)jitter_us;
+            wall_us += jitter;
+        }
+        sim_publish(&sim->buf, &sim->counter,
+                    (frames % sim->buffer_frames) * SIM_FRAME_SIZE, wall_us);
+        sim->updates++;
+
+        if (skip) {
+            skip--;
+            continue;
+        }
+        sim_check(sim, frames);
+
+        /* mostly keep up, sometimes stall for up to three laps */
+        if (sim_rand(sim) % 8 == 0)
+            skip = sim_rand(sim) % (3 * sim->buffer_frames /
+                                    sim->period_frames + 1);
+    }
+}
+
+static int sim_replay(struct sim *sim, const char *path)
+{
+    unsigned long long wall_us, frames;
+    unsigned int read_index;
+    char line[128];
+    FILE *fp;
+    int n;
+
+    fp = fopen(path, "r");
+    if (!fp) {
+        printf("Unable to open trace %s\n", path);
+        return -errno;
+    }
+
+    while (fgets(line, sizeof(line), fp)) {
+        if (line[0] == '#')
+            continue;
+        n = sscanf(line, "%llu %u %llu", &wall_us, &read_index, &frames);
+        if (n < 2)
+            continue;
+        sim_publish(&sim->buf, &sim->counter, read_index, wall_us);
+        sim->updates++;
+        if (n == 3) {
+            sim_check(sim, frames);
+        } else {
+            sim->reads++;
+            if (agm_pos_tracker_update(&sim->tracker, &sim->buf))
+                sim->torn++;
+        }
+    }
+    fclose(fp);
+
+    return 0;
+}
+
+static double elapsed_ns(struct timespec *start)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1000000000.0 +
+           (now.tv_nsec - start->tv_nsec);
+}
+
+/* cost of a read when the DSP did not move and when it did */
+static void sim_cost(struct sim *sim)
+{
+    struct agm_pos_tracker t = sim->tracker;
+    struct timespec start;
+    unsigned int i, count = 1000000;
+    uint32_t counter = sim->counter;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < count; i++)
+        agm_pos_tracker_update(&t, &sim->buf);
+    printf("read, no update   %8.1f ns\n", elapsed_ns(&start) / count);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < count; i++) {
+        sim_publish(&sim->buf, &counter,
+                    (i % sim->buffer_frames) * SIM_FRAME_SIZE, 1000000 + i);
+        agm_pos_tracker_update(&t, &sim->buf);
+    }
+    printf("publish and read  %8.1f ns\n", elapsed_ns(&start) / count);
+}
+
+struct stress {
+    struct agm_shared_pos_buffer buf;
+    volatile bool done;
+};
+
+/* the wall clock is always read_index + 1, a torn read breaks that */
+static void *stress_writer(void *arg)
+{
+    struct stress *st = arg;
+    uint32_t counter = 0, i = 0;
+
+    while (!st->done) {
+        i++;
+        sim_publish(&st->buf, &counter, i, (uint64_t)i + 1 +
+                    ((uint64_t)i << 32));
+    }
+    return NULL;
+}
+
+static int sim_stress(unsigned int seconds)
+{
+    struct agm_pos_buf_snapshot snap;
+    struct stress st;
+    struct timespec start;
+    unsigned long long reads = 0, given_up = 0, torn = 0;
+    pthread_t writer;
+
+    memset(&st, 0, sizeof(st));
+    if (pthread_create(&writer, NULL, stress_writer, &st))
+        return -EINVAL;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while (elapsed_ns(&start) < seconds * 1000000000.0) {
+        reads++;
+        if (agm_pos_buf_read(&st.buf, &snap, AGM_POS_BUF_READ_RETRIES)) {
+            given_up++;
+            continue;
+        }
+        if (snap.wall_clock_us != (uint64_t)snap.read_index + 1 +
+                                  ((uint64_t)snap.read_index << 32))
+            torn++;
+    }
+    st.done = true;
+    pthread_join(writer, NULL);
+
+    printf("stress: %llu reads, %llu given up, %llu torn\n",
+           reads, given_up, torn);
+    return torn ? -EIO : 0;
+}
+
+int main(int argc, char **argv)
+{
+    struct sim sim;
+    unsigned int updates = 100000, periods = 4, stress = 0;
+    uint32_t jitter_us = 500;
+    char *trace = NULL;
+    int ret = 0;
+
+    memset(&sim, 0, sizeof(sim));
+    sim.rate = 48000;
+    sim.period_frames = 240;
+    sim.seed = 1;
+
+    argv += 1;
+    while (*argv) {
+        if (strcmp(*argv, "-r") == 0) {
+            argv++;
+            if (*argv)
+                sim.rate = atoi(*argv);
+        } else if (strcmp(*argv, "-p") == 0) {
+            argv++;
+            if (*argv)
+                sim.period_frames = atoi(*argv);
+        } else if (strcmp(*argv, "-n") == 0) {
+            argv++;
+            if (*argv)
+                periods = atoi(*argv);
+        } else if (strcmp(*argv, "-u") == 0) {
+            argv++;
+            if (*argv)
+                updates = atoi(*argv);
+        } else if (strcmp(*argv, "-j") == 0) {
+            argv++;
+            if (*argv)
+                jitter_us = atoi(*argv);
+        } else if (strcmp(*argv, "-s") == 0) {
+            argv++;
+            if (*argv)
+                sim.seed = strtoull(*argv, NULL, 0);
+        } else if (strcmp(*argv, "-f") == 0) {
+            argv++;
+            if (*argv)
+                trace = *argv;
+        } else if (strcmp(*argv, "-t") == 0) {
+            argv++;
+            if (*argv)
+                stress = atoi(*argv);
+        } else if (strcmp(*argv, "-h") == 0) {
+            usage();
+            return 0;
+        }
+        if (*argv)
+            argv++;
+    }
+
+    if (!sim.rate || !sim.period_frames || !periods) {
+        usage();
+        return 1;
+    }
+    sim.buffer_frames = sim.period_frames * periods;
+    agm_pos_tracker_init(&sim.tracker, SIM_FRAME_SIZE, sim.period_frames,
+                         sim.buffer_frames, sim.rate, 0);
+
+    if (trace)
+        ret = sim_replay(&sim, trace);
+    else
+        sim_generated(&sim, updates, jitter_us);
+    if (ret)
+        return 1;
+
+    printf("%u updates, %u reads, %u given up, %u wrong, max error %llu frames\n",
+           sim.updates, sim.reads, sim.torn, sim.errors,
+           (unsigned long long)sim.max_error);
+    sim_cost(&sim);
+
+    if (stress && sim_stress(stress))
+        ret = -EIO;
+
+    return (ret || sim.errors) ? 1 : 0;
+}
@@ -29,7 +29,14 @@ LOCAL_SRC_FILES  := \
     src/graph.c\
     src/graph_module.c\
     src/metadata.c\
+    src/param_store.c\
     src/session_obj.c\
+    src/session_async.c\
+    src/session_txn.c\
+    src/session_fanout.c\
+    src/blob_registry.c\
+    src/ssr_recovery.c\
+    src/agm_sched.c\
     src/device.c \
     src/utils.c \
     src/device_hw_ep.c \
@@ -59,6 +66,11 @@ LOCAL_SHARED_LIBRARIES += libtinyalsa
 endif
 
 
+#data path locks use priority inheritance unless disabled
+ifneq ($(strip $(AUDIO_FEATURE_ENABLED_AGM_PI_LOCKS)), false)
+LOCAL_CFLAGS           += -DAGM_PI_LOCKS
+endif
+
 ifeq ($(strip $(AUDIO_FEATURE_ENABLED_DYNAMIC_LOG)), true)
 LOCAL_CFLAGS           += -DDYNAMIC_LOG_ENABLED
 LOCAL_C_INCLUDES       += $(TOP)/external/expat/lib/expat.h
@@ -0,0 +1,57 @@
+/*
+* Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+* SPDX-License-Identifier: BSD-3-Clause-Clear
+*/
+
+#ifndef _AGM_SCHED_H_
+#define _AGM_SCHED_H_
+
+#include <pthread.h>
+#include <agm/agm_api.h>
+
+/*
+ *Scheduling of the threads AGM runs. Each thread class gets a policy,
+ *priority and cpu affinity from configuration, threads apply the setting
+ *of their class when they start and are listed until they release it.
+ *Classes without configuration keep the scheduling they inherited.
+ *
+ *Config file lines, '#' starts a comment:
+ *    <ats|async|ssr|ipc> <other|fifo|rr> <priority or nice> [cpu mask]
+ *Android properties use the same fields:
+ *    vendor.audio.agm.sched.<class> = <policy>,<priority>[,<cpu mask>]
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void agm_sched_init(void);
+void agm_sched_deinit(void);
+
+/**
+ *\brief Apply the configured policy, priority and cpu affinity of a
+ *       thread class to the calling thread and list it in
+ *       agm_get_thread_sched_info().
+ *
+ *\return 0 on success, error code otherwise
+ */
+int agm_thread_sched_apply(enum agm_thread_class thread_class);
+
+/**
+ *\brief Remove the calling thread from agm_get_thread_sched_info(),
+ *       to be called before a thread which applied a class exits.
+ */
+void agm_thread_sched_release(void);
+
+/**
+ *\brief Initialize a lock taken by real-time data path threads. With
+ *       AGM_PI_LOCKS it uses priority inheritance, so that a control
+ *       thread holding it runs at the priority of the highest waiter.
+ */
+int agm_sched_mutex_init(pthread_mutex_t *lock);
+
+#ifdef __cplusplus
+}  /* extern "C" */
+#endif
+
+#endif /*_AGM_SCHED_H_*/
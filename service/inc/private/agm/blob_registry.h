@@ -0,0 +1,48 @@
+/*
+* Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+* SPDX-License-Identifier: BSD-3-Clause-Clear
+*/
+
+#ifndef _BLOB_REGISTRY_H_
+#define _BLOB_REGISTRY_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <agm/agm_api.h>
+
+/* upper bound on the payload bytes held by the registry */
+#define BLOB_REGISTRY_MAX_BYTES    (4 * 1024 * 1024)
+
+/**
+ *\brief Register a blob, identical blobs of the same type share one id
+ *\param [in] type: enum agm_blob_type
+ *\param [in] blob: metadata or set_params payload
+ *\param [in] size: payload size in bytes
+ *\param [out] blob_id: id to pass to blob_registry_apply()
+ *
+ * return 0 on success or error code otherwise.
+ */
+int blob_registry_register(uint32_t type, void *blob, size_t size,
+                           uint32_t *blob_id);
+
+/**
+ *\brief Drop one registration of a blob, the blob is freed with the last one
+ */
+int blob_registry_unregister(uint32_t blob_id);
+
+/**
+ *\brief Apply a registered blob to a session or a session-aif pair
+ *\param [in] session_id: session id
+ *\param [in] aif_id: audio interface id or AGM_AIF_NONE
+ *\param [in] blob_id: registered blob id
+ *
+ * return 0 on success or error code otherwise.
+ */
+int blob_registry_apply(uint32_t session_id, uint32_t aif_id, uint32_t blob_id);
+
+/**
+ *\brief Free every registered blob
+ */
+void blob_registry_deinit(void);
+
+#endif /*_BLOB_REGISTRY_H_*/
@@ -310,11 +310,65 @@ int graph_set_config_with_tag(struct graph_obj *gph_obj,
 int graph_get_config(struct graph_obj *graph_obj, void *payload,
                      size_t payload_size);
 
+/**
+ *\brief Apply calibration key vector of meta_data to the subgraphs of its
+ *       graph key vector. Nothing is sent to SPF if the same calibration
+ *       keys are already applied to these subgraphs.
+ *\param [in] graph_obj: associated graph obj
+ *\param [in] meta_data: graph and calibration key vectors
+ *
+ * return 0 on success or error code otherwise.
+ */
 int graph_set_cal(struct graph_obj *gph_obj,
                               struct agm_meta_data_gsl *meta_data);
 
+/**
+ *\brief Get number of calibrations sent to SPF and dropped as no-op
+ *       since the graph was opened.
+ *\param [in] graph_obj: associated graph obj
+ *\param [out] applied: calibrations sent to SPF
+ *\param [out] skipped: calibrations matching the applied ones
+ *
+ * return 0 on success or error code otherwise.
+ */
+int graph_get_cal_stats(struct graph_obj *gph_obj, uint32_t *applied,
+                        uint32_t *skipped);
+
+/**
+ *\brief Forget which calibrations were applied to the graph, so that the
+ *       next set_cal is sent to SPF even if its keys did not change. To be
+ *       called once the calibration data in ACDB was written to.
+ *\param [in] graph_obj: associated graph obj
+ */
+void graph_invalidate_cal(struct graph_obj *gph_obj);
+
 int graph_rw_acdb_param(void *payload, bool is_param_write);
 
+/**
+ *\brief Set gain of a volume control module in the graph
+ *\param [in] graph_obj: associated graph obj
+ *\param [in] miid: module instance id of the volume module, 0 for the
+ *                  stream volume module of the graph
+ *\param [in] gain: master gain in Q13 format, at most 0xFFFF
+ *\param [in] ramp_ms: duration of the ramp to the new gain done by the
+ *                     module, 0 to apply the gain immediately
+ *
+ * return 0 on success or error code otherwise.
+ */
+int graph_set_gain(struct graph_obj *gph_obj, uint32_t miid, uint32_t gain,
+                   uint32_t ramp_ms);
+
+/**
+ *\brief Get module instance id of the module with a given tag
+ *\param [in] gkv: graph key vector the module belongs to
+ *\param [in] tag: module tag
+ *\param [out] miid: module instance id
+ *
+ * return 0 on success, -ENOENT if no module has the tag or error code otherwise.
+ */
+int graph_get_tagged_miid(struct agm_key_vector_gsl *gkv, uint32_t tag,
+                          uint32_t *miid);
+
 /**
  *\brief Issue eos to the associated graph
  *\param [in] graph_obj: associated graph obj
@@ -325,6 +379,9 @@ int graph_eos(struct graph_obj *gph_obj);
 
 /**
  *\brief Get timestamp of the associated running graph
+ *       The value is extrapolated from the last SPR sample as long as that
+ *       sample is not older than the configured max staleness, SPF is
+ *       queried otherwise.
  *\param [in] graph_obj: associated graph obj
  *\param [out] timestamp: updated the timestamp value if success
  *
@@ -332,6 +389,13 @@ int graph_eos(struct graph_obj *gph_obj);
  */
 int graph_get_session_time(struct graph_obj *gph_obj, uint64_t *timestamp);
 
+/**
+ *\brief Set max age of a cached SPR sample used to answer session time
+ *       queries, applies to all graphs.
+ *\param [in] max_staleness_us: max age in us, 0 disables caching
+ */
+void graph_set_session_time_max_staleness(uint32_t max_staleness_us);
+
 /**
  *\brief Get timestamp of the last read buffer
  *\param [in] graph_obj: associated graph obj
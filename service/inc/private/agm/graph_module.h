@@ -56,6 +56,7 @@
 #include "gapless_api.h"
 #include "pcm_encoder_api.h"
 #include "aac_encoder_api.h"
+#include "volume_ctrl_api.h"
 
 /*
  *Internal enum to identify different modules
@@ -86,12 +87,13 @@ typedef enum module
     MODULE_STREAM_SPR,
     MODULE_STREAM_GAPLESS,
     MODULE_RD_SHARED_MEM,
+    MODULE_STREAM_VOLUME,
     /*
      *Ensure that whenever a new stream module is added it
      *is added in the end of stream module list and the end
      *is updated with the same entry.
      */
-    MODULE_STREAM_END = MODULE_RD_SHARED_MEM,
+    MODULE_STREAM_END = MODULE_STREAM_VOLUME,
     MODULE_DEVICE_START = 0,
     MODULE_HW_EP_RX = MODULE_DEVICE_START,
     MODULE_HW_EP_TX,
@@ -146,6 +148,36 @@ struct graph_buf_info {
     uint64_t timestamp;
 };
 
+/*
+ *Last (session_time, absolute_time) pair read from the SPR module, used to
+ *answer session time queries without a DSP round trip. Samples older than
+ *the configured max staleness are refreshed from SPF.
+ */
+struct graph_time_cache {
+    pthread_mutex_t lock;
+    bool valid;
+    /* session time does not advance while the graph is paused */
+    bool frozen;
+    /* bumped on every invalidate, drops samples raced by state changes */
+    uint32_t generation;
+    uint64_t session_time;
+    uint64_t absolute_time;
+    /* CLOCK_MONOTONIC time in us at which the pair was sampled */
+    uint64_t sample_time;
+};
+
+/*
+ *Calibration key vector last applied to the subgraphs of one graph key
+ *vector, used to drop set_cal requests which would not change anything.
+ *Graph key vectors of a graph share subgraphs, so a record holds only as
+ *long as no other calibration key vector reached any of its subgraphs.
+ */
+struct graph_applied_cal {
+    struct listnode node;
+    struct agm_key_vector_gsl gkv;
+    struct agm_key_vector_gsl ckv;
+};
+
 struct graph_obj {
     pthread_mutex_t lock;
     pthread_mutex_t gph_open_thread_lock;
@@ -162,6 +194,11 @@ struct graph_obj {
     uint32_t spr_miid;
     struct graph_buf_info buf_info;
     bool is_config_buf_params_done;
+    struct graph_time_cache time_cache;
+    /* list of graph_applied_cal, protected by lock */
+    struct listnode applied_cal_list;
+    uint32_t cal_applied_cnt;
+    uint32_t cal_skipped_cnt;
 };
 
 void get_stream_module_list_array(module_info_t **info, size_t *size);
@@ -35,6 +35,8 @@
 
 struct agm_meta_data_gsl* metadata_merge(int num, ...);
 int metadata_copy(struct agm_meta_data_gsl *dest, uint32_t size, uint8_t *payload);
+int metadata_dup(struct agm_meta_data_gsl *dest,
+                 const struct agm_meta_data_gsl *src);
 void metadata_free(struct agm_meta_data_gsl *metadata);
 void metadata_update_cal(struct agm_meta_data_gsl *meta_data,
                              struct agm_key_vector_gsl *ckv);
@@ -0,0 +1,98 @@
+/*
+* Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+* SPDX-License-Identifier: BSD-3-Clause-Clear
+*/
+
+#ifndef _PARAM_STORE_H_
+#define _PARAM_STORE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <agm/agm_list.h>
+
+/*
+ *Staged set_params payloads of a session or a session-aif pair.
+ *Payloads are split into their apm_module_param_data_t records and kept
+ *once per (module instance id, param id), a later record for the same key
+ *replaces the earlier one in place. Payloads which can not be parsed as
+ *records are kept as is, a payload identical to one kept already is not
+ *added again and only the latest PARAM_STORE_MAX_RAW of them are kept.
+ *Such payloads are never mixed with the records, as their layout would
+ *break the parsing of every record after them.
+ */
+#define PARAM_STORE_MAX_RAW 8
+
+struct param_store {
+    struct listnode entries;
+    uint32_t num_entries;
+    /* entries holding a payload that is not a param list */
+    uint32_t num_raw;
+    /* size of the payload param_store_flatten() would build, raw excluded */
+    size_t size;
+};
+
+void param_store_init(struct param_store *store);
+void param_store_clear(struct param_store *store);
+bool param_store_is_empty(struct param_store *store);
+
+/**
+ *\brief Merge a set_params payload into the store
+ *\param [in] store: param store
+ *\param [in] payload: concatenated apm_module_param_data_t records
+ *\param [in] size: payload size in bytes
+ *
+ * return 0 on success or error code otherwise.
+ */
+int param_store_merge(struct param_store *store, void *payload, size_t size);
+
+/**
+ *\brief Merge a set_params payload into the store without copying it
+ *\param [in] store: param store
+ *\param [in] payload: malloc'ed payload, owned by the store from here on,
+ *                     freed once no record of it is left, also on error
+ *\param [in] size: payload size in bytes
+ *
+ * return 0 on success or error code otherwise.
+ */
+int param_store_adopt(struct param_store *store, void *payload, size_t size);
+
+/**
+ *\brief Move all records of src into dst, records already present in dst
+ *       are replaced. src is left empty.
+ */
+void param_store_move(struct param_store *dst, struct param_store *src);
+
+/**
+ *\brief Copy all records of src into dst, which is expected to be empty.
+ *       Records of an adopted payload are shared, not duplicated.
+ *
+ * return 0 on success or error code otherwise, dst is left empty on error.
+ */
+int param_store_copy(struct param_store *dst, struct param_store *src);
+
+/**
+ *\brief Build one payload holding every parsed record of the store, payloads
+ *       kept as is are left out, see param_store_for_each_raw()
+ *\param [in] store: param store
+ *\param [out] payload: allocated payload, to be freed by the caller
+ *\param [out] size: payload size in bytes
+ *
+ * return 0 on success, -ENODATA if the store has no parsed record or
+ * error code otherwise.
+ */
+int param_store_flatten(struct param_store *store, void **payload, size_t *size);
+
+/**
+ *\brief Call fn on each payload kept as is, oldest first
+ *\param [in] store: param store
+ *\param [in] fn: called with priv and the payload, stops the walk on error
+ *\param [in] priv: passed to fn
+ *
+ * return 0 on success or the error returned by fn.
+ */
+int param_store_for_each_raw(struct param_store *store,
+                             int (*fn)(void *priv, void *payload, size_t size),
+                             void *priv);
+
+#endif /*_PARAM_STORE_H_*/
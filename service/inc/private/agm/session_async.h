@@ -0,0 +1,32 @@
+/*
+* Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+* SPDX-License-Identifier: BSD-3-Clause-Clear
+*/
+
+#ifndef _SESSION_ASYNC_H_
+#define _SESSION_ASYNC_H_
+
+#include <agm/agm_api.h>
+#include <agm/session_obj.h>
+
+/*
+ *Executes session control requests off the caller's thread. Each session
+ *keeps its own FIFO of requests, a small pool of workers picks sessions
+ *with pending requests so that different sessions progress in parallel
+ *while a session is only ever serviced by one worker at a time.
+ */
+int session_async_init(void);
+void session_async_deinit(void);
+
+/**
+ *\brief Queue a control request on a session
+ *\param [in] sess_obj: session object
+ *\param [in] cmd: request to execute
+ *\param [in] token: client value reported back on completion
+ *
+ * return 0 if queued or error code otherwise.
+ */
+int session_async_queue_cmd(struct session_obj *sess_obj,
+                            enum agm_session_cmd cmd, uint32_t token);
+
+#endif /*_SESSION_ASYNC_H_*/
@@ -0,0 +1,58 @@
+/*
+* Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+* SPDX-License-Identifier: BSD-3-Clause-Clear
+*/
+
+#ifndef _SESSION_FANOUT_H_
+#define _SESSION_FANOUT_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <agm/session_obj.h>
+
+/*
+ *Shares the capture of one session between several readers. Captured
+ *periods are kept in a ring of bounded size, readers consume it at their
+ *own pace and whichever reader runs out of captured data reads the next
+ *period from the graph into the ring. A reader falling more than the ring
+ *behind skips to the oldest period still present and is told how many
+ *bytes it lost.
+ */
+
+/**
+ *\brief Attach a reader to the capture of a session
+ *\param [in] sess_obj: session object of a TX session with buffer config set
+ *\param [out] reader: reader handle
+ *
+ * return 0 on success or error code otherwise.
+ */
+int session_fanout_reader_open(struct session_obj *sess_obj, uint64_t *reader);
+
+/**
+ *\brief Read captured data from the position of a reader
+ *\param [in] reader: reader handle
+ *\param [out] buff: destination buffer
+ *\param [in,out] count: bytes requested, updated with bytes read
+ *\param [out] dropped: bytes this reader lost to an overrun, 0 if none
+ *
+ * return 0 on success or error code otherwise.
+ */
+int session_fanout_reader_read(uint64_t reader, void *buff, size_t *count,
+                               uint64_t *dropped);
+
+/**
+ *\brief Detach a reader, the ring is freed with the last reader. Reads of
+ *       the reader waiting for a capture return and a read capturing a
+ *       period is waited for, reads after close fail with -EINVAL.
+ */
+int session_fanout_reader_close(uint64_t reader);
+
+/**
+ *\brief Tell whether a session has fan-out readers attached
+ *\param [in] sess_obj: session object
+ *
+ * return true if at least one reader is open on the session.
+ */
+bool session_fanout_active(struct session_obj *sess_obj);
+
+#endif /*_SESSION_FANOUT_H_*/
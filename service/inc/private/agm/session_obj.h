@@ -37,6 +37,7 @@
 #include <agm/agm_list.h>
 #include <agm/agm_priv.h>
 #include <agm/metadata.h>
+#include <agm/param_store.h>
 #include <agm/graph.h>
 
 enum aif_state {
@@ -55,11 +56,30 @@ struct aif {
     struct device_obj *dev_obj;
     enum aif_state state;
     struct agm_meta_data_gsl sess_aif_meta;
-    void *params;
-    size_t params_size;
+    struct param_store params;
     struct agm_tag_config *tag_config;
 };
 
+/*
+ *Last-writer-wins gain request slot of a session or of a session-aif pair.
+ *Writers only overwrite pending, whoever sets busy applies the newest
+ *request to the graph and loops until pending is found empty.
+ */
+struct gain_mailbox {
+    struct listnode node;
+    /* GAIN_MAILBOX_SESSION for the stream volume module of the session */
+    uint32_t aif_id;
+    /* volume module instance id, resolved on first apply */
+    uint32_t miid;
+    /* newest request not applied yet, 0 if none */
+    uint64_t pending;
+    uint32_t busy;
+    /* last request which made it to the graph, put back after SSR */
+    uint64_t applied;
+};
+
+#define GAIN_MAILBOX_SESSION UINT32_MAX
+
 enum session_state {
     SESSION_CLOSED,
     SESSION_OPENED,
@@ -73,6 +93,20 @@ struct session_cb {
     agm_event_cb cb;
     enum event_type evt_type;
     void *client_data;
+    struct agm_event_filter filter;
+    /* bit (id % 64) of every filtered id, rejects most events without a scan */
+    uint64_t event_mask;
+    uint64_t module_mask;
+};
+
+/*
+ *Immutable copy of the cb_pool which events are dispatched from, rebuilt on
+ *every registration change. Dispatchers hold a reference while calling out.
+ */
+struct session_cb_snapshot {
+    uint32_t refs;
+    uint32_t num_cbs;
+    struct session_cb cbs[];
 };
 
 struct session_obj {
@@ -88,8 +122,7 @@ struct session_obj {
     struct agm_media_config out_media_config;
     struct agm_buffer_config in_buffer_config;
     struct agm_buffer_config out_buffer_config;
-    void *params;
-    size_t params_size;
+    struct param_store params;
     uint32_t loopback_sess_id;
     bool loopback_state;
     uint32_t ec_ref_aif_id;
@@ -97,7 +130,33 @@ struct session_obj {
     uint32_t rx_metadata_sz;
     uint32_t tx_metadata_sz;
     pthread_mutex_t lock;
+    /* serializes registrations, event dispatch only uses cb_snapshot */
     pthread_mutex_t cb_pool_lock;
+    struct session_cb_snapshot *cb_snapshot;
+    pthread_mutex_t cb_snapshot_lock;
+    pthread_cond_t cb_snapshot_cond;
+    /* events being delivered from any snapshot, under cb_snapshot_lock */
+    uint32_t cb_dispatching;
+    /* client mappable time page, created on first TIME_BUF request */
+    int time_page_fd;
+    struct agm_session_time_page *time_page;
+    pthread_mutex_t time_page_lock;
+    /* gain mailboxes are created on first use and live with the session */
+    struct listnode gain_mbox_list;
+    pthread_mutex_t gain_mbox_lock;
+    /* records sent to the graph so far, sent again when it is rebuilt */
+    struct param_store replay_params;
+    bool paused;
+    /* graph was lost to an SPF restart and is rebuilt on SVC_UP */
+    bool ssr_pending;
+    /* state to bring the session back to once the graph is rebuilt */
+    enum session_state ssr_state;
+    /* async control requests, protected by the session_async lock */
+    struct listnode async_cmd_list;
+    struct listnode async_node;
+    bool async_queued;
+    /* capture fan-out ring, protected by the session_fanout lock */
+    struct session_fanout *fanout;
 };
 
 struct session_pool {
@@ -127,18 +186,60 @@ int session_obj_resume(struct session_obj *sess_obj);
 int session_obj_suspend(struct session_obj *sess_obj);
 int session_obj_read(struct session_obj *sess_obj, void *buff, size_t *count);
 int session_obj_write(struct session_obj *sess_obj, void *buff, size_t *count);
+int session_obj_readv(struct session_obj *sess_obj, struct agm_iovec *iov,
+                      uint32_t iovcnt, uint32_t *done);
+int session_obj_writev(struct session_obj *sess_obj, struct agm_iovec *iov,
+                       uint32_t iovcnt, uint32_t *done);
 int session_obj_sess_aif_connect(struct session_obj *sess_obj,
                              uint32_t audio_intf, bool state);
+bool session_obj_aif_connected(struct session_obj *sess_obj,
+                             uint32_t audio_intf);
 int session_obj_set_sess_metadata(struct session_obj *sess_obj, uint32_t size,
                              uint8_t *metadata);
 int session_obj_set_sess_aif_metadata(struct session_obj *sess_obj,
                              uint32_t audio_intf, uint32_t size,
                              uint8_t *metadata);
+int session_obj_set_sess_metadata_gsl(struct session_obj *sess_obj,
+                             const struct agm_meta_data_gsl *metadata);
+int session_obj_set_sess_aif_metadata_gsl(struct session_obj *sess_obj,
+                             uint32_t audio_intf,
+                             const struct agm_meta_data_gsl *metadata);
 int session_obj_set_sess_params(struct session_obj *sess_obj,
                              void* payload, size_t size);
 int session_obj_set_sess_aif_params(struct session_obj *sess_obj,
                              uint32_t audio_intf,
                              void *payload, size_t size);
+int session_obj_set_params_owned(struct session_obj *sess_obj,
+                             uint32_t aif_id, void *payload, size_t size);
+int session_obj_set_params_fd(struct session_obj *sess_obj,
+                             uint32_t aif_id, int fd, size_t size);
+int session_obj_stage_sess_params(struct session_obj *sess_obj,
+                             void *payload, size_t size);
+int session_obj_stage_sess_aif_params(struct session_obj *sess_obj,
+                             uint32_t audio_intf,
+                             void *payload, size_t size);
+int session_obj_commit_params(struct session_obj *sess_obj);
+
+/*
+ *Copy of the metadata and params cached on a session and its aifs, for a
+ *caller changing several of them to put them back if a later step fails.
+ */
+struct session_obj_cache;
+int session_obj_cache_save(struct session_obj *sess_obj,
+                           struct session_obj_cache **cache);
+/* consumes cache, aifs created since the save are left with nothing cached */
+void session_obj_cache_restore(struct session_obj *sess_obj,
+                               struct session_obj_cache *cache);
+void session_obj_cache_free(struct session_obj_cache *cache);
+int session_obj_set_gain(struct session_obj *sess_obj, uint32_t aif_id,
+                         uint32_t gain, uint32_t ramp_ms);
+void session_obj_notify_cmd_done(struct session_obj *sess_obj,
+                                 enum agm_session_cmd cmd, uint32_t token,
+                                 int status);
+int session_obj_get_all(struct session_obj ***sess_objs, uint32_t *count);
+void session_obj_ssr_down(struct session_obj *sess_obj);
+bool session_obj_ssr_pending(struct session_obj *sess_obj, bool *dependent);
+int session_obj_ssr_up(struct session_obj *sess_obj);
 int session_obj_get_sess_params(struct session_obj *sess_obj,
                              void *payload, size_t size);
 int session_obj_set_sess_aif_params_with_tag(struct session_obj *sess_obj,
@@ -163,6 +264,10 @@ int session_obj_set_loopback(struct session_obj *sess_obj,
                              uint32_t playback_sess_id, bool state);
 int session_obj_set_ec_ref(struct session_obj *sess_obj,
                              uint32_t aif_id, bool state);
+int session_obj_register_cb_filtered(struct session_obj *sess_obj,
+                             agm_event_cb cb, enum event_type evt_type,
+                             void *client_data,
+                             const struct agm_event_filter *filter);
 int session_obj_register_cb(struct session_obj *sess_obj, agm_event_cb cb,
                              enum event_type evt_type, void *client_data);
 int session_obj_register_for_events(struct session_obj *sess_obj,
@@ -172,6 +277,8 @@ int session_obj_set_ec_ref(struct session_obj *sess_obj, uint32_t aif_id,
 int session_obj_eos(struct session_obj *sess_obj);
 int session_obj_get_timestamp(struct session_obj *sess_obj,
                              uint64_t *timestamp);
+int session_obj_get_cal_stats(struct session_obj *sess_obj, uint32_t *applied,
+                              uint32_t *skipped);
 int session_obj_buffer_timestamp(struct session_obj *sess_obj,
                              uint64_t *timestamp);
 int session_obj_get_sess_buf_info(struct session_obj *sess_obj,
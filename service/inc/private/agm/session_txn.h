@@ -0,0 +1,24 @@
+/*
+* Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+* SPDX-License-Identifier: BSD-3-Clause-Clear
+*/
+
+#ifndef _SESSION_TXN_H_
+#define _SESSION_TXN_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ *\brief Execute a session bring-up transaction
+ *\param [in] txn: struct agm_session_txn followed by its records
+ *\param [in] size: transaction size in bytes
+ *\param [out] handle: session handle if the session was opened, 0 otherwise
+ *
+ * return 0 on success or error code otherwise, nothing done by the
+ * transaction is left in place on failure apart from cached metadata
+ * and params.
+ */
+int session_txn_execute(void *txn, size_t size, uint64_t *handle);
+
+#endif /*_SESSION_TXN_H_*/
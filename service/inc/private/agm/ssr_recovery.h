@@ -0,0 +1,28 @@
+/*
+* Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+* SPDX-License-Identifier: BSD-3-Clause-Clear
+*/
+
+#ifndef _SSR_RECOVERY_H_
+#define _SSR_RECOVERY_H_
+
+#include <agm/agm_api.h>
+
+/*
+ *Restores sessions lost to an audio DSP (SPF) restart. On SVC_DN the graph
+ *of every open session is torn down while its replay record is kept, on
+ *SVC_UP the graphs are rebuilt in parallel and the sessions brought back
+ *to the state the client left them in.
+ */
+int ssr_recovery_init(void);
+void ssr_recovery_deinit(void);
+
+/**
+ *\brief Get statistics of the SPF restarts seen since init
+ *\param [out] stats: restart count and outcome of the last restore
+ *
+ * return 0 on success or error code otherwise.
+ */
+int ssr_recovery_get_stats(struct agm_ssr_stats *stats);
+
+#endif /*_SSR_RECOVERY_H_*/
@@ -173,6 +173,27 @@ struct agm_buff {
     struct agm_extern_alloc_buff_info alloc_info; /**< holds info for extern buff */
 };
 
+/**
+ * Buffer of a vectored read or write
+ */
+struct agm_iovec {
+    uint8_t *addr; /**< data buffer */
+    uint32_t size; /**< size in bytes, updated with the bytes transferred */
+    uint32_t flags; /**< AGM_BUFF_FLAG_* as in struct agm_buff */
+    uint64_t timestamp; /**< timestamp in micro-secs, valid with AGM_BUFF_FLAG_TS_VALID */
+};
+
+/** max number of buffers in one vectored read or write */
+#define AGM_SESSION_MAX_IOV 32
+
+/**
+ * Key of the compress plugin metadata which returns, with
+ * compress_get_metadata(), the eventfd that is readable while
+ * the compress stream is ready to be written or read. It can
+ * be added to a client's own poll()/epoll loop.
+ */
+#define AGM_COMPRESS_METADATA_POLL_FD 0x41474d01
+
 /**
  *Gapless playback Silence type
  */
@@ -325,6 +346,7 @@ union agm_session_codec
 enum buf_flag {
     DATA_BUF = 0x1,
     POS_BUF = 0x2,
+    TIME_BUF = 0x4,
 };
 
 /**
@@ -335,8 +357,62 @@ struct agm_buf_info {
     int32_t data_buf_size;
     int32_t pos_buf_fd;
     int32_t pos_buf_size;
+    int32_t time_buf_fd;           /**< valid only if TIME_BUF is requested */
+    int32_t time_buf_size;
 };
 
+/**
+ * Session state published in the session time page
+ */
+enum agm_time_page_state {
+    AGM_TIME_PAGE_CLOSED = 0,
+    AGM_TIME_PAGE_OPENED,
+    AGM_TIME_PAGE_PREPARED,
+    AGM_TIME_PAGE_STARTED,
+    AGM_TIME_PAGE_PAUSED,
+    AGM_TIME_PAGE_STOPPED,
+};
+
+/**
+ * Session time page, obtained with TIME_BUF and mapped read only by clients.
+ * The service makes seq odd while it updates the page, so a reader has to
+ * retry until it sees the same even seq before and after copying the page,
+ * see agm_session_time_page_read().
+ * While state is AGM_TIME_PAGE_STARTED the current session time is
+ * session_time + (CLOCK_MONOTONIC now - sample_time).
+ */
+struct agm_session_time_page {
+    uint32_t seq;
+    uint32_t state;                /**< enum agm_time_page_state */
+    uint64_t session_time;         /**< session time in us */
+    uint64_t absolute_time;        /**< SPF absolute time of session_time in us */
+    uint64_t sample_time;          /**< CLOCK_MONOTONIC time in us of session_time */
+    uint64_t buffer_timestamp;     /**< timestamp of last read buffer */
+    uint64_t processed_buf_cnt;    /**< buffers completed since start */
+};
+
+/**
+ * \brief Take a consistent snapshot of a mapped session time page.
+ *
+ * \param[in] page - session time page mapped from time_buf_fd
+ * \param[out] snapshot - copy of the page
+ */
+static inline void agm_session_time_page_read(
+                              const struct agm_session_time_page *page,
+                              struct agm_session_time_page *snapshot)
+{
+    uint32_t seq;
+
+    do {
+        seq = __atomic_load_n(&page->seq, __ATOMIC_ACQUIRE);
+        if (seq & 1)
+            continue;
+        *snapshot = *page;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while ((seq & 1) || seq != __atomic_load_n(&page->seq, __ATOMIC_RELAXED));
+    snapshot->seq = seq;
+}
+
 /**
  * Media Config
  */
@@ -458,6 +534,44 @@ enum event_type
 {
     AGM_EVENT_DATA_PATH = 1,/**< Events on the Data path, READ_DONE or WRITE_DONE */
     AGM_EVENT_MODULE,       /**< Events raised by modules */
+    AGM_EVENT_SESSION_CONTROL, /**< Completion of async session control requests */
+};
+
+/**
+ * Classes of threads whose scheduling is configured together
+ */
+enum agm_thread_class {
+    AGM_THREAD_ATS,   /**< ATS bring-up */
+    AGM_THREAD_ASYNC, /**< async session control workers */
+    AGM_THREAD_SSR,   /**< SSR recovery and session restore */
+    AGM_THREAD_IPC,   /**< IPC server threads moving session data */
+    AGM_THREAD_CLASS_MAX,
+};
+
+/**
+ * Scheduling a thread of a thread class runs with
+ */
+struct agm_thread_sched_info {
+    int32_t tid; /**< kernel thread id */
+    uint32_t thread_class; /**< enum agm_thread_class */
+    int32_t policy; /**< SCHED_OTHER, SCHED_FIFO or SCHED_RR */
+    int32_t priority; /**< rt priority, nice value for SCHED_OTHER */
+    uint64_t cpu_mask; /**< cpus the thread may run on, 0 if not pinned */
+};
+
+/** max number of ids in each set of an event filter */
+#define AGM_EVENT_FILTER_MAX_IDS 8
+
+/**
+ * Subscription filter of an event callback. An event is delivered when its
+ * event id is in event_ids and its source module is in module_ids, an empty
+ * set matches every id.
+ */
+struct agm_event_filter {
+    uint32_t num_event_ids; /**< number of valid event_ids, 0 for any */
+    uint32_t event_ids[AGM_EVENT_FILTER_MAX_IDS];
+    uint32_t num_module_ids; /**< number of valid module_ids, 0 for any */
+    uint32_t module_ids[AGM_EVENT_FILTER_MAX_IDS]; /**< source module ids */
 };
 
 struct agm_event_read_write_done_payload {
@@ -512,6 +626,12 @@ enum agm_event_id {
     */
 
     AGM_EVENT_WRITE_DONE = 0x2,
+   /**
+    * Indicates a request queued with agm_session_cmd_async() has completed,
+    * payload is struct agm_event_session_cmd_done_payload
+    */
+
+    AGM_EVENT_SESSION_CMD_DONE = 0x3,
    /**
     * Indicates early EOS event
     */
@@ -521,6 +641,101 @@ enum agm_event_id {
     AGM_EVENT_ID_MAX
 };
 
+/** Session control requests which can be issued asynchronously */
+enum agm_session_cmd {
+    AGM_SESSION_CMD_PREPARE,
+    AGM_SESSION_CMD_START,
+    AGM_SESSION_CMD_STOP,
+    AGM_SESSION_CMD_CLOSE,
+    AGM_SESSION_CMD_PAUSE,
+    AGM_SESSION_CMD_RESUME,
+    AGM_SESSION_CMD_FLUSH,
+    AGM_SESSION_CMD_MAX,
+};
+
+struct agm_event_session_cmd_done_payload {
+    uint32_t cmd;    /**< enum agm_session_cmd that completed */
+    uint32_t token;  /**< token passed to agm_session_cmd_async */
+    int32_t status;  /**< 0 on success, error code otherwise */
+};
+
+/**
+ * Session bring-up transaction, see agm_session_transact().
+ *
+ * A transaction is a struct agm_session_txn header followed by num_records
+ * records, each a struct agm_session_txn_record header followed by size
+ * bytes of payload padded to AGM_SESSION_TXN_ALIGN bytes. All fields are
+ * fixed width so the buffer can be passed as is across processes.
+ */
+#define AGM_SESSION_TXN_VERSION  1
+#define AGM_SESSION_TXN_ALIGN(x) (((x) + 7) & ~7)
+
+/** open the session once all records are applied */
+#define AGM_SESSION_TXN_OPEN     0x1
+/** prepare the session, implies AGM_SESSION_TXN_OPEN */
+#define AGM_SESSION_TXN_PREPARE  0x2
+/** start the session, implies AGM_SESSION_TXN_PREPARE */
+#define AGM_SESSION_TXN_START    0x4
+
+enum agm_session_txn_type {
+    /**< payload as for agm_session_set_metadata */
+    AGM_SESSION_TXN_SESS_METADATA = 1,
+    /**< payload as for agm_session_aif_set_metadata */
+    AGM_SESSION_TXN_AIF_METADATA,
+    /**< connect aif_id to the session, no payload */
+    AGM_SESSION_TXN_AIF_CONNECT,
+    /**< payload as for agm_session_set_params */
+    AGM_SESSION_TXN_SESS_PARAMS,
+    /**< payload as for agm_session_aif_set_params */
+    AGM_SESSION_TXN_AIF_PARAMS,
+    /**< payload is struct agm_session_txn_config */
+    AGM_SESSION_TXN_CONFIG,
+};
+
+/** fixed width equivalent of the agm_session_set_config arguments */
+struct agm_session_txn_config {
+    uint32_t dir;                  /**< enum direction */
+    uint32_t start_threshold;
+    uint32_t stop_threshold;
+    uint32_t data_mode;            /**< enum agm_data_mode */
+    uint32_t sess_flags;
+    union agm_session_codec codec;
+    uint32_t rate;
+    uint32_t channels;
+    uint32_t format;               /**< enum agm_media_format */
+    uint32_t data_format;
+    uint32_t buf_count;
+    uint32_t buf_size;
+    uint32_t max_metadata_size;
+};
+
+struct agm_session_txn_record {
+    uint32_t type;        /**< enum agm_session_txn_type */
+    uint32_t aif_id;      /**< audio interface id, unused by session records */
+    uint32_t size;        /**< payload size in bytes, without padding */
+    uint32_t reserved;
+    uint8_t payload[];
+};
+
+struct agm_session_txn {
+    uint32_t version;     /**< AGM_SESSION_TXN_VERSION */
+    uint32_t session_id;
+    uint32_t sess_mode;   /**< enum agm_session_mode */
+    uint32_t flags;       /**< AGM_SESSION_TXN_OPEN/PREPARE/START */
+    uint32_t num_records;
+    uint32_t reserved;
+    uint8_t records[];
+};
+
+/** blob types for agm_blob_register() */
+enum agm_blob_type {
+    AGM_BLOB_METADATA = 1, /**< payload as for agm_session_set_metadata */
+    AGM_BLOB_PARAMS,       /**< payload as for agm_session_set_params */
+};
+
+/** aif_id for calls that address the session rather than a session-aif */
+#define AGM_AIF_NONE    0xFFFFFFFF
+
 /** data that will be passed to client in the event callback */
 struct agm_event_cb_params {
 /**< identifies the module which generated event */
@@ -729,6 +944,191 @@ int agm_session_aif_set_cal(uint32_t session_id,
 int agm_session_set_params(uint32_t session_id,
                            void* payload, size_t size);
 
+/**
+ * \brief Set parameters for modules in stream without copying the payload
+ *
+ * Same as agm_session_set_params or agm_session_aif_set_params, the service
+ * takes ownership of the payload instead of copying it. It is sent to the
+ * graph as is and is kept, not copied, for reuse after an SPF restart.
+ *
+ * \param[in] session_id - Valid audio session id
+ * \param[in] aif_id - Valid audio interface id or AGM_AIF_NONE
+ * \param[in] payload - malloc'ed payload, freed by the service on every
+ *       path including failure. Over IPC the payload is freed once sent.
+ * \param[in] size - payload size in bytes
+ *
+ *  \return 0 on success, error code on failure.
+ */
+int agm_session_set_params_owned(uint32_t session_id, uint32_t aif_id,
+                                 void *payload, size_t size);
+
+/**
+ * \brief Set parameters for modules in stream from shared memory
+ *
+ * Same as agm_session_set_params or agm_session_aif_set_params with the
+ * payload read from the first size bytes of fd rather than marshalled.
+ * The service copies the payload out of fd, unless fd is a memfd sealed
+ * with F_SEAL_WRITE and F_SEAL_SHRINK, which is used in place. The caller
+ * keeps the fd and may rewrite its contents once the call returns.
+ *
+ * \param[in] session_id - Valid audio session id
+ * \param[in] aif_id - Valid audio interface id or AGM_AIF_NONE
+ * \param[in] fd - shared memory fd holding the payload
+ * \param[in] size - payload size in bytes
+ *
+ *  \return 0 on success, error code on failure.
+ */
+int agm_session_set_params_fd(uint32_t session_id, uint32_t aif_id,
+                              int fd, size_t size);
+
+/**
+ * \brief Stage parameters for modules in stream without sending them
+ *
+ * Staged parameters are kept once per module instance id and param id,
+ * a later value for the same pair replaces the earlier one. They are sent
+ * in one go on agm_session_commit_params(), on session prepare or along
+ * with the next agm_session_set_params().
+ *
+ * \param[in] session_id - Valid audio session id
+ * \param[in] payload - payload
+ * \param[in] size - payload size in bytes
+ *
+ *  \return 0 on success, error code on failure.
+ */
+int agm_session_stage_params(uint32_t session_id,
+                           void* payload, size_t size);
+
+/**
+ * \brief Stage parameters for modules in b/w stream and audio interface
+ *        without sending them, see agm_session_stage_params()
+ *
+ * \param[in] session_id - Valid audio session id
+ * \param[in] aif_id - Valid audio interface id
+ * \param[in] payload - payload
+ * \param[in] size - payload size in bytes
+ *
+ *  \return 0 on success, error code on failure.
+ */
+int agm_session_aif_stage_params(uint32_t session_id,
+                           uint32_t aif_id,
+                           void* payload, size_t size);
+
+/**
+ * \brief Send all staged stream and stream-audio interface parameters
+ *        of a session in a single set config
+ *
+ * Staged payloads which are not a list of module parameters are sent
+ * after it, with one set config each.
+ *
+ * \param[in] session_id - Valid audio session id
+ *
+ *  \return 0 on success, error code on failure.
+ *       If the session is not opened, parameters stay staged
+ *       and are sent when the session is opened.
+ */
+int agm_session_commit_params(uint32_t session_id);
+
+/**
+ * \brief Set gain of the stream volume module of a session
+ *
+ * Meant to be called at control rate, e.g. per UI slider step. Calls for
+ * the same session never queue up: while a gain update is being sent to
+ * the DSP further calls only replace the pending value and return, the
+ * newest value is sent once the ongoing update completes.
+ *
+ * \param[in] session_id - Valid audio session id
+ * \param[in] gain - linear gain in Q13 format, 0x2000 is unity, at most
+ *            0xFFFF
+ * \param[in] ramp_duration_ms - duration of the linear ramp from the current
+ *            gain, 0 to apply the gain right away
+ *
+ *  \return 0 on success, error code on failure.
+ *       Session must be opened and its graph must have a module tagged
+ *       with TAG_STREAM_VOLUME.
+ */
+int agm_session_set_gain(uint32_t session_id, uint32_t gain,
+                         uint32_t ramp_duration_ms);
+
+/**
+ * \brief Set gain of the volume module in b/w stream and audio interface,
+ *        see agm_session_set_gain()
+ *
+ * \param[in] session_id - Valid audio session id
+ * \param[in] aif_id - Valid audio interface id
+ * \param[in] gain - linear gain in Q13 format, 0x2000 is unity, at most
+ *            0xFFFF
+ * \param[in] ramp_duration_ms - duration of the linear ramp from the current
+ *            gain, 0 to apply the gain right away
+ *
+ *  \return 0 on success, error code on failure.
+ */
+int agm_session_aif_set_gain(uint32_t session_id, uint32_t aif_id,
+                             uint32_t gain, uint32_t ramp_duration_ms);
+
+/**
+ * \brief Queue a session control request without waiting for it
+ *
+ * Requests of a session are executed one after the other in the order they
+ * were queued, requests of different sessions run in parallel. Completion
+ * is reported with an AGM_EVENT_SESSION_CMD_DONE event to the callbacks
+ * registered for AGM_EVENT_SESSION_CONTROL with agm_session_register_cb().
+ * Synchronous calls made on the same session are not ordered against
+ * queued requests.
+ *
+ * \param[in] handle - Valid session handle obtained from agm_session_open
+ * \param[in] cmd - request to execute
+ * \param[in] token - client value echoed back in the completion event
+ *
+ *  \return 0 if the request was queued, error code otherwise.
+ *       -EOPNOTSUPP for AGM_SESSION_CMD_CLOSE through the D-Bus client,
+ *       which closes sessions with agm_session_close() only.
+ */
+int agm_session_cmd_async(uint64_t handle, enum agm_session_cmd cmd,
+                          uint32_t token);
+
+/**
+ * \brief Get calibration statistics of a session
+ *
+ * agm_session_aif_set_cal() requests carrying the calibration keys already
+ * applied to the graph are not sent to the DSP, they are counted as skipped.
+ * Counters start from zero whenever the session is opened. Writing
+ * calibration data to ACDB drops the record of what was applied, so the
+ * next request of every session is sent to the DSP again.
+ *
+ * \param[in] session_id - Valid audio session id
+ * \param[out] applied - calibrations sent to the DSP
+ * \param[out] skipped - calibrations dropped as no-op
+ *
+ *  \return 0 on success, error code on failure.
+ */
+int agm_session_get_cal_stats(uint32_t session_id, uint32_t *applied,
+                              uint32_t *skipped);
+
+/**
+ * Audio DSP restart (SSR) statistics
+ */
+struct agm_ssr_stats {
+    uint32_t ssr_count;            /**< restarts seen since agm_init */
+    uint32_t sessions_restored;    /**< sessions restored after the last one */
+    uint32_t sessions_failed;      /**< sessions which could not be restored */
+    uint64_t down_to_restored_us;  /**< DSP down to all sessions restored */
+    uint64_t up_to_restored_us;    /**< DSP up to all sessions restored */
+};
+
+/**
+ * \brief Get audio DSP restart statistics
+ *
+ * Sessions open when the audio DSP goes down are rebuilt once it is up
+ * again and brought back to the state they were in, with their metadata,
+ * calibration, configs, params and gains. Clients need not close and
+ * reopen them.
+ *
+ * \param[out] stats - restart count and outcome of the last restore
+ *
+ *  \return 0 on success, error code on failure.
+ */
+int agm_get_ssr_stats(struct agm_ssr_stats *stats);
+
 /**
  * \brief Get parameters of the modules of a given session
  *
@@ -811,6 +1211,23 @@ int agm_set_params_to_acdb_tunnel(void *payload, size_t size);
 int agm_session_register_cb(uint32_t session_id, agm_event_cb cb,
                     enum event_type evt_type, void *client_data);
 
+/**
+  * \brief Register a callback for a subset of the events of a type. The
+  *        callback is only invoked for events which pass the filter, it is
+  *        deregistered with agm_session_register_cb() and a NULL cb.
+  *
+  * \param[in] session_id - Valid audio session id
+  * \param[in] cb - callback function to be invoked when an event occurs.
+  * \param[in] evt_type - Event type that client is interested in.
+  * \param[in] client_data - client data passed back with the callback.
+  * \param[in] filter - event and source module ids to deliver, NULL for all
+  *
+  * \return 0 on success, error code otherwise
+  */
+int agm_session_register_cb_filtered(uint32_t session_id, agm_event_cb cb,
+                    enum event_type evt_type, void *client_data,
+                    const struct agm_event_filter *filter);
+
 /**
   * \brief Register for events from Modules. Not needed for data path events.
   *
@@ -822,6 +1239,71 @@ int agm_session_register_cb(uint32_t session_id, agm_event_cb cb,
 int agm_session_register_for_events(uint32_t session_id,
                  struct agm_event_reg_cfg *evt_reg_cfg);
 
+/**
+  * \brief Bring up a session with a single call.
+  *
+  * Applies the records of the transaction in order, as the matching
+  * set_metadata, aif_set_metadata, aif_connect, set_params,
+  * aif_set_params and set_config calls would, then opens, prepares and
+  * starts the session as requested by the transaction flags. On failure
+  * the steps already done are undone: the session is closed again and
+  * audio interfaces connected by the transaction are disconnected.
+  * Connect records for audio interfaces already connected are skipped and
+  * such interfaces stay connected on failure. Metadata and params set by
+  * the transaction stay cached.
+  *
+  * \param[in] txn - transaction, see struct agm_session_txn
+  * \param[in] txn_size - size of the transaction in bytes
+  * \param[out] handle - session handle if the transaction opened the
+  *       session, 0 otherwise
+  *
+  * \return 0 on success, error code otherwise
+  */
+int agm_session_transact(void *txn, size_t txn_size, uint64_t *handle);
+
+/**
+  * \brief Register a metadata or set_params blob with the service.
+  *
+  * Registering the same bytes of the same type again returns the same id
+  * and takes another reference, so every client can register the blobs it
+  * uses without coordinating. Metadata blobs are parsed once here.
+  *
+  * \param[in] type - enum agm_blob_type
+  * \param[in] blob - blob payload
+  * \param[in] size - size of the blob in bytes
+  * \param[out] blob_id - id to pass to agm_session_set_blob()
+  *
+  * \return 0 on success, -ENOSPC if the registry is full,
+  *         error code otherwise
+  */
+int agm_blob_register(enum agm_blob_type type, void *blob, size_t size,
+                      uint32_t *blob_id);
+
+/**
+  * \brief Drop a reference taken by agm_blob_register().
+  *
+  * \param[in] blob_id - registered blob id
+  *
+  * \return 0 on success, error code otherwise
+  */
+int agm_blob_unregister(uint32_t blob_id);
+
+/**
+  * \brief Apply a registered blob to a session or a session-aif pair.
+  *
+  * Behaves as agm_session_set_metadata, agm_session_aif_set_metadata,
+  * agm_session_set_params or agm_session_aif_set_params with the
+  * registered payload, depending on the blob type and aif_id.
+  *
+  * \param[in] session_id - Valid audio session id
+  * \param[in] aif_id - Valid audio interface id or AGM_AIF_NONE
+  * \param[in] blob_id - registered blob id
+  *
+  * \return 0 on success, error code otherwise
+  */
+int agm_session_set_blob(uint32_t session_id, uint32_t aif_id,
+                         uint32_t blob_id);
+
 /**
   * \brief Open the session with specified session id.
   *
@@ -961,10 +1443,107 @@ int agm_session_suspend(uint64_t hndl);
   *      the buffer. AGM will update the count with actual
   *      number of bytes filled.
   *
-  * \return 0 on success, error code otherwise
+  * \return 0 on success, -EBUSY if readers are attached with
+  *         agm_session_reader_open, error code otherwise
   */
 int agm_session_read(uint64_t handle, void *buff, size_t *count);
 
+/**
+  * \brief Write several buffers to a session in one call. Buffers are
+  *        written in order, the call stops at the first buffer which
+  *        fails or is not fully consumed.
+  *
+  * \param[in] handle: session handle returned from agm_session_open
+  * \param[in,out] iov: buffers to write, size of each is updated with
+  *       the bytes written, 0 for buffers past the one the call
+  *       stopped at
+  * \param[in] iovcnt: number of buffers, at most AGM_SESSION_MAX_IOV
+  * \param[out] done: number of buffers fully written
+  *
+  * \return 0 on success, error code of the failing buffer otherwise
+  */
+int agm_session_writev(uint64_t handle, struct agm_iovec *iov,
+                       uint32_t iovcnt, uint32_t *done);
+
+/**
+  * \brief Read several buffers from a session in one call. Buffers are
+  *        filled in order, the call stops at the first buffer which
+  *        fails or comes back short. The timestamp of each buffer is set
+  *        along with AGM_BUFF_FLAG_TS_VALID when the graph reports one.
+  *
+  * \param[in] handle: session handle returned from agm_session_open
+  * \param[in,out] iov: buffers to fill, size of each is updated with the
+  *       bytes read, 0 for buffers past the one the call stopped at
+  * \param[in] iovcnt: number of buffers, at most AGM_SESSION_MAX_IOV
+  * \param[out] done: number of buffers fully read
+  *
+  * \return 0 on success, -EBUSY if readers are attached with
+  *         agm_session_reader_open, error code of the failing buffer
+  *         otherwise
+  */
+int agm_session_readv(uint64_t handle, struct agm_iovec *iov,
+                      uint32_t iovcnt, uint32_t *done);
+
+/**
+  * \brief List the threads AGM runs with the scheduling of a thread
+  *        class. Through the IPC clients these are the threads of the
+  *        AGM service.
+  *
+  * \param[out] info: array filled with up to *num entries, may be NULL
+  * \param[in,out] num: capacity of info, updated with the number of
+  *       threads listed
+  *
+  * \return 0 on success, error code otherwise
+  */
+int agm_get_thread_sched_info(struct agm_thread_sched_info *info,
+                              uint32_t *num);
+
+/**
+  * \brief Attach a reader to the capture of a session. The captured
+  *        periods are kept in a bounded ring shared by all readers of
+  *        the session, each reader consumes it at its own position. The
+  *        periods are copied from the ring into the buffer of each
+  *        reader. agm_session_read and agm_session_readv fail with
+  *        -EBUSY on a session with readers.
+  *
+  * \param[in] handle: handle of a TX session returned from
+  *       agm_session_open, with its buffer config set
+  * \param[out] reader: reader handle
+  *
+  * \return 0 on success, error code otherwise
+  */
+int agm_session_reader_open(uint64_t handle, uint64_t *reader);
+
+/**
+  * \brief Read captured data from the position of a reader. Returns
+  *        as soon as some data was read, blocks only if the reader has
+  *        caught up with the capture.
+  *
+  * \param[in] reader: reader handle returned from agm_session_reader_open
+  * \param[out] buff: buffer where data will be copied to
+  * \param[in,out] count: number of bytes requested, AGM updates it with
+  *       the number of bytes filled
+  * \param[out] dropped: bytes lost because the reader fell behind by
+  *       more than the ring holds, 0 if the data is contiguous with the
+  *       previous read
+  *
+  * \return 0 on success, error code otherwise
+  */
+int agm_session_reader_read(uint64_t reader, void *buff, size_t *count,
+                            uint64_t *dropped);
+
+/**
+  * \brief Detach a reader, the ring is released with the last reader.
+  *        May be called while another thread reads from the reader: a
+  *        read blocked on the capture returns, a read capturing a period
+  *        is waited for.
+  *
+  * \param[in] reader: reader handle returned from agm_session_reader_open
+  *
+  * \return 0 on success, error code otherwise
+  */
+int agm_session_reader_close(uint64_t reader);
+
 /**
  * \brief Write data buffers.to session
  *
@@ -1068,11 +1647,14 @@ int agm_get_buffer_timestamp(uint32_t session_id, uint64_t *timestamp);
  *
  * \param[in] session_id - Valid audio session id
  * \param[out] buf_info - agm_buf_info structure with dma_buf_fd
- * \param[in] buf_info - flag to determine data buf/pos buf
+ * \param[in] buf_info - flag to determine data buf/pos buf/time buf
  *
  * \return 0 on success, error code on failure.
  * If the session is not opened,
  * api will return failure.
+ * time_buf_fd returned for TIME_BUF is owned by the caller and stays valid
+ * across session close/open, it is to be mapped PROT_READ as
+ * struct agm_session_time_page.
  */
 int agm_session_get_buf_info(uint32_t session_id, struct agm_buf_info *buf_info, uint32_t flag);
 
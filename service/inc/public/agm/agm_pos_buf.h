@@ -0,0 +1,211 @@
+/*
+* Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+* SPDX-License-Identifier: BSD-3-Clause-Clear
+*/
+
+#ifndef _AGM_POS_BUF_H_
+#define _AGM_POS_BUF_H_
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ *Position of a push pull mode session. The DSP publishes where it is in the
+ *shared data buffer through the POS_BUF mapping of agm_session_get_buf_info,
+ *clients turn that into a running frame count.
+ */
+
+/* default attempts at a consistent read of the position buffer */
+#define AGM_POS_BUF_READ_RETRIES 10
+
+/**
+ * Position buffer updated by the DSP. frame_counter is 0 while the DSP
+ * writes the other fields and changes with every update, so a read is
+ * consistent if the same non zero frame_counter is seen before and after
+ * copying them.
+ */
+struct agm_shared_pos_buffer {
+    volatile uint32_t frame_counter;
+    volatile uint32_t read_index;      /**< byte offset in the data buffer */
+    volatile uint32_t wall_clock_us_lsw;
+    volatile uint32_t wall_clock_us_msw;
+};
+
+struct agm_pos_buf_snapshot {
+    uint32_t frame_counter;
+    uint32_t read_index;
+    uint64_t wall_clock_us;
+};
+
+/**
+ * Running position of a session, in frames since the tracker was reset.
+ * 64 bits do not wrap in the lifetime of a stream, clients fold the count
+ * into their own boundary with agm_pos_to_ptr().
+ */
+struct agm_pos_tracker {
+    uint32_t frame_size;           /**< bytes per frame */
+    uint32_t period_frames;        /**< the DSP moves whole periods */
+    uint32_t buffer_frames;        /**< size of the data buffer */
+    uint32_t rate;
+    uint32_t retries;              /**< attempts at a consistent read */
+    uint64_t frames;               /**< frames moved since reset */
+    uint32_t pos;                  /**< last position in the data buffer */
+    uint32_t frame_counter;        /**< frame_counter of the last update */
+    uint64_t wall_clock_us;        /**< DSP time of the last update, 0 if none */
+    uint32_t read_failures;        /**< reads given up as torn */
+};
+
+/**
+ * \brief Take a consistent copy of the position buffer.
+ *
+ * \param[in] buf - position buffer mapped from pos_buf_fd
+ * \param[out] snapshot - copy of the buffer
+ * \param[in] retries - attempts before giving up
+ *
+ * \return 0 on success, -EAGAIN if the DSP kept updating the buffer
+ *         or has not written it yet.
+ */
+static inline int agm_pos_buf_read(const struct agm_shared_pos_buffer *buf,
+                                   struct agm_pos_buf_snapshot *snapshot,
+                                   uint32_t retries)
+{
+    uint32_t cnt, lsw, msw;
+
+    while (retries--) {
+        cnt = __atomic_load_n(&buf->frame_counter, __ATOMIC_ACQUIRE);
+        if (cnt == 0)
+            continue;
+        snapshot->read_index = buf->read_index;
+        lsw = buf->wall_clock_us_lsw;
+        msw = buf->wall_clock_us_msw;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (cnt != __atomic_load_n(&buf->frame_counter, __ATOMIC_RELAXED))
+            continue;
+
+        snapshot->frame_counter = cnt;
+        snapshot->wall_clock_us = ((uint64_t)msw << 32) | lsw;
+        return 0;
+    }
+
+    return -EAGAIN;
+}
+
+/**
+ * \brief Set up a tracker for a session, its position starts at 0.
+ *
+ * \param[in] retries - attempts at a consistent read, 0 for the default
+ */
+static inline void agm_pos_tracker_init(struct agm_pos_tracker *t,
+                                        uint32_t frame_size,
+                                        uint32_t period_frames,
+                                        uint32_t buffer_frames,
+                                        uint32_t rate, uint32_t retries)
+{
+    t->frame_size = frame_size;
+    t->period_frames = period_frames;
+    t->buffer_frames = buffer_frames;
+    t->rate = rate;
+    t->retries = retries ? retries : AGM_POS_BUF_READ_RETRIES;
+    t->frames = 0;
+    t->pos = 0;
+    t->frame_counter = 0;
+    t->wall_clock_us = 0;
+    t->read_failures = 0;
+}
+
+/**
+ * \brief Restart the frame count at the current position in the buffer
+ *        and forget the DSP time, for a session restarted by the DSP.
+ */
+static inline void agm_pos_tracker_reset(struct agm_pos_tracker *t)
+{
+    t->frames = t->pos;
+    t->wall_clock_us = 0;
+}
+
+/**
+ * \brief Move the tracker to the position the DSP last published.
+ *
+ * The position buffer only tells where in the data buffer the DSP is, so
+ * whole laps of the buffer between two updates are taken from the DSP
+ * time that passed, rounded to the lap count closest to it.
+ *
+ * \return 0 on success, -EAGAIN if no consistent read was possible, in
+ *         which case the tracker keeps its position.
+ */
+static inline int agm_pos_tracker_update(struct agm_pos_tracker *t,
+                              const struct agm_shared_pos_buffer *buf)
+{
+    struct agm_pos_buf_snapshot snap;
+    uint64_t delta, elapsed, expected;
+    uint32_t pos;
+    int ret;
+
+    if (!t->frame_size || !t->period_frames || !t->buffer_frames)
+        return -EINVAL;
+
+    ret = agm_pos_buf_read(buf, &snap, t->retries);
+    if (ret) {
+        /* the DSP has not published a position yet, it is at 0 */
+        if (!t->frame_counter)
+            return 0;
+        t->read_failures++;
+        return ret;
+    }
+
+    if (snap.frame_counter == t->frame_counter)
+        return 0;
+
+    pos = snap.read_index / t->frame_size;
+    pos -= pos % t->period_frames;
+    pos %= t->buffer_frames;
+    delta = (pos + t->buffer_frames - t->pos) % t->buffer_frames;
+
+    if (t->wall_clock_us && snap.wall_clock_us > t->wall_clock_us) {
+        elapsed = snap.wall_clock_us - t->wall_clock_us;
+        if (!__builtin_mul_overflow(elapsed / 1000000, (uint64_t)t->rate,
+                                    &expected)) {
+            expected += elapsed % 1000000 * t->rate / 1000000;
+            if (expected > delta)
+                delta += (expected - delta + t->buffer_frames / 2) /
+                         t->buffer_frames * t->buffer_frames;
+        }
+    }
+
+    t->frames += delta;
+    t->pos = pos;
+    t->frame_counter = snap.frame_counter;
+    t->wall_clock_us = snap.wall_clock_us;
+
+    return 0;
+}
+
+/**
+ * \brief Fold a frame count into a pointer of range 0 ... boundary - 1.
+ */
+static inline uint64_t agm_pos_to_ptr(uint64_t frames, uint64_t boundary)
+{
+    return boundary ? frames % boundary : frames;
+}
+
+/**
+ * \brief Frames available to the application, from pointers of range
+ *        0 ... boundary - 1 with boundary a multiple of buffer_frames.
+ *        Playback values above buffer_frames mean an underrun.
+ */
+static inline uint64_t agm_pos_avail(uint64_t hw_ptr, uint64_t appl_ptr,
+                                     uint64_t buffer_frames,
+                                     uint64_t boundary, bool playback)
+{
+    if (playback) {
+        hw_ptr += buffer_frames;
+        if (hw_ptr >= boundary)
+            hw_ptr -= boundary;
+    }
+
+    return hw_ptr >= appl_ptr ? hw_ptr - appl_ptr :
+                                hw_ptr + (boundary - appl_ptr);
+}
+
+#endif /*_AGM_POS_BUF_H_*/
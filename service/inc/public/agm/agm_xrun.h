@@ -0,0 +1,40 @@
+/*
+* Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+* SPDX-License-Identifier: BSD-3-Clause-Clear
+*/
+
+#ifndef _AGM_XRUN_H_
+#define _AGM_XRUN_H_
+
+#include <stdint.h>
+
+/*
+ *Underruns and overruns seen by the AGM tinyalsa pcm plugin for a stream of
+ *the calling process. Mixer clients read them as the "PCM<device> xrun"
+ *bytes control, which stays zero while no stream of the device is open in
+ *the process. Counters start at zero when the stream is opened.
+ */
+
+/* library of the pcm plugin, resolved by the mixer plugin when loaded */
+#define AGM_PCM_PLUGIN_LIB "libagm_pcm_plugin.so"
+#define AGM_PCM_PLUGIN_XRUN_STATS_FN "agm_pcm_plugin_get_xrun_stats"
+
+struct agm_xrun_stats {
+    uint32_t xruns;                /**< avail grew past the buffer size */
+    uint32_t xrun_frames_max;      /**< largest excess of avail over the buffer */
+    uint32_t pos_gaps;             /**< DSP moved a buffer or more between two reads */
+    uint32_t pos_read_failures;    /**< DSP position reads given up as torn */
+    uint32_t late_wakeups;         /**< poll woke more than a period late */
+    uint32_t late_wakeup_max_us;
+    uint32_t timeouts;             /**< poll gave up waiting for the DSP */
+    uint32_t transfer_errors;      /**< session read or write failed */
+    uint64_t last_xrun_us;         /**< CLOCK_MONOTONIC, 0 if none yet */
+    uint64_t last_late_wakeup_us;
+    uint64_t last_error_us;        /**< last timeout or transfer error */
+};
+
+typedef int (*agm_pcm_plugin_get_xrun_stats_t)(unsigned int card,
+                                               unsigned int device,
+                                               struct agm_xrun_stats *stats);
+
+#endif /*_AGM_XRUN_H_*/
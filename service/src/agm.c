@@ -36,6 +36,12 @@
 #include <agm/session_obj.h>
 #include <agm/utils.h>
 #include <agm/agm_memlogger.h>
+#include <agm/session_async.h>
+#include <agm/session_txn.h>
+#include <agm/session_fanout.h>
+#include <agm/blob_registry.h>
+#include <agm/ssr_recovery.h>
+#include <agm/agm_sched.h>
 #include "ats.h"
 #include <stdio.h>
 #include <stdbool.h>
@@ -58,6 +64,7 @@ static void *ats_init_thread(void *obj __unused)
     int ret = 0;
     int retry = 0;
 
+    agm_thread_sched_apply(AGM_THREAD_ATS);
     while(retry++ < MAX_RETRIES) {
         if (agm_initialized) {
             ret = ats_init();
@@ -71,6 +78,7 @@ static void *ats_init_thread(void *obj __unused)
         }
         usleep(RETRY_INTERVAL_US);
     }
+    agm_thread_sched_release();
     return NULL;
 }
 
@@ -81,21 +89,15 @@ int agm_init()
     if (agm_initialized)
         goto exit;
 
-    pthread_attr_t tattr;
-    struct sched_param param;
-
 #ifdef DYNAMIC_LOG_ENABLED
     register_for_dynamic_logging("agm");
     log_utils_init();
 #endif
 
     agm_memlog_init();
-    pthread_attr_init (&tattr);
-    pthread_attr_getschedparam (&tattr, &param);
-    param.sched_priority = SCHED_FIFO;
-    pthread_attr_setschedparam (&tattr, &param);
+    agm_sched_init();
 
-    ret = pthread_create(&ats_thread, (const pthread_attr_t *) &tattr,
+    ret = pthread_create(&ats_thread, (const pthread_attr_t *) NULL,
                                            ats_init_thread, NULL);
     if (ret)
         AGM_LOGE(" ats init thread creation failed\n");
@@ -105,6 +107,12 @@ int agm_init()
         AGM_LOGE("Session_obj_init failed with %d", ret);
         goto exit;
     }
+
+    session_async_init();
+
+    /* sessions are still usable without it, they just die with the DSP */
+    if (ssr_recovery_init())
+        AGM_LOGE("SSR recovery init failed, sessions will not be restored");
     agm_initialized = 1;
 
 exit:
@@ -117,7 +125,11 @@ int agm_deinit()
     if (agm_initialized) {
         AGM_LOGD("Deinitializing ATS...");
         ats_deinit();
+        ssr_recovery_deinit();
+        session_async_deinit();
         session_obj_deinit();
+        blob_registry_deinit();
+        agm_sched_deinit();
         agm_memlog_deinit();
         agm_initialized = 0;
     }
@@ -441,6 +453,39 @@ done:
     return ret;
 }
 
+int agm_session_set_params_owned(uint32_t session_id, uint32_t aif_id,
+                                 void *payload, size_t size)
+{
+    struct session_obj *obj = NULL;
+    int ret = 0;
+
+    ret = session_obj_get(session_id, &obj);
+    if (ret) {
+        AGM_LOGE("Error:%d retrieving session obj with session id=%d\n",
+                                                 ret, session_id);
+        free(payload);
+        return ret;
+    }
+
+    return session_obj_set_params_owned(obj, aif_id, payload, size);
+}
+
+int agm_session_set_params_fd(uint32_t session_id, uint32_t aif_id,
+                              int fd, size_t size)
+{
+    struct session_obj *obj = NULL;
+    int ret = 0;
+
+    ret = session_obj_get(session_id, &obj);
+    if (ret) {
+        AGM_LOGE("Error:%d retrieving session obj with session id=%d\n",
+                                                 ret, session_id);
+        return ret;
+    }
+
+    return session_obj_set_params_fd(obj, aif_id, fd, size);
+}
+
 int agm_session_set_params(uint32_t session_id,
                          void* payload, size_t size)
 {
@@ -465,6 +510,140 @@ done:
     return ret;
 }
 
+int agm_session_stage_params(uint32_t session_id,
+                         void* payload, size_t size)
+{
+    struct session_obj *obj = NULL;
+    int ret = 0;
+
+    ret = session_obj_get(session_id, &obj);
+    if (ret) {
+        AGM_LOGE("Error:%d retrieving session obj with session id=%d\n",
+                                                 ret, session_id);
+        goto done;
+    }
+
+    ret = session_obj_stage_sess_params(obj, payload, size);
+    if (ret) {
+        AGM_LOGE("Error:%d staging parameters for session obj with \
+                               session id=%d\n", ret, session_id);
+    }
+
+done:
+    return ret;
+}
+
+int agm_session_aif_stage_params(uint32_t session_id,
+                        uint32_t aif_id,
+                        void* payload, size_t size)
+{
+    struct session_obj *obj = NULL;
+    int ret = 0;
+
+    ret = session_obj_get(session_id, &obj);
+    if (ret) {
+        AGM_LOGE("Error:%d retrieving session obj with \
+                        session id=%d\n", ret, session_id);
+        goto done;
+    }
+
+    ret = session_obj_stage_sess_aif_params(obj, aif_id, payload, size);
+    if (ret) {
+        AGM_LOGE("Error:%d staging parameters for session obj with \
+                                          session id=%d, aif_id=%d\n",
+                                        ret, session_id, aif_id);
+    }
+
+done:
+    return ret;
+}
+
+int agm_session_commit_params(uint32_t session_id)
+{
+    struct session_obj *obj = NULL;
+    int ret = 0;
+
+    ret = session_obj_get(session_id, &obj);
+    if (ret) {
+        AGM_LOGE("Error:%d retrieving session obj with session id=%d\n",
+                                                 ret, session_id);
+        goto done;
+    }
+
+    ret = session_obj_commit_params(obj);
+    if (ret) {
+        AGM_LOGE("Error:%d committing parameters for session obj with \
+                               session id=%d\n", ret, session_id);
+    }
+
+done:
+    return ret;
+}
+
+int agm_session_get_cal_stats(uint32_t session_id, uint32_t *applied,
+                              uint32_t *skipped)
+{
+    struct session_obj *obj = NULL;
+    int ret = 0;
+
+    if (!applied || !skipped) {
+        AGM_LOGE("Invalid input\n");
+        return -EINVAL;
+    }
+
+    ret = session_obj_get(session_id, &obj);
+    if (ret) {
+        AGM_LOGE("Error:%d retrieving session obj with session id=%d\n",
+                                                 ret, session_id);
+        goto done;
+    }
+
+    ret = session_obj_get_cal_stats(obj, applied, skipped);
+
+done:
+    return ret;
+}
+
+int agm_get_ssr_stats(struct agm_ssr_stats *stats)
+{
+    if (!stats) {
+        AGM_LOGE("Invalid input\n");
+        return -EINVAL;
+    }
+
+    return ssr_recovery_get_stats(stats);
+}
+
+int agm_session_set_gain(uint32_t session_id, uint32_t gain,
+                         uint32_t ramp_duration_ms)
+{
+    return agm_session_aif_set_gain(session_id, GAIN_MAILBOX_SESSION,
+                                    gain, ramp_duration_ms);
+}
+
+int agm_session_aif_set_gain(uint32_t session_id, uint32_t aif_id,
+                             uint32_t gain, uint32_t ramp_duration_ms)
+{
+    struct session_obj *obj = NULL;
+    int ret = 0;
+
+    ret = session_obj_get(session_id, &obj);
+    if (ret) {
+        AGM_LOGE("Error:%d retrieving session obj with session id=%d\n",
+                                                 ret, session_id);
+        goto done;
+    }
+
+    ret = session_obj_set_gain(obj, aif_id, gain, ramp_duration_ms);
+    if (ret) {
+        AGM_LOGE("Error:%d setting gain 0x%x for session id=%d, aif_id=%d\n",
+                                         ret, gain, session_id, aif_id);
+    }
+
+done:
+    return ret;
+}
+
 int agm_set_params_with_tag(uint32_t session_id, uint32_t aif_id,
                                struct agm_tag_config *tag_config)
 {
@@ -582,6 +761,28 @@ done:
     return ret;
 }
 
+int agm_session_register_cb_filtered(uint32_t session_id, agm_event_cb cb,
+                                     enum event_type evt_type, void *client_data,
+                                     const struct agm_event_filter *filter)
+{
+    struct session_obj *obj = NULL;
+    int ret = 0;
+
+    ret = session_obj_get(session_id, &obj);
+    if (ret) {
+        AGM_LOGE("Error:%d retrieving session obj with session id=%d\n",
+                                                 ret, session_id);
+        return ret;
+    }
+
+    ret = session_obj_register_cb_filtered(obj, cb, evt_type, client_data,
+                                           filter);
+    if (ret)
+        AGM_LOGE("Error:%d registering filtered callback for session id=%d\n",
+                 ret, session_id);
+    return ret;
+}
+
 int agm_session_register_for_events(uint32_t session_id,
                             struct agm_event_reg_cfg *evt_reg_cfg)
 {
@@ -655,6 +856,39 @@ int agm_session_open(uint32_t session_id,
     return session_obj_open(session_id, sess_mode, handle);
 }
 
+int agm_session_transact(void *txn, size_t txn_size, uint64_t *hndl)
+{
+    if (!txn || !hndl) {
+        AGM_LOGE("Invalid params txn:%pK, handle:%pK\n", txn, hndl);
+        return -EINVAL;
+    }
+
+    return session_txn_execute(txn, txn_size, hndl);
+}
+
+int agm_blob_register(enum agm_blob_type type, void *blob, size_t size,
+                      uint32_t *blob_id)
+{
+    if (!blob || !size || !blob_id) {
+        AGM_LOGE("Invalid params blob:%pK, size:%zu, blob_id:%pK\n",
+                 blob, size, blob_id);
+        return -EINVAL;
+    }
+
+    return blob_registry_register(type, blob, size, blob_id);
+}
+
+int agm_blob_unregister(uint32_t blob_id)
+{
+    return blob_registry_unregister(blob_id);
+}
+
+int agm_session_set_blob(uint32_t session_id, uint32_t aif_id,
+                         uint32_t blob_id)
+{
+    return blob_registry_apply(session_id, aif_id, blob_id);
+}
+
 int agm_session_set_config(uint64_t hndl,
                            struct agm_session_config *stream_config,
                            struct agm_media_config *media_config,
@@ -738,6 +972,23 @@ int agm_session_close(uint64_t hndl)
     return session_obj_close(handle);
 }
 
+int agm_session_cmd_async(uint64_t hndl, enum agm_session_cmd cmd,
+                          uint32_t token)
+{
+    struct session_obj *handle = (struct session_obj *) hndl;
+    if (!handle) {
+        AGM_LOGE("Invalid handle\n");
+        return -EINVAL;
+    }
+
+    if (!session_obj_valid_check(hndl)) {
+        AGM_LOGE("Invalid handle\n");
+        return -EINVAL;
+    }
+
+    return session_async_queue_cmd(handle, cmd, token);
+}
+
 int agm_session_pause(uint64_t hndl)
 {
     struct session_obj *handle = (struct session_obj *) hndl;
@@ -839,9 +1090,86 @@ int agm_session_read(uint64_t hndl, void *buff, size_t *count)
         AGM_LOGE("Invalid handle\n");
         return -EINVAL;
     }
+
+    /* the readers own the capture, a direct read would steal their periods */
+    if (session_fanout_active(handle)) {
+        AGM_LOGE("session has fan-out readers, use agm_session_reader_read\n");
+        return -EBUSY;
+    }
     return session_obj_read(handle, buff, count);
 }
 
+static int agm_session_iov_check(uint64_t hndl, struct agm_iovec *iov,
+                                 uint32_t iovcnt, uint32_t *done)
+{
+    if (!hndl || !session_obj_valid_check(hndl)) {
+        AGM_LOGE("Invalid handle\n");
+        return -EINVAL;
+    }
+
+    if (!iov || !done || iovcnt == 0 || iovcnt > AGM_SESSION_MAX_IOV) {
+        AGM_LOGE("Invalid iov count %u\n", iovcnt);
+        return -EINVAL;
+    }
+    return 0;
+}
+
+int agm_session_writev(uint64_t hndl, struct agm_iovec *iov,
+                       uint32_t iovcnt, uint32_t *done)
+{
+    int ret = agm_session_iov_check(hndl, iov, iovcnt, done);
+
+    if (ret)
+        return ret;
+    return session_obj_writev((struct session_obj *)hndl, iov, iovcnt, done);
+}
+
+int agm_session_readv(uint64_t hndl, struct agm_iovec *iov,
+                      uint32_t iovcnt, uint32_t *done)
+{
+    int ret = agm_session_iov_check(hndl, iov, iovcnt, done);
+
+    if (ret)
+        return ret;
+
+    if (session_fanout_active((struct session_obj *)hndl)) {
+        AGM_LOGE("session has fan-out readers, use agm_session_reader_read\n");
+        return -EBUSY;
+    }
+    return session_obj_readv((struct session_obj *)hndl, iov, iovcnt, done);
+}
+
+int agm_session_reader_open(uint64_t hndl, uint64_t *reader)
+{
+    struct session_obj *handle = (struct session_obj *) hndl;
+
+    if (!handle || !reader) {
+        AGM_LOGE("Invalid handle\n");
+        return -EINVAL;
+    }
+
+    if (!session_obj_valid_check(hndl)) {
+        AGM_LOGE("Invalid handle\n");
+        return -EINVAL;
+    }
+    return session_fanout_reader_open(handle, reader);
+}
+
+int agm_session_reader_read(uint64_t reader, void *buff, size_t *count,
+                            uint64_t *dropped)
+{
+    if (!buff || !count || !dropped) {
+        AGM_LOGE("Invalid params\n");
+        return -EINVAL;
+    }
+    return session_fanout_reader_read(reader, buff, count, dropped);
+}
+
+int agm_session_reader_close(uint64_t reader)
+{
+    return session_fanout_reader_close(reader);
+}
+
 size_t agm_get_hw_processed_buff_cnt(uint64_t hndl, enum direction dir)
 {
     struct session_obj *handle = (struct session_obj *) hndl;
@@ -26,10 +26,10 @@ void agm_memlog_init()
     if (ret) {
         AGM_LOGE("error in initializing SPF reset static buffer %d", ret);
     }
-    ret = gsl_register_global_event_cb(agm_memlog_spf_reset_cb, NULL);
-    if (ret) {
-        AGM_LOGE("error in initializing SPF reset callback %d", ret);
-    }
+    /*
+     *agm_memlog_spf_reset_cb is called from the SSR recovery callback, which
+     *registers it with GSL directly while SSR recovery is not running.
+     */
 }
 
 void agm_memlog_deinit()
@@ -0,0 +1,329 @@
+/*
+* Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+* SPDX-License-Identifier: BSD-3-Clause-Clear
+*/
+#define LOG_TAG "AGM: sched"
+
+#include <errno.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <agm/agm_sched.h>
+#include <agm/utils.h>
+
+#ifdef AGM_USE_CUTILS
+#include <cutils/properties.h>
+#endif
+
+#ifdef DYNAMIC_LOG_ENABLED
+#include <log_xml_parser.h>
+#define LOG_MASK AGM_MOD_FILE_AGM_SRC
+#include <log_utils.h>
+#endif
+
+#ifndef AGM_SCHED_CONF_PATH
+#define AGM_SCHED_CONF_PATH "/etc/agm_sched.conf"
+#endif
+
+#define AGM_SCHED_MAX_THREADS 32
+#define AGM_SCHED_PROP_PREFIX "vendor.audio.agm.sched."
+
+struct agm_sched_conf {
+    bool valid;
+    int policy;
+    int priority;
+    uint64_t cpu_mask;
+};
+
+struct agm_sched {
+    pthread_mutex_t lock;
+    struct agm_sched_conf conf[AGM_THREAD_CLASS_MAX];
+    struct agm_thread_sched_info threads[AGM_SCHED_MAX_THREADS];
+    uint32_t num_threads;
+};
+
+static struct agm_sched sched = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+static const char *agm_sched_class_names[AGM_THREAD_CLASS_MAX] = {
+    [AGM_THREAD_ATS] = "ats",
+    [AGM_THREAD_ASYNC] = "async",
+    [AGM_THREAD_SSR] = "ssr",
+    [AGM_THREAD_IPC] = "ipc",
+};
+
+static int agm_sched_policy_from_name(const char *name)
+{
+    if (!strcmp(name, "fifo"))
+        return SCHED_FIFO;
+    if (!strcmp(name, "rr"))
+        return SCHED_RR;
+    if (!strcmp(name, "other"))
+        return SCHED_OTHER;
+    return -1;
+}
+
+static int agm_sched_class_from_name(const char *name)
+{
+    int i;
+
+    for (i = 0; i < AGM_THREAD_CLASS_MAX; i++) {
+        if (!strcmp(name, agm_sched_class_names[i]))
+            return i;
+    }
+    return -1;
+}
+
+static bool agm_sched_conf_valid(struct agm_sched_conf *conf)
+{
+    if (conf->policy == SCHED_OTHER)
+        return conf->priority >= -20 && conf->priority <= 19;
+
+    return conf->priority >= sched_get_priority_min(conf->policy) &&
+           conf->priority <= sched_get_priority_max(conf->policy);
+}
+
+/* fields are "<policy> <priority> [cpu mask]", separated by sep */
+static int agm_sched_parse(char *fields, const char *sep,
+                           struct agm_sched_conf *conf)
+{
+    char *policy, *prio, *mask, *saveptr = NULL;
+
+    policy = strtok_r(fields, sep, &saveptr);
+    prio = strtok_r(NULL, sep, &saveptr);
+    mask = strtok_r(NULL, sep, &saveptr);
+    if (!policy || !prio)
+        return -EINVAL;
+
+    conf->policy = agm_sched_policy_from_name(policy);
+    if (conf->policy < 0)
+        return -EINVAL;
+    conf->priority = (int)strtol(prio, NULL, 0);
+    conf->cpu_mask = mask ? strtoull(mask, NULL, 0) : 0;
+    if (!agm_sched_conf_valid(conf))
+        return -EINVAL;
+
+    conf->valid = true;
+    return 0;
+}
+
+static void agm_sched_load_file(void)
+{
+    struct agm_sched_conf conf;
+    char line[128], *name, *rest, *saveptr = NULL;
+    FILE *fp;
+    int cls;
+
+    fp = fopen(AGM_SCHED_CONF_PATH, "r");
+    if (!fp)
+        return;
+
+    while (fgets(line, sizeof(line), fp)) {
+        rest = strchr(line, '#');
+        if (rest)
+            *rest = '\0';
+        name = strtok_r(line, " \t\n", &saveptr);
+        if (!name)
+            continue;
+        rest = strtok_r(NULL, "\n", &saveptr);
+
+        cls = agm_sched_class_from_name(name);
+        memset(&conf, 0, sizeof(conf));
+        if (cls < 0 || !rest || agm_sched_parse(rest, " \t", &conf)) {
+            AGM_LOGE("ignoring invalid sched config for %s\n", name);
+            continue;
+        }
+        sched.conf[cls] = conf;
+    }
+    fclose(fp);
+}
+
+#ifdef AGM_USE_CUTILS
+static void agm_sched_load_props(void)
+{
+    struct agm_sched_conf conf;
+    char key[PROPERTY_KEY_MAX], val[PROPERTY_VALUE_MAX];
+    int cls;
+
+    for (cls = 0; cls < AGM_THREAD_CLASS_MAX; cls++) {
+        snprintf(key, sizeof(key), AGM_SCHED_PROP_PREFIX "%s",
+                 agm_sched_class_names[cls]);
+        if (property_get(key, val, "") <= 0)
+            continue;
+
+        memset(&conf, 0, sizeof(conf));
+        if (agm_sched_parse(val, ",", &conf)) {
+            AGM_LOGE("ignoring invalid %s = %s\n", key, val);
+            continue;
+        }
+        sched.conf[cls] = conf;
+    }
+}
+#endif
+
+void agm_sched_init(void)
+{
+    int cls;
+
+    pthread_mutex_lock(&sched.lock);
+    memset(sched.conf, 0, sizeof(sched.conf));
+    agm_sched_load_file();
+#ifdef AGM_USE_CUTILS
+    agm_sched_load_props();
+#endif
+    for (cls = 0; cls < AGM_THREAD_CLASS_MAX; cls++) {
+        if (sched.conf[cls].valid)
+            AGM_LOGI("%s threads: policy %d priority %d cpus 0x%llx\n",
+                     agm_sched_class_names[cls], sched.conf[cls].policy,
+                     sched.conf[cls].priority,
+                     (unsigned long long)sched.conf[cls].cpu_mask);
+    }
+    pthread_mutex_unlock(&sched.lock);
+}
+
+void agm_sched_deinit(void)
+{
+    pthread_mutex_lock(&sched.lock);
+    memset(sched.conf, 0, sizeof(sched.conf));
+    pthread_mutex_unlock(&sched.lock);
+}
+
+int agm_sched_mutex_init(pthread_mutex_t *lock)
+{
+    pthread_mutexattr_t attr;
+    int ret;
+
+    pthread_mutexattr_init(&attr);
+#ifdef AGM_PI_LOCKS
+    ret = pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT);
+    if (ret)
+        AGM_LOGE("priority inheritance not available, err %d\n", ret);
+#endif
+    ret = pthread_mutex_init(lock, &attr);
+    pthread_mutexattr_destroy(&attr);
+    return -ret;
+}
+
+static int agm_sched_set_affinity(uint64_t cpu_mask)
+{
+    cpu_set_t set;
+    int cpu;
+
+    CPU_ZERO(&set);
+    for (cpu = 0; cpu < 64 && cpu < CPU_SETSIZE; cpu++) {
+        if (cpu_mask & (1ULL << cpu))
+            CPU_SET(cpu, &set);
+    }
+    if (sched_setaffinity(0, sizeof(set), &set))
+        return -errno;
+    return 0;
+}
+
+/* called with sched lock held */
+static struct agm_thread_sched_info *agm_sched_thread_slot_l(int32_t tid)
+{
+    uint32_t i;
+
+    for (i = 0; i < sched.num_threads; i++) {
+        if (sched.threads[i].tid == tid)
+            return &sched.threads[i];
+    }
+    if (sched.num_threads == AGM_SCHED_MAX_THREADS)
+        return NULL;
+    return &sched.threads[sched.num_threads++];
+}
+
+int agm_thread_sched_apply(enum agm_thread_class thread_class)
+{
+    struct agm_thread_sched_info *info;
+    struct agm_sched_conf conf;
+    struct sched_param param = {0};
+    int32_t tid = (int32_t)syscall(SYS_gettid);
+    int policy, ret = 0;
+
+    if (thread_class >= AGM_THREAD_CLASS_MAX)
+        return -EINVAL;
+
+    pthread_mutex_lock(&sched.lock);
+    conf = sched.conf[thread_class];
+    pthread_mutex_unlock(&sched.lock);
+
+    if (conf.valid) {
+        if (conf.policy == SCHED_OTHER) {
+            ret = pthread_setschedparam(pthread_self(), SCHED_OTHER, &param);
+            if (!ret && setpriority(PRIO_PROCESS, tid, conf.priority))
+                ret = errno;
+        } else {
+            param.sched_priority = conf.priority;
+            ret = pthread_setschedparam(pthread_self(), conf.policy, &param);
+        }
+        if (ret)
+            AGM_LOGE("%s thread %d: policy %d priority %d failed, err %d\n",
+                     agm_sched_class_names[thread_class], tid, conf.policy,
+                     conf.priority, ret);
+
+        if (conf.cpu_mask && agm_sched_set_affinity(conf.cpu_mask))
+            AGM_LOGE("%s thread %d: cpu mask 0x%llx failed\n",
+                     agm_sched_class_names[thread_class], tid,
+                     (unsigned long long)conf.cpu_mask);
+    }
+
+    /* list what the thread ended up with, not what was asked for */
+    pthread_getschedparam(pthread_self(), &policy, &param);
+
+    pthread_mutex_lock(&sched.lock);
+    info = agm_sched_thread_slot_l(tid);
+    if (info) {
+        info->tid = tid;
+        info->thread_class = thread_class;
+        info->policy = policy;
+        info->priority = policy == SCHED_OTHER ?
+                         getpriority(PRIO_PROCESS, tid) : param.sched_priority;
+        info->cpu_mask = conf.valid ? conf.cpu_mask : 0;
+    }
+    pthread_mutex_unlock(&sched.lock);
+
+    return -ret;
+}
+
+void agm_thread_sched_release(void)
+{
+    int32_t tid = (int32_t)syscall(SYS_gettid);
+    uint32_t i;
+
+    pthread_mutex_lock(&sched.lock);
+    for (i = 0; i < sched.num_threads; i++) {
+        if (sched.threads[i].tid == tid) {
+            sched.threads[i] = sched.threads[--sched.num_threads];
+            break;
+        }
+    }
+    pthread_mutex_unlock(&sched.lock);
+}
+
+int agm_get_thread_sched_info(struct agm_thread_sched_info *info,
+                              uint32_t *num)
+{
+    uint32_t count;
+
+    if (!num)
+        return -EINVAL;
+
+    pthread_mutex_lock(&sched.lock);
+    count = sched.num_threads;
+    if (info) {
+        if (count > *num)
+            count = *num;
+        memcpy(info, sched.threads,
+               count * sizeof(struct agm_thread_sched_info));
+    }
+    *num = count;
+    pthread_mutex_unlock(&sched.lock);
+
+    return 0;
+}
@@ -0,0 +1,294 @@
+/*
+* Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+* SPDX-License-Identifier: BSD-3-Clause-Clear
+*/
+#define LOG_TAG "AGM: blob_registry"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <string.h>
+#include <agm/agm_list.h>
+#include <agm/blob_registry.h>
+#include <agm/metadata.h>
+#include <agm/session_obj.h>
+#include <agm/utils.h>
+
+#ifdef DYNAMIC_LOG_ENABLED
+#include <log_xml_parser.h>
+#define LOG_MASK AGM_MOD_FILE_SESSION_OBJ
+#include <log_utils.h>
+#endif
+
+#define BLOB_REGISTRY_BUCKETS    64
+
+/*
+ *Blobs are looked up by content hash on register and by id on use. An
+ *entry stays alive while registered or being applied, the id is never
+ *reused for other content.
+ */
+struct blob_entry {
+    struct listnode hash_node;
+    struct listnode id_node;
+    uint32_t id;
+    uint32_t type;
+    uint32_t hash;
+    uint32_t refs;
+    uint32_t users;
+    bool unlinked;
+    /* metadata blobs are kept parsed, ready for merging */
+    struct agm_meta_data_gsl meta;
+    size_t size;
+    uint8_t data[];
+};
+
+static struct {
+    pthread_mutex_t lock;
+    bool init;
+    struct listnode hash_buckets[BLOB_REGISTRY_BUCKETS];
+    struct listnode id_buckets[BLOB_REGISTRY_BUCKETS];
+    uint32_t next_id;
+    size_t size;
+} blob_reg = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+/* FNV-1a, mixed with the type so equal bytes of other types do not match */
+static uint32_t blob_hash(uint32_t type, const uint8_t *data, size_t size)
+{
+    uint32_t hash = 2166136261u ^ type;
+    size_t i;
+
+    for (i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+static void blob_registry_init_l(void)
+{
+    int i;
+
+    if (blob_reg.init)
+        return;
+
+    for (i = 0; i < BLOB_REGISTRY_BUCKETS; i++) {
+        list_init(&blob_reg.hash_buckets[i]);
+        list_init(&blob_reg.id_buckets[i]);
+    }
+    blob_reg.next_id = 1;
+    blob_reg.init = true;
+}
+
+static struct blob_entry *blob_find_by_content_l(uint32_t type, uint32_t hash,
+                                                 void *blob, size_t size)
+{
+    struct blob_entry *entry;
+    struct listnode *node;
+
+    list_for_each(node, &blob_reg.hash_buckets[hash % BLOB_REGISTRY_BUCKETS]) {
+        entry = node_to_item(node, struct blob_entry, hash_node);
+        if (entry->hash == hash && entry->type == type &&
+            entry->size == size && !memcmp(entry->data, blob, size))
+            return entry;
+    }
+
+    return NULL;
+}
+
+static struct blob_entry *blob_find_by_id_l(uint32_t blob_id)
+{
+    struct blob_entry *entry;
+    struct listnode *node;
+
+    if (!blob_reg.init)
+        return NULL;
+
+    list_for_each(node, &blob_reg.id_buckets[blob_id % BLOB_REGISTRY_BUCKETS]) {
+        entry = node_to_item(node, struct blob_entry, id_node);
+        if (entry->id == blob_id)
+            return entry;
+    }
+
+    return NULL;
+}
+
+static void blob_entry_free(struct blob_entry *entry)
+{
+    metadata_free(&entry->meta);
+    free(entry);
+}
+
+/* unlink from lookups, freed right away unless a user still holds it */
+static void blob_entry_release_l(struct blob_entry *entry)
+{
+    list_remove(&entry->hash_node);
+    list_remove(&entry->id_node);
+    entry->unlinked = true;
+    blob_reg.size -= entry->size;
+
+    if (!entry->users)
+        blob_entry_free(entry);
+}
+
+int blob_registry_register(uint32_t type, void *blob, size_t size,
+                           uint32_t *blob_id)
+{
+    struct blob_entry *entry;
+    uint32_t hash;
+    int ret = 0;
+
+    if (type != AGM_BLOB_METADATA && type != AGM_BLOB_PARAMS) {
+        AGM_LOGE("Invalid blob type %u\n", type);
+        return -EINVAL;
+    }
+
+    hash = blob_hash(type, blob, size);
+
+    pthread_mutex_lock(&blob_reg.lock);
+    blob_registry_init_l();
+
+    entry = blob_find_by_content_l(type, hash, blob, size);
+    if (entry) {
+        entry->refs++;
+        *blob_id = entry->id;
+        goto done;
+    }
+
+    if (blob_reg.size + size > BLOB_REGISTRY_MAX_BYTES) {
+        AGM_LOGE("Registry full, %zu bytes held, blob of %zu refused\n",
+                 blob_reg.size, size);
+        ret = -ENOSPC;
+        goto done;
+    }
+
+    entry = calloc(1, sizeof(struct blob_entry) + size);
+    if (!entry) {
+        ret = -ENOMEM;
+        goto done;
+    }
+
+    memcpy(entry->data, blob, size);
+    entry->size = size;
+    entry->type = type;
+    entry->hash = hash;
+    entry->refs = 1;
+
+    /* parse once here, later uses only copy the key vectors */
+    if (type == AGM_BLOB_METADATA) {
+        ret = metadata_copy(&entry->meta, size, entry->data);
+        if (ret) {
+            AGM_LOGE("Error:%d parsing metadata blob\n", ret);
+            free(entry);
+            goto done;
+        }
+    }
+
+    entry->id = blob_reg.next_id++;
+    if (!blob_reg.next_id)
+        blob_reg.next_id = 1;
+
+    list_add_tail(&blob_reg.hash_buckets[hash % BLOB_REGISTRY_BUCKETS],
+                  &entry->hash_node);
+    list_add_tail(&blob_reg.id_buckets[entry->id % BLOB_REGISTRY_BUCKETS],
+                  &entry->id_node);
+    blob_reg.size += size;
+    *blob_id = entry->id;
+
+done:
+    pthread_mutex_unlock(&blob_reg.lock);
+    return ret;
+}
+
+int blob_registry_unregister(uint32_t blob_id)
+{
+    struct blob_entry *entry;
+    int ret = 0;
+
+    pthread_mutex_lock(&blob_reg.lock);
+    entry = blob_find_by_id_l(blob_id);
+    if (!entry) {
+        AGM_LOGE("No blob registered with id %u\n", blob_id);
+        ret = -EINVAL;
+        goto done;
+    }
+
+    if (--entry->refs == 0)
+        blob_entry_release_l(entry);
+
+done:
+    pthread_mutex_unlock(&blob_reg.lock);
+    return ret;
+}
+
+int blob_registry_apply(uint32_t session_id, uint32_t aif_id, uint32_t blob_id)
+{
+    struct session_obj *sess_obj = NULL;
+    struct blob_entry *entry;
+    int ret = 0;
+
+    ret = session_obj_get(session_id, &sess_obj);
+    if (ret) {
+        AGM_LOGE("Error:%d retrieving session obj with session id=%d\n",
+                 ret, session_id);
+        return ret;
+    }
+
+    /* the registry lock is not held across the session calls */
+    pthread_mutex_lock(&blob_reg.lock);
+    entry = blob_find_by_id_l(blob_id);
+    if (entry)
+        entry->users++;
+    pthread_mutex_unlock(&blob_reg.lock);
+
+    if (!entry) {
+        AGM_LOGE("No blob registered with id %u\n", blob_id);
+        return -EINVAL;
+    }
+
+    if (entry->type == AGM_BLOB_METADATA) {
+        if (aif_id == AGM_AIF_NONE)
+            ret = session_obj_set_sess_metadata_gsl(sess_obj, &entry->meta);
+        else
+            ret = session_obj_set_sess_aif_metadata_gsl(sess_obj, aif_id,
+                                                        &entry->meta);
+    } else {
+        if (aif_id == AGM_AIF_NONE)
+            ret = session_obj_set_sess_params(sess_obj, entry->data,
+                                              entry->size);
+        else
+            ret = session_obj_set_sess_aif_params(sess_obj, aif_id,
+                                                  entry->data, entry->size);
+    }
+
+    if (ret)
+        AGM_LOGE("Error:%d applying blob %u to session id=%d, aif_id:%u\n",
+                 ret, blob_id, session_id, aif_id);
+
+    pthread_mutex_lock(&blob_reg.lock);
+    if (--entry->users == 0 && entry->unlinked)
+        blob_entry_free(entry);
+    pthread_mutex_unlock(&blob_reg.lock);
+
+    return ret;
+}
+
+void blob_registry_deinit(void)
+{
+    struct blob_entry *entry;
+    struct listnode *node, *next;
+    int i;
+
+    pthread_mutex_lock(&blob_reg.lock);
+    if (blob_reg.init) {
+        for (i = 0; i < BLOB_REGISTRY_BUCKETS; i++) {
+            list_for_each_safe(node, next, &blob_reg.id_buckets[i]) {
+                entry = node_to_item(node, struct blob_entry, id_node);
+                blob_entry_release_l(entry);
+            }
+        }
+    }
+    pthread_mutex_unlock(&blob_reg.lock);
+}
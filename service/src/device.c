@@ -42,6 +42,7 @@
 #include <unistd.h>
 #include <limits.h>
 #include <stdbool.h>
+#include <agm/agm_sched.h>
 #include <agm/device.h>
 #include <agm/metadata.h>
 #include <agm/utils.h>
@@ -1003,7 +1004,7 @@ int parse_snd_card()
            continue;
         }
 
-        pthread_mutex_init(&dev_obj->lock, (const pthread_mutexattr_t *) NULL);
+        agm_sched_mutex_init(&dev_obj->lock);
         list_add_tail(&device_list, &dev_obj->list_node);
         count++;
         if (dev_obj->num_virtual_child) {
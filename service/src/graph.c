@@ -68,8 +68,10 @@
 #include <string.h>
 #include <dirent.h>
 #include <dlfcn.h>
+#include <time.h>
 #include <unistd.h>
 #include "gsl_intf.h"
+#include <agm/agm_sched.h>
 #include <agm/graph.h>
 #include <agm/graph_module.h>
 #include <agm/metadata.h>
@@ -82,6 +84,10 @@
 #include <log_utils.h>
 #endif
 
+#ifdef AGM_USE_CUTILS
+#include <cutils/properties.h>
+#endif
+
 #define DEVICE_RX 0
 #define DEVICE_TX 1
 #define FILE_PATH_EXTN_MAX_SIZE 80
@@ -89,6 +95,9 @@
 
 #define TAGGED_MOD_SIZE_BYTES 1024
 
+/* max age of a cached SPR sample before session time is re-read from SPF */
+#define SESSION_TIME_MAX_STALENESS_US 20000
+
 enum {
     MIID_IDX,
     NUM_OF_PARAM_IDX,
@@ -121,8 +130,228 @@ typedef struct module_info_link_list {
 }module_info_link_list_t;
 
 static char acdb_path[ACDB_PATH_MAX_LENGTH];
+static uint32_t session_time_max_staleness_us = SESSION_TIME_MAX_STALENESS_US;
 static void print_graph_alias(const struct agm_meta_data_gsl *meta_data_kv);
 
+static uint64_t graph_get_monotonic_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000) + ((uint64_t)ts.tv_nsec / 1000);
+}
+
+/*
+ *Drop the cached SPR sample, called on every transition which makes the
+ *session time jump or stop. frozen marks that the session time does not
+ *advance until the next invalidate (paused graph).
+ */
+static void graph_time_cache_invalidate(struct graph_obj *graph_obj, bool frozen)
+{
+    pthread_mutex_lock(&graph_obj->time_cache.lock);
+    graph_obj->time_cache.valid = false;
+    graph_obj->time_cache.frozen = frozen;
+    graph_obj->time_cache.generation++;
+    pthread_mutex_unlock(&graph_obj->time_cache.lock);
+}
+
+static bool graph_time_cache_lookup(struct graph_obj *graph_obj, uint64_t *tstamp,
+                                    uint32_t *generation)
+{
+    struct graph_time_cache *cache = &graph_obj->time_cache;
+    uint64_t now, age;
+    bool hit = false;
+
+    pthread_mutex_lock(&cache->lock);
+    *generation = cache->generation;
+    if (!cache->valid || session_time_max_staleness_us == 0)
+        goto done;
+
+    now = graph_get_monotonic_us();
+    age = now - cache->sample_time;
+    if (age > session_time_max_staleness_us)
+        goto done;
+
+    *tstamp = cache->session_time + (cache->frozen ? 0 : age);
+    hit = true;
+done:
+    pthread_mutex_unlock(&cache->lock);
+    return hit;
+}
+
+static void graph_time_cache_update(struct graph_obj *graph_obj, uint32_t generation,
+                                    uint64_t session_time, uint64_t absolute_time,
+                                    uint64_t sample_time)
+{
+    struct graph_time_cache *cache = &graph_obj->time_cache;
+
+    pthread_mutex_lock(&cache->lock);
+    /* state changed while SPF was queried, sample may predate it */
+    if (cache->generation == generation) {
+        cache->session_time = session_time;
+        cache->absolute_time = absolute_time;
+        cache->sample_time = sample_time;
+        cache->valid = true;
+    }
+    pthread_mutex_unlock(&cache->lock);
+}
+
+void graph_set_session_time_max_staleness(uint32_t max_staleness_us)
+{
+    AGM_LOGD("session time max staleness %u us", max_staleness_us);
+    session_time_max_staleness_us = max_staleness_us;
+}
+
+/* key vectors are compared as sets, key order differs between merges */
+static bool graph_kv_equal(const struct agm_key_vector_gsl *a,
+                           const struct agm_key_vector_gsl *b)
+{
+    uint32_t i, j;
+
+    if (a->num_kvs != b->num_kvs)
+        return false;
+
+    for (i = 0; i < a->num_kvs; i++) {
+        for (j = 0; j < b->num_kvs; j++) {
+            if (a->kv[i].key == b->kv[j].key)
+                break;
+        }
+        if (j == b->num_kvs || a->kv[i].value != b->kv[j].value)
+            return false;
+    }
+
+    return true;
+}
+
+static int graph_kv_copy(struct agm_key_vector_gsl *dst,
+                         const struct agm_key_vector_gsl *src)
+{
+    struct agm_key_value *kv = NULL;
+
+    if (src->num_kvs) {
+        kv = calloc(src->num_kvs, sizeof(struct agm_key_value));
+        if (!kv)
+            return -ENOMEM;
+        memcpy(kv, src->kv, src->num_kvs * sizeof(struct agm_key_value));
+    }
+
+    free(dst->kv);
+    dst->kv = kv;
+    dst->num_kvs = src->num_kvs;
+    return 0;
+}
+
+static struct graph_applied_cal *graph_applied_cal_find(struct graph_obj *graph_obj,
+                                        const struct agm_key_vector_gsl *gkv)
+{
+    struct graph_applied_cal *cal;
+    struct listnode *node;
+
+    list_for_each(node, &graph_obj->applied_cal_list) {
+        cal = node_to_item(node, struct graph_applied_cal, node);
+        if (graph_kv_equal(&cal->gkv, gkv))
+            return cal;
+    }
+
+    return NULL;
+}
+
+static void graph_applied_cal_free(struct graph_applied_cal *cal)
+{
+    list_remove(&cal->node);
+    free(cal->gkv.kv);
+    free(cal->ckv.kv);
+    free(cal);
+}
+
+static void graph_applied_cal_forget(struct graph_obj *graph_obj,
+                                     const struct agm_key_vector_gsl *gkv)
+{
+    struct graph_applied_cal *cal;
+
+    cal = graph_applied_cal_find(graph_obj, gkv);
+    if (cal)
+        graph_applied_cal_free(cal);
+}
+
+static void graph_applied_cal_clear(struct graph_obj *graph_obj)
+{
+    struct graph_applied_cal *cal;
+    struct listnode *node, *next;
+
+    list_for_each_safe(node, next, &graph_obj->applied_cal_list) {
+        cal = node_to_item(node, struct graph_applied_cal, node);
+        graph_applied_cal_free(cal);
+    }
+}
+
+/*
+ *ckv was applied to the subgraphs of gkv. Which subgraphs other graph key
+ *vectors share with gkv is not known here, so drop every record which
+ *holds a different ckv: any of them may have been recalibrated.
+ */
+static void graph_applied_cal_invalidate(struct graph_obj *graph_obj,
+                                         const struct agm_key_vector_gsl *gkv,
+                                         const struct agm_key_vector_gsl *ckv)
+{
+    struct graph_applied_cal *cal;
+    struct listnode *node, *next;
+
+    list_for_each_safe(node, next, &graph_obj->applied_cal_list) {
+        cal = node_to_item(node, struct graph_applied_cal, node);
+        if (!graph_kv_equal(&cal->gkv, gkv) &&
+            !graph_kv_equal(&cal->ckv, ckv))
+            graph_applied_cal_free(cal);
+    }
+}
+
+/* true if every subgraph known to be calibrated carries ckv */
+static bool graph_applied_cal_all_equal(struct graph_obj *graph_obj,
+                                        const struct agm_key_vector_gsl *ckv)
+{
+    struct graph_applied_cal *cal;
+    struct listnode *node;
+
+    if (list_empty(&graph_obj->applied_cal_list))
+        return false;
+
+    list_for_each(node, &graph_obj->applied_cal_list) {
+        cal = node_to_item(node, struct graph_applied_cal, node);
+        if (!graph_kv_equal(&cal->ckv, ckv))
+            return false;
+    }
+
+    return true;
+}
+
+/*
+ *Remember ckv as applied to the subgraphs of gkv. Failing to do so only
+ *costs a redundant set_cal later, so errors are not propagated.
+ */
+static void graph_applied_cal_record(struct graph_obj *graph_obj,
+                                     const struct agm_key_vector_gsl *gkv,
+                                     const struct agm_key_vector_gsl *ckv)
+{
+    struct graph_applied_cal *cal;
+
+    graph_applied_cal_invalidate(graph_obj, gkv, ckv);
+
+    cal = graph_applied_cal_find(graph_obj, gkv);
+    if (!cal) {
+        cal = calloc(1, sizeof(struct graph_applied_cal));
+        if (!cal)
+            return;
+        if (graph_kv_copy(&cal->gkv, gkv)) {
+            free(cal);
+            return;
+        }
+        list_add_tail(&graph_obj->applied_cal_list, &cal->node);
+    }
+
+    if (graph_kv_copy(&cal->ckv, ckv))
+        graph_applied_cal_free(cal);
+}
+
 static int get_acdb_files_from_directory(const char* acdb_files_path,
                                          struct gsl_acdb_data_files *data_files)
 {
@@ -328,6 +557,12 @@ int graph_init()
     char file_path_extn_wo_variant[FILE_PATH_EXTN_MAX_SIZE] = {0};
     bool snd_card_found = false;
 
+#ifdef AGM_USE_CUTILS
+    session_time_max_staleness_us = (uint32_t)property_get_int32(
+                         "vendor.audio.agm.session_time.max_staleness_us",
+                         SESSION_TIME_MAX_STALENESS_US);
+#endif
+
 #ifndef ACDB_PATH
 #  error "Define -DACDB_PATH="PATH" in the makefile to compile"
 #endif
@@ -499,6 +734,45 @@ done:
     return ret;
 }
 
+int graph_get_tagged_miid(struct agm_key_vector_gsl *gkv, uint32_t tag,
+                          uint32_t *miid)
+{
+    int ret = 0;
+    uint32_t i = 0;
+    struct gsl_tag_module_info *tag_module_info = NULL;
+    struct gsl_tag_module_info_entry *gsl_tag_entry = NULL;
+    size_t tag_module_info_size = 0;
+
+    if (gkv == NULL || miid == NULL) {
+        AGM_LOGE("Invalid input\n");
+        return -EINVAL;
+    }
+
+    ret = get_tags_with_module_info(gkv, (void **)&tag_module_info,
+                                    &tag_module_info_size);
+    if (ret != 0 || !tag_module_info)
+        return ret ? ret : -ENOENT;
+
+    ret = -ENOENT;
+    gsl_tag_entry = (struct gsl_tag_module_info_entry *)
+                          (tag_module_info->tag_module_entry);
+    for (i = 0; i < tag_module_info->num_tags; i++) {
+        if (gsl_tag_entry->tag_id == tag && gsl_tag_entry->num_modules > 0) {
+            *miid = gsl_tag_entry->module_entry[0].module_iid;
+            ret = 0;
+            break;
+        }
+        gsl_tag_entry = (struct gsl_tag_module_info_entry *)
+                          ((char *)gsl_tag_entry +
+                           sizeof(struct gsl_tag_module_info_entry) +
+                           (sizeof(struct gsl_module_id_info_entry) *
+                            gsl_tag_entry->num_modules));
+    }
+
+    free(tag_module_info);
+    return ret;
+}
+
 static int add_to_list(uint32_t module_list_count, module_info_t *info, struct listnode *node)
 {
     uint32_t count = 0;
@@ -564,7 +838,9 @@ int graph_open(struct agm_meta_data_gsl *meta_data_kv,
     print_graph_alias(meta_data_kv);
 
     list_init(&graph_obj->tagged_mod_list);
-    pthread_mutex_init(&graph_obj->lock, (const pthread_mutexattr_t *)NULL);
+    list_init(&graph_obj->applied_cal_list);
+    agm_sched_mutex_init(&graph_obj->lock);
+    pthread_mutex_init(&graph_obj->time_cache.lock, (const pthread_mutexattr_t *)NULL);
     if (sess_obj->stream_config.sess_mode == AGM_SESSION_NO_CONFIG)
         goto no_config;
 
@@ -704,6 +980,7 @@ no_config:
         AGM_LOGE("failed to register callback\n");
         goto close_graph;
     }
+    graph_applied_cal_record(graph_obj, &meta_data_kv->gkv, &meta_data_kv->ckv);
     graph_obj->state = OPENED;
     *gph_obj = graph_obj;
     AGM_LOGD("graph_handle %p\n", graph_obj->graph_handle);
@@ -724,6 +1001,7 @@ free_graph_obj:
         }
         free(temp_mod);
     }
+    pthread_mutex_destroy(&graph_obj->time_cache.lock);
     pthread_mutex_destroy(&graph_obj->lock);
     free(graph_obj);
 done:
@@ -777,7 +1055,9 @@ int graph_close(struct graph_obj *graph_obj)
         }
         free(temp_mod);
     }
+    graph_applied_cal_clear(graph_obj);
     pthread_mutex_unlock(&graph_obj->lock);
+    pthread_mutex_destroy(&graph_obj->time_cache.lock);
     pthread_mutex_destroy(&graph_obj->lock);
     free(graph_obj);
     AGM_LOGD("exit, ret %d", ret);
@@ -905,6 +1185,7 @@ int graph_start(struct graph_obj *graph_obj)
         goto done;
     }
     graph_obj->state = STARTED;
+    graph_time_cache_invalidate(graph_obj, false);
 
 done:
     agm_memlog_graph_enqueue(GRAPH_START, ret, graph_obj->graph_handle);
@@ -970,6 +1251,8 @@ int graph_stop(struct graph_obj *graph_obj,
         }
     }
 
+    graph_time_cache_invalidate(graph_obj, false);
+
 done:
     agm_memlog_graph_enqueue(GRAPH_STOP, ret, graph_obj->graph_handle);
     pthread_mutex_unlock(&graph_obj->lock);
@@ -1023,6 +1306,8 @@ int graph_pause_resume(struct graph_obj *graph_obj, bool pause)
             if (ret !=0) {
                 ret = ar_err_get_lnx_err_code(ret);
                 AGM_LOGE("graph_set_custom_config failed %d\n", ret);
+            } else {
+                graph_time_cache_invalidate(graph_obj, pause);
             }
             pthread_mutex_unlock(&graph_obj->lock);
             free(payload);
@@ -1036,6 +1321,97 @@ done:
 }
 
 
+int graph_set_gain(struct graph_obj *graph_obj, uint32_t miid, uint32_t gain,
+                   uint32_t ramp_ms)
+{
+    int ret = 0;
+    struct listnode *node = NULL;
+    module_info_t *mod;
+    struct apm_module_param_data_t *header;
+    struct volume_ctrl_gain_ramp_params_t *ramp;
+    struct volume_ctrl_master_gain_t *master_gain;
+    size_t ramp_size = 0, gain_size = 0;
+    uint8_t *payload = NULL;
+
+    if (graph_obj == NULL) {
+        AGM_LOGE("invalid graph object\n");
+        return -EINVAL;
+    }
+
+    /* the module takes a 16 bit gain, do not silently truncate it */
+    if (gain > UINT16_MAX) {
+        AGM_LOGE("gain 0x%x out of range\n", gain);
+        return -EINVAL;
+    }
+
+    pthread_mutex_lock(&graph_obj->lock);
+    if (miid == 0) {
+        list_for_each(node, &graph_obj->tagged_mod_list) {
+            mod = node_to_item(node, module_info_t, list);
+            if (mod->tag == TAG_STREAM_VOLUME) {
+                miid = mod->miid;
+                break;
+            }
+        }
+    }
+    if (miid == 0) {
+        AGM_LOGE("No volume module in graph %p\n", graph_obj->graph_handle);
+        ret = -ENOENT;
+        goto done;
+    }
+
+    /* ramp params, if any, must reach the module ahead of the gain */
+    if (ramp_ms) {
+        ramp_size = sizeof(struct apm_module_param_data_t) +
+                    sizeof(struct volume_ctrl_gain_ramp_params_t);
+        ALIGN_PAYLOAD(ramp_size, 8);
+    }
+    gain_size = sizeof(struct apm_module_param_data_t) +
+                sizeof(struct volume_ctrl_master_gain_t);
+    ALIGN_PAYLOAD(gain_size, 8);
+
+    payload = calloc(1, ramp_size + gain_size);
+    if (!payload) {
+        AGM_LOGE("No memory to allocate for payload\n");
+        ret = -ENOMEM;
+        goto done;
+    }
+
+    if (ramp_ms) {
+        header = (struct apm_module_param_data_t *)payload;
+        header->module_instance_id = miid;
+        header->param_id = PARAM_ID_VOL_CTRL_GAIN_RAMP_PARAMETERS;
+        header->param_size = sizeof(struct volume_ctrl_gain_ramp_params_t);
+        ramp = (struct volume_ctrl_gain_ramp_params_t *)
+                    (payload + sizeof(struct apm_module_param_data_t));
+        ramp->period_ms = ramp_ms;
+        /* 0 lets the module pick its default step */
+        ramp->step_us = 0;
+        ramp->ramping_curve = PARAM_VOL_CTRL_RAMPINGCURVE_LINEAR;
+    }
+
+    header = (struct apm_module_param_data_t *)(payload + ramp_size);
+    header->module_instance_id = miid;
+    header->param_id = PARAM_ID_VOL_CTRL_MASTER_GAIN;
+    header->param_size = sizeof(struct volume_ctrl_master_gain_t);
+    master_gain = (struct volume_ctrl_master_gain_t *)
+                    (payload + ramp_size + sizeof(struct apm_module_param_data_t));
+    master_gain->master_gain = (uint16_t)gain;
+
+    AGM_LOGV("miid 0x%x gain 0x%x ramp %u ms\n", miid, gain, ramp_ms);
+    ret = gsl_set_custom_config(graph_obj->graph_handle, payload,
+                                ramp_size + gain_size);
+    if (ret != 0) {
+        ret = ar_err_get_lnx_err_code(ret);
+        AGM_LOGE("gain set failed for miid 0x%x, error %d\n", miid, ret);
+    }
+    free(payload);
+
+done:
+    pthread_mutex_unlock(&graph_obj->lock);
+    return ret;
+}
+
 int graph_pause(struct graph_obj *graph_obj)
 {
     return graph_pause_resume(graph_obj, true);
@@ -1059,6 +1435,7 @@ int graph_flush(struct graph_obj *graph_obj)
         AGM_LOGE("graph_flush failed %d\n", ret);
         goto done;
     }
+    graph_time_cache_invalidate(graph_obj, false);
 
 done:
     pthread_mutex_unlock(&graph_obj->lock);
@@ -1170,6 +1547,7 @@ int graph_set_cal(struct graph_obj *graph_obj,
                   struct agm_meta_data_gsl *metadata)
 {
      int ret = 0;
+     struct graph_applied_cal *cal = NULL;
 
      if (graph_obj == NULL) {
          AGM_LOGE("invalid graph object\n");
@@ -1177,19 +1555,59 @@ int graph_set_cal(struct graph_obj *graph_obj,
      }
 
      pthread_mutex_lock(&graph_obj->lock);
+     cal = graph_applied_cal_find(graph_obj, &metadata->gkv);
+     if (cal && graph_kv_equal(&cal->ckv, &metadata->ckv)) {
+         graph_obj->cal_skipped_cnt++;
+         AGM_LOGD("ckv already applied, skipped %u applied %u\n",
+                  graph_obj->cal_skipped_cnt, graph_obj->cal_applied_cnt);
+         goto done;
+     }
+
      ret = gsl_set_cal(graph_obj->graph_handle,
                        (struct gsl_key_vector *)&metadata->gkv,
                        (struct gsl_key_vector *)&metadata->ckv);
      if (ret) {
          ret = ar_err_get_lnx_err_code(ret);
          AGM_LOGE("graph_set_cal failed %d\n", ret);
+         /* calibration of these and any shared subgraphs is unknown now */
+         graph_applied_cal_clear(graph_obj);
+         goto done;
      }
+     graph_obj->cal_applied_cnt++;
+     graph_applied_cal_record(graph_obj, &metadata->gkv, &metadata->ckv);
 
+done:
      pthread_mutex_unlock(&graph_obj->lock);
 
      return ret;
 }
 
+int graph_get_cal_stats(struct graph_obj *graph_obj, uint32_t *applied,
+                        uint32_t *skipped)
+{
+    if (graph_obj == NULL || applied == NULL || skipped == NULL) {
+        AGM_LOGE("invalid input\n");
+        return -EINVAL;
+    }
+
+    pthread_mutex_lock(&graph_obj->lock);
+    *applied = graph_obj->cal_applied_cnt;
+    *skipped = graph_obj->cal_skipped_cnt;
+    pthread_mutex_unlock(&graph_obj->lock);
+
+    return 0;
+}
+
+void graph_invalidate_cal(struct graph_obj *graph_obj)
+{
+    if (graph_obj == NULL)
+        return;
+
+    pthread_mutex_lock(&graph_obj->lock);
+    graph_applied_cal_clear(graph_obj);
+    pthread_mutex_unlock(&graph_obj->lock);
+}
+
 int graph_rw_acdb_param(void *payload, bool is_param_write)
 {
     int ret = 0;
@@ -1471,6 +1889,15 @@ int graph_add(struct graph_obj *graph_obj,
         AGM_LOGE("graph add failed with error %d\n", ret);
         goto done;
     }
+    /*
+     *Only the new subgraphs got ckv, those shared with graph key vectors
+     *already in the graph kept their calibration.
+     */
+    if (graph_applied_cal_all_equal(graph_obj, &meta_data_kv->ckv))
+        graph_applied_cal_record(graph_obj, &meta_data_kv->gkv,
+                                 &meta_data_kv->ckv);
+    else
+        graph_applied_cal_forget(graph_obj, &meta_data_kv->gkv);
     if (dev_obj != NULL) {
         module_info_t *temp_mod = NULL;
         size_t module_info_size;
@@ -1708,8 +2135,12 @@ int graph_change(struct graph_obj *graph_obj,
     if (ret != 0) {
         ret = ar_err_get_lnx_err_code(ret);
         AGM_LOGE("graph add failed with error %d\n", ret);
+        graph_applied_cal_clear(graph_obj);
         goto done;
     }
+    /* subgraphs of the old gkv are gone, the new ones carry this ckv */
+    graph_applied_cal_clear(graph_obj);
+    graph_applied_cal_record(graph_obj, &meta_data_kv->gkv, &meta_data_kv->ckv);
     /*configure modules again*/
     list_for_each(node, &graph_obj->tagged_mod_list) {
         mod = node_to_item(node, module_info_t, list);
@@ -1721,6 +2152,8 @@ int graph_change(struct graph_obj *graph_obj,
             mod->is_configured = true;
         }
     }
+    /* device switch can restart the session clock */
+    graph_time_cache_invalidate(graph_obj, graph_obj->time_cache.frozen);
 done:
     pthread_mutex_unlock(&graph_obj->lock);
     AGM_LOGD("exit, ret %d", ret);
@@ -1757,6 +2190,7 @@ int graph_remove(struct graph_obj *graph_obj,
         ret = ar_err_get_lnx_err_code(ret);
         AGM_LOGE("graph add failed with error %d\n", ret);
     }
+    graph_applied_cal_forget(graph_obj, &meta_data_kv->gkv);
 
     pthread_mutex_unlock(&graph_obj->lock);
     AGM_LOGD("exit, ret %d", ret);
@@ -1878,13 +2312,17 @@ int graph_get_session_time(struct graph_obj *graph_obj, uint64_t *tstamp)
     struct apm_module_param_data_t *header;
     struct param_id_spr_session_time_t *sess_time;
     size_t payload_size = 0;
-    uint64_t timestamp;
+    uint64_t timestamp, absolute_time, sample_time;
+    uint32_t generation = 0;
 
     if (graph_obj == NULL || tstamp == NULL) {
         AGM_LOGE("Invalid Input Params\n");
         return -EINVAL;
     }
 
+    if (graph_time_cache_lookup(graph_obj, tstamp, &generation))
+        return 0;
+
     pthread_mutex_lock(&graph_obj->lock);
     if (!(graph_obj->state & (STARTED))) {
        AGM_LOGV("graph object is not in correct state, current state %d\n",
@@ -1917,6 +2355,7 @@ int graph_get_session_time(struct graph_obj *graph_obj, uint64_t *tstamp)
     header->param_size = (uint32_t)sizeof(struct param_id_spr_session_time_t);
 
     ret = gsl_get_custom_config(graph_obj->graph_handle, payload, payload_size);
+    sample_time = graph_get_monotonic_us();
     if (ret != 0) {
         ret = ar_err_get_lnx_err_code(ret);
         AGM_LOGE("gsl_get_custom_config command failed with error %d\n", ret);
@@ -1935,6 +2374,11 @@ int graph_get_session_time(struct graph_obj *graph_obj, uint64_t *tstamp)
     timestamp = timestamp  << 32 | sess_time->session_time.value_lsw;
     *tstamp = timestamp;
 
+    absolute_time = (uint64_t)sess_time->absolute_time.value_msw;
+    absolute_time = absolute_time << 32 | sess_time->absolute_time.value_lsw;
+    graph_time_cache_update(graph_obj, generation, timestamp, absolute_time,
+                            sample_time);
+
 get_fail:
     free(payload);
 done:
@@ -2099,6 +2099,11 @@ module_info_t stream_module_list[] = {
         .tag = RD_SHMEM_ENDPOINT,
         .configure = configure_rd_shared_mem_ep,
     },
+    {
+        .module = MODULE_STREAM_VOLUME,
+        .tag = TAG_STREAM_VOLUME,
+        .configure = NULL,
+    },
 };
 
 module_info_t hw_ep_module[] = {
@@ -397,6 +397,49 @@ done:
 
 }
 
+/* deep copy of already parsed metadata, dest is overwritten */
+int metadata_dup(struct agm_meta_data_gsl *dest,
+                 const struct agm_meta_data_gsl *src)
+{
+    memset(dest, 0, sizeof(struct agm_meta_data_gsl));
+
+    if (src->gkv.num_kvs) {
+        dest->gkv.kv = calloc(src->gkv.num_kvs, sizeof(struct agm_key_value));
+        if (!dest->gkv.kv)
+            goto nomem;
+        memcpy(dest->gkv.kv, src->gkv.kv,
+               src->gkv.num_kvs * sizeof(struct agm_key_value));
+        dest->gkv.num_kvs = src->gkv.num_kvs;
+    }
+
+    if (src->ckv.num_kvs) {
+        dest->ckv.kv = calloc(src->ckv.num_kvs, sizeof(struct agm_key_value));
+        if (!dest->ckv.kv)
+            goto nomem;
+        memcpy(dest->ckv.kv, src->ckv.kv,
+               src->ckv.num_kvs * sizeof(struct agm_key_value));
+        dest->ckv.num_kvs = src->ckv.num_kvs;
+    }
+
+    dest->sg_props.prop_id = src->sg_props.prop_id;
+    if (src->sg_props.num_values) {
+        dest->sg_props.values = calloc(src->sg_props.num_values,
+                                       sizeof(uint32_t));
+        if (!dest->sg_props.values)
+            goto nomem;
+        memcpy(dest->sg_props.values, src->sg_props.values,
+               src->sg_props.num_values * sizeof(uint32_t));
+        dest->sg_props.num_values = src->sg_props.num_values;
+    }
+
+    return 0;
+
+nomem:
+    AGM_LOGE("Memory allocation failed to duplicate metadata\n");
+    metadata_free(dest);
+    return -ENOMEM;
+}
+
 void metadata_free(struct agm_meta_data_gsl *metadata)
 {
     if (metadata) {
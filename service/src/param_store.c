@@ -0,0 +1,438 @@
+/*
+* Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+* SPDX-License-Identifier: BSD-3-Clause-Clear
+*/
+#define LOG_TAG "AGM: param_store"
+
+#include <errno.h>
+#include <malloc.h>
+#include <string.h>
+#include "apm_api.h"
+#include <agm/param_store.h>
+#include <agm/utils.h>
+
+#ifdef DYNAMIC_LOG_ENABLED
+#include <log_xml_parser.h>
+#define LOG_MASK AGM_MOD_FILE_SESSION_OBJ
+#include <log_utils.h>
+#endif
+
+#define PARAM_STORE_ALIGN(x)   (((x) + (size_t)7) & ~(size_t)7)
+
+/* adopted payload, shared by the entries of its records */
+struct param_store_chunk {
+    uint32_t refs;
+    uint8_t *data;
+};
+
+struct param_store_entry {
+    struct listnode node;
+    uint32_t miid;
+    uint32_t param_id;
+    /* opaque payload, never matched against other entries */
+    bool raw;
+    /* record (header + param data) padded to 8 bytes */
+    size_t size;
+    /* bytes present at data, the padding of an adopted record may be absent */
+    size_t len;
+    uint8_t *data;
+    /* owner of data if adopted, data is owned by the entry otherwise */
+    struct param_store_chunk *chunk;
+};
+
+void param_store_init(struct param_store *store)
+{
+    list_init(&store->entries);
+    store->num_entries = 0;
+    store->num_raw = 0;
+    store->size = 0;
+}
+
+static void param_store_chunk_put(struct param_store_chunk *chunk)
+{
+    if (--chunk->refs)
+        return;
+
+    free(chunk->data);
+    free(chunk);
+}
+
+static void param_store_entry_release_data(struct param_store_entry *entry)
+{
+    if (entry->chunk)
+        param_store_chunk_put(entry->chunk);
+    else
+        free(entry->data);
+}
+
+static void param_store_entry_free(struct param_store_entry *entry)
+{
+    param_store_entry_release_data(entry);
+    free(entry);
+}
+
+void param_store_clear(struct param_store *store)
+{
+    struct param_store_entry *entry;
+    struct listnode *node, *next;
+
+    list_for_each_safe(node, next, &store->entries) {
+        entry = node_to_item(node, struct param_store_entry, node);
+        list_remove(&entry->node);
+        param_store_entry_free(entry);
+    }
+    store->num_entries = 0;
+    store->num_raw = 0;
+    store->size = 0;
+}
+
+bool param_store_is_empty(struct param_store *store)
+{
+    return store->num_entries == 0;
+}
+
+static struct param_store_entry *param_store_find(struct param_store *store,
+                                                  uint32_t miid, uint32_t param_id)
+{
+    struct param_store_entry *entry;
+    struct listnode *node;
+
+    list_for_each(node, &store->entries) {
+        entry = node_to_item(node, struct param_store_entry, node);
+        if (!entry->raw && entry->miid == miid && entry->param_id == param_id)
+            return entry;
+    }
+
+    return NULL;
+}
+
+/* returns the raw entry with the same payload, else the oldest if full */
+static struct param_store_entry *param_store_find_raw(struct param_store *store,
+                                          struct param_store_entry *entry,
+                                          bool *same)
+{
+    struct param_store_entry *raw, *oldest = NULL;
+    struct listnode *node;
+
+    list_for_each(node, &store->entries) {
+        raw = node_to_item(node, struct param_store_entry, node);
+        if (!raw->raw)
+            continue;
+        if (raw->len == entry->len && !memcmp(raw->data, entry->data, raw->len)) {
+            *same = true;
+            return raw;
+        }
+        if (!oldest)
+            oldest = raw;
+    }
+
+    *same = false;
+    return store->num_raw >= PARAM_STORE_MAX_RAW ? oldest : NULL;
+}
+
+/*
+ *Takes ownership of entry, replacing an entry with the same key in place.
+ *A raw entry is dropped if the same payload is kept already and evicts the
+ *oldest raw entry once PARAM_STORE_MAX_RAW are kept.
+ */
+static void param_store_insert(struct param_store *store,
+                               struct param_store_entry *entry)
+{
+    struct param_store_entry *old = NULL;
+    bool same;
+
+    if (entry->raw) {
+        old = param_store_find_raw(store, entry, &same);
+        if (old && same) {
+            param_store_entry_free(entry);
+            return;
+        }
+        if (old) {
+            AGM_LOGD("dropping oldest unparsed payload of size %zu\n",
+                     old->size);
+            list_remove(&old->node);
+            store->num_entries--;
+            store->num_raw--;
+            param_store_entry_free(old);
+            old = NULL;
+        }
+    } else {
+        old = param_store_find(store, entry->miid, entry->param_id);
+    }
+
+    if (old) {
+        store->size -= old->size;
+        param_store_entry_release_data(old);
+        old->data = entry->data;
+        old->size = entry->size;
+        old->len = entry->len;
+        old->chunk = entry->chunk;
+        store->size += old->size;
+        free(entry);
+        return;
+    }
+
+    list_add_tail(&store->entries, &entry->node);
+    store->num_entries++;
+    if (entry->raw)
+        store->num_raw++;
+    else
+        store->size += entry->size;
+}
+
+static struct param_store_entry *param_store_entry_create(uint8_t *record,
+                                                          size_t size, bool raw)
+{
+    struct param_store_entry *entry;
+    struct apm_module_param_data_t *header;
+
+    entry = calloc(1, sizeof(struct param_store_entry));
+    if (!entry)
+        return NULL;
+
+    entry->size = PARAM_STORE_ALIGN(size);
+    entry->len = entry->size;
+    entry->data = calloc(1, entry->size);
+    if (!entry->data) {
+        free(entry);
+        return NULL;
+    }
+    memcpy(entry->data, record, size);
+    entry->raw = raw;
+    if (!raw) {
+        header = (struct apm_module_param_data_t *)entry->data;
+        entry->miid = header->module_instance_id;
+        entry->param_id = header->param_id;
+    }
+
+    return entry;
+}
+
+/*
+ *A payload is a list of apm_module_param_data_t headers each followed by
+ *param_size bytes of data padded to 8 bytes, padding of the last record
+ *may be omitted.
+ */
+static bool param_store_payload_is_valid(uint8_t *payload, size_t size)
+{
+    struct apm_module_param_data_t *header;
+    size_t offset = 0, record_size;
+
+    while (offset < size) {
+        if (size - offset < sizeof(struct apm_module_param_data_t))
+            return false;
+
+        header = (struct apm_module_param_data_t *)(payload + offset);
+        record_size = sizeof(struct apm_module_param_data_t) + header->param_size;
+        if (record_size > size - offset)
+            return false;
+
+        offset += PARAM_STORE_ALIGN(record_size);
+    }
+
+    return true;
+}
+
+int param_store_merge(struct param_store *store, void *payload, size_t size)
+{
+    struct apm_module_param_data_t *header;
+    struct param_store_entry *entry;
+    uint8_t *record = (uint8_t *)payload;
+    size_t offset = 0, record_size;
+
+    if (!payload || size == 0)
+        return -EINVAL;
+
+    if (!param_store_payload_is_valid(record, size)) {
+        AGM_LOGD("payload of size %zu kept as is, not a param list\n", size);
+        entry = param_store_entry_create(record, size, true);
+        if (!entry)
+            return -ENOMEM;
+        param_store_insert(store, entry);
+        return 0;
+    }
+
+    while (offset < size) {
+        header = (struct apm_module_param_data_t *)(record + offset);
+        record_size = sizeof(struct apm_module_param_data_t) + header->param_size;
+
+        entry = param_store_entry_create(record + offset, record_size, false);
+        if (!entry) {
+            AGM_LOGE("No memory for param 0x%x of miid 0x%x\n",
+                     header->param_id, header->module_instance_id);
+            return -ENOMEM;
+        }
+        param_store_insert(store, entry);
+        offset += PARAM_STORE_ALIGN(record_size);
+    }
+
+    return 0;
+}
+
+/* entry for a record of an adopted payload, takes a reference on chunk */
+static struct param_store_entry *param_store_entry_wrap(
+                                    struct param_store_chunk *chunk,
+                                    size_t offset, size_t len, bool raw)
+{
+    struct param_store_entry *entry;
+    struct apm_module_param_data_t *header;
+
+    entry = calloc(1, sizeof(struct param_store_entry));
+    if (!entry)
+        return NULL;
+
+    entry->data = chunk->data + offset;
+    entry->len = len;
+    entry->size = PARAM_STORE_ALIGN(len);
+    entry->raw = raw;
+    entry->chunk = chunk;
+    chunk->refs++;
+    if (!raw) {
+        header = (struct apm_module_param_data_t *)entry->data;
+        entry->miid = header->module_instance_id;
+        entry->param_id = header->param_id;
+    }
+
+    return entry;
+}
+
+int param_store_adopt(struct param_store *store, void *payload, size_t size)
+{
+    struct apm_module_param_data_t *header;
+    struct param_store_entry *entry;
+    struct param_store_chunk *chunk;
+    size_t offset = 0, record_size;
+    int ret = 0;
+
+    if (!payload || size == 0) {
+        free(payload);
+        return -EINVAL;
+    }
+
+    chunk = calloc(1, sizeof(struct param_store_chunk));
+    if (!chunk) {
+        free(payload);
+        return -ENOMEM;
+    }
+    chunk->data = payload;
+    /* held until every record is in, entries take their own references */
+    chunk->refs = 1;
+
+    if (!param_store_payload_is_valid(chunk->data, size)) {
+        AGM_LOGD("payload of size %zu kept as is, not a param list\n", size);
+        entry = param_store_entry_wrap(chunk, 0, size, true);
+        if (!entry)
+            ret = -ENOMEM;
+        else
+            param_store_insert(store, entry);
+        goto done;
+    }
+
+    while (offset < size) {
+        header = (struct apm_module_param_data_t *)(chunk->data + offset);
+        record_size = sizeof(struct apm_module_param_data_t) + header->param_size;
+
+        /* padding of the last record may be omitted */
+        entry = param_store_entry_wrap(chunk, offset,
+                   size - offset < PARAM_STORE_ALIGN(record_size) ?
+                   size - offset : PARAM_STORE_ALIGN(record_size), false);
+        if (!entry) {
+            AGM_LOGE("No memory for param 0x%x of miid 0x%x\n",
+                     header->param_id, header->module_instance_id);
+            ret = -ENOMEM;
+            goto done;
+        }
+        param_store_insert(store, entry);
+        offset += PARAM_STORE_ALIGN(record_size);
+    }
+
+done:
+    param_store_chunk_put(chunk);
+    return ret;
+}
+
+void param_store_move(struct param_store *dst, struct param_store *src)
+{
+    struct param_store_entry *entry;
+    struct listnode *node, *next;
+
+    list_for_each_safe(node, next, &src->entries) {
+        entry = node_to_item(node, struct param_store_entry, node);
+        list_remove(&entry->node);
+        param_store_insert(dst, entry);
+    }
+    src->num_entries = 0;
+    src->num_raw = 0;
+    src->size = 0;
+}
+
+int param_store_copy(struct param_store *dst, struct param_store *src)
+{
+    struct param_store_entry *entry, *copy;
+    struct listnode *node;
+
+    list_for_each(node, &src->entries) {
+        entry = node_to_item(node, struct param_store_entry, node);
+        if (entry->chunk)
+            copy = param_store_entry_wrap(entry->chunk,
+                                          entry->data - entry->chunk->data,
+                                          entry->len, entry->raw);
+        else
+            copy = param_store_entry_create(entry->data, entry->len,
+                                            entry->raw);
+        if (!copy) {
+            param_store_clear(dst);
+            return -ENOMEM;
+        }
+        param_store_insert(dst, copy);
+    }
+
+    return 0;
+}
+
+int param_store_flatten(struct param_store *store, void **payload, size_t *size)
+{
+    struct param_store_entry *entry;
+    struct listnode *node;
+    uint8_t *buf;
+    size_t offset = 0;
+
+    if (store->num_entries == store->num_raw)
+        return -ENODATA;
+
+    buf = calloc(1, store->size);
+    if (!buf)
+        return -ENOMEM;
+
+    list_for_each(node, &store->entries) {
+        entry = node_to_item(node, struct param_store_entry, node);
+        if (entry->raw)
+            continue;
+        memcpy(buf + offset, entry->data, entry->len);
+        offset += entry->size;
+    }
+
+    *payload = buf;
+    *size = store->size;
+    return 0;
+}
+
+int param_store_for_each_raw(struct param_store *store,
+                             int (*fn)(void *priv, void *payload, size_t size),
+                             void *priv)
+{
+    struct param_store_entry *entry;
+    struct listnode *node;
+    int ret = 0;
+
+    list_for_each(node, &store->entries) {
+        entry = node_to_item(node, struct param_store_entry, node);
+        if (!entry->raw)
+            continue;
+        ret = fn(priv, entry->data, entry->len);
+        if (ret)
+            break;
+    }
+
+    return ret;
+}
@@ -0,0 +1,210 @@
+/*
+* Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+* SPDX-License-Identifier: BSD-3-Clause-Clear
+*/
+#define LOG_TAG "AGM: session_async"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <agm/agm_sched.h>
+#include <agm/session_async.h>
+#include <agm/utils.h>
+
+#ifdef DYNAMIC_LOG_ENABLED
+#include <log_xml_parser.h>
+#define LOG_MASK AGM_MOD_FILE_SESSION_OBJ
+#include <log_utils.h>
+#endif
+
+#define SESSION_ASYNC_MAX_WORKERS 4
+
+struct session_async_cmd {
+    struct listnode node;
+    enum agm_session_cmd cmd;
+    uint32_t token;
+};
+
+struct session_async {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    /* sessions with queued requests which no worker has picked yet */
+    struct listnode ready_list;
+    pthread_t workers[SESSION_ASYNC_MAX_WORKERS];
+    uint32_t num_workers;
+    uint32_t idle_workers;
+    bool initialized;
+    bool exit;
+};
+
+static struct session_async async;
+
+static int session_async_run(struct session_obj *sess_obj,
+                             enum agm_session_cmd cmd)
+{
+    switch (cmd) {
+    case AGM_SESSION_CMD_PREPARE:
+        return session_obj_prepare(sess_obj);
+    case AGM_SESSION_CMD_START:
+        return session_obj_start(sess_obj);
+    case AGM_SESSION_CMD_STOP:
+        return session_obj_stop(sess_obj);
+    case AGM_SESSION_CMD_CLOSE:
+        return session_obj_close(sess_obj);
+    case AGM_SESSION_CMD_PAUSE:
+        return session_obj_pause(sess_obj);
+    case AGM_SESSION_CMD_RESUME:
+        return session_obj_resume(sess_obj);
+    case AGM_SESSION_CMD_FLUSH:
+        return session_obj_flush(sess_obj);
+    default:
+        return -EINVAL;
+    }
+}
+
+static void *session_async_worker(void *arg __unused)
+{
+    struct session_obj *sess_obj;
+    struct session_async_cmd *cmd;
+    int ret;
+
+    agm_thread_sched_apply(AGM_THREAD_ASYNC);
+    pthread_mutex_lock(&async.lock);
+    while (!async.exit) {
+        if (list_empty(&async.ready_list)) {
+            async.idle_workers++;
+            pthread_cond_wait(&async.cond, &async.lock);
+            async.idle_workers--;
+            continue;
+        }
+
+        sess_obj = node_to_item(list_head(&async.ready_list),
+                                struct session_obj, async_node);
+        list_remove(&sess_obj->async_node);
+        cmd = node_to_item(list_head(&sess_obj->async_cmd_list),
+                           struct session_async_cmd, node);
+        list_remove(&cmd->node);
+        pthread_mutex_unlock(&async.lock);
+
+        AGM_LOGD("sess_id:%d cmd:%d token:%u\n", sess_obj->sess_id,
+                 cmd->cmd, cmd->token);
+        ret = session_async_run(sess_obj, cmd->cmd);
+        if (ret)
+            AGM_LOGE("Error:%d executing cmd:%d on sess_id:%d\n", ret,
+                     cmd->cmd, sess_obj->sess_id);
+        session_obj_notify_cmd_done(sess_obj, cmd->cmd, cmd->token, ret);
+        free(cmd);
+
+        pthread_mutex_lock(&async.lock);
+        /* one request at a time keeps busy sessions from starving others */
+        if (!list_empty(&sess_obj->async_cmd_list))
+            list_add_tail(&async.ready_list, &sess_obj->async_node);
+        else
+            sess_obj->async_queued = false;
+    }
+    pthread_mutex_unlock(&async.lock);
+
+    agm_thread_sched_release();
+    return NULL;
+}
+
+int session_async_queue_cmd(struct session_obj *sess_obj,
+                            enum agm_session_cmd cmd, uint32_t token)
+{
+    struct session_async_cmd *async_cmd;
+    int ret = 0;
+
+    if (cmd >= AGM_SESSION_CMD_MAX) {
+        AGM_LOGE("Invalid cmd:%d\n", cmd);
+        return -EINVAL;
+    }
+
+    async_cmd = calloc(1, sizeof(struct session_async_cmd));
+    if (!async_cmd)
+        return -ENOMEM;
+    async_cmd->cmd = cmd;
+    async_cmd->token = token;
+
+    pthread_mutex_lock(&async.lock);
+    if (!async.initialized || async.exit) {
+        ret = -ENODEV;
+        goto free_cmd;
+    }
+
+    /* workers are spawned on demand, up to SESSION_ASYNC_MAX_WORKERS */
+    if (!sess_obj->async_queued && async.idle_workers == 0 &&
+        async.num_workers < SESSION_ASYNC_MAX_WORKERS) {
+        ret = pthread_create(&async.workers[async.num_workers], NULL,
+                             session_async_worker, NULL);
+        if (ret == 0) {
+            async.num_workers++;
+        } else if (async.num_workers == 0) {
+            AGM_LOGE("Error:%d creating session async worker\n", ret);
+            ret = -ret;
+            goto free_cmd;
+        }
+        ret = 0;
+    }
+
+    list_add_tail(&sess_obj->async_cmd_list, &async_cmd->node);
+    if (!sess_obj->async_queued) {
+        sess_obj->async_queued = true;
+        list_add_tail(&async.ready_list, &sess_obj->async_node);
+        pthread_cond_signal(&async.cond);
+    }
+    pthread_mutex_unlock(&async.lock);
+    return 0;
+
+free_cmd:
+    pthread_mutex_unlock(&async.lock);
+    free(async_cmd);
+    return ret;
+}
+
+int session_async_init(void)
+{
+    list_init(&async.ready_list);
+    pthread_mutex_init(&async.lock, (const pthread_mutexattr_t *) NULL);
+    pthread_cond_init(&async.cond, (const pthread_condattr_t *) NULL);
+    async.num_workers = 0;
+    async.idle_workers = 0;
+    async.exit = false;
+    async.initialized = true;
+
+    return 0;
+}
+
+/* requests still queued are dropped without a completion event */
+void session_async_deinit(void)
+{
+    struct session_obj *sess_obj;
+    struct session_async_cmd *cmd;
+    struct listnode *node, *next, *cmd_node, *cmd_next;
+    uint32_t i;
+
+    if (!async.initialized)
+        return;
+
+    pthread_mutex_lock(&async.lock);
+    async.exit = true;
+    pthread_cond_broadcast(&async.cond);
+    pthread_mutex_unlock(&async.lock);
+
+    for (i = 0; i < async.num_workers; i++)
+        pthread_join(async.workers[i], NULL);
+
+    list_for_each_safe(node, next, &async.ready_list) {
+        sess_obj = node_to_item(node, struct session_obj, async_node);
+        list_for_each_safe(cmd_node, cmd_next, &sess_obj->async_cmd_list) {
+            cmd = node_to_item(cmd_node, struct session_async_cmd, node);
+            list_remove(&cmd->node);
+            free(cmd);
+        }
+        list_remove(&sess_obj->async_node);
+        sess_obj->async_queued = false;
+    }
+
+    async.initialized = false;
+    pthread_cond_destroy(&async.cond);
+    pthread_mutex_destroy(&async.lock);
+}
@@ -0,0 +1,373 @@
+/*
+* Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+* SPDX-License-Identifier: BSD-3-Clause-Clear
+*/
+#define LOG_TAG "AGM: session_fanout"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <agm/session_fanout.h>
+#include <agm/utils.h>
+
+#ifdef DYNAMIC_LOG_ENABLED
+#include <log_xml_parser.h>
+#define LOG_MASK AGM_MOD_FILE_SESSION_OBJ
+#include <log_utils.h>
+#endif
+
+#define SESSION_FANOUT_NUM_PERIODS 16
+#define SESSION_FANOUT_MIN_PERIODS 2
+#define SESSION_FANOUT_MAX_BYTES   (2 * 1024 * 1024)
+#define SESSION_FANOUT_MAX_READERS 8
+
+struct session_fanout_period {
+    /* stream offset of the first byte of the period */
+    uint64_t pos;
+    size_t len;
+};
+
+struct session_fanout {
+    struct session_obj *sess_obj;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint8_t *ring;
+    size_t period_size;
+    uint32_t num_periods;
+    struct session_fanout_period *periods;
+    /* sequence number of the next period to capture */
+    uint64_t head;
+    /* stream offset of the next captured byte */
+    uint64_t pos;
+    /* a reader is capturing period head, its slot can not be read */
+    bool filling;
+    uint32_t num_readers;
+};
+
+struct session_fanout_reader {
+    struct listnode node;
+    struct session_fanout *fanout;
+    /* period and offset in it of the next byte to read */
+    uint64_t seq;
+    size_t offset;
+    uint64_t pos;
+    /* bytes lost to overruns since the reader was opened */
+    uint64_t dropped;
+    /* reads in flight, protected by fanout_lock */
+    uint32_t refs;
+    /* set under fanout_lock and the fanout lock once close started */
+    bool closing;
+};
+
+static pthread_mutex_t fanout_lock = PTHREAD_MUTEX_INITIALIZER;
+/* signalled when the last read of a closing reader returns */
+static pthread_cond_t fanout_cond = PTHREAD_COND_INITIALIZER;
+static list_declare(reader_list);
+
+/* called with fanout_lock held */
+static struct session_fanout_reader *session_fanout_reader_find_l(uint64_t hndl)
+{
+    struct session_fanout_reader *reader;
+    struct listnode *node;
+
+    list_for_each(node, &reader_list) {
+        reader = node_to_item(node, struct session_fanout_reader, node);
+        if ((uint64_t)reader == hndl)
+            return reader;
+    }
+    return NULL;
+}
+
+/* take a reference on a reader which is not being closed */
+static struct session_fanout_reader *session_fanout_reader_get(uint64_t hndl)
+{
+    struct session_fanout_reader *reader;
+
+    pthread_mutex_lock(&fanout_lock);
+    reader = session_fanout_reader_find_l(hndl);
+    if (reader && reader->closing)
+        reader = NULL;
+    if (reader)
+        reader->refs++;
+    pthread_mutex_unlock(&fanout_lock);
+
+    return reader;
+}
+
+static void session_fanout_reader_put(struct session_fanout_reader *reader)
+{
+    pthread_mutex_lock(&fanout_lock);
+    if (--reader->refs == 0 && reader->closing)
+        pthread_cond_broadcast(&fanout_cond);
+    pthread_mutex_unlock(&fanout_lock);
+}
+
+static void session_fanout_free(struct session_fanout *fanout)
+{
+    pthread_cond_destroy(&fanout->cond);
+    pthread_mutex_destroy(&fanout->lock);
+    free(fanout->periods);
+    free(fanout->ring);
+    free(fanout);
+}
+
+static int session_fanout_create(struct session_obj *sess_obj,
+                                 struct session_fanout **fanout_out)
+{
+    struct session_fanout *fanout;
+    size_t period_size;
+    uint32_t num_periods = SESSION_FANOUT_NUM_PERIODS;
+
+    pthread_mutex_lock(&sess_obj->lock);
+    if (sess_obj->state == SESSION_CLOSED ||
+        sess_obj->stream_config.dir != TX) {
+        pthread_mutex_unlock(&sess_obj->lock);
+        AGM_LOGE("session %d is not an open capture session\n",
+                 sess_obj->sess_id);
+        return -EINVAL;
+    }
+    period_size = sess_obj->in_buffer_config.size;
+    pthread_mutex_unlock(&sess_obj->lock);
+
+    if (period_size == 0) {
+        AGM_LOGE("session %d has no buffer config\n", sess_obj->sess_id);
+        return -EINVAL;
+    }
+
+    while (num_periods > SESSION_FANOUT_MIN_PERIODS &&
+           num_periods * period_size > SESSION_FANOUT_MAX_BYTES)
+        num_periods--;
+    if (num_periods * period_size > SESSION_FANOUT_MAX_BYTES) {
+        AGM_LOGE("period size %zu too large for a fan-out ring\n",
+                 period_size);
+        return -EINVAL;
+    }
+
+    fanout = calloc(1, sizeof(struct session_fanout));
+    if (!fanout)
+        return -ENOMEM;
+
+    fanout->ring = calloc(num_periods, period_size);
+    fanout->periods = calloc(num_periods,
+                             sizeof(struct session_fanout_period));
+    if (!fanout->ring || !fanout->periods) {
+        free(fanout->periods);
+        free(fanout->ring);
+        free(fanout);
+        return -ENOMEM;
+    }
+
+    pthread_mutex_init(&fanout->lock, (const pthread_mutexattr_t *)NULL);
+    pthread_cond_init(&fanout->cond, (const pthread_condattr_t *)NULL);
+    fanout->sess_obj = sess_obj;
+    fanout->period_size = period_size;
+    fanout->num_periods = num_periods;
+
+    AGM_LOGD("session %d fan-out ring of %u periods of %zu bytes\n",
+             sess_obj->sess_id, num_periods, period_size);
+    *fanout_out = fanout;
+    return 0;
+}
+
+int session_fanout_reader_open(struct session_obj *sess_obj, uint64_t *hndl)
+{
+    struct session_fanout_reader *reader;
+    struct session_fanout *fanout;
+    int ret = 0;
+
+    reader = calloc(1, sizeof(struct session_fanout_reader));
+    if (!reader)
+        return -ENOMEM;
+
+    pthread_mutex_lock(&fanout_lock);
+    fanout = sess_obj->fanout;
+    if (!fanout) {
+        ret = session_fanout_create(sess_obj, &fanout);
+        if (ret)
+            goto err;
+        sess_obj->fanout = fanout;
+    } else if (fanout->num_readers >= SESSION_FANOUT_MAX_READERS) {
+        AGM_LOGE("session %d has %u readers already\n",
+                 sess_obj->sess_id, fanout->num_readers);
+        ret = -EBUSY;
+        goto err;
+    }
+
+    /* new readers join at the live position */
+    pthread_mutex_lock(&fanout->lock);
+    reader->fanout = fanout;
+    reader->seq = fanout->head;
+    reader->pos = fanout->pos;
+    fanout->num_readers++;
+    pthread_mutex_unlock(&fanout->lock);
+
+    list_add_tail(&reader_list, &reader->node);
+    pthread_mutex_unlock(&fanout_lock);
+
+    *hndl = (uint64_t)reader;
+    return 0;
+
+err:
+    pthread_mutex_unlock(&fanout_lock);
+    free(reader);
+    return ret;
+}
+
+bool session_fanout_active(struct session_obj *sess_obj)
+{
+    bool active;
+
+    pthread_mutex_lock(&fanout_lock);
+    active = sess_obj->fanout != NULL;
+    pthread_mutex_unlock(&fanout_lock);
+
+    return active;
+}
+
+int session_fanout_reader_close(uint64_t hndl)
+{
+    struct session_fanout_reader *reader;
+    struct session_fanout *fanout;
+    bool last;
+
+    pthread_mutex_lock(&fanout_lock);
+    reader = session_fanout_reader_find_l(hndl);
+    if (!reader || reader->closing) {
+        pthread_mutex_unlock(&fanout_lock);
+        AGM_LOGE("Invalid reader handle\n");
+        return -EINVAL;
+    }
+
+    /* wake reads of this reader waiting for a capture, then let them return */
+    fanout = reader->fanout;
+    pthread_mutex_lock(&fanout->lock);
+    reader->closing = true;
+    pthread_cond_broadcast(&fanout->cond);
+    pthread_mutex_unlock(&fanout->lock);
+    while (reader->refs)
+        pthread_cond_wait(&fanout_cond, &fanout_lock);
+
+    list_remove(&reader->node);
+    pthread_mutex_lock(&fanout->lock);
+    last = --fanout->num_readers == 0;
+    pthread_mutex_unlock(&fanout->lock);
+    if (last)
+        fanout->sess_obj->fanout = NULL;
+    pthread_mutex_unlock(&fanout_lock);
+
+    if (reader->dropped)
+        AGM_LOGD("reader of session %d lost %llu bytes to overruns\n",
+                 fanout->sess_obj->sess_id,
+                 (unsigned long long)reader->dropped);
+    if (last)
+        session_fanout_free(fanout);
+    free(reader);
+    return 0;
+}
+
+/* called with fanout lock held, returns the oldest period which can be read */
+static uint64_t session_fanout_oldest(struct session_fanout *fanout)
+{
+    uint64_t end = fanout->head + (fanout->filling ? 1 : 0);
+
+    return end > fanout->num_periods ? end - fanout->num_periods : 0;
+}
+
+int session_fanout_reader_read(uint64_t hndl, void *buff, size_t *count,
+                               uint64_t *dropped)
+{
+    struct session_fanout_reader *reader;
+    struct session_fanout_period *period;
+    struct session_fanout *fanout;
+    uint8_t *dst = (uint8_t *)buff;
+    uint64_t oldest;
+    size_t done = 0, len;
+    uint32_t slot;
+    int ret = 0;
+
+    reader = session_fanout_reader_get(hndl);
+    if (!reader) {
+        AGM_LOGE("Invalid reader handle\n");
+        return -EINVAL;
+    }
+    fanout = reader->fanout;
+    *dropped = 0;
+
+    pthread_mutex_lock(&fanout->lock);
+    while (done < *count) {
+        if (reader->closing) {
+            if (!done)
+                ret = -EINVAL;
+            break;
+        }
+
+        oldest = session_fanout_oldest(fanout);
+        if (reader->seq < oldest) {
+            period = &fanout->periods[oldest % fanout->num_periods];
+            AGM_LOGD("reader overrun, %llu bytes lost\n",
+                     (unsigned long long)(period->pos - reader->pos));
+            *dropped += period->pos - reader->pos;
+            reader->dropped += period->pos - reader->pos;
+            reader->seq = oldest;
+            reader->offset = 0;
+            reader->pos = period->pos;
+        }
+
+        if (reader->seq < fanout->head) {
+            slot = reader->seq % fanout->num_periods;
+            period = &fanout->periods[slot];
+            len = period->len - reader->offset;
+            if (len > *count - done)
+                len = *count - done;
+            memcpy(dst + done, fanout->ring + slot * fanout->period_size +
+                   reader->offset, len);
+            done += len;
+            reader->offset += len;
+            reader->pos += len;
+            if (reader->offset == period->len) {
+                reader->seq++;
+                reader->offset = 0;
+            }
+            continue;
+        }
+
+        /* caught up with the capture, hand back what was read so far */
+        if (done)
+            break;
+
+        if (fanout->filling) {
+            pthread_cond_wait(&fanout->cond, &fanout->lock);
+            continue;
+        }
+
+        /*
+         *Capture the next period for everyone. Its slot holds the oldest
+         *period, which readers see as gone as soon as filling is set.
+         */
+        fanout->filling = true;
+        slot = fanout->head % fanout->num_periods;
+        pthread_mutex_unlock(&fanout->lock);
+
+        len = fanout->period_size;
+        ret = session_obj_read(fanout->sess_obj,
+                               fanout->ring + slot * fanout->period_size, &len);
+
+        pthread_mutex_lock(&fanout->lock);
+        fanout->filling = false;
+        if (!ret) {
+            fanout->periods[slot].pos = fanout->pos;
+            fanout->periods[slot].len = len;
+            fanout->pos += len;
+            fanout->head++;
+        }
+        pthread_cond_broadcast(&fanout->cond);
+        if (ret || len == 0)
+            break;
+    }
+    pthread_mutex_unlock(&fanout->lock);
+    session_fanout_reader_put(reader);
+
+    *count = done;
+    return ret;
+}
@@ -34,8 +34,15 @@
 
 #include <malloc.h>
 #include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <agm/agm_sched.h>
 #include <agm/session_obj.h>
 #include <agm/utils.h>
+#include "kvh2xml.h"
 
 #ifdef DYNAMIC_LOG_ENABLED
 #include <log_xml_parser.h>
@@ -67,6 +74,10 @@ char tracestr[100] = "agm: ";
 #define check_and_enable_traces()
 #endif
 
+#ifdef _ANDROID_
+#include <cutils/ashmem.h>
+#endif
+
 #define GSL_EVENT_SRC_MODULE_ID_GSL 0x2001 // DO NOT CHANGE
 
 //forward declarations
@@ -74,6 +85,7 @@ static struct session_pool *sess_pool;
 static int session_close(struct session_obj *sess_obj);
 static int session_set_loopback(struct session_obj *sess_obj,
                            uint32_t session_id, bool enable);
+static int session_commit_params(struct session_obj *sess_obj);
 static pthread_mutex_t hwep_lock;
 static struct aif *aif_obj_get_from_pool(struct session_obj *sess_obj,
                                       uint32_t aif)
@@ -110,6 +122,7 @@ static struct aif* aif_obj_create(struct session_obj *sess_obj __unused, int aif
     }
     aif_obj->aif_id = aif_id;
     aif_obj->dev_obj = dev_obj;
+    param_store_init(&aif_obj->params);
 
 done:
     return aif_obj;
@@ -233,16 +246,173 @@ static int session_pool_init()
         goto done;
     }
     list_init(&sess_pool->session_list);
-    pthread_mutex_init(&sess_pool->lock, (const pthread_mutexattr_t *) NULL);
+    agm_sched_mutex_init(&sess_pool->lock);
+
+done:
+    return ret;
+}
+
+static uint64_t session_get_monotonic_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000) + ((uint64_t)ts.tv_nsec / 1000);
+}
+
+/* called with time_page_lock held */
+static int session_time_page_create(struct session_obj *sess_obj)
+{
+    size_t size = (size_t)sysconf(_SC_PAGESIZE);
+    void *addr = NULL;
+    int fd = -1;
+    int ret = 0;
+
+#ifdef _ANDROID_
+    fd = ashmem_create_region("agm_time_page", size);
+#else
+    fd = memfd_create("agm_time_page", MFD_CLOEXEC);
+    if (fd >= 0 && ftruncate(fd, size) < 0) {
+        close(fd);
+        fd = -1;
+    }
+#endif
+    if (fd < 0) {
+        ret = -errno;
+        AGM_LOGE("failed to create time page for session %d, err %d\n",
+                 sess_obj->sess_id, ret);
+        goto done;
+    }
+
+    addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+        ret = -errno;
+        AGM_LOGE("failed to map time page for session %d, err %d\n",
+                 sess_obj->sess_id, ret);
+        close(fd);
+        goto done;
+    }
+#ifdef _ANDROID_
+    /* mappings made by clients from here on are read only */
+    ashmem_set_prot_region(fd, PROT_READ);
+#endif
+
+    sess_obj->time_page = (struct agm_session_time_page *)addr;
+    sess_obj->time_page_fd = fd;
+    sess_obj->time_page->state = AGM_TIME_PAGE_CLOSED;
 
 done:
     return ret;
 }
 
+static void session_time_page_destroy(struct session_obj *sess_obj)
+{
+    if (!sess_obj->time_page)
+        return;
+
+    munmap(sess_obj->time_page, (size_t)sysconf(_SC_PAGESIZE));
+    close(sess_obj->time_page_fd);
+    sess_obj->time_page = NULL;
+    sess_obj->time_page_fd = -1;
+}
+
+/*
+ *Writer side of the time page seqlock, seq is odd between begin and end.
+ *Returns NULL if no client asked for the page, end must not be called then.
+ */
+static struct agm_session_time_page *session_time_page_begin(
+                                               struct session_obj *sess_obj)
+{
+    struct agm_session_time_page *page;
+
+    pthread_mutex_lock(&sess_obj->time_page_lock);
+    page = sess_obj->time_page;
+    if (!page) {
+        pthread_mutex_unlock(&sess_obj->time_page_lock);
+        return NULL;
+    }
+    __atomic_store_n(&page->seq, page->seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    return page;
+}
+
+static void session_time_page_end(struct session_obj *sess_obj,
+                                  struct agm_session_time_page *page)
+{
+    __atomic_store_n(&page->seq, page->seq + 1, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&sess_obj->time_page_lock);
+}
+
+static void session_time_page_set_state(struct session_obj *sess_obj,
+                                        enum agm_time_page_state state,
+                                        uint64_t session_time)
+{
+    struct agm_session_time_page *page = session_time_page_begin(sess_obj);
+
+    if (!page)
+        return;
+
+    /* a fresh start, not a resume, restarts the counters */
+    if (state == AGM_TIME_PAGE_STARTED && page->state != AGM_TIME_PAGE_PAUSED) {
+        page->buffer_timestamp = 0;
+        page->processed_buf_cnt = 0;
+    }
+    page->state = state;
+    page->session_time = session_time;
+    page->absolute_time = 0;
+    page->sample_time = session_get_monotonic_us();
+    session_time_page_end(sess_obj, page);
+}
+
+static void session_time_page_set_time(struct session_obj *sess_obj,
+                                       uint64_t session_time)
+{
+    struct agm_session_time_page *page = session_time_page_begin(sess_obj);
+
+    if (!page)
+        return;
+
+    page->session_time = session_time;
+    page->sample_time = session_get_monotonic_us();
+    session_time_page_end(sess_obj, page);
+}
+
+static void session_time_page_buf_done(struct session_obj *sess_obj,
+                                       uint64_t *buffer_timestamp)
+{
+    struct agm_session_time_page *page = session_time_page_begin(sess_obj);
+
+    if (!page)
+        return;
+
+    if (buffer_timestamp)
+        page->buffer_timestamp = *buffer_timestamp;
+    else
+        page->processed_buf_cnt++;
+    session_time_page_end(sess_obj, page);
+}
+
+/*
+ *Re-anchor the time page on a fresh SPR sample, sess_obj->lock held.
+ *Skips the query altogether when nobody maps the page.
+ */
+static void session_time_page_sync(struct session_obj *sess_obj,
+                                   enum agm_time_page_state state)
+{
+    uint64_t session_time = 0;
+
+    if (!sess_obj->time_page)
+        return;
+
+    if (graph_get_session_time(sess_obj->graph, &session_time))
+        AGM_LOGE("failed to sample session time for time page\n");
+    session_time_page_set_state(sess_obj, state, session_time);
+}
+
 static void aif_free(struct aif *aif_obj)
 {
     metadata_free(&aif_obj->sess_aif_meta);
-    free(aif_obj->params);
+    param_store_clear(&aif_obj->params);
     free(aif_obj);
 }
 
@@ -268,15 +438,35 @@ static void session_cb_pool_free(struct session_obj *sess_obj)
         list_remove(&sess_cb->node);
         free(sess_cb);
     }
+    free(sess_obj->cb_snapshot);
+    sess_obj->cb_snapshot = NULL;
+    pthread_cond_destroy(&sess_obj->cb_snapshot_cond);
+    pthread_mutex_destroy(&sess_obj->cb_snapshot_lock);
+}
 
+static void session_gain_mbox_free(struct session_obj *sess_obj)
+{
+    struct gain_mailbox *mbox;
+    struct listnode *node, *next;
+
+    list_for_each_safe(node, next, &sess_obj->gain_mbox_list) {
+        mbox = node_to_item(node, struct gain_mailbox, node);
+        list_remove(&mbox->node);
+        free(mbox);
+    }
+    pthread_mutex_destroy(&sess_obj->gain_mbox_lock);
 }
 
 static void sess_obj_free(struct session_obj *sess_obj)
 {
     aif_pool_free(sess_obj);
+    session_gain_mbox_free(sess_obj);
     session_cb_pool_free(sess_obj);
     metadata_free(&sess_obj->sess_meta);
-    free(sess_obj->params);
+    param_store_clear(&sess_obj->params);
+    param_store_clear(&sess_obj->replay_params);
+    session_time_page_destroy(sess_obj);
+    pthread_mutex_destroy(&sess_obj->time_page_lock);
     free(sess_obj);
 }
 
@@ -318,8 +508,17 @@ static struct session_obj* session_obj_create(int session_id)
     obj->sess_id = session_id;
     list_init(&obj->aif_pool);
     list_init(&obj->cb_pool);
-    pthread_mutex_init(&obj->lock, (const pthread_mutexattr_t *) NULL);
+    param_store_init(&obj->params);
+    param_store_init(&obj->replay_params);
+    agm_sched_mutex_init(&obj->lock);
     pthread_mutex_init(&obj->cb_pool_lock, (const pthread_mutexattr_t *) NULL);
+    pthread_mutex_init(&obj->cb_snapshot_lock, (const pthread_mutexattr_t *) NULL);
+    pthread_cond_init(&obj->cb_snapshot_cond, (const pthread_condattr_t *) NULL);
+    pthread_mutex_init(&obj->time_page_lock, (const pthread_mutexattr_t *) NULL);
+    obj->time_page_fd = -1;
+    list_init(&obj->gain_mbox_list);
+    pthread_mutex_init(&obj->gain_mbox_lock, (const pthread_mutexattr_t *) NULL);
+    list_init(&obj->async_cmd_list);
 
     return obj;
 }
@@ -626,12 +825,93 @@ done:
     return ret;
 }
 
+static struct session_cb_snapshot *session_cb_snapshot_get(
+                                        struct session_obj *sess_obj)
+{
+    struct session_cb_snapshot *snap;
+
+    pthread_mutex_lock(&sess_obj->cb_snapshot_lock);
+    snap = sess_obj->cb_snapshot;
+    if (snap) {
+        snap->refs++;
+        sess_obj->cb_dispatching++;
+    }
+    pthread_mutex_unlock(&sess_obj->cb_snapshot_lock);
+    return snap;
+}
+
+static void session_cb_snapshot_put(struct session_obj *sess_obj,
+                                    struct session_cb_snapshot *snap)
+{
+    bool last;
+
+    pthread_mutex_lock(&sess_obj->cb_snapshot_lock);
+    last = --snap->refs == 0;
+    sess_obj->cb_dispatching--;
+    pthread_cond_broadcast(&sess_obj->cb_snapshot_cond);
+    pthread_mutex_unlock(&sess_obj->cb_snapshot_lock);
+    if (last)
+        free(snap);
+}
+
+static bool session_cb_id_match(uint64_t mask, const uint32_t *ids,
+                                uint32_t num_ids, uint32_t id)
+{
+    uint32_t i;
+
+    if (num_ids == 0)
+        return true;
+    if (!(mask & (1ULL << (id % 64))))
+        return false;
+    for (i = 0; i < num_ids; i++) {
+        if (ids[i] == id)
+            return true;
+    }
+    return false;
+}
+
+static bool session_cb_filter_match(const struct session_cb *sess_cb,
+                                    const struct agm_event_cb_params *event_params)
+{
+    return session_cb_id_match(sess_cb->event_mask, sess_cb->filter.event_ids,
+                               sess_cb->filter.num_event_ids,
+                               event_params->event_id) &&
+           session_cb_id_match(sess_cb->module_mask, sess_cb->filter.module_ids,
+                               sess_cb->filter.num_module_ids,
+                               event_params->source_module_id);
+}
+
+/*
+ *Deliver an event to the callbacks registered for evt_type, or to all of
+ *them if evt_type is 0. Runs off a snapshot, never waits for registrations.
+ */
+static void session_cb_dispatch(struct session_obj *sess_obj,
+                                struct agm_event_cb_params *event_params,
+                                enum event_type evt_type)
+{
+    struct session_cb_snapshot *snap;
+    struct session_cb *sess_cb;
+    uint32_t i;
+
+    snap = session_cb_snapshot_get(sess_obj);
+    if (!snap)
+        return;
+
+    for (i = 0; i < snap->num_cbs; i++) {
+        sess_cb = &snap->cbs[i];
+        if (evt_type && sess_cb->evt_type != evt_type)
+            continue;
+        if (!session_cb_filter_match(sess_cb, event_params))
+            continue;
+        sess_cb->cb(sess_obj->sess_id, event_params, sess_cb->client_data);
+    }
+    session_cb_snapshot_put(sess_obj, snap);
+}
+
 static void graph_event_cb(struct agm_event_cb_params *event_params,
                          void *client_data)
 {
     struct session_obj *sess_obj = NULL;
-    struct session_cb *sess_cb;
-    struct listnode *node, *next;
     uint32_t session_id = (uint32_t)((uintptr_t)client_data);
 
     if (!event_params) {
@@ -646,28 +926,60 @@ static void graph_event_cb(struct agm_event_cb_params *event_params,
         return;
     }
 
-    pthread_mutex_lock(&sess_obj->cb_pool_lock);
-    list_for_each_safe(node, next, &sess_obj->cb_pool) {
-        sess_cb = node_to_item(node, struct session_cb, node);
-        if (sess_cb && sess_cb->cb) {
-            /* Filter callbacks based on event_id and event_type */
-            if (sess_cb->evt_type == AGM_EVENT_DATA_PATH &&
-                event_params->source_module_id == GSL_EVENT_SRC_MODULE_ID_GSL &&
-                (event_params->event_id == AGM_EVENT_EOS_RENDERED ||
-                event_params->event_id == AGM_EVENT_READ_DONE ||
-                event_params->event_id == AGM_EVENT_WRITE_DONE)) {
-                sess_cb->cb(sess_obj->sess_id,
-                                   (struct agm_event_cb_params *)event_params,
-                                    sess_cb->client_data);
-            } else if (sess_cb->evt_type == AGM_EVENT_MODULE &&
-                       event_params->source_module_id != GSL_EVENT_SRC_MODULE_ID_GSL) {
-                sess_cb->cb(sess_obj->sess_id,
-                                   (struct agm_event_cb_params *)event_params,
-                                    sess_cb->client_data);
-            }
-        }
+    if (event_params->source_module_id == GSL_EVENT_SRC_MODULE_ID_GSL &&
+        (event_params->event_id == AGM_EVENT_READ_DONE ||
+         event_params->event_id == AGM_EVENT_WRITE_DONE))
+        session_time_page_buf_done(sess_obj, NULL);
+
+    /* Filter callbacks based on event_id and event_type */
+    if (event_params->source_module_id == GSL_EVENT_SRC_MODULE_ID_GSL) {
+        if (event_params->event_id == AGM_EVENT_EOS_RENDERED ||
+            event_params->event_id == AGM_EVENT_READ_DONE ||
+            event_params->event_id == AGM_EVENT_WRITE_DONE)
+            session_cb_dispatch(sess_obj, event_params, AGM_EVENT_DATA_PATH);
+    } else {
+        session_cb_dispatch(sess_obj, event_params, AGM_EVENT_MODULE);
     }
-    pthread_mutex_unlock(&sess_obj->cb_pool_lock);
+}
+
+static int session_apply_raw_params(void *priv, void *payload, size_t size)
+{
+    return graph_set_config((struct graph_obj *)priv, payload, size);
+}
+
+/*
+ *Send every record staged in store with a single set config, followed by
+ *one set config per payload which is not a param list. Records which
+ *made it to the graph are kept in replay to be sent again if the graph has
+ *to be rebuilt after an SPF restart. The store is emptied irrespective of
+ *the result to avoid impact to next usecase.
+ */
+static int session_apply_params(struct graph_obj *graph,
+                                struct param_store *store,
+                                struct param_store *replay)
+{
+    void *payload = NULL;
+    size_t size = 0;
+    int ret = 0;
+
+    if (param_store_is_empty(store))
+        return 0;
+
+    ret = param_store_flatten(store, &payload, &size);
+    if (!ret) {
+        ret = graph_set_config(graph, payload, size);
+        free(payload);
+    } else if (ret == -ENODATA) {
+        ret = 0;
+    }
+
+    if (!ret)
+        ret = param_store_for_each_raw(store, session_apply_raw_params, graph);
+    if (ret)
+        param_store_clear(store);
+    else
+        param_store_move(replay, store);
+    return ret;
 }
 
 static int session_apply_aif_tag_params(struct session_obj *sess_obj,
@@ -735,6 +1047,9 @@ static int session_connect_aif(struct session_obj *sess_obj,
     int ret = 0;
     struct agm_meta_data_gsl *merged_metadata = NULL;
     struct graph_obj *graph = sess_obj->graph;
+    struct param_store staged;
+
+    param_store_init(&staged);
 
     //step 2.a  merge metadata
     pthread_mutex_lock(&aif_obj->dev_obj->lock);
@@ -804,32 +1119,19 @@ static int session_connect_aif(struct session_obj *sess_obj,
             }
     }
 
-    //step 2.c set cached params for stream only in closed
-    if (sess_obj->state == SESSION_CLOSED && sess_obj->params != NULL) {
-        ret = graph_set_config(graph, sess_obj->params, sess_obj->params_size);
-        /* clean up params irrespective of success or failure to avoid
-         * impact to next usecase */
-        free(sess_obj->params);
-        sess_obj->params = NULL;
-        sess_obj->params_size = 0;
-        if (ret) {
-            AGM_LOGE("Error:%d setting session cached params: %d\n",
-                ret, sess_obj->sess_id);
-            goto graph_cleanup;
-        }
-    }
-
-    //step 2.d set cached streamdevice params
-    if (aif_obj->params != NULL) {
-        ret = graph_set_config(graph, aif_obj->params, aif_obj->params_size);
-        if (ret) {
-            AGM_LOGE("Error:%d setting session cached params: %d\n",
-                ret, sess_obj->sess_id);
-            goto graph_cleanup;
-        }
-        free(aif_obj->params);
-        aif_obj->params = NULL;
-        aif_obj->params_size = 0;
+    /*
+     *step 2.c set cached params for stream only in closed
+     *step 2.d set cached streamdevice params
+     *both are sent together, streamdevice records win on a common key
+     */
+    if (sess_obj->state == SESSION_CLOSED)
+        param_store_move(&staged, &sess_obj->params);
+    param_store_move(&staged, &aif_obj->params);
+    ret = session_apply_params(graph, &staged, &sess_obj->replay_params);
+    if (ret) {
+        AGM_LOGE("Error:%d setting session cached params: %d\n",
+            ret, sess_obj->sess_id);
+        goto graph_cleanup;
     }
 
     //step 2.e set cached device params
@@ -853,11 +1155,7 @@ graph_cleanup:
     }
 
 close_device:
-    if (aif_obj->params) {
-        free(aif_obj->params);
-        aif_obj->params = NULL;
-        aif_obj->params_size = 0;
-    }
+    param_store_clear(&aif_obj->params);
     device_close(aif_obj->dev_obj);
 
 done:
@@ -978,16 +1276,14 @@ static int session_open_without_device(struct session_obj *sess_obj)
             }
     }
     //step 2.c set cached params for stream only in closed
-    if (sess_obj->state == SESSION_CLOSED && sess_obj->params != NULL) {
-        ret = graph_set_config(graph, sess_obj->params, sess_obj->params_size);
+    if (sess_obj->state == SESSION_CLOSED) {
+        ret = session_apply_params(graph, &sess_obj->params,
+                                   &sess_obj->replay_params);
         if (ret) {
             AGM_LOGE("Error:%d setting session cached params: %d\n",
                 ret, sess_obj->sess_id);
             goto graph_cleanup;
         }
-        free(sess_obj->params);
-        sess_obj->params = NULL;
-        sess_obj->params_size = 0;
     }
 
     goto done;
@@ -1007,6 +1303,11 @@ static int session_prepare(struct session_obj *sess_obj)
     struct listnode *node = NULL;
     uint32_t count = 0;
 
+    /* params staged since open go out before the graph is prepared */
+    ret = session_commit_params(sess_obj);
+    if (ret)
+        goto done;
+
     if (sess_mode != AGM_SESSION_NON_TUNNEL  && sess_mode != AGM_SESSION_NO_CONFIG) {
         count = aif_obj_get_count_with_state(sess_obj, AIF_OPENED, false);
         if (count == 0) {
@@ -1039,6 +1340,7 @@ static int session_prepare(struct session_obj *sess_obj)
                 goto done;
             } else {
                 sess_obj->state = SESSION_PREPARED;
+                session_time_page_set_state(sess_obj, AGM_TIME_PAGE_PREPARED, 0);
             }
         }
     } else if(sess_obj->state != SESSION_STARTED) {
@@ -1050,6 +1352,7 @@ static int session_prepare(struct session_obj *sess_obj)
              goto done;
         } else {
              sess_obj->state = SESSION_PREPARED;
+             session_time_page_set_state(sess_obj, AGM_TIME_PAGE_PREPARED, 0);
         }
     }
 
@@ -1222,6 +1525,8 @@ static int session_start(struct session_obj *sess_obj)
     }
 
     sess_obj->state = SESSION_STARTED;
+    sess_obj->paused = false;
+    session_time_page_set_state(sess_obj, AGM_TIME_PAGE_STARTED, 0);
     goto done;
 
 unwind:
@@ -1309,11 +1614,33 @@ static int session_stop(struct session_obj *sess_obj)
             }
     }
     sess_obj->state = SESSION_STOPPED;
+    sess_obj->paused = false;
+    session_time_page_set_state(sess_obj, AGM_TIME_PAGE_STOPPED, 0);
 
 done:
     return ret;
 }
 
+/* forget what the client did with the graph, done once the graph is gone */
+static void session_reset_graph_state(struct session_obj *sess_obj)
+{
+    struct listnode *node = NULL;
+    struct gain_mailbox *gain_mbox = NULL;
+
+    sess_obj->ec_ref_state = false;
+    sess_obj->loopback_state = false;
+    sess_obj->paused = false;
+    param_store_clear(&sess_obj->replay_params);
+
+    /* next graph may place the volume modules elsewhere */
+    pthread_mutex_lock(&sess_obj->gain_mbox_lock);
+    list_for_each(node, &sess_obj->gain_mbox_list) {
+        gain_mbox = node_to_item(node, struct gain_mailbox, node);
+        gain_mbox->miid = 0;
+    }
+    pthread_mutex_unlock(&sess_obj->gain_mbox_lock);
+}
+
 static int session_close(struct session_obj *sess_obj)
 {
     int ret = 0;
@@ -1323,6 +1650,14 @@ static int session_close(struct session_obj *sess_obj)
     struct listnode *next = NULL;
 
     AGM_LOGD("enter");
+    if (sess_obj->ssr_pending) {
+        /* graph and devices are already gone, drop the replay record */
+        sess_obj->ssr_pending = false;
+        session_reset_graph_state(sess_obj);
+        aif_pool_free(sess_obj);
+        goto done;
+    }
+
     if (sess_obj->state == SESSION_CLOSED) {
         AGM_LOGE("session already in CLOSED state\n");
         ret = -EALREADY;
@@ -1342,8 +1677,7 @@ static int session_close(struct session_obj *sess_obj)
         AGM_LOGE("Error:%d closing graph\n", ret);
     }
     sess_obj->graph = NULL;
-    sess_obj->ec_ref_state = false;
-    sess_obj->loopback_state = false;
+    session_reset_graph_state(sess_obj);
 
     if (sess_mode != AGM_SESSION_NON_TUNNEL  && sess_mode != AGM_SESSION_NO_CONFIG) {
         list_for_each_safe(node, next, &sess_obj->aif_pool) {
@@ -1372,6 +1706,7 @@ static int session_close(struct session_obj *sess_obj)
     }
     pthread_mutex_unlock(&hwep_lock);
     sess_obj->state = SESSION_CLOSED;
+    session_time_page_set_state(sess_obj, AGM_TIME_PAGE_CLOSED, 0);
 done:
     AGM_LOGD("exit, ret %d", ret);
     return ret;
@@ -1407,7 +1742,7 @@ int session_obj_init()
         AGM_LOGE("Error:%d initializing session_pool\n", ret);
         goto graph_deinit;
     }
-    pthread_mutex_init(&hwep_lock, (const pthread_mutexattr_t *) NULL);
+    agm_sched_mutex_init(&hwep_lock);
     check_and_enable_traces();
     goto done;
 
@@ -1435,158 +1770,502 @@ int session_obj_set_sess_metadata(struct session_obj *sess_obj,
     return ret;
 }
 
-int session_obj_set_sess_params(struct session_obj *sess_obj,
-    void *payload, size_t size)
-{
-   int ret = 0;
-
-   pthread_mutex_lock(&sess_obj->lock);
-
-   if (sess_obj->params) {
-       free(sess_obj->params);
-       sess_obj->params = NULL;
-       sess_obj->params_size = 0;
-   }
-
-   if ((size == 0) ||(payload == NULL))
-       goto done;
-
-   sess_obj->params = calloc(1, size);
-   if (!sess_obj->params) {
-       AGM_LOGE("No memory for sess params on sess_id:%d\n",
-                                   sess_obj->sess_id);
-       ret = -EINVAL;
-       goto done;
-   }
-
-   memcpy(sess_obj->params, payload, size);
-   sess_obj->params_size = size;
-
-   if (sess_obj->state != SESSION_CLOSED) {
-       ret = graph_set_config(sess_obj->graph, sess_obj->params,
-                                         sess_obj->params_size);
-       if (ret) {
-           AGM_LOGE("Error:%d setting for sess params on sess_id:%d\n",
-                   ret, sess_obj->sess_id);
-       }
-       free(sess_obj->params);
-       sess_obj->params = NULL;
-       sess_obj->params_size = 0;
-   }
-
-done:
-   pthread_mutex_unlock(&sess_obj->lock);
-   return ret;
-}
-
-int session_obj_set_sess_aif_params(struct session_obj *sess_obj,
-    uint32_t aif_id,
-    void* payload, size_t size)
+int session_obj_set_sess_metadata_gsl(struct session_obj *sess_obj,
+                              const struct agm_meta_data_gsl *metadata)
 {
     int ret = 0;
-    struct aif *aif_obj = NULL;
 
     pthread_mutex_lock(&sess_obj->lock);
-    ret = aif_obj_get(sess_obj, aif_id, &aif_obj);
-    if (ret) {
-        AGM_LOGE("Error obtaining aif object with sess_id:%d,  aif id:%d\n",
-            sess_obj->sess_id, aif_id);
-        goto done;
-    }
+    metadata_free(&(sess_obj->sess_meta));
+    ret = metadata_dup(&(sess_obj->sess_meta), metadata);
+    pthread_mutex_unlock(&sess_obj->lock);
 
-   if (aif_obj->params) {
-       free(aif_obj->params);
-       aif_obj->params = NULL;
-       aif_obj->params_size = 0;
-   }
+    return ret;
+}
 
-   if ((size == 0) || (payload == NULL))
-       goto done;
+/*
+ *Stage or send a set_params payload for the session, or for aif_obj if set.
+ *With nothing staged ahead of it the payload goes to the graph as is and is
+ *only kept for replay once it made it there. An owned payload is adopted
+ *instead of copied and is consumed on every path.
+ */
+static int session_set_params_l(struct session_obj *sess_obj,
+                                struct aif *aif_obj, void *payload,
+                                size_t size, bool owned)
+{
+    struct param_store *store = aif_obj ? &aif_obj->params : &sess_obj->params;
+    bool live = sess_obj->state != SESSION_CLOSED &&
+                (!aif_obj || aif_obj->state >= AIF_OPENED);
+    int ret = 0;
 
-   aif_obj->params = calloc(1, size);
-   if (!aif_obj->params) {
-       AGM_LOGE("No memory for sess_aif params on sess_id:%d, aif_id:%d\n",
-                                 sess_obj->sess_id, aif_obj->aif_id);
-       ret = -EINVAL;
-       goto done;
-   }
+    if (live && param_store_is_empty(store)) {
+        ret = graph_set_config(sess_obj->graph, payload, size);
+        if (ret) {
+            if (owned)
+                free(payload);
+            return ret;
+        }
 
-   memcpy(aif_obj->params, payload, size);
-   aif_obj->params_size = size;
+        if (owned)
+            ret = param_store_adopt(&sess_obj->replay_params, payload, size);
+        else
+            ret = param_store_merge(&sess_obj->replay_params, payload, size);
+        if (ret)
+            AGM_LOGE("Error:%d keeping params for replay on sess_id:%d\n",
+                     ret, sess_obj->sess_id);
+        return 0;
+    }
 
-   if (sess_obj->state != SESSION_CLOSED && aif_obj->state >= AIF_OPENED) {
-       ret = graph_set_config(sess_obj->graph, aif_obj->params, aif_obj->params_size);
-       if (ret) {
-           AGM_LOGE("Error:%d setting for sess_aif params on sess_id:%d, \
-                     aif_id:%d\n", ret,
-                     sess_obj->sess_id, aif_obj->aif_id);
-       }
-       free(aif_obj->params);
-       aif_obj->params = NULL;
-       aif_obj->params_size = 0;
-   }
+    if (owned)
+        ret = param_store_adopt(store, payload, size);
+    else
+        ret = param_store_merge(store, payload, size);
+    if (ret) {
+        AGM_LOGE("Error:%d caching params on sess_id:%d, aif_id:%d\n",
+                 ret, sess_obj->sess_id, aif_obj ? (int)aif_obj->aif_id : -1);
+        return ret;
+    }
 
-done:
-    pthread_mutex_unlock(&sess_obj->lock);
+    /* staged params go out along with this payload */
+    if (live)
+        ret = session_apply_params(sess_obj->graph, store,
+                                   &sess_obj->replay_params);
     return ret;
-
 }
 
-int session_obj_set_sess_aif_params_with_tag(struct session_obj *sess_obj,
-    uint32_t aif_id,
-    struct agm_tag_config *tag_config)
+static int session_set_params(struct session_obj *sess_obj, uint32_t aif_id,
+                              void *payload, size_t size, bool owned)
 {
-    int ret = 0;
     struct aif *aif_obj = NULL;
-    struct agm_meta_data_gsl *merged_metadata = NULL;
-    struct agm_tag_config_gsl tag_config_gsl;
-    size_t tkv_payload_size = 0;
+    int ret = 0;
 
     pthread_mutex_lock(&sess_obj->lock);
-    if (aif_id < UINT_MAX) {
+    if (aif_id != AGM_AIF_NONE) {
         ret = aif_obj_get(sess_obj, aif_id, &aif_obj);
         if (ret) {
             AGM_LOGE("Error obtaining aif object with sess_id:%d,  aif id:%d\n",
                 sess_obj->sess_id, aif_id);
+            if (owned)
+                free(payload);
             goto done;
         }
+    }
 
-        if (sess_obj->state == SESSION_STARTED && aif_obj->state < AIF_OPENED) {
-            AGM_LOGE("AIF not opened on sess_id:%d, aif_id:%d, caching tkv\n",
-                     sess_obj->sess_id, aif_obj->aif_id);
+    if ((size == 0) || (payload == NULL)) {
+        param_store_clear(aif_obj ? &aif_obj->params : &sess_obj->params);
+        if (owned)
+            free(payload);
+        goto done;
+    }
 
-            if (aif_obj->tag_config) {
-                free(aif_obj->tag_config);
-                aif_obj->tag_config = NULL;
-            }
+    ret = session_set_params_l(sess_obj, aif_obj, payload, size, owned);
+    if (ret)
+        AGM_LOGE("Error:%d setting params on sess_id:%d, aif_id:%d\n",
+                 ret, sess_obj->sess_id, aif_id);
 
-            tkv_payload_size = sizeof(struct agm_tag_config) +
-                               (tag_config->num_tkvs * sizeof(struct agm_key_value));
-            aif_obj->tag_config = (struct agm_tag_config *)calloc(1, tkv_payload_size);
-            if (!aif_obj->tag_config) {
-                AGM_LOGE("Tag_config memory allocation failed for sess_id:%d, aif_id:%d",
-                          sess_obj->sess_id, aif_obj->aif_id);
-                ret = -ENOMEM;
-                goto done;
-            }
-            memcpy(aif_obj->tag_config, tag_config, tkv_payload_size);
-            goto done;
-        }
+done:
+    pthread_mutex_unlock(&sess_obj->lock);
+    return ret;
+}
 
-        if (sess_obj->state == SESSION_CLOSED && aif_obj->state < AIF_OPENED) {
-            AGM_LOGE("Invalid state on sess_id:%d, aif_id:%d\n",
-                     sess_obj->sess_id, aif_obj->aif_id);
-            ret = -EINVAL;
-            goto done;
-        }
+int session_obj_set_sess_params(struct session_obj *sess_obj,
+    void *payload, size_t size)
+{
+    return session_set_params(sess_obj, AGM_AIF_NONE, payload, size, false);
+}
 
-        pthread_mutex_lock(&aif_obj->dev_obj->lock);
-        merged_metadata = metadata_merge(3, &sess_obj->sess_meta,
-                          &aif_obj->sess_aif_meta, &aif_obj->dev_obj->metadata);
-        pthread_mutex_unlock(&aif_obj->dev_obj->lock);
-        if (!merged_metadata) {
-            AGM_LOGE("Error merging metadata session_id:%d aif_id:%d\n",
-                sess_obj->sess_id, aif_obj->aif_id);
+int session_obj_set_sess_aif_params(struct session_obj *sess_obj,
+    uint32_t aif_id,
+    void* payload, size_t size)
+{
+    return session_set_params(sess_obj, aif_id, payload, size, false);
+}
+
+int session_obj_set_params_owned(struct session_obj *sess_obj,
+                                 uint32_t aif_id, void *payload, size_t size)
+{
+    return session_set_params(sess_obj, aif_id, payload, size, true);
+}
+
+/*
+ *A memfd sealed against writes and shrinking can neither change under the
+ *validation of the payload nor fault on access, so it is safe to map.
+ */
+static bool session_params_fd_sealed(int fd, size_t size)
+{
+#ifdef F_GET_SEALS
+    struct stat st;
+    int seals;
+
+    seals = fcntl(fd, F_GET_SEALS);
+    if (seals < 0 || (seals & (F_SEAL_WRITE | F_SEAL_SHRINK)) !=
+                     (F_SEAL_WRITE | F_SEAL_SHRINK))
+        return false;
+
+    return fstat(fd, &st) == 0 && st.st_size >= 0 &&
+           (uint64_t)st.st_size >= size;
+#else
+    return false;
+#endif
+}
+
+/*
+ *Copy size bytes at the start of fd. Reading rather than mapping the fd
+ *turns a short or shrinking file into an error instead of a SIGBUS.
+ */
+static int session_params_fd_copy(int fd, size_t size, void **payload)
+{
+    uint8_t *buf;
+    size_t done = 0;
+    ssize_t len;
+    int ret = 0;
+
+    buf = malloc(size);
+    if (!buf)
+        return -ENOMEM;
+
+    while (done < size) {
+        len = pread(fd, buf + done, size - done, done);
+        if (len < 0 && errno == EINTR)
+            continue;
+        if (len <= 0) {
+            ret = len < 0 ? -errno : -EINVAL;
+            AGM_LOGE("Error:%d reading params fd %d, %zu of %zu bytes\n",
+                     ret, fd, done, size);
+            free(buf);
+            return ret;
+        }
+        done += len;
+    }
+
+    *payload = buf;
+    return 0;
+}
+
+int session_obj_set_params_fd(struct session_obj *sess_obj, uint32_t aif_id,
+                              int fd, size_t size)
+{
+    void *payload;
+    int ret = 0;
+
+    if (fd < 0 || size == 0)
+        return -EINVAL;
+
+    if (!session_params_fd_sealed(fd, size)) {
+        /* the client may rewrite or truncate its fd at any time */
+        ret = session_params_fd_copy(fd, size, &payload);
+        if (ret)
+            return ret;
+        return session_set_params(sess_obj, aif_id, payload, size, true);
+    }
+
+    /* the graph reads straight from the caller's pages */
+    payload = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (payload == MAP_FAILED) {
+        ret = -errno;
+        AGM_LOGE("Error:%d mapping params fd %d of size %zu\n", ret, fd, size);
+        return ret;
+    }
+
+    ret = session_set_params(sess_obj, aif_id, payload, size, false);
+    munmap(payload, size);
+    return ret;
+}
+
+int session_obj_stage_sess_params(struct session_obj *sess_obj,
+                                  void *payload, size_t size)
+{
+    int ret = 0;
+
+    if ((size == 0) || (payload == NULL))
+        return -EINVAL;
+
+    pthread_mutex_lock(&sess_obj->lock);
+    ret = param_store_merge(&sess_obj->params, payload, size);
+    if (ret)
+        AGM_LOGE("Error:%d staging sess params on sess_id:%d\n",
+                 ret, sess_obj->sess_id);
+    pthread_mutex_unlock(&sess_obj->lock);
+    return ret;
+}
+
+int session_obj_stage_sess_aif_params(struct session_obj *sess_obj,
+                                      uint32_t aif_id, void *payload,
+                                      size_t size)
+{
+    int ret = 0;
+    struct aif *aif_obj = NULL;
+
+    if ((size == 0) || (payload == NULL))
+        return -EINVAL;
+
+    pthread_mutex_lock(&sess_obj->lock);
+    ret = aif_obj_get(sess_obj, aif_id, &aif_obj);
+    if (ret) {
+        AGM_LOGE("Error obtaining aif object with sess_id:%d,  aif id:%d\n",
+            sess_obj->sess_id, aif_id);
+        goto done;
+    }
+
+    ret = param_store_merge(&aif_obj->params, payload, size);
+    if (ret)
+        AGM_LOGE("Error:%d staging sess_aif params on sess_id:%d, aif_id:%d\n",
+                 ret, sess_obj->sess_id, aif_id);
+
+done:
+    pthread_mutex_unlock(&sess_obj->lock);
+    return ret;
+}
+
+/*
+ *Send staged session and session-aif params in one set config, caller
+ *holds sess_obj->lock. Params of a closed session or of an aif which is
+ *not opened yet stay staged and go out when the graph is opened.
+ */
+static int session_commit_params(struct session_obj *sess_obj)
+{
+    struct aif *aif_obj = NULL;
+    struct listnode *node = NULL;
+    struct param_store staged;
+    int ret = 0;
+
+    if (sess_obj->state == SESSION_CLOSED || !sess_obj->graph)
+        return 0;
+
+    param_store_init(&staged);
+    param_store_move(&staged, &sess_obj->params);
+    list_for_each(node, &sess_obj->aif_pool) {
+        aif_obj = node_to_item(node, struct aif, node);
+        if (aif_obj->state >= AIF_OPENED)
+            param_store_move(&staged, &aif_obj->params);
+    }
+
+    ret = session_apply_params(sess_obj->graph, &staged,
+                               &sess_obj->replay_params);
+    if (ret)
+        AGM_LOGE("Error:%d committing staged params on sess_id:%d\n",
+                 ret, sess_obj->sess_id);
+    return ret;
+}
+
+int session_obj_commit_params(struct session_obj *sess_obj)
+{
+    int ret = 0;
+
+    pthread_mutex_lock(&sess_obj->lock);
+    ret = session_commit_params(sess_obj);
+    pthread_mutex_unlock(&sess_obj->lock);
+    return ret;
+}
+
+#define GAIN_REQ_VALID          (1ULL << 63)
+#define GAIN_REQ(gain, ramp)    (GAIN_REQ_VALID | \
+                                 ((uint64_t)((ramp) & 0x7FFFFFFF) << 32) | (gain))
+#define GAIN_REQ_GAIN(req)      ((uint32_t)((req) & 0xFFFFFFFF))
+#define GAIN_REQ_RAMP(req)      ((uint32_t)(((req) >> 32) & 0x7FFFFFFF))
+
+static struct gain_mailbox *session_gain_mbox_get(struct session_obj *sess_obj,
+                                                  uint32_t aif_id)
+{
+    struct gain_mailbox *mbox = NULL;
+    struct listnode *node;
+
+    pthread_mutex_lock(&sess_obj->gain_mbox_lock);
+    list_for_each(node, &sess_obj->gain_mbox_list) {
+        mbox = node_to_item(node, struct gain_mailbox, node);
+        if (mbox->aif_id == aif_id)
+            goto done;
+    }
+
+    mbox = calloc(1, sizeof(struct gain_mailbox));
+    if (!mbox) {
+        AGM_LOGE("No memory for gain mailbox of sess_id:%d, aif_id:%d\n",
+                 sess_obj->sess_id, aif_id);
+        goto done;
+    }
+    mbox->aif_id = aif_id;
+    list_add_tail(&sess_obj->gain_mbox_list, &mbox->node);
+
+done:
+    pthread_mutex_unlock(&sess_obj->gain_mbox_lock);
+    return mbox;
+}
+
+/* resolves the volume module between stream and aif, sess_obj->lock held */
+static int session_gain_mbox_resolve(struct session_obj *sess_obj,
+                                     struct gain_mailbox *mbox)
+{
+    struct agm_meta_data_gsl *merged_metadata = NULL;
+    struct aif *aif_obj = NULL;
+    int ret = 0;
+
+    aif_obj = aif_obj_get_from_pool(sess_obj, mbox->aif_id);
+    if (!aif_obj || aif_obj->state < AIF_OPENED) {
+        AGM_LOGE("aif %d not connected to sess_id:%d\n",
+                 mbox->aif_id, sess_obj->sess_id);
+        return -EINVAL;
+    }
+
+    pthread_mutex_lock(&aif_obj->dev_obj->lock);
+    merged_metadata = metadata_merge(3, &sess_obj->sess_meta,
+                         &aif_obj->sess_aif_meta, &aif_obj->dev_obj->metadata);
+    pthread_mutex_unlock(&aif_obj->dev_obj->lock);
+    if (!merged_metadata)
+        return -ENOMEM;
+
+    ret = graph_get_tagged_miid(&merged_metadata->gkv, TAG_STREAM_VOLUME,
+                                &mbox->miid);
+    if (ret)
+        AGM_LOGE("Error:%d no volume module for sess_id:%d, aif_id:%d\n",
+                 ret, sess_obj->sess_id, mbox->aif_id);
+
+    metadata_free(merged_metadata);
+    free(merged_metadata);
+    return ret;
+}
+
+static int session_gain_mbox_apply(struct session_obj *sess_obj,
+                                   struct gain_mailbox *mbox, uint64_t req)
+{
+    int ret = 0;
+
+    if (sess_obj->state == SESSION_CLOSED || !sess_obj->graph) {
+        AGM_LOGE("Cannot set gain in state:%d\n", sess_obj->state);
+        return -EINVAL;
+    }
+
+    if (mbox->aif_id != GAIN_MAILBOX_SESSION && mbox->miid == 0) {
+        ret = session_gain_mbox_resolve(sess_obj, mbox);
+        if (ret)
+            return ret;
+    }
+
+    ret = graph_set_gain(sess_obj->graph, mbox->miid, GAIN_REQ_GAIN(req),
+                         GAIN_REQ_RAMP(req));
+    if (!ret)
+        mbox->applied = req;
+    return ret;
+}
+
+/* puts the last applied gains back on a rebuilt graph, sess_obj->lock held */
+static void session_gain_mbox_restore(struct session_obj *sess_obj)
+{
+    struct gain_mailbox *mbox;
+    struct listnode *node;
+    uint64_t req;
+
+    pthread_mutex_lock(&sess_obj->gain_mbox_lock);
+    list_for_each(node, &sess_obj->gain_mbox_list) {
+        mbox = node_to_item(node, struct gain_mailbox, node);
+        if (!mbox->applied)
+            continue;
+        /* no point in ramping towards a value which was reached already */
+        req = GAIN_REQ(GAIN_REQ_GAIN(mbox->applied), 0);
+        if (session_gain_mbox_apply(sess_obj, mbox, req))
+            AGM_LOGE("Failed to restore gain on sess_id:%d, aif_id:%d\n",
+                     sess_obj->sess_id, mbox->aif_id);
+    }
+    pthread_mutex_unlock(&sess_obj->gain_mbox_lock);
+}
+
+int session_obj_set_gain(struct session_obj *sess_obj, uint32_t aif_id,
+                         uint32_t gain, uint32_t ramp_ms)
+{
+    struct gain_mailbox *mbox;
+    uint64_t req;
+    uint32_t idle;
+    int ret = 0;
+
+    /* rejected here as the request may be sent by another caller */
+    if (gain > UINT16_MAX) {
+        AGM_LOGE("gain 0x%x out of range\n", gain);
+        return -EINVAL;
+    }
+
+    mbox = session_gain_mbox_get(sess_obj, aif_id);
+    if (!mbox)
+        return -ENOMEM;
+
+    __atomic_store_n(&mbox->pending, GAIN_REQ(gain, ramp_ms), __ATOMIC_RELEASE);
+
+    /*
+     *Only one caller talks to the DSP at a time, everybody else returns
+     *right away and its request, if still the newest one, is picked up by
+     *that caller. Recheck pending after dropping busy so that a request
+     *posted in between is not left behind.
+     */
+    do {
+        idle = 0;
+        if (!__atomic_compare_exchange_n(&mbox->busy, &idle, 1, false,
+                                         __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+            break;
+
+        pthread_mutex_lock(&sess_obj->lock);
+        while ((req = __atomic_exchange_n(&mbox->pending, 0, __ATOMIC_ACQ_REL)))
+            ret = session_gain_mbox_apply(sess_obj, mbox, req);
+        pthread_mutex_unlock(&sess_obj->lock);
+
+        __atomic_store_n(&mbox->busy, 0, __ATOMIC_RELEASE);
+    } while (__atomic_load_n(&mbox->pending, __ATOMIC_ACQUIRE));
+
+    return ret;
+}
+
+int session_obj_set_sess_aif_params_with_tag(struct session_obj *sess_obj,
+    uint32_t aif_id,
+    struct agm_tag_config *tag_config)
+{
+    int ret = 0;
+    struct aif *aif_obj = NULL;
+    struct agm_meta_data_gsl *merged_metadata = NULL;
+    struct agm_tag_config_gsl tag_config_gsl;
+    size_t tkv_payload_size = 0;
+
+    pthread_mutex_lock(&sess_obj->lock);
+    if (aif_id < UINT_MAX) {
+        ret = aif_obj_get(sess_obj, aif_id, &aif_obj);
+        if (ret) {
+            AGM_LOGE("Error obtaining aif object with sess_id:%d,  aif id:%d\n",
+                sess_obj->sess_id, aif_id);
+            goto done;
+        }
+
+        if (sess_obj->state == SESSION_STARTED && aif_obj->state < AIF_OPENED) {
+            AGM_LOGE("AIF not opened on sess_id:%d, aif_id:%d, caching tkv\n",
+                     sess_obj->sess_id, aif_obj->aif_id);
+
+            if (aif_obj->tag_config) {
+                free(aif_obj->tag_config);
+                aif_obj->tag_config = NULL;
+            }
+
+            tkv_payload_size = sizeof(struct agm_tag_config) +
+                               (tag_config->num_tkvs * sizeof(struct agm_key_value));
+            aif_obj->tag_config = (struct agm_tag_config *)calloc(1, tkv_payload_size);
+            if (!aif_obj->tag_config) {
+                AGM_LOGE("Tag_config memory allocation failed for sess_id:%d, aif_id:%d",
+                          sess_obj->sess_id, aif_obj->aif_id);
+                ret = -ENOMEM;
+                goto done;
+            }
+            memcpy(aif_obj->tag_config, tag_config, tkv_payload_size);
+            goto done;
+        }
+
+        if (sess_obj->state == SESSION_CLOSED && aif_obj->state < AIF_OPENED) {
+            AGM_LOGE("Invalid state on sess_id:%d, aif_id:%d\n",
+                     sess_obj->sess_id, aif_obj->aif_id);
+            ret = -EINVAL;
+            goto done;
+        }
+
+        pthread_mutex_lock(&aif_obj->dev_obj->lock);
+        merged_metadata = metadata_merge(3, &sess_obj->sess_meta,
+                          &aif_obj->sess_aif_meta, &aif_obj->dev_obj->metadata);
+        pthread_mutex_unlock(&aif_obj->dev_obj->lock);
+        if (!merged_metadata) {
+            AGM_LOGE("Error merging metadata session_id:%d aif_id:%d\n",
+                sess_obj->sess_id, aif_obj->aif_id);
             ret = -ENOMEM;
             goto done;
         }
@@ -1632,6 +2311,27 @@ done:
     return ret;
 }
 
+/*
+ *ACDB tuning changed the data behind some calibration keys, which graph
+ *key vectors are affected is not known here. Drop the applied records of
+ *every open graph so the next set_cal reaches SPF.
+ */
+static void session_invalidate_applied_cal(void)
+{
+    struct session_obj *sess_obj;
+    struct listnode *node;
+
+    pthread_mutex_lock(&sess_pool->lock);
+    list_for_each(node, &sess_pool->session_list) {
+        sess_obj = node_to_item(node, struct session_obj, node);
+        pthread_mutex_lock(&sess_obj->lock);
+        if (sess_obj->graph)
+            graph_invalidate_cal(sess_obj->graph);
+        pthread_mutex_unlock(&sess_obj->lock);
+    }
+    pthread_mutex_unlock(&sess_pool->lock);
+}
+
 int session_obj_rw_acdb_params_with_tag(
     struct session_obj *sess_obj, uint32_t aif_id,
     struct agm_acdb_param *acdb_param, bool is_set)
@@ -1707,6 +2407,9 @@ free_metadata:
 error:
     pthread_mutex_unlock(&sess_obj->lock);
 
+    if (!ret && is_set)
+        session_invalidate_applied_cal();
+
     return ret;
 }
 
@@ -1724,6 +2427,8 @@ int session_dummy_rw_acdb_tunnel(
     }
 
     ret = graph_rw_acdb_param(payload, is_param_set);
+    if (!ret && is_param_set)
+        session_invalidate_applied_cal();
 
     AGM_LOGD("exit status=%d", ret);
 
@@ -1839,6 +2544,32 @@ done:
     return ret;
 }
 
+int session_obj_set_sess_aif_metadata_gsl(struct session_obj *sess_obj,
+    uint32_t aif_id, const struct agm_meta_data_gsl *metadata)
+{
+    int ret = 0;
+    struct aif *aif_obj = NULL;
+
+    pthread_mutex_lock(&sess_obj->lock);
+    ret = aif_obj_get(sess_obj, aif_id, &aif_obj);
+    if (ret) {
+        AGM_LOGE("Error obtaining aif object with sess_id:%d,  aif id:%d\n",
+            sess_obj->sess_id, aif_id);
+        goto done;
+    }
+
+    metadata_free(&(aif_obj->sess_aif_meta));
+    ret = metadata_dup(&(aif_obj->sess_aif_meta), metadata);
+    if (ret) {
+        AGM_LOGE("Error copying session audio interface metadata \
+                  sess_id:%d, aif_id:%d \n",
+                  sess_obj->sess_id, aif_obj->aif_id);
+    }
+done:
+    pthread_mutex_unlock(&sess_obj->lock);
+    return ret;
+}
+
 int session_obj_get_sess_params(struct session_obj *sess_obj,
         void *payload, size_t size)
 {
@@ -1932,18 +2663,90 @@ int session_dummy_get_tag_with_module_info(struct agm_key_vector_gsl *gkv,
     return ret;
 }
 
-int session_obj_register_cb(struct session_obj *sess_obj, agm_event_cb cb,
-                              enum event_type evt_type, void *client_data)
+/*
+ *Publish a new snapshot of the cb_pool, called with cb_pool_lock held.
+ *snap has room for every callback in the pool. If wait is set the call
+ *returns only once no event is delivered from any older snapshot, not
+ *only the one replaced, so that a deregistered client_data is no longer
+ *in use. Dispatches of the new snapshot are all the in-flight ones but
+ *the reference the session holds.
+ */
+static void session_cb_snapshot_publish_l(struct session_obj *sess_obj,
+                                          struct session_cb_snapshot *snap,
+                                          bool wait)
+{
+    struct session_cb_snapshot *old;
+    struct session_cb *sess_cb;
+    struct listnode *node;
+    bool last = false;
+
+    snap->refs = 1;
+    snap->num_cbs = 0;
+    list_for_each(node, &sess_obj->cb_pool) {
+        sess_cb = node_to_item(node, struct session_cb, node);
+        if (sess_cb->cb)
+            snap->cbs[snap->num_cbs++] = *sess_cb;
+    }
+
+    pthread_mutex_lock(&sess_obj->cb_snapshot_lock);
+    old = sess_obj->cb_snapshot;
+    sess_obj->cb_snapshot = snap;
+    if (old)
+        last = --old->refs == 0;
+    while (wait && sess_obj->cb_dispatching > snap->refs - 1)
+        pthread_cond_wait(&sess_obj->cb_snapshot_cond,
+                          &sess_obj->cb_snapshot_lock);
+    pthread_mutex_unlock(&sess_obj->cb_snapshot_lock);
+    if (last)
+        free(old);
+}
+
+static struct session_cb_snapshot *session_cb_snapshot_alloc_l(
+                                        struct session_obj *sess_obj,
+                                        uint32_t extra)
+{
+    struct listnode *node;
+    uint32_t num = extra;
+
+    list_for_each(node, &sess_obj->cb_pool)
+        num++;
+
+    return calloc(1, sizeof(struct session_cb_snapshot) +
+                     num * sizeof(struct session_cb));
+}
+
+int session_obj_register_cb_filtered(struct session_obj *sess_obj,
+                                     agm_event_cb cb, enum event_type evt_type,
+                                     void *client_data,
+                                     const struct agm_event_filter *filter)
 {
     int ret = 0;
     struct session_cb *sess_cb = NULL;
+    struct session_cb_snapshot *snap;
+    struct listnode *node, *next;
+    uint32_t i;
+
+    if (filter && (filter->num_event_ids > AGM_EVENT_FILTER_MAX_IDS ||
+                   filter->num_module_ids > AGM_EVENT_FILTER_MAX_IDS)) {
+        AGM_LOGE("Invalid event filter\n");
+        return -EINVAL;
+    }
 
     pthread_mutex_lock(&sess_obj->cb_pool_lock);
+    snap = session_cb_snapshot_alloc_l(sess_obj, cb ? 1 : 0);
+    if (!snap) {
+        AGM_LOGE("Error creating callback snapshot for sess_id:%d\n",
+                                         sess_obj->sess_id);
+        ret = -ENOMEM;
+        goto done;
+    }
+
     if (cb != NULL) {
         sess_cb = calloc(1, sizeof(struct session_cb));
         if (!sess_cb) {
             AGM_LOGE("Error creating session_cb object with sess_id:%d\n",
                                              sess_obj->sess_id);
+            free(snap);
             ret = -ENOMEM;
             goto done;
         }
@@ -1951,11 +2754,18 @@ int session_obj_register_cb(struct session_obj *sess_obj, agm_event_cb cb,
         sess_cb->cb = cb;
         sess_cb->client_data = client_data;
         sess_cb->evt_type = evt_type;
+        if (filter) {
+            sess_cb->filter = *filter;
+            for (i = 0; i < filter->num_event_ids; i++)
+                sess_cb->event_mask |= 1ULL << (filter->event_ids[i] % 64);
+            for (i = 0; i < filter->num_module_ids; i++)
+                sess_cb->module_mask |= 1ULL << (filter->module_ids[i] % 64);
+        }
         AGM_LOGV("sess_cb %p client_data %p evt_type %d", sess_cb,
                                            client_data, evt_type);
         list_add_tail(&sess_obj->cb_pool, &sess_cb->node);
+        session_cb_snapshot_publish_l(sess_obj, snap, false);
     } else {
-        struct listnode *node, *next;
         list_for_each_safe(node, next, &sess_obj->cb_pool) {
             sess_cb = node_to_item(node, struct session_cb, node);
             if (sess_cb->evt_type == evt_type &&
@@ -1967,12 +2777,47 @@ int session_obj_register_cb(struct session_obj *sess_obj, agm_event_cb cb,
                 free(sess_cb);
             }
         }
+        session_cb_snapshot_publish_l(sess_obj, snap, true);
     }
 done:
     pthread_mutex_unlock(&sess_obj->cb_pool_lock);
     return ret;
 }
 
+int session_obj_register_cb(struct session_obj *sess_obj, agm_event_cb cb,
+                              enum event_type evt_type, void *client_data)
+{
+    return session_obj_register_cb_filtered(sess_obj, cb, evt_type,
+                                            client_data, NULL);
+}
+
+void session_obj_notify_cmd_done(struct session_obj *sess_obj,
+                                 enum agm_session_cmd cmd, uint32_t token,
+                                 int status)
+{
+    struct agm_event_cb_params *event_params;
+    struct agm_event_session_cmd_done_payload *payload;
+
+    event_params = calloc(1, sizeof(struct agm_event_cb_params) +
+                             sizeof(struct agm_event_session_cmd_done_payload));
+    if (!event_params) {
+        AGM_LOGE("Not enough memory for event_params");
+        return;
+    }
+
+    event_params->event_id = AGM_EVENT_SESSION_CMD_DONE;
+    event_params->event_payload_size =
+                         sizeof(struct agm_event_session_cmd_done_payload);
+    payload = (struct agm_event_session_cmd_done_payload *)
+                         event_params->event_payload;
+    payload->cmd = cmd;
+    payload->token = token;
+    payload->status = status;
+
+    session_cb_dispatch(sess_obj, event_params, AGM_EVENT_SESSION_CONTROL);
+    free(event_params);
+}
+
 int session_obj_register_for_events(struct session_obj *sess_obj,
                            struct agm_event_reg_cfg *evt_reg_cfg)
 {
@@ -2001,6 +2846,19 @@ done:
     return ret;
 }
 
+bool session_obj_aif_connected(struct session_obj *sess_obj, uint32_t aif_id)
+{
+    struct aif *aif_obj = NULL;
+    bool connected;
+
+    pthread_mutex_lock(&sess_obj->lock);
+    aif_obj = aif_obj_get_from_pool(sess_obj, aif_id);
+    connected = aif_obj && aif_obj->state >= AIF_OPEN;
+    pthread_mutex_unlock(&sess_obj->lock);
+
+    return connected;
+}
+
 int session_obj_sess_aif_connect(struct session_obj *sess_obj,
     uint32_t aif_id, bool aif_state)
 {
@@ -2122,32 +2980,18 @@ done:
     return ret;
 }
 
-int session_obj_open(uint32_t session_id,
-                     enum agm_session_mode sess_mode,
-                     struct session_obj **session)
+/*
+ *Builds the graph of a session from the aifs connected to it and its cached
+ *metadata, params and loopback/ec reference state, sess_obj->lock held.
+ */
+static int session_open(struct session_obj *sess_obj)
 {
-
-    struct session_obj *sess_obj = NULL;
+    enum agm_session_mode sess_mode = sess_obj->stream_config.sess_mode;
     int ret = 0;
     int ret_unwind = 0;
     struct listnode *node;
     struct aif *aif_obj = NULL;
 
-    ret = session_obj_get(session_id, &sess_obj);
-    if (ret) {
-        AGM_LOGE("Error getting session object\n");
-        return ret;
-    }
-
-    pthread_mutex_lock(&sess_obj->lock);
-    if (sess_obj->state != SESSION_CLOSED) {
-        AGM_LOGE("Session already Opened, session_state:%d\n",
-                                       sess_obj->state);
-        ret = -EALREADY;
-        goto done;
-    }
-    sess_obj->stream_config.sess_mode = sess_mode;
-
     if (sess_mode == AGM_SESSION_NON_TUNNEL || sess_mode == AGM_SESSION_NO_CONFIG) {
         /**
          *AGM session can be opened in any one of the agm_session_modes
@@ -2207,7 +3051,7 @@ int session_obj_open(uint32_t session_id,
     }
 
     sess_obj->state = SESSION_OPENED;
-    *session = sess_obj;
+    session_time_page_set_state(sess_obj, AGM_TIME_PAGE_OPENED, 0);
     goto done;
 
 unwind:
@@ -2227,7 +3071,45 @@ unwind:
     if (ret_unwind) {
         AGM_LOGE("Error:%d Failed to close graph\n", ret_unwind);
     }
-    sess_obj->graph = NULL;
+    sess_obj->graph = NULL;
+
+done:
+    return ret;
+}
+
+int session_obj_open(uint32_t session_id,
+                     enum agm_session_mode sess_mode,
+                     struct session_obj **session)
+{
+
+    struct session_obj *sess_obj = NULL;
+    int ret = 0;
+
+    ret = session_obj_get(session_id, &sess_obj);
+    if (ret) {
+        AGM_LOGE("Error getting session object\n");
+        return ret;
+    }
+
+    pthread_mutex_lock(&sess_obj->lock);
+    if (sess_obj->state != SESSION_CLOSED) {
+        AGM_LOGE("Session already Opened, session_state:%d\n",
+                                       sess_obj->state);
+        ret = -EALREADY;
+        goto done;
+    }
+    sess_obj->stream_config.sess_mode = sess_mode;
+    /* client reopened a session lost to SSR, its own setup wins */
+    if (sess_obj->ssr_pending) {
+        sess_obj->ssr_pending = false;
+        session_reset_graph_state(sess_obj);
+    }
+
+    ret = session_open(sess_obj);
+    if (ret)
+        goto done;
+
+    *session = sess_obj;
 
 done:
     pthread_mutex_unlock(&sess_obj->lock);
@@ -2333,7 +3215,10 @@ int session_obj_pause(struct session_obj *sess_obj)
     ret = graph_pause(sess_obj->graph);
     if (ret) {
         AGM_LOGE("Error:%d pausing graph\n", ret);
+        goto done;
     }
+    sess_obj->paused = true;
+    session_time_page_sync(sess_obj, AGM_TIME_PAGE_PAUSED);
 
 done:
     pthread_mutex_unlock(&sess_obj->lock);
@@ -2343,8 +3228,6 @@ done:
 int session_obj_flush(struct session_obj *sess_obj)
 {
     int ret = 0;
-    struct session_cb *sess_cb;
-    struct listnode *node, *next;
     struct agm_event_cb_params *event_params = NULL;
 
     pthread_mutex_lock(&sess_obj->lock);
@@ -2363,17 +3246,8 @@ int session_obj_flush(struct session_obj *sess_obj)
         goto done;
     }
 
-    pthread_mutex_lock(&sess_obj->cb_pool_lock);
-    list_for_each_safe(node, next, &sess_obj->cb_pool) {
-        sess_cb = node_to_item(node, struct session_cb, node);
-        if (sess_cb && sess_cb->cb) {
-            event_params->event_id = AGM_EVENT_EARLY_EOS;
-            sess_cb->cb(sess_obj->sess_id,
-                        (struct agm_event_cb_params *)event_params,
-                        sess_cb->client_data);
-        }
-    }
-    pthread_mutex_unlock(&sess_obj->cb_pool_lock);
+    event_params->event_id = AGM_EVENT_EARLY_EOS;
+    session_cb_dispatch(sess_obj, event_params, 0);
     if (event_params)
         free(event_params);
 
@@ -2392,6 +3266,10 @@ int session_obj_resume(struct session_obj *sess_obj)
     ret = graph_resume(sess_obj->graph);
     if (ret) {
         AGM_LOGE("Error:%d resuming graph\n", ret);
+    } else {
+        sess_obj->paused = false;
+        if (sess_obj->state == SESSION_STARTED)
+            session_time_page_sync(sess_obj, AGM_TIME_PAGE_STARTED);
     }
 
 
@@ -2436,6 +3314,9 @@ int session_obj_read(struct session_obj *sess_obj, void *buff, size_t *count)
     ret = graph_read(sess_obj->graph, &buffer, count);
     if (ret) {
         AGM_LOGE("Error:%d reading from graph\n", ret);
+    } else if (sess_obj->time_page &&
+               !graph_get_buffer_timestamp(sess_obj->graph, &buffer.timestamp)) {
+        session_time_page_buf_done(sess_obj, &buffer.timestamp);
     }
 
 done:
@@ -2471,6 +3352,107 @@ done:
     return ret;
 }
 
+int session_obj_readv(struct session_obj *sess_obj, struct agm_iovec *iov,
+                      uint32_t iovcnt, uint32_t *done)
+{
+    int ret = 0;
+    struct agm_buff buffer = {0};
+    size_t count;
+    uint32_t i;
+
+    /*
+     *The lock is taken per buffer so that control calls are not held off
+     *for the whole vector and a session closed in between stops the read.
+     */
+    *done = 0;
+    for (i = 0; i < iovcnt; i++) {
+        buffer.timestamp = 0x0;
+        buffer.flags = 0;
+        buffer.size = iov[i].size;
+        buffer.addr = iov[i].addr;
+        count = iov[i].size;
+        iov[i].flags = 0;
+
+        pthread_mutex_lock(&sess_obj->lock);
+        if (sess_obj->state == SESSION_CLOSED) {
+            pthread_mutex_unlock(&sess_obj->lock);
+            AGM_LOGE("Cannot issue read in state:%d\n",
+                               sess_obj->state);
+            iov[i].size = 0;
+            ret = -EINVAL;
+            break;
+        }
+
+        ret = graph_read(sess_obj->graph, &buffer, &count);
+        iov[i].size = (uint32_t)count;
+        if (ret) {
+            pthread_mutex_unlock(&sess_obj->lock);
+            AGM_LOGE("Error:%d reading buffer %u from graph\n", ret, i);
+            break;
+        }
+
+        if (!graph_get_buffer_timestamp(sess_obj->graph, &buffer.timestamp)) {
+            iov[i].timestamp = buffer.timestamp;
+            iov[i].flags |= AGM_BUFF_FLAG_TS_VALID;
+            if (sess_obj->time_page)
+                session_time_page_buf_done(sess_obj, &buffer.timestamp);
+        }
+        pthread_mutex_unlock(&sess_obj->lock);
+
+        if (count < buffer.size)
+            break;
+        (*done)++;
+    }
+    while (++i < iovcnt)
+        iov[i].size = 0;
+
+    return ret;
+}
+
+int session_obj_writev(struct session_obj *sess_obj, struct agm_iovec *iov,
+                       uint32_t iovcnt, uint32_t *done)
+{
+    int ret = 0;
+    struct agm_buff buffer = {0};
+    size_t count;
+    uint32_t i;
+
+    /* locked per buffer, see session_obj_readv() */
+    *done = 0;
+    for (i = 0; i < iovcnt; i++) {
+        buffer.timestamp = iov[i].timestamp;
+        buffer.flags = iov[i].flags;
+        buffer.size = iov[i].size;
+        buffer.addr = iov[i].addr;
+        count = iov[i].size;
+
+        pthread_mutex_lock(&sess_obj->lock);
+        if (sess_obj->state == SESSION_CLOSED) {
+            pthread_mutex_unlock(&sess_obj->lock);
+            AGM_LOGE("Cannot issue write in state:%d\n",
+                                sess_obj->state);
+            iov[i].size = 0;
+            ret = -EINVAL;
+            break;
+        }
+
+        ret = graph_write(sess_obj->graph, &buffer, &count);
+        pthread_mutex_unlock(&sess_obj->lock);
+        iov[i].size = (uint32_t)count;
+        if (ret) {
+            AGM_LOGE("Error:%d writing buffer %u to graph\n", ret, i);
+            break;
+        }
+        if (count < buffer.size)
+            break;
+        (*done)++;
+    }
+    while (++i < iovcnt)
+        iov[i].size = 0;
+
+    return ret;
+}
+
 size_t session_obj_hw_processed_buff_cnt(struct session_obj *sess_obj,
                                                    enum direction dir)
 {
@@ -2633,6 +3615,28 @@ int session_obj_get_timestamp(struct session_obj *sess_obj,
     ret = graph_get_session_time(sess_obj->graph, timestamp);
     if (ret)
         AGM_LOGE("Error:%d for get_timestamp \n", ret);
+    else if (sess_obj->state == SESSION_STARTED)
+        session_time_page_set_time(sess_obj, *timestamp);
+
+done:
+    pthread_mutex_unlock(&sess_obj->lock);
+    return ret;
+}
+
+int session_obj_get_cal_stats(struct session_obj *sess_obj, uint32_t *applied,
+                              uint32_t *skipped)
+{
+    int ret = 0;
+
+    pthread_mutex_lock(&sess_obj->lock);
+    if (sess_obj->state == SESSION_CLOSED) {
+        AGM_LOGE("Cannot get calibration stats in state:%d\n",
+                              sess_obj->state);
+        ret = -EINVAL;
+        goto done;
+    }
+
+    ret = graph_get_cal_stats(sess_obj->graph, applied, skipped);
 
 done:
     pthread_mutex_unlock(&sess_obj->lock);
@@ -2671,9 +3675,41 @@ int session_obj_get_sess_buf_info(struct session_obj *sess_obj, struct agm_buf_i
         goto done;
     }
 
-    ret = graph_get_buf_info(sess_obj->graph, buf_info, flag);
-    if (ret)
-        AGM_LOGE("graph_get_buf_info failed %d\n", ret);
+    if (flag & (DATA_BUF | POS_BUF)) {
+        ret = graph_get_buf_info(sess_obj->graph, buf_info, flag);
+        if (ret) {
+            AGM_LOGE("graph_get_buf_info failed %d\n", ret);
+            goto done;
+        }
+    }
+
+    if (flag & TIME_BUF) {
+        if (!sess_obj->time_page) {
+            pthread_mutex_lock(&sess_obj->time_page_lock);
+            ret = session_time_page_create(sess_obj);
+            pthread_mutex_unlock(&sess_obj->time_page_lock);
+            if (ret)
+                goto done;
+
+            /* page starts publishing now, seed it with the current state */
+            if (sess_obj->state == SESSION_STARTED)
+                session_time_page_sync(sess_obj, AGM_TIME_PAGE_STARTED);
+            else
+                session_time_page_set_state(sess_obj,
+                    sess_obj->state == SESSION_PREPARED ? AGM_TIME_PAGE_PREPARED :
+                    sess_obj->state == SESSION_STOPPED ? AGM_TIME_PAGE_STOPPED :
+                                                         AGM_TIME_PAGE_OPENED, 0);
+        }
+
+        /* caller owns the returned fd, the page stays with the session */
+        buf_info->time_buf_fd = dup(sess_obj->time_page_fd);
+        if (buf_info->time_buf_fd < 0) {
+            ret = -errno;
+            AGM_LOGE("failed to dup time page fd %d\n", ret);
+            goto done;
+        }
+        buf_info->time_buf_size = (int32_t)sysconf(_SC_PAGESIZE);
+    }
 
 done:
     pthread_mutex_unlock(&sess_obj->lock);
@@ -2770,3 +3806,330 @@ int session_obj_set_non_tunnel_mode_config(struct session_obj *sess_obj,
     pthread_mutex_unlock(&sess_obj->lock);
     return ret;
 }
+
+struct session_obj_cache_aif {
+    uint32_t aif_id;
+    struct agm_meta_data_gsl meta;
+    struct param_store params;
+};
+
+struct session_obj_cache {
+    struct agm_meta_data_gsl sess_meta;
+    struct param_store params;
+    uint32_t num_aifs;
+    struct session_obj_cache_aif *aifs;
+};
+
+void session_obj_cache_free(struct session_obj_cache *cache)
+{
+    uint32_t i;
+
+    if (!cache)
+        return;
+
+    for (i = 0; i < cache->num_aifs; i++) {
+        metadata_free(&cache->aifs[i].meta);
+        param_store_clear(&cache->aifs[i].params);
+    }
+    free(cache->aifs);
+    metadata_free(&cache->sess_meta);
+    param_store_clear(&cache->params);
+    free(cache);
+}
+
+int session_obj_cache_save(struct session_obj *sess_obj,
+                           struct session_obj_cache **cache_out)
+{
+    struct session_obj_cache *cache;
+    struct session_obj_cache_aif *saved;
+    struct listnode *node;
+    struct aif *aif_obj;
+    uint32_t num_aifs = 0;
+    int ret = 0;
+
+    cache = calloc(1, sizeof(struct session_obj_cache));
+    if (!cache)
+        return -ENOMEM;
+    param_store_init(&cache->params);
+
+    pthread_mutex_lock(&sess_obj->lock);
+    list_for_each(node, &sess_obj->aif_pool)
+        num_aifs++;
+
+    if (num_aifs) {
+        cache->aifs = calloc(num_aifs, sizeof(struct session_obj_cache_aif));
+        if (!cache->aifs) {
+            ret = -ENOMEM;
+            goto done;
+        }
+    }
+
+    ret = metadata_dup(&cache->sess_meta, &sess_obj->sess_meta);
+    if (!ret)
+        ret = param_store_copy(&cache->params, &sess_obj->params);
+    if (ret)
+        goto done;
+
+    list_for_each(node, &sess_obj->aif_pool) {
+        aif_obj = node_to_item(node, struct aif, node);
+        saved = &cache->aifs[cache->num_aifs++];
+        saved->aif_id = aif_obj->aif_id;
+        param_store_init(&saved->params);
+        ret = metadata_dup(&saved->meta, &aif_obj->sess_aif_meta);
+        if (!ret)
+            ret = param_store_copy(&saved->params, &aif_obj->params);
+        if (ret)
+            goto done;
+    }
+
+done:
+    pthread_mutex_unlock(&sess_obj->lock);
+    if (ret) {
+        AGM_LOGE("Error:%d saving cache of sess_id:%d\n", ret,
+                 sess_obj->sess_id);
+        session_obj_cache_free(cache);
+        return ret;
+    }
+
+    *cache_out = cache;
+    return 0;
+}
+
+void session_obj_cache_restore(struct session_obj *sess_obj,
+                               struct session_obj_cache *cache)
+{
+    struct session_obj_cache_aif *saved;
+    struct listnode *node;
+    struct aif *aif_obj;
+    uint32_t i;
+
+    pthread_mutex_lock(&sess_obj->lock);
+    metadata_free(&sess_obj->sess_meta);
+    sess_obj->sess_meta = cache->sess_meta;
+    memset(&cache->sess_meta, 0, sizeof(cache->sess_meta));
+    param_store_clear(&sess_obj->params);
+    param_store_move(&sess_obj->params, &cache->params);
+
+    list_for_each(node, &sess_obj->aif_pool) {
+        aif_obj = node_to_item(node, struct aif, node);
+        saved = NULL;
+        for (i = 0; i < cache->num_aifs; i++) {
+            if (cache->aifs[i].aif_id == aif_obj->aif_id) {
+                saved = &cache->aifs[i];
+                break;
+            }
+        }
+
+        metadata_free(&aif_obj->sess_aif_meta);
+        param_store_clear(&aif_obj->params);
+        if (!saved)
+            continue;
+        aif_obj->sess_aif_meta = saved->meta;
+        memset(&saved->meta, 0, sizeof(saved->meta));
+        param_store_move(&aif_obj->params, &saved->params);
+    }
+    pthread_mutex_unlock(&sess_obj->lock);
+
+    session_obj_cache_free(cache);
+}
+
+int session_obj_get_all(struct session_obj ***sess_objs, uint32_t *count)
+{
+    struct session_obj **objs = NULL;
+    struct listnode *node;
+    uint32_t num = 0, i = 0;
+
+    pthread_mutex_lock(&sess_pool->lock);
+    list_for_each(node, &sess_pool->session_list)
+        num++;
+
+    if (num) {
+        objs = calloc(num, sizeof(struct session_obj *));
+        if (!objs) {
+            pthread_mutex_unlock(&sess_pool->lock);
+            return -ENOMEM;
+        }
+        list_for_each(node, &sess_pool->session_list)
+            objs[i++] = node_to_item(node, struct session_obj, node);
+    }
+    pthread_mutex_unlock(&sess_pool->lock);
+
+    *sess_objs = objs;
+    *count = num;
+    return 0;
+}
+
+/*
+ *SPF went down and took the graph with it. Release what is left of the
+ *graph and the devices but keep the aifs with their metadata, the cached
+ *configs and the replayed params, along with the state the client left
+ *the session in, so that session_obj_ssr_up() can build it again.
+ */
+void session_obj_ssr_down(struct session_obj *sess_obj)
+{
+    enum agm_session_mode sess_mode;
+    struct aif *aif_obj = NULL;
+    struct listnode *node = NULL;
+    int ret = 0;
+
+    pthread_mutex_lock(&sess_obj->lock);
+    if (sess_obj->state == SESSION_CLOSED)
+        goto done;
+
+    AGM_LOGI("sess_id:%d lost in state:%d\n", sess_obj->sess_id,
+             sess_obj->state);
+    sess_mode = sess_obj->stream_config.sess_mode;
+
+    pthread_mutex_lock(&hwep_lock);
+    ret = graph_close(sess_obj->graph);
+    if (ret)
+        AGM_LOGD("Error:%d closing graph of sess_id:%d\n", ret,
+                 sess_obj->sess_id);
+    sess_obj->graph = NULL;
+
+    if (sess_mode != AGM_SESSION_NON_TUNNEL && sess_mode != AGM_SESSION_NO_CONFIG) {
+        list_for_each(node, &sess_obj->aif_pool) {
+            aif_obj = node_to_item(node, struct aif, node);
+            if (aif_obj->state >= AIF_OPENED) {
+                ret = device_close(aif_obj->dev_obj);
+                if (ret)
+                    AGM_LOGE("Error:%d closing device id:%d\n", ret,
+                             aif_obj->aif_id);
+                aif_obj->state = AIF_OPEN;
+            }
+        }
+    }
+    pthread_mutex_unlock(&hwep_lock);
+
+    sess_obj->ssr_state = sess_obj->state;
+    sess_obj->ssr_pending = true;
+    sess_obj->state = SESSION_CLOSED;
+    session_time_page_set_state(sess_obj, AGM_TIME_PAGE_CLOSED, 0);
+
+done:
+    pthread_mutex_unlock(&sess_obj->lock);
+}
+
+/*
+ *dependent is set for capture sessions which loop back to or take the EC
+ *reference of another session, these need the other one running first.
+ */
+bool session_obj_ssr_pending(struct session_obj *sess_obj, bool *dependent)
+{
+    bool pending;
+
+    pthread_mutex_lock(&sess_obj->lock);
+    pending = sess_obj->ssr_pending;
+    *dependent = pending && sess_obj->stream_config.dir == TX &&
+                 (sess_obj->loopback_state || sess_obj->ec_ref_state);
+    pthread_mutex_unlock(&sess_obj->lock);
+
+    return pending;
+}
+
+/*
+ *Add back the loopback and EC ref edges lost with the graph. One which
+ *cannot be added, e.g. as the other end is not back yet, is dropped
+ *instead of failing the restore, so that the client can set it again.
+ */
+static void session_ssr_restore_links(struct session_obj *sess_obj,
+                                      bool loopback, bool ec_ref)
+{
+    enum agm_session_mode sess_mode = sess_obj->stream_config.sess_mode;
+    int ret = 0;
+
+    if (ec_ref) {
+        /* session_open() only sets up ec_ref on sessions with a device */
+        if (sess_mode != AGM_SESSION_NON_TUNNEL &&
+            sess_mode != AGM_SESSION_NO_CONFIG)
+            ret = session_set_ec_ref(sess_obj, sess_obj->ec_ref_aif_id, true);
+        if (ret) {
+            AGM_LOGE("Error:%d restoring ec_ref aif_id:%d of sess_id:%d\n",
+                     ret, sess_obj->ec_ref_aif_id, sess_obj->sess_id);
+            sess_obj->ec_ref_aif_id = 0;
+        } else {
+            sess_obj->ec_ref_state = true;
+        }
+    }
+
+    if (loopback) {
+        ret = session_set_loopback(sess_obj, sess_obj->loopback_sess_id, true);
+        if (ret) {
+            AGM_LOGE("Error:%d restoring loopback to sess_id:%d of sess_id:%d\n",
+                     ret, sess_obj->loopback_sess_id, sess_obj->sess_id);
+            sess_obj->loopback_sess_id = 0;
+        } else {
+            sess_obj->loopback_state = true;
+        }
+    }
+}
+
+int session_obj_ssr_up(struct session_obj *sess_obj)
+{
+    enum session_state target;
+    struct param_store replay;
+    bool paused, loopback, ec_ref;
+    int ret = 0;
+
+    pthread_mutex_lock(&sess_obj->lock);
+    /* closed or reopened by the client in the meantime */
+    if (!sess_obj->ssr_pending)
+        goto done;
+
+    sess_obj->ssr_pending = false;
+    target = sess_obj->ssr_state;
+    paused = sess_obj->paused;
+
+    /* replayed records go first, anything staged since wins on a common key */
+    param_store_init(&replay);
+    param_store_move(&replay, &sess_obj->replay_params);
+    param_store_move(&replay, &sess_obj->params);
+    param_store_move(&sess_obj->params, &replay);
+
+    /* links are added back below, a missing peer must not fail the open */
+    loopback = sess_obj->loopback_state;
+    ec_ref = sess_obj->ec_ref_state;
+    sess_obj->loopback_state = false;
+    sess_obj->ec_ref_state = false;
+
+    ret = session_open(sess_obj);
+    if (ret) {
+        sess_obj->loopback_state = loopback;
+        sess_obj->ec_ref_state = ec_ref;
+        goto fail;
+    }
+
+    session_ssr_restore_links(sess_obj, loopback, ec_ref);
+
+    if (target != SESSION_OPENED) {
+        ret = session_prepare(sess_obj);
+        if (ret)
+            goto fail;
+    }
+
+    if (target == SESSION_STARTED) {
+        ret = session_start(sess_obj);
+        if (ret)
+            goto fail;
+
+        if (paused) {
+            ret = graph_pause(sess_obj->graph);
+            if (ret)
+                goto fail;
+            sess_obj->paused = true;
+            session_time_page_sync(sess_obj, AGM_TIME_PAGE_PAUSED);
+        }
+    }
+
+    session_gain_mbox_restore(sess_obj);
+    AGM_LOGI("sess_id:%d restored to state:%d\n", sess_obj->sess_id,
+             sess_obj->state);
+    goto done;
+
+fail:
+    AGM_LOGE("Error:%d restoring sess_id:%d to state:%d, left in state:%d\n",
+             ret, sess_obj->sess_id, target, sess_obj->state);
+done:
+    pthread_mutex_unlock(&sess_obj->lock);
+    return ret;
+}
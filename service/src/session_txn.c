@@ -0,0 +1,239 @@
+/*
+* Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+* SPDX-License-Identifier: BSD-3-Clause-Clear
+*/
+#define LOG_TAG "AGM: session_txn"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <agm/agm_api.h>
+#include <agm/session_obj.h>
+#include <agm/session_txn.h>
+#include <agm/utils.h>
+
+#ifdef DYNAMIC_LOG_ENABLED
+#include <log_xml_parser.h>
+#define LOG_MASK AGM_MOD_FILE_SESSION_OBJ
+#include <log_utils.h>
+#endif
+
+/* checks that every record fits and counts aif connect records */
+static int session_txn_validate(struct agm_session_txn *txn, size_t size,
+                                uint32_t *num_connects)
+{
+    struct agm_session_txn_record *rec;
+    size_t offset = sizeof(struct agm_session_txn);
+    uint32_t i;
+
+    if (size < sizeof(struct agm_session_txn)) {
+        AGM_LOGE("transaction of size %zu too small\n", size);
+        return -EINVAL;
+    }
+
+    if (txn->version != AGM_SESSION_TXN_VERSION) {
+        AGM_LOGE("unsupported transaction version %u\n", txn->version);
+        return -EINVAL;
+    }
+
+    *num_connects = 0;
+    for (i = 0; i < txn->num_records; i++) {
+        if (size - offset < sizeof(struct agm_session_txn_record))
+            return -EINVAL;
+
+        rec = (struct agm_session_txn_record *)((uint8_t *)txn + offset);
+        offset += sizeof(struct agm_session_txn_record);
+        if (rec->size > size - offset) {
+            AGM_LOGE("record %u of size %u overruns transaction\n", i,
+                     rec->size);
+            return -EINVAL;
+        }
+
+        switch (rec->type) {
+        case AGM_SESSION_TXN_AIF_CONNECT:
+            (*num_connects)++;
+            break;
+        case AGM_SESSION_TXN_CONFIG:
+            if (rec->size < sizeof(struct agm_session_txn_config))
+                return -EINVAL;
+            break;
+        case AGM_SESSION_TXN_SESS_METADATA:
+        case AGM_SESSION_TXN_AIF_METADATA:
+        case AGM_SESSION_TXN_SESS_PARAMS:
+        case AGM_SESSION_TXN_AIF_PARAMS:
+            break;
+        default:
+            AGM_LOGE("record %u of unknown type %u\n", i, rec->type);
+            return -EINVAL;
+        }
+
+        /* padding of the last record may be omitted */
+        offset += rec->size;
+        if (i + 1 < txn->num_records) {
+            if (AGM_SESSION_TXN_ALIGN(rec->size) - rec->size > size - offset)
+                return -EINVAL;
+            offset += AGM_SESSION_TXN_ALIGN(rec->size) - rec->size;
+        }
+    }
+
+    return 0;
+}
+
+static int session_txn_set_config(struct session_obj *sess_obj,
+                                  struct agm_session_txn *txn,
+                                  struct agm_session_txn_config *cfg)
+{
+    struct agm_session_config stream_config;
+    struct agm_media_config media_config;
+    struct agm_buffer_config buffer_config;
+
+    memset(&stream_config, 0, sizeof(stream_config));
+    stream_config.dir = (enum direction)cfg->dir;
+    stream_config.sess_mode = (enum agm_session_mode)txn->sess_mode;
+    stream_config.start_threshold = cfg->start_threshold;
+    stream_config.stop_threshold = cfg->stop_threshold;
+    stream_config.codec = cfg->codec;
+    stream_config.data_mode = (enum agm_data_mode)cfg->data_mode;
+    stream_config.sess_flags = cfg->sess_flags;
+
+    media_config.rate = cfg->rate;
+    media_config.channels = cfg->channels;
+    media_config.format = (enum agm_media_format)cfg->format;
+    media_config.data_format = cfg->data_format;
+
+    buffer_config.count = cfg->buf_count;
+    buffer_config.size = cfg->buf_size;
+    buffer_config.max_metadata_size = cfg->max_metadata_size;
+
+    return session_obj_set_config(sess_obj, &stream_config, &media_config,
+                                  &buffer_config);
+}
+
+static int session_txn_apply(struct session_obj *sess_obj,
+                             struct agm_session_txn *txn,
+                             struct agm_session_txn_record *rec)
+{
+    switch (rec->type) {
+    case AGM_SESSION_TXN_SESS_METADATA:
+        return session_obj_set_sess_metadata(sess_obj, rec->size, rec->payload);
+    case AGM_SESSION_TXN_AIF_METADATA:
+        return session_obj_set_sess_aif_metadata(sess_obj, rec->aif_id,
+                                                 rec->size, rec->payload);
+    case AGM_SESSION_TXN_AIF_CONNECT:
+        return session_obj_sess_aif_connect(sess_obj, rec->aif_id, true);
+    case AGM_SESSION_TXN_SESS_PARAMS:
+        return session_obj_set_sess_params(sess_obj, rec->payload, rec->size);
+    case AGM_SESSION_TXN_AIF_PARAMS:
+        return session_obj_set_sess_aif_params(sess_obj, rec->aif_id,
+                                               rec->payload, rec->size);
+    case AGM_SESSION_TXN_CONFIG:
+        return session_txn_set_config(sess_obj, txn,
+                              (struct agm_session_txn_config *)rec->payload);
+    default:
+        return -EINVAL;
+    }
+}
+
+int session_txn_execute(void *buf, size_t size, uint64_t *handle)
+{
+    struct agm_session_txn *txn = (struct agm_session_txn *)buf;
+    struct agm_session_txn_record *rec;
+    struct session_obj *sess_obj = NULL;
+    struct session_obj_cache *cache = NULL;
+    uint32_t *connected = NULL;
+    uint32_t num_connects = 0, num_connected = 0, i;
+    size_t offset = sizeof(struct agm_session_txn);
+    bool opened = false;
+    int ret = 0;
+
+    *handle = 0;
+    ret = session_txn_validate(txn, size, &num_connects);
+    if (ret)
+        return ret;
+
+    ret = session_obj_get(txn->session_id, &sess_obj);
+    if (ret) {
+        AGM_LOGE("Error:%d retrieving session obj with session id=%d\n",
+                 ret, txn->session_id);
+        return ret;
+    }
+
+    /* records only update the cache, a failed step puts it back as it was */
+    ret = session_obj_cache_save(sess_obj, &cache);
+    if (ret)
+        return ret;
+
+    if (num_connects) {
+        connected = calloc(num_connects, sizeof(uint32_t));
+        if (!connected) {
+            session_obj_cache_free(cache);
+            return -ENOMEM;
+        }
+    }
+
+    for (i = 0; i < txn->num_records; i++) {
+        rec = (struct agm_session_txn_record *)((uint8_t *)txn + offset);
+        offset += sizeof(struct agm_session_txn_record) +
+                  AGM_SESSION_TXN_ALIGN(rec->size);
+
+        /* connected before the transaction, not ours to undo */
+        if (rec->type == AGM_SESSION_TXN_AIF_CONNECT &&
+            session_obj_aif_connected(sess_obj, rec->aif_id)) {
+            AGM_LOGD("aif_id:%u already connected to session id=%d\n",
+                     rec->aif_id, txn->session_id);
+            continue;
+        }
+
+        ret = session_txn_apply(sess_obj, txn, rec);
+        if (ret) {
+            AGM_LOGE("Error:%d applying record %u of type %u, aif_id:%u on \
+                      session id=%d\n", ret, i, rec->type, rec->aif_id,
+                      txn->session_id);
+            goto unwind;
+        }
+
+        if (rec->type == AGM_SESSION_TXN_AIF_CONNECT)
+            connected[num_connected++] = rec->aif_id;
+    }
+
+    if (!(txn->flags & (AGM_SESSION_TXN_OPEN | AGM_SESSION_TXN_PREPARE |
+                        AGM_SESSION_TXN_START)))
+        goto done;
+
+    ret = session_obj_open(txn->session_id,
+                           (enum agm_session_mode)txn->sess_mode, &sess_obj);
+    if (ret)
+        goto unwind;
+    opened = true;
+
+    if (txn->flags & (AGM_SESSION_TXN_PREPARE | AGM_SESSION_TXN_START)) {
+        ret = session_obj_prepare(sess_obj);
+        if (ret)
+            goto unwind;
+    }
+
+    if (txn->flags & AGM_SESSION_TXN_START) {
+        ret = session_obj_start(sess_obj);
+        if (ret)
+            goto unwind;
+    }
+
+    *handle = (uint64_t)sess_obj;
+    goto done;
+
+unwind:
+    if (opened)
+        session_obj_close(sess_obj);
+    while (num_connected--) {
+        if (session_obj_sess_aif_connect(sess_obj, connected[num_connected],
+                                         false))
+            AGM_LOGE("Failed to disconnect aif_id:%u from session id=%d\n",
+                     connected[num_connected], txn->session_id);
+    }
+    session_obj_cache_restore(sess_obj, cache);
+    cache = NULL;
+done:
+    session_obj_cache_free(cache);
+    free(connected);
+    return ret;
+}
@@ -0,0 +1,295 @@
+/*
+* Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+* SPDX-License-Identifier: BSD-3-Clause-Clear
+*/
+#define LOG_TAG "AGM: ssr_recovery"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "gsl_intf.h"
+#include <agm/agm_memlogger.h>
+#include <agm/agm_sched.h>
+#include <agm/session_obj.h>
+#include <agm/ssr_recovery.h>
+#include <agm/utils.h>
+
+#ifdef DYNAMIC_LOG_ENABLED
+#include <log_xml_parser.h>
+#define LOG_MASK AGM_MOD_FILE_SESSION_OBJ
+#include <log_utils.h>
+#endif
+
+#define SSR_EVENT_DOWN 0x1
+#define SSR_EVENT_UP   0x2
+
+struct ssr_recovery {
+    pthread_t thread;
+    bool thread_created;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    /* SSR_EVENT_* not handled by the recovery thread yet */
+    uint32_t events;
+    bool exit;
+    /* CLOCK_MONOTONIC time in us of the last SVC_DN and SVC_UP */
+    uint64_t down_time;
+    uint64_t up_time;
+    struct agm_ssr_stats stats;
+};
+
+struct ssr_restore_job {
+    pthread_t thread;
+    bool thread_created;
+    struct session_obj *sess_obj;
+    int ret;
+};
+
+/*
+ *lock and cond stay valid for the life of the process, GSL may still be in
+ *a callback it dispatched before the callback was handed back.
+ */
+static struct ssr_recovery ssr = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+};
+
+static uint64_t ssr_get_monotonic_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000) + ((uint64_t)ts.tv_nsec / 1000);
+}
+
+static uint32_t ssr_recovery_event_cb(enum gsl_global_event_ids event_id,
+                                      void *event_payload,
+                                      size_t event_payload_sz,
+                                      void *client_data)
+{
+    agm_memlog_spf_reset_cb(event_id, event_payload, event_payload_sz,
+                            client_data);
+
+    pthread_mutex_lock(&ssr.lock);
+    if (event_id == GSL_GLOBAL_EVENT_AUDIO_SVC_DN) {
+        AGM_LOGI("SPF down\n");
+        ssr.down_time = ssr_get_monotonic_us();
+        /* an UP not handled yet is stale now */
+        ssr.events = (ssr.events & ~SSR_EVENT_UP) | SSR_EVENT_DOWN;
+    } else if (event_id == GSL_GLOBAL_EVENT_AUDIO_SVC_UP) {
+        AGM_LOGI("SPF up\n");
+        ssr.up_time = ssr_get_monotonic_us();
+        ssr.events |= SSR_EVENT_UP;
+    }
+    pthread_cond_signal(&ssr.cond);
+    pthread_mutex_unlock(&ssr.lock);
+
+    return 0;
+}
+
+static void ssr_recovery_down(void)
+{
+    struct session_obj **sess_objs = NULL;
+    uint32_t count = 0, i;
+
+    if (session_obj_get_all(&sess_objs, &count)) {
+        AGM_LOGE("No memory to list sessions, SSR not handled\n");
+        return;
+    }
+
+    for (i = 0; i < count; i++)
+        session_obj_ssr_down(sess_objs[i]);
+
+    pthread_mutex_lock(&ssr.lock);
+    ssr.stats.ssr_count++;
+    pthread_mutex_unlock(&ssr.lock);
+    free(sess_objs);
+}
+
+static void *ssr_restore_thread(void *arg)
+{
+    struct ssr_restore_job *job = (struct ssr_restore_job *)arg;
+
+    agm_thread_sched_apply(AGM_THREAD_SSR);
+    job->ret = session_obj_ssr_up(job->sess_obj);
+    agm_thread_sched_release();
+    return NULL;
+}
+
+/*
+ *Restore all pending sessions with the given dependency class, one thread
+ *per session so that graph opens overlap. Returns number of failures.
+ */
+static uint32_t ssr_recovery_restore(struct session_obj **sess_objs,
+                                     uint32_t count, bool dependent,
+                                     uint32_t *restored)
+{
+    struct ssr_restore_job *jobs;
+    uint32_t i, num_jobs = 0, failed = 0;
+    bool is_dependent;
+
+    jobs = calloc(count, sizeof(struct ssr_restore_job));
+    if (!jobs)
+        return count;
+
+    for (i = 0; i < count; i++) {
+        if (!session_obj_ssr_pending(sess_objs[i], &is_dependent) ||
+            is_dependent != dependent)
+            continue;
+
+        jobs[num_jobs].sess_obj = sess_objs[i];
+        if (pthread_create(&jobs[num_jobs].thread, NULL, ssr_restore_thread,
+                           &jobs[num_jobs]) == 0) {
+            jobs[num_jobs].thread_created = true;
+        } else {
+            AGM_LOGE("restore thread creation failed, restoring inline\n");
+            ssr_restore_thread(&jobs[num_jobs]);
+        }
+        num_jobs++;
+    }
+
+    for (i = 0; i < num_jobs; i++) {
+        if (jobs[i].thread_created)
+            pthread_join(jobs[i].thread, NULL);
+        if (jobs[i].ret)
+            failed++;
+        else
+            (*restored)++;
+    }
+
+    free(jobs);
+    return failed;
+}
+
+static void ssr_recovery_up(void)
+{
+    struct session_obj **sess_objs = NULL;
+    uint32_t count = 0, restored = 0, failed = 0;
+    uint64_t now;
+
+    if (session_obj_get_all(&sess_objs, &count)) {
+        AGM_LOGE("No memory to list sessions, nothing restored\n");
+        return;
+    }
+
+    /* capture sessions looping back from or referencing another go last */
+    failed += ssr_recovery_restore(sess_objs, count, false, &restored);
+    failed += ssr_recovery_restore(sess_objs, count, true, &restored);
+    free(sess_objs);
+
+    now = ssr_get_monotonic_us();
+    pthread_mutex_lock(&ssr.lock);
+    ssr.stats.sessions_restored = restored;
+    ssr.stats.sessions_failed = failed;
+    ssr.stats.up_to_restored_us = now - ssr.up_time;
+    ssr.stats.down_to_restored_us = now - ssr.down_time;
+    AGM_LOGI("SSR %u: %u sessions restored, %u failed, in %llu us after \
+             SVC_UP, %llu us after SVC_DN\n", ssr.stats.ssr_count, restored,
+             failed, (unsigned long long)ssr.stats.up_to_restored_us,
+             (unsigned long long)ssr.stats.down_to_restored_us);
+    pthread_mutex_unlock(&ssr.lock);
+}
+
+static void *ssr_recovery_thread(void *arg __unused)
+{
+    uint32_t events;
+
+    agm_thread_sched_apply(AGM_THREAD_SSR);
+    pthread_mutex_lock(&ssr.lock);
+    while (!ssr.exit) {
+        if (!ssr.events) {
+            pthread_cond_wait(&ssr.cond, &ssr.lock);
+            continue;
+        }
+
+        events = ssr.events;
+        ssr.events = 0;
+        pthread_mutex_unlock(&ssr.lock);
+
+        if (events & SSR_EVENT_DOWN)
+            ssr_recovery_down();
+        if (events & SSR_EVENT_UP)
+            ssr_recovery_up();
+
+        pthread_mutex_lock(&ssr.lock);
+    }
+    pthread_mutex_unlock(&ssr.lock);
+
+    agm_thread_sched_release();
+    return NULL;
+}
+
+/* GSL keeps a single global callback, the memlogger gets it back */
+static void ssr_recovery_release_cb(void)
+{
+    int ret;
+
+    ret = gsl_register_global_event_cb(agm_memlog_spf_reset_cb, NULL);
+    if (ret)
+        AGM_LOGE("Error:%d registering SPF reset memlog callback\n",
+                 ar_err_get_lnx_err_code(ret));
+}
+
+int ssr_recovery_init(void)
+{
+    int ret = 0;
+
+    pthread_mutex_lock(&ssr.lock);
+    ssr.events = 0;
+    ssr.exit = false;
+    ssr.down_time = 0;
+    ssr.up_time = 0;
+    memset(&ssr.stats, 0, sizeof(ssr.stats));
+    pthread_mutex_unlock(&ssr.lock);
+
+    ret = pthread_create(&ssr.thread, NULL, ssr_recovery_thread, NULL);
+    if (ret) {
+        AGM_LOGE("Error:%d creating ssr recovery thread\n", ret);
+        ret = -ret;
+        goto release_cb;
+    }
+    ssr.thread_created = true;
+
+    ret = gsl_register_global_event_cb(ssr_recovery_event_cb, NULL);
+    if (ret) {
+        ret = ar_err_get_lnx_err_code(ret);
+        AGM_LOGE("Error:%d registering SPF reset callback\n", ret);
+        goto stop_thread;
+    }
+
+    return 0;
+
+stop_thread:
+    ssr_recovery_deinit();
+    return ret;
+
+release_cb:
+    ssr_recovery_release_cb();
+    return ret;
+}
+
+void ssr_recovery_deinit(void)
+{
+    if (!ssr.thread_created)
+        return;
+
+    /* no new events once the callback is handed back */
+    ssr_recovery_release_cb();
+
+    pthread_mutex_lock(&ssr.lock);
+    ssr.exit = true;
+    pthread_cond_signal(&ssr.cond);
+    pthread_mutex_unlock(&ssr.lock);
+    pthread_join(ssr.thread, NULL);
+    ssr.thread_created = false;
+}
+
+int ssr_recovery_get_stats(struct agm_ssr_stats *stats)
+{
+    pthread_mutex_lock(&ssr.lock);
+    *stats = ssr.stats;
+    pthread_mutex_unlock(&ssr.lock);
+
+    return 0;
+}
@@ -29,7 +29,13 @@
 
 //#include "pch.h"
 #include <agm/agm_api.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
 
 typedef int(*testcase)(void);
 
@@ -566,6 +572,201 @@ done:
 	return ret;
 }
 
+#define WRITE_LATENCY_ITERATIONS 500
+/* the writer may wait on the DSP for a buffer, never this long on the lock */
+#define LOCK_WAIT_BOUND_US 10000
+
+#define TEST_PARAM_ID_MODULE_ENABLE 0x08001026
+
+/* a set_params payload entry, laid out as apm_module_param_data_t */
+struct test_module_enable_param {
+	uint32_t module_instance_id;
+	uint32_t param_id;
+	uint32_t param_size;
+	uint32_t error_code;
+	uint32_t enable;
+	uint32_t reserved; /* entries are padded to 8 bytes */
+};
+
+static volatile bool control_load_stop;
+static struct test_module_enable_param control_load_param;
+
+/* enable again the first tagged module of the stream, which the DSP applies */
+static int control_load_param_init(void)
+{
+	struct agm_tag_module_info_list *list = NULL;
+	struct agm_tag_info *tag;
+	uint8_t *entry;
+	size_t size = 0;
+	uint32_t i;
+	int ret;
+
+	ret = agm_session_aif_get_tag_module_info(session_id_rx1, aif_id_rx1,
+			NULL, &size);
+	if (ret || !size)
+		return ret ? ret : -EINVAL;
+
+	list = calloc(1, size);
+	if (!list)
+		return -ENOMEM;
+
+	ret = agm_session_aif_get_tag_module_info(session_id_rx1, aif_id_rx1,
+			list, &size);
+	if (ret)
+		goto done;
+
+	ret = -EINVAL;
+	entry = list->tag_info_list;
+	for (i = 0; i < list->num_tags; i++) {
+		tag = (struct agm_tag_info *)entry;
+		if (tag->num_modules) {
+			control_load_param.module_instance_id =
+					tag->mid_iid_list[0].module_iid;
+			control_load_param.param_id = TEST_PARAM_ID_MODULE_ENABLE;
+			control_load_param.param_size = sizeof(uint32_t);
+			control_load_param.enable = 1;
+			ret = 0;
+			break;
+		}
+		entry += sizeof(*tag) +
+				tag->num_modules * sizeof(struct agm_module_id_iid_map);
+	}
+
+done:
+	free(list);
+	return ret;
+}
+
+static void *control_load_thread(void *arg)
+{
+	while (!control_load_stop) {
+		agm_session_set_params(session_id_rx1, &control_load_param,
+				sizeof(control_load_param));
+		agm_session_aif_set_params(session_id_rx1, aif_id_rx1,
+				&control_load_param, sizeof(control_load_param));
+		agm_session_aif_set_metadata(session_id_rx1, aif_id_rx1,
+				sizeof(dev_rx_metadata), dev_rx_metadata);
+	}
+	return NULL;
+}
+
+static long long elapsed_us(struct timespec *start, struct timespec *end)
+{
+	return (end->tv_sec - start->tv_sec) * 1000000LL +
+			(end->tv_nsec - start->tv_nsec) / 1000;
+}
+
+int test_stream_write_latency_with_control_load(void)
+{
+	int ret = 0;
+	char buff[320] = {0};
+	size_t size;
+	int i = 0;
+	pthread_t control_thread;
+	bool control_started = false;
+	struct sched_param param = {0};
+	struct timespec start, end;
+	long long latency_us, max_latency_us = 0, max_lock_wait_us = 0;
+
+	ret = testcase_common_init(__func__);
+	if (ret) {
+		goto fail;
+	}
+
+	ret = setup_device_rx();
+	if (ret) {
+		goto fail;
+	}
+
+	ret = setup_playback_stream();
+	if (ret) {
+		goto fail;
+	}
+
+	ret = setup_playback_stream_open_prepare_start_with_device_rx();
+	if (ret) {
+		goto fail;
+	}
+
+	ret = control_load_param_init();
+	if (ret) {
+		printf("%s: Error:%d, no module to load the session with\n",
+				__func__, ret);
+		goto fail;
+	}
+
+	/* writer runs as an rt audio thread, the control load at normal priority */
+	param.sched_priority = sched_get_priority_min(SCHED_FIFO);
+	if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param))
+		printf("%s: running without SCHED_FIFO\n", __func__);
+
+	control_load_stop = false;
+	ret = pthread_create(&control_thread, NULL, control_load_thread, NULL);
+	if (ret) {
+		goto fail;
+	}
+	control_started = true;
+
+	for (i = 0; i < WRITE_LATENCY_ITERATIONS; i++) {
+		size = sizeof(buff);
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		ret = agm_session_write(sess_handle_rx1, buff, &size);
+		clock_gettime(CLOCK_MONOTONIC, &end);
+		if (ret) {
+			printf("%s: Error:%d, session write failed\n", __func__, ret);
+			goto fail;
+		}
+		latency_us = elapsed_us(&start, &end);
+		if (latency_us > max_latency_us)
+			max_latency_us = latency_us;
+
+		/*
+		 * A write also waits for the DSP to free a buffer, the buffer
+		 * count query only takes the session lock, so it tells how long
+		 * the control calls hold the writer off.
+		 */
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		agm_get_hw_processed_buff_cnt(sess_handle_rx1, RX);
+		clock_gettime(CLOCK_MONOTONIC, &end);
+		latency_us = elapsed_us(&start, &end);
+		if (latency_us > max_lock_wait_us)
+			max_lock_wait_us = latency_us;
+	}
+
+	control_load_stop = true;
+	pthread_join(control_thread, NULL);
+	control_started = false;
+
+	printf("%s: max write latency %lld us, max lock wait %lld us\n",
+			__func__, max_latency_us, max_lock_wait_us);
+	if (max_lock_wait_us > LOCK_WAIT_BOUND_US) {
+		ret = -1;
+		goto fail;
+	}
+
+	ret = setup_playback_stream_stop_close();
+	if (ret) {
+		goto fail;
+	}
+
+	printf("TEST PASS: %s()\n", __func__);
+	goto done;
+
+fail:
+	printf("TEST FAIL: %s()\n", __func__);
+	goto done;
+
+done:
+	if (control_started) {
+		control_load_stop = true;
+		pthread_join(control_thread, NULL);
+	}
+	param.sched_priority = 0;
+	pthread_setschedparam(pthread_self(), SCHED_OTHER, &param);
+	testcase_common_deinit(__func__);
+	return ret;
+}
+
 int test_stream_pause_resume(void) {
 	int ret = 0;
 
@@ -1465,6 +1666,7 @@ int main() {
 	testcase testcases[] = {
 			    test_device_get_aif_list,
 				test_stream_sssd_with_buf_writes,
+				test_stream_write_latency_with_control_load,
 				test_stream_sssd_deviceswitch,
 				test_stream_ssmd,
 				test_stream_ssmd_teardown_first_device,